@@ -5,9 +5,16 @@
 #include "GPCS4Log.h"
 
 #include "UtilString.h"
+#include "Platform/PlatThread.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstdio>
 #include <memory>
+#include <mutex>
+#include <thread>
 #include <cxxopts/cxxopts.hpp>
 #include <spdlog/sinks/basic_file_sink.h>
 #include <spdlog/sinks/msvc_sink.h>
@@ -38,6 +45,328 @@ namespace logsys
 {;
 
 static std::unique_ptr<spdlog::logger> g_logger;
+static AssertHandler                   g_assertHandler = nullptr;
+
+// Per-thread single producer single consumer ring buffer.
+// The owning thread writes records, the log thread reads them.
+class LogRing
+{
+public:
+	static constexpr size_t Capacity = 0x100000;
+
+	LogRing() :
+		m_buffer(new uint8_t[Capacity]),
+		m_threadId(plat::GetThreadId())
+	{
+	}
+
+	uint8_t* reserve(size_t size)
+	{
+		size = util::align(size, detail::RecordAlign);
+
+		uint64_t head   = m_head.load(std::memory_order_relaxed);
+		size_t   offset = head % Capacity;
+		size_t   tail   = Capacity - offset;
+		if (tail < size)
+		{
+			// not enough space at the end, fill with a padding record and wrap around
+			waitForSpace(head, tail);
+			auto padding       = reinterpret_cast<detail::RecordHeader*>(&m_buffer[offset]);
+			padding->size      = static_cast<uint32_t>(tail);
+			padding->formatter = nullptr;
+			head += tail;
+			m_head.store(head, std::memory_order_release);
+			offset = 0;
+		}
+
+		waitForSpace(head, size);
+		auto record  = &m_buffer[offset];
+		reinterpret_cast<detail::RecordHeader*>(record)->size = static_cast<uint32_t>(size);
+		return record;
+	}
+
+	void commit(uint8_t* record)
+	{
+		auto header = reinterpret_cast<detail::RecordHeader*>(record);
+		m_head.fetch_add(header->size, std::memory_order_release);
+	}
+
+	// Returns nullptr if the ring is empty.
+	const detail::RecordHeader* peek()
+	{
+		while (true)
+		{
+			uint64_t tail = m_tail.load(std::memory_order_relaxed);
+			if (tail == m_head.load(std::memory_order_acquire))
+			{
+				return nullptr;
+			}
+
+			auto header = reinterpret_cast<const detail::RecordHeader*>(&m_buffer[tail % Capacity]);
+			if (header->formatter)
+			{
+				return header;
+			}
+			// skip padding
+			m_tail.store(tail + header->size, std::memory_order_release);
+		}
+	}
+
+	void pop(const detail::RecordHeader* header)
+	{
+		m_tail.fetch_add(header->size, std::memory_order_release);
+	}
+
+	uint64_t threadId() const
+	{
+		return m_threadId;
+	}
+
+	void retire()
+	{
+		m_retired.store(true, std::memory_order_release);
+	}
+
+	bool retired() const
+	{
+		return m_retired.load(std::memory_order_acquire);
+	}
+
+private:
+	void waitForSpace(uint64_t head, size_t size)
+	{
+		// The log thread is behind, block the producer
+		// rather than dropping records.
+		while (head + size - m_tail.load(std::memory_order_acquire) > Capacity)
+		{
+			std::this_thread::yield();
+		}
+	}
+
+private:
+	std::unique_ptr<uint8_t[]> m_buffer;
+	uint64_t                   m_threadId;
+	std::atomic<bool>          m_retired = { false };
+
+	alignas(64) std::atomic<uint64_t> m_head = { 0 };
+	alignas(64) std::atomic<uint64_t> m_tail = { 0 };
+};
+
+
+// Formats records from all rings on a background thread.
+class LogWriter
+{
+public:
+	LogWriter()
+	{
+	}
+
+	~LogWriter()
+	{
+		stop();
+	}
+
+	void start()
+	{
+		m_running.store(true, std::memory_order_release);
+		m_thread = std::thread([this]() { run(); });
+	}
+
+	void stop()
+	{
+		if (m_thread.joinable())
+		{
+			m_running.store(false, std::memory_order_release);
+			m_thread.join();
+		}
+		// drain what left synchronously
+		drain();
+	}
+
+	bool running() const
+	{
+		return m_running.load(std::memory_order_acquire);
+	}
+
+	std::shared_ptr<LogRing> createRing()
+	{
+		auto ring = std::make_shared<LogRing>();
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_rings.push_back(ring);
+		return ring;
+	}
+
+	void flush()
+	{
+		if (!running())
+		{
+			drain();
+			return;
+		}
+
+		uint64_t sequence = m_drainSequence.load(std::memory_order_acquire);
+		// wait two full passes to make sure records committed
+		// before this call have been seen
+		while (m_drainSequence.load(std::memory_order_acquire) < sequence + 2)
+		{
+			std::this_thread::yield();
+		}
+		g_logger->flush();
+	}
+
+	// Write out all pending records, merging rings by timestamp.
+	// Only called from one thread at a time.
+	size_t drain()
+	{
+		std::lock_guard<std::mutex> drainLock(m_drainMutex);
+
+		std::vector<std::shared_ptr<LogRing>> rings;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			rings = m_rings;
+		}
+
+		size_t count = 0;
+		while (true)
+		{
+			LogRing*                    oldest       = nullptr;
+			const detail::RecordHeader* oldestRecord = nullptr;
+			for (auto& ring : rings)
+			{
+				auto record = ring->peek();
+				if (record && (!oldestRecord || record->timestamp < oldestRecord->timestamp))
+				{
+					oldest       = ring.get();
+					oldestRecord = record;
+				}
+			}
+
+			if (!oldest)
+			{
+				break;
+			}
+
+			write(oldest->threadId(), oldestRecord);
+			oldest->pop(oldestRecord);
+			++count;
+		}
+
+		// release rings of exited threads
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_rings.erase(std::remove_if(m_rings.begin(), m_rings.end(),
+									 [](const std::shared_ptr<LogRing>& ring)
+									 { return ring->retired() && !ring->peek(); }),
+					  m_rings.end());
+
+		m_drainSequence.fetch_add(1, std::memory_order_release);
+		return count;
+	}
+
+private:
+	void run()
+	{
+		while (running())
+		{
+			if (!drain())
+			{
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
+		}
+	}
+
+	void write(uint64_t threadId, const detail::RecordHeader* header)
+	{
+		if (!g_logger)
+		{
+			return;
+		}
+
+		char szTempStr[LOG_STR_BUFFER_LEN + 1] = { 0 };
+		header->formatter(szTempStr, LOG_STR_BUFFER_LEN, header->format,
+						  reinterpret_cast<const uint8_t*>(header + 1));
+
+		const char* szFunction = header->function;
+		int         nLine      = header->line;
+		switch (header->level)
+		{
+		case Level::kDebug:
+			g_logger->debug("[{}]{}({}): {}", threadId, szFunction, nLine, szTempStr);
+			break;
+		case Level::kTrace:
+			g_logger->trace("[{}]{}({}): {}", threadId, szFunction, nLine, szTempStr);
+			break;
+		case Level::kFixme:
+			g_logger->warn("[{}]<FIXME>{}({}): {}", threadId, szFunction, nLine, szTempStr);
+			break;
+		case Level::kWarning:
+			g_logger->warn("[{}]{}({}): {}", threadId, szFunction, nLine, szTempStr);
+			break;
+		case Level::kError:
+			g_logger->error("[{}]{}({}): {}", threadId, szFunction, nLine, szTempStr);
+			break;
+		case Level::kSceTrace:
+			g_logger->trace("[{}]<SCE>{}({}): {}", threadId, szFunction, nLine, szTempStr);
+			break;
+		case Level::kSceGraphic:
+			g_logger->trace("[{}]<GRAPH>{}({}): {}", threadId, szFunction, nLine, szTempStr);
+			break;
+		}
+	}
+
+private:
+	std::mutex                            m_mutex;
+	std::mutex                            m_drainMutex;
+	std::vector<std::shared_ptr<LogRing>> m_rings;
+	std::atomic<bool>                     m_running       = { false };
+	std::atomic<uint64_t>                 m_drainSequence = { 0 };
+	std::thread                           m_thread;
+};
+
+static LogWriter g_writer;
+
+
+// Retires the ring when the owning thread exits,
+// the log thread frees it once it's drained.
+struct LogRingHolder
+{
+	std::shared_ptr<LogRing> ring = g_writer.createRing();
+
+	~LogRingHolder()
+	{
+		ring->retire();
+	}
+};
+
+static LogRing& threadRing()
+{
+	static thread_local LogRingHolder t_holder;
+	return *t_holder.ring;
+}
+
+namespace detail
+{
+	uint8_t* beginRecord(size_t size)
+	{
+		return threadRing().reserve(size);
+	}
+
+	void commitRecord(uint8_t* record)
+	{
+		threadRing().commit(record);
+		if (!g_writer.running())
+		{
+			// log thread not started yet or already stopped,
+			// write synchronously
+			g_writer.drain();
+		}
+	}
+
+	uint64_t timestamp()
+	{
+		return std::chrono::steady_clock::now().time_since_epoch().count();
+	}
+}  // namespace detail
+
 
 void initSpdLog()
 {
@@ -45,15 +374,15 @@ void initSpdLog()
 
 	auto console_sink = std::make_shared<spdlog::sinks::stdout_color_sink_mt>();
 	console_sink->set_level(spdlog::level::trace);  // message generating filter
-	console_sink->set_pattern("[%t][%^%l%$]%v");
+	console_sink->set_pattern("[%^%l%$]%v");
 
 	auto msvc_sink = std::make_shared<spdlog::sinks::msvc_sink_mt>();
 	msvc_sink->set_level(spdlog::level::trace);  // message generating filter
-	msvc_sink->set_pattern("[%t][%^%l%$]%v");
+	msvc_sink->set_pattern("[%^%l%$]%v");
 
 	auto file_sink = std::make_shared<spdlog::sinks::basic_file_sink_mt>("GPCS4.log", true);
 	file_sink->set_level(spdlog::level::trace);
-	file_sink->set_pattern("[%t][%^%l%$]%v");
+	file_sink->set_pattern("[%^%l%$]%v");
 
 	//g_logger.reset(new spdlog::logger("GPCS4", { console_sink }));
 	//g_logger.reset(new spdlog::logger("GPCS4", { msvc_sink, file_sink, console_sink }));
@@ -99,44 +428,25 @@ void init(const cxxopts::ParseResult& optResult)
 {
 	initSpdLog();
 	initLogChannel(optResult);
+	g_writer.start();
 }
 
-void Channel::print(Level nLevel, const char* szFunction, const char* szSourcePath, int nLine, const char* szFormat, ...)
+void flush()
 {
-	if (!m_enabled)
-	{
-		return;
-	}
-	// generate format string
-	va_list stArgList;
-	va_start(stArgList, szFormat);
-	char szTempStr[LOG_STR_BUFFER_LEN + 1] = { 0 };
-	vsprintf_s(szTempStr, LOG_STR_BUFFER_LEN, szFormat, stArgList);
-	va_end(stArgList);
+	g_writer.flush();
+}
 
-	switch (nLevel)
-	{
-	case Level::kDebug:
-		g_logger->debug("{}({}): {}", szFunction, nLine, szTempStr);
-		break;
-	case Level::kTrace:
-		g_logger->trace("{}({}): {}", szFunction, nLine, szTempStr);
-		break;
-	case Level::kFixme:
-		g_logger->warn("<FIXME>{}({}): {}", szFunction, nLine, szTempStr);
-		break;
-	case Level::kWarning:
-		g_logger->warn("{}({}): {}", szFunction, nLine, szTempStr);
-		break;
-	case Level::kError:
-		g_logger->error("{}({}): {}", szFunction, nLine, szTempStr);
-		break;
-	case Level::kSceTrace:
-		g_logger->trace("<SCE>{}({}): {}", szFunction, nLine, szTempStr);
-		break;
-	case Level::kSceGraphic:
-		g_logger->trace("<GRAPH>{}({}): {}", szFunction, nLine, szTempStr);
-		break;
+void setAssertHandler(AssertHandler handler)
+{
+	g_assertHandler = handler;
+}
+
+void shutdown()
+{
+	g_writer.stop();
+	if (g_logger)
+	{
+		g_logger->flush();
 	}
 }
 
@@ -155,8 +465,16 @@ void Channel::assert_(const char* szExpression, const char* szFunction, const ch
 	sprintf_s(szMsgBoxStr, LOG_STR_BUFFER_LEN, "[Assert@%s]: %s\n[Cause]: %s\n[Path]: %s(%d): %s", getName().c_str(), szExpression, szTempStr, szSourcePath, nLine, szFunction);
 	va_end(stArgList);
 
+	// make sure everything before the assertion is written
+	flush();
 	g_logger->critical("[{}]{}({}): [Assert: {}] {}", getName(), szFunction, nLine, szExpression, szTempStr);
 
+	if (g_assertHandler)
+	{
+		g_assertHandler(szMsgBoxStr);
+		return;
+	}
+
 	showMessageBox("Assertion Fail", szMsgBoxStr);
 
 #ifdef GPCS4_DEBUG
@@ -168,13 +486,36 @@ void Channel::assert_(const char* szExpression, const char* szFunction, const ch
 
 Channel::Channel(const std::string& n) :
 	m_channelNameList(util::str::split(n, '.')),
-	m_enabled(false)
+	m_enabled(false),
+	m_minSeverity(GPCS4_LOG_SEVERITY_TRACE)
 {
 	auto cc = ChannelContainer::get();
 	cc->add(this);
 }
 
-void Channel::checkSig(const std::string& n)
+static int parseSeverity(const std::string& level)
+{
+	int severity = GPCS4_LOG_SEVERITY_TRACE;
+	if (level == "debug")
+	{
+		severity = GPCS4_LOG_SEVERITY_DEBUG;
+	}
+	else if (level == "fixme")
+	{
+		severity = GPCS4_LOG_SEVERITY_FIXME;
+	}
+	else if (level == "warn")
+	{
+		severity = GPCS4_LOG_SEVERITY_WARNING;
+	}
+	else if (level == "error")
+	{
+		severity = GPCS4_LOG_SEVERITY_ERROR;
+	}
+	return severity;
+}
+
+void Channel::checkSig(const std::string& sig)
 {
 	do 
 	{
@@ -184,9 +525,20 @@ void Channel::checkSig(const std::string& n)
 			break;
 		}
 
+		// "Solar.Earth:warn" enables the channel with minimum level warning
+		std::string n        = sig;
+		int         severity = GPCS4_LOG_SEVERITY_TRACE;
+		auto        colon    = sig.find(':');
+		if (colon != std::string::npos)
+		{
+			n        = sig.substr(0, colon);
+			severity = parseSeverity(sig.substr(colon + 1));
+		}
+
 		if (n == "ALL")
 		{
-			m_enabled = true;
+			m_enabled     = true;
+			m_minSeverity = severity;
 			break;
 		}
 		m_enabled = false;
@@ -211,12 +563,13 @@ void Channel::checkSig(const std::string& n)
 		// If this name is "Solar.Earth.Asia", should enable
 		if (up.size() <= m_channelNameList.size())
 		{
-			m_enabled = true;
+			m_enabled     = true;
+			m_minSeverity = severity;
 		}
 	} while (false);
 }
 
-std::string Channel::getName()
+std::string Channel::getName() const
 {
 	return util::str::concat(m_channelNameList, ".");
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "GPCS4Common.h"
+#include "GPCS4LogRecord.h"
 
 #include <string>
 #include <vector>
@@ -15,6 +16,18 @@ namespace logsys
 
 	void init(const cxxopts::ParseResult& optResult);
 
+	// Block until the log thread has written all pending records.
+	void flush();
+
+	// Drain pending records and stop the log thread.
+	void shutdown();
+
+	// Called with the message of a failed assertion instead of
+	// showing it and stopping the process. Tools set this to
+	// report the failure, it may throw to abandon the work.
+	using AssertHandler = void (*)(const char* message);
+	void setAssertHandler(AssertHandler handler);
+
 	enum class Level : int
 	{
 		kTrace,
@@ -26,20 +39,63 @@ namespace logsys
 		kSceGraphic,
 	};
 
+	constexpr int severity(Level level)
+	{
+		switch (level)
+		{
+		case Level::kDebug:
+			return GPCS4_LOG_SEVERITY_DEBUG;
+		case Level::kFixme:
+			return GPCS4_LOG_SEVERITY_FIXME;
+		case Level::kWarning:
+			return GPCS4_LOG_SEVERITY_WARNING;
+		case Level::kError:
+			return GPCS4_LOG_SEVERITY_ERROR;
+		default:
+			return GPCS4_LOG_SEVERITY_TRACE;
+		}
+	}
+
 	class Channel
 	{
 	public:
 		Channel(const std::string& n);
 
-		void print(Level nLevel, const char* szFunction, const char* szSourcePath, int nLine, const char* szFormat, ...);
+		// Checked by the log macros before any argument is evaluated.
+		bool isEnabled(Level nLevel) const
+		{
+			return m_enabled && severity(nLevel) >= m_minSeverity;
+		}
+
+		template <typename... Args>
+		void print(Level nLevel, const char* szFunction, const char* szSourcePath, int nLine, const char* szFormat, Args... args)
+		{
+			uint64_t strings = detail::stringArguments<Args...>(szFormat);
+			size_t   size    = sizeof(detail::RecordHeader) + detail::payloadSize(strings, args...);
+			uint8_t* record  = detail::beginRecord(size);
+
+			auto header       = reinterpret_cast<detail::RecordHeader*>(record);
+			header->level     = nLevel;
+			header->line      = nLine;
+			header->timestamp = detail::timestamp();
+			header->channel   = this;
+			header->function  = szFunction;
+			header->format    = szFormat;
+			header->formatter = &detail::formatRecord<Args...>;
+			detail::encodePayload(record + sizeof(detail::RecordHeader), strings, args...);
+
+			detail::commitRecord(record);
+		}
+
 		void assert_(const char* szExpression, const char* szFunction, const char* szSourcePath, int nLine, const char* szFormat, ...);
 
 		void        checkSig(const std::string& n);
-		std::string getName();
+		std::string getName() const;
 
 	private:
 		const std::vector<std::string> m_channelNameList;
 		bool                           m_enabled;
+		int                            m_minSeverity;
 	};
 
 	class ChannelContainer
@@ -59,9 +115,10 @@ namespace logsys
 }  // namespace logsys
 
 //do not use these directly
-#define _LOG_PRINT_(level, format, ...)    __logger_handle.print(level, __FUNCTION__, __FILE__, __LINE__, format, __VA_ARGS__)
+#define _LOG_ENABLED_(level)               (::logsys::severity(level) >= GPCS4_LOG_MIN_SEVERITY && __logger_handle.isEnabled(level))
+#define _LOG_PRINT_(level, format, ...)    (void)(_LOG_ENABLED_(level) && (__logger_handle.print(level, __FUNCTION__, __FILE__, __LINE__, format, __VA_ARGS__), 0))
 #define _LOG_ASSERT_(expr, format, ...)    (void)(!!(expr) || (__logger_handle.assert_(#expr, __FUNCTION__, __FILE__, __LINE__, format, __VA_ARGS__), 0))
-#define _LOG_IF_(expr, level, format, ...) (void)(!!(expr) && (__logger_handle.print(level, __FUNCTION__, __FILE__, __LINE__, format, __VA_ARGS__), 0))
+#define _LOG_IF_(expr, level, format, ...) (void)(!!(expr) && _LOG_ENABLED_(level) && (__logger_handle.print(level, __FUNCTION__, __FILE__, __LINE__, format, __VA_ARGS__), 0))
 
 #ifdef GPCS4_DEBUG
 
@@ -69,13 +126,29 @@ namespace logsys
 #define LOG_CHANNEL(ch) static ::logsys::Channel __logger_handle(#ch)
 
 // for debug print
+#if GPCS4_LOG_MIN_SEVERITY <= GPCS4_LOG_SEVERITY_DEBUG
 #define LOG_DEBUG(format, ...) _LOG_PRINT_(::logsys::Level::kDebug, format, __VA_ARGS__);
+#else
+#define LOG_DEBUG(format, ...)
+#endif
 // for trace calling
+#if GPCS4_LOG_MIN_SEVERITY <= GPCS4_LOG_SEVERITY_TRACE
 #define LOG_TRACE(format, ...) _LOG_PRINT_(::logsys::Level::kTrace, format, __VA_ARGS__);
+#else
+#define LOG_TRACE(format, ...)
+#endif
 // should be fixed, but without fix, the program should run, treat this as TODO
+#if GPCS4_LOG_MIN_SEVERITY <= GPCS4_LOG_SEVERITY_FIXME
 #define LOG_FIXME(format, ...) _LOG_PRINT_(::logsys::Level::kFixme, format, __VA_ARGS__);
+#else
+#define LOG_FIXME(format, ...)
+#endif
 // should be fixed, without this, program can run, but behaves unexpected
+#if GPCS4_LOG_MIN_SEVERITY <= GPCS4_LOG_SEVERITY_WARNING
 #define LOG_WARN(format, ...) _LOG_PRINT_(::logsys::Level::kWarning, format, __VA_ARGS__);
+#else
+#define LOG_WARN(format, ...)
+#endif
 // critical error, program can't go on
 #define LOG_ERR(format, ...) _LOG_PRINT_(::logsys::Level::kError, format, __VA_ARGS__);
 // critical error, log then pop up a window then exit process
@@ -96,10 +169,18 @@ namespace logsys
 
 // only use to trace sce module export functions
 // to trace other functions, use LOG_TRACE
+#if GPCS4_LOG_MIN_SEVERITY <= GPCS4_LOG_SEVERITY_TRACE
 #define LOG_SCE_TRACE(format, ...) _LOG_PRINT_(::logsys::Level::kSceTrace, format, __VA_ARGS__);
+#else
+#define LOG_SCE_TRACE(format, ...)
+#endif
 
 // only use to trace graphic calls, mostly in libVideoOut and libGnmDriver
+#if GPCS4_LOG_MIN_SEVERITY <= GPCS4_LOG_SEVERITY_TRACE
 #define LOG_SCE_GRAPHIC(format, ...) _LOG_PRINT_(::logsys::Level::kSceGraphic, format, __VA_ARGS__);
+#else
+#define LOG_SCE_GRAPHIC(format, ...)
+#endif
 
 // not really implemented
 // just return result which looks correct to let the program go on
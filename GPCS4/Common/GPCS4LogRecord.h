@@ -0,0 +1,230 @@
+#pragma once
+
+// Binary log record encoding.
+// The producer thread only copies the format string pointer and raw argument values
+// into its ring buffer, formatting is deferred to the log thread.
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <tuple>
+#include <type_traits>
+
+namespace logsys
+{
+	enum class Level : int;
+	class Channel;
+
+	namespace detail
+	{
+		typedef int (*PFN_FORMAT_RECORD)(char* buffer, size_t size, const char* format, const uint8_t* payload);
+
+		struct RecordHeader
+		{
+			// total size including header, padding record if formatter is null
+			uint32_t          size;
+			Level             level;
+			int               line;
+			uint64_t          timestamp;
+			const Channel*    channel;
+			const char*       function;
+			const char*       format;
+			PFN_FORMAT_RECORD formatter;
+		};
+
+		constexpr size_t RecordAlign   = alignof(RecordHeader);
+		constexpr size_t MaxStringSize = 0x2000;
+
+		template <typename T>
+		constexpr bool IsCharPointer = std::is_same_v<T, const char*> || std::is_same_v<T, char*>;
+
+		// Bit i is set if argument i is printed by %s.
+		// Char pointers printed any other way, e.g. by %p, needn't point to a string.
+		inline uint64_t parseStringArguments(const char* format)
+		{
+			uint64_t strings = 0;
+			uint32_t index   = 0;
+			for (const char* p = format; *p && index < 64; ++p)
+			{
+				if (*p != '%')
+				{
+					continue;
+				}
+
+				if (*++p == '%')
+				{
+					continue;
+				}
+
+				// flags, width, precision and length, * takes an argument
+				while (*p && !std::strchr("diouxXeEfFgGaAcspn", *p))
+				{
+					index += *p == '*';
+					++p;
+				}
+
+				if (!*p)
+				{
+					break;
+				}
+
+				if (*p == 's' && index < 64)
+				{
+					strings |= uint64_t(1) << index;
+				}
+				++index;
+			}
+			return strings;
+		}
+
+		inline bool isStringArgument(uint64_t strings, uint32_t index)
+		{
+			return index < 64 && (strings >> index) & 1;
+		}
+
+		// Plain values are copied bitwise.
+		template <typename T>
+		struct ArgCodec
+		{
+			static_assert(std::is_trivially_copyable_v<T>, "log argument must be trivially copyable.");
+
+			typedef T Decoded;
+
+			static size_t size(const T&, bool)
+			{
+				return sizeof(T);
+			}
+
+			static uint8_t* encode(uint8_t* dst, const T& value, bool)
+			{
+				std::memcpy(dst, &value, sizeof(T));
+				return dst + sizeof(T);
+			}
+
+			static const uint8_t* decode(const uint8_t* src, T& value, bool)
+			{
+				std::memcpy(&value, src, sizeof(T));
+				return src + sizeof(T);
+			}
+		};
+
+		// Strings may not outlive the call, so they are copied into the record.
+		// Char pointers not printed by %s are copied as plain pointers.
+		template <>
+		struct ArgCodec<const char*>
+		{
+			typedef const char* Decoded;
+
+			static uint32_t length(const char* str)
+			{
+				return str ? static_cast<uint32_t>(strnlen(str, MaxStringSize - 1)) : 0;
+			}
+
+			static size_t size(const char* str, bool string)
+			{
+				if (!string)
+				{
+					return sizeof(str);
+				}
+				return sizeof(uint32_t) + (str ? length(str) + 1 : 0);
+			}
+
+			static uint8_t* encode(uint8_t* dst, const char* str, bool string)
+			{
+				if (!string)
+				{
+					std::memcpy(dst, &str, sizeof(str));
+					return dst + sizeof(str);
+				}
+
+				uint32_t len = str ? length(str) : UINT32_MAX;
+				std::memcpy(dst, &len, sizeof(len));
+				dst += sizeof(len);
+				if (str)
+				{
+					std::memcpy(dst, str, len);
+					dst[len] = '\0';
+					dst += len + 1;
+				}
+				return dst;
+			}
+
+			static const uint8_t* decode(const uint8_t* src, const char*& str, bool string)
+			{
+				if (!string)
+				{
+					std::memcpy(&str, src, sizeof(str));
+					return src + sizeof(str);
+				}
+
+				uint32_t len = 0;
+				std::memcpy(&len, src, sizeof(len));
+				src += sizeof(len);
+				if (len == UINT32_MAX)
+				{
+					str = "(null)";
+					return src;
+				}
+				str = reinterpret_cast<const char*>(src);
+				return src + len + 1;
+			}
+		};
+
+		template <>
+		struct ArgCodec<char*> : public ArgCodec<const char*>
+		{
+		};
+
+		// The format is only parsed if there is a char pointer argument.
+		template <typename... Args>
+		uint64_t stringArguments(const char* format)
+		{
+			if constexpr ((IsCharPointer<Args> || ...))
+			{
+				return parseStringArguments(format);
+			}
+			return 0;
+		}
+
+		template <typename... Args>
+		size_t payloadSize(uint64_t strings, const Args&... args)
+		{
+			size_t   size  = 0;
+			uint32_t index = 0;
+			((size += ArgCodec<Args>::size(args, isStringArgument(strings, index++))), ...);
+			return size;
+		}
+
+		template <typename... Args>
+		void encodePayload(uint8_t* dst, uint64_t strings, const Args&... args)
+		{
+			uint32_t index = 0;
+			((dst = ArgCodec<Args>::encode(dst, args, isStringArgument(strings, index++))), ...);
+		}
+
+		template <typename... Args>
+		int formatRecord(char* buffer, size_t size, const char* format, const uint8_t* payload)
+		{
+			uint64_t strings = stringArguments<Args...>(format);
+			uint32_t index   = 0;
+
+			std::tuple<typename ArgCodec<Args>::Decoded...> values;
+			std::apply([&](auto&... value)
+					   { ((payload = ArgCodec<Args>::decode(payload, value, isStringArgument(strings, index++))), ...); },
+					   values);
+			return std::apply([&](const auto&... value)
+							  { return std::snprintf(buffer, size, format, value...); },
+							  values);
+		}
+
+		// Reserve a record in the calling thread's ring buffer.
+		uint8_t* beginRecord(size_t size);
+
+		// Publish the record to the log thread.
+		void commitRecord(uint8_t* record);
+
+		uint64_t timestamp();
+
+	}  // namespace detail
+
+}  // namespace logsys
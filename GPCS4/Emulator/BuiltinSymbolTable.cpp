@@ -0,0 +1,145 @@
+#include "BuiltinSymbolTable.h"
+#include "sce_module_common.h"
+
+LOG_CHANNEL(Emulator.BuiltinSymbolTable);
+
+constexpr uint64_t FnvOffsetBasis = 0xCBF29CE484222325ull;
+constexpr uint64_t FnvPrime       = 0x100000001B3ull;
+
+static uint64_t fnv1a(uint64_t hash, const void *data, size_t size)
+{
+	auto bytes = reinterpret_cast<const uint8_t *>(data);
+	for (size_t i = 0; i != size; ++i)
+	{
+		hash ^= bytes[i];
+		hash *= FnvPrime;
+	}
+	return hash;
+}
+
+bool SymbolKey::operator==(SymbolKey const &other) const
+{
+	return isEncoded == other.isEncoded &&
+		   nid == other.nid &&
+		   moduleName == other.moduleName &&
+		   libraryName == other.libraryName &&
+		   name == other.name;
+}
+
+uint64_t SymbolKeyHash::operator()(SymbolKey const &key) const
+{
+	// separates the names, and NID keys from name keys
+	const char separator = '\0';
+
+	uint64_t hash = FnvOffsetBasis;
+	hash = fnv1a(hash, key.moduleName.data(), key.moduleName.size());
+	hash = fnv1a(hash, &separator, sizeof(separator));
+	hash = fnv1a(hash, key.libraryName.data(), key.libraryName.size());
+	if (key.isEncoded)
+	{
+		hash = fnv1a(hash, &key.nid, sizeof(key.nid));
+	}
+	else
+	{
+		hash = fnv1a(hash, &separator, sizeof(separator));
+		hash = fnv1a(hash, key.name.data(), key.name.size());
+	}
+	return hash;
+}
+
+SymbolKey BuiltinSymbolTable::symbolKey(std::string const &modName,
+										std::string const &libName,
+										uint64_t nid)
+{
+	return SymbolKey{ modName, libName, true, nid, {} };
+}
+
+SymbolKey BuiltinSymbolTable::symbolKey(std::string const &modName,
+										std::string const &libName,
+										std::string const &name)
+{
+	return SymbolKey{ modName, libName, false, 0, name };
+}
+
+void BuiltinSymbolTable::addModule(const SCE_EXPORT_MODULE &module)
+{
+	LOG_ASSERT(!m_table.isFrozen(), "module added to a frozen builtin symbol table");
+	m_modules.push_back(&module);
+}
+
+bool BuiltinSymbolTable::freeze(PolicyManager const &policyManager)
+{
+	bool retVal = true;
+
+	for (auto module : m_modules)
+	{
+		std::string modName = module->szModuleName;
+
+		for (auto pLib = module->pLibraries; !pLib->isEndEntry(); pLib = pLib->iterNext())
+		{
+			std::string libName = pLib->szLibraryName;
+
+			// Keys refer to the static export tables.
+			SymbolKey key   = {};
+			key.moduleName  = module->szModuleName;
+			key.libraryName = pLib->szLibraryName;
+
+			for (auto pFunc = pLib->pFunctionEntries; !pFunc->isEndEntry(); pFunc = pFunc->iterNext())
+			{
+				Entry entry   = {};
+				entry.address = pFunc->pFunction;
+
+				key.isEncoded = true;
+				key.nid       = pFunc->nNid;
+				key.name      = {};
+				entry.policy  = policyManager.getSymbolPolicy(modName, libName, pFunc->nNid);
+				retVal &= addEntry(key, entry);
+
+				if (pFunc->szFunctionName)
+				{
+					key.isEncoded = false;
+					key.nid       = 0;
+					key.name      = pFunc->szFunctionName;
+					entry.policy  = policyManager.getSymbolPolicy(modName, libName, std::string(key.name));
+					retVal &= addEntry(key, entry);
+				}
+			}
+		}
+	}
+
+	m_table.freeze();
+	m_modules.clear();
+
+	LOG_DEBUG("builtin symbol table frozen, %zu entries.", m_table.size());
+	return retVal;
+}
+
+bool BuiltinSymbolTable::addEntry(SymbolKey const &key, Entry const &entry)
+{
+	bool retVal = m_table.insert(key, entry);
+	if (!retVal)
+	{
+		// Whichever came first would win silently otherwise.
+		LOG_ERR("builtin export %s %s %s (nid %llx) is %s.",
+				std::string(key.moduleName).c_str(), std::string(key.libraryName).c_str(),
+				std::string(key.name).c_str(), key.nid,
+				m_table.findPending(key) ? "exported twice" : "colliding with another export");
+		LOG_ASSERT(false, "duplicate builtin export");
+	}
+	return retVal;
+}
+
+bool BuiltinSymbolTable::isFrozen() const
+{
+	return m_table.isFrozen();
+}
+
+const BuiltinSymbolTable::Entry *BuiltinSymbolTable::find(SymbolKey const &key) const
+{
+	return m_table.find(key);
+}
+
+size_t BuiltinSymbolTable::size() const
+{
+	return m_table.size();
+}
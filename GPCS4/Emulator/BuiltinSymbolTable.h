@@ -0,0 +1,117 @@
+#pragma once
+
+#include "GPCS4Common.h"
+#include "PolicyManager.h"
+#include "UtilPerfectHash.h"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct SCE_EXPORT_MODULE;
+
+/**
+ * @brief Key of a symbol
+ *
+ * A symbol is identified by its module and library,
+ * and by its NID or, for unencoded symbols, its name.
+ * The tables compare the whole key on lookup, the hash
+ * only picks the slot. The key refers to the names,
+ * tables keep the names of the keys they store.
+ */
+struct SymbolKey
+{
+	std::string_view moduleName;
+	std::string_view libraryName;
+	bool             isEncoded = true;
+	uint64_t         nid       = 0;
+	std::string_view name;
+
+	bool operator==(SymbolKey const &other) const;
+};
+
+struct SymbolKeyHash
+{
+	uint64_t operator()(SymbolKey const &key) const;
+};
+
+/**
+ * @brief Flat table of all builtin HLE exports.
+ *
+ * The export tables of builtin modules are static, so once all modules
+ * and policies are registered, every export is put into a single perfect hash
+ * keyed by (module, library, NID), together with the policy of that symbol.
+ * Resolving an import is then one probe instead of walking the nested maps
+ * of SymbolManager and PolicyManager.
+ */
+class BuiltinSymbolTable
+{
+public:
+	struct Entry
+	{
+		const void *address;
+		Policy policy;
+	};
+
+	/**
+	 * @brief Builds the key of a symbol
+	 *
+	 * @param modName module name
+	 * @param libName library name
+	 * @param nid symbol NID
+	 * @return symbol key, referring to the arguments
+	 */
+	static SymbolKey symbolKey(std::string const &modName,
+							   std::string const &libName,
+							   uint64_t nid);
+
+	/**
+	 * @brief Builds the key of a symbol
+	 *
+	 * @param modName module name
+	 * @param libName library name
+	 * @param name symbol name
+	 * @return symbol key, referring to the arguments
+	 */
+	static SymbolKey symbolKey(std::string const &modName,
+							   std::string const &libName,
+							   std::string const &name);
+
+	/**
+	 * @brief Adds the exports of a builtin module
+	 *
+	 * The module definition must be static, it is only walked
+	 * when the table is frozen, and the keys refer to its names.
+	 */
+	void addModule(const SCE_EXPORT_MODULE &module);
+
+	/**
+	 * @brief Builds the table
+	 *
+	 * Must be called after all policies are declared,
+	 * they are evaluated once here.
+	 *
+	 * @return false if two exports have the same key
+	 */
+	bool freeze(PolicyManager const &policyManager);
+
+	bool isFrozen() const;
+
+	/**
+	 * @brief Looks up a builtin export
+	 *
+	 * @param key symbol key
+	 * @return entry or nullptr if there is no builtin implementation
+	 */
+	const Entry *find(SymbolKey const &key) const;
+
+	size_t size() const;
+
+private:
+	bool addEntry(SymbolKey const &key, Entry const &entry);
+
+private:
+	std::vector<const SCE_EXPORT_MODULE *> m_modules;
+	util::PerfectHashMap<SymbolKey, Entry, SymbolKeyHash> m_table;
+};
@@ -3,16 +3,20 @@
 #include "GameThread.h"
 #include "SceModuleSystem.h"
 #include "VirtualCPU.h"
+#include "VirtualFileSystem.h"
 #include "VirtualGPU.h"
 #include "Sce/SceGnmDriver.h"
 #include "Sce/SceVideoOut.h"
 
+#include <filesystem>
+
 LOG_CHANNEL(Emulator);
 
 Emulator::Emulator() 
 {
 	m_cpu = std::make_shared<VirtualCPU>();
 	m_gpu = std::make_shared<sce::VirtualGPU>();
+	m_vfs = std::make_shared<VirtualFileSystem>();
 }
 
 Emulator::~Emulator() {}
@@ -75,6 +79,12 @@ bool Emulator::Init()
 			break;
 		}
 
+		// The current working directory is mapped to /app0.
+		if (!m_vfs->Init(std::filesystem::current_path().string()))
+		{
+			break;
+		}
+
 		bRet = true;
 	} while (false);
 	return bRet;
@@ -121,5 +131,10 @@ sce::VirtualGPU& Emulator::GPU()
 	return *m_gpu;
 }
 
+VirtualFileSystem& Emulator::VFS()
+{
+	return *m_vfs;
+}
+
 void PS4API Emulator::LastExitHandler(void) { LOG_DEBUG("program exit."); }
 
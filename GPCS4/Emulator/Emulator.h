@@ -6,6 +6,7 @@
 #include <memory>
 
 class VirtualCPU;
+class VirtualFileSystem;
 namespace sce
 {
 	class VirtualGPU;
@@ -30,6 +31,8 @@ public:
 
 	sce::VirtualGPU& GPU();
 
+	VirtualFileSystem& VFS();
+
 private:
 	Emulator();
 	~Emulator();
@@ -44,8 +47,9 @@ private:
 	static void PS4API LastExitHandler(void);
 
 private:
-	std::shared_ptr<VirtualCPU>      m_cpu;
-	std::shared_ptr<sce::VirtualGPU> m_gpu;
+	std::shared_ptr<VirtualCPU>        m_cpu;
+	std::shared_ptr<sce::VirtualGPU>   m_gpu;
+	std::shared_ptr<VirtualFileSystem> m_vfs;
 };
 
 // for convenience access
@@ -63,4 +67,9 @@ inline VirtualCPU& CPU()
 inline sce::VirtualGPU& GPU()
 {
 	return TheEmulator().GPU();
+}
+
+inline VirtualFileSystem& VFS()
+{
+	return TheEmulator().VFS();
 }
\ No newline at end of file
@@ -2,8 +2,13 @@
 #include "ModuleSystemCommon.h"
 #include "SceModuleSystem.h"
 #include "UtilString.h"
+#include "UtilThreadPool.h"
 #include "Loader/FuncStub.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+
 
 LOG_CHANNEL(Linker);
 
@@ -19,8 +24,6 @@ bool CLinker::resolveSymbol(NativeModule const &mod,
 	do
 	{
 		const SymbolInfo *info = nullptr;
-		void *address    = nullptr;
-		bool useNative   = false;
 
 		if (addrOut == nullptr)
 		{
@@ -35,35 +38,55 @@ bool CLinker::resolveSymbol(NativeModule const &mod,
 			break;
 		}
 
+		auto key = ResolvedSymbolTable::makeKey(*info);
+		if (!m_symbolTable.find(key, addrOut))
+		{
+			// Not collected by buildSymbolTable, resolve it directly.
+			LOG_WARN("symbol %s is not in resolved table.", name.c_str());
+			std::lock_guard<std::mutex> lock(m_resolveMutex);
+			resolveSymbolInfo(mod, *info, addrOut);
+		}
+
+		retVal = true;
+	} while (false);
+
+	return retVal;
+}
+
+bool CLinker::resolveSymbolInfo(NativeModule const &mod,
+								SymbolInfo const &symbol,
+								uint64_t *addrOut) const
+{
+	bool retVal = true;
+
+	do
+	{
+		const SymbolInfo *info = &symbol;
+		void *address    = nullptr;
+		bool useNative   = false;
+
+		Policy policy = Policy::UseBuiltin;
 		if (!info->isEncoded)
 		{
 			address = getSymbolAddress(info->moduleName,
 									   info->libraryName,
-									   info->symbolName);
-
-			auto policy = m_modSystem.getSymbolPolicy(info->moduleName,
-													  info->libraryName,
-													  info->symbolName);
-
-			useNative  = (policy == Policy::UseNative);
+									   info->symbolName,
+									   &policy);
 		}
 		else
 		{
 			address = getSymbolAddress(info->moduleName,
 									   info->libraryName,
-									   info->nid);
-
-			auto policy = m_modSystem.getSymbolPolicy(info->moduleName,
-													  info->libraryName,
-													  info->nid);
-
-			useNative  = (policy == Policy::UseNative);
+									   info->nid,
+									   &policy);
 		}
 
+		useNative = (policy == Policy::UseNative);
+
 		const char* source = useNative? "NATIVE":"BUILTIN";
 
 		LOG_ERR_IF(address == nullptr, "fail to resolve symbol: %s[%s] from %s for module %s",
-				   name.c_str(), source, info->moduleName.c_str(), mod.fileName.c_str());
+				   info->symbolName.c_str(), source, info->moduleName.c_str(), mod.fileName.c_str());
 
 #ifdef MODSYS_STUB_DISABLE
 
@@ -156,42 +179,107 @@ bool CLinker::relocateModules()
 	auto &mods  = m_modSystem.getAllNativeModules();
 	bool retVal = false;
 
-	for (auto &mod : mods)
+	do
 	{
-		retVal = relocateModule(mod);
-		if (retVal == false)
+		auto begin = std::chrono::steady_clock::now();
+
+		retVal = buildSymbolTable();
+		if (!retVal)
 		{
-			LOG_ERR("fail to relocate module: %s", mod.fileName.c_str());
 			break;
 		}
+
+		auto resolved = std::chrono::steady_clock::now();
+
+		// The symbol table is read only from now on,
+		// and every module only writes to its own image.
+		std::atomic<bool> failed = { false };
+		{
+			util::ThreadPool pool(std::min<uint32_t>(
+				static_cast<uint32_t>(mods.size()),
+				std::max(1u, std::thread::hardware_concurrency())));
+
+			pool.parallelFor(mods.size(), [&](size_t i)
+							 {
+								 if (!relocateModule(mods[i]))
+								 {
+									 LOG_ERR("fail to relocate module: %s", mods[i].fileName.c_str());
+									 failed = true;
+								 }
+							 });
+		}
+
+		auto end = std::chrono::steady_clock::now();
+
+		LOG_DEBUG("relocation of %zu modules: resolve %lld us (%zu symbols), relocate %lld us",
+				  mods.size(),
+				  std::chrono::duration_cast<std::chrono::microseconds>(resolved - begin).count(),
+				  m_symbolTable.size(),
+				  std::chrono::duration_cast<std::chrono::microseconds>(end - resolved).count());
+
+		retVal = !failed;
+	} while (false);
+
+	return retVal;
+}
+
+bool CLinker::buildSymbolTable()
+{
+	auto &mods = m_modSystem.getAllNativeModules();
+
+	m_symbolTable.clear();
+
+	bool retVal = true;
+
+	// Stub generation is not thread safe, so every symbol is resolved
+	// here on a single thread, and only once even if it is imported by many modules.
+	auto addSymbols = [this, &retVal](NativeModule const &mod, std::vector<size_t> const &indices)
+	{
+		for (auto index : indices)
+		{
+			const SymbolInfo *info = nullptr;
+			mod.getSymbol(index, &info);
+
+			auto key = ResolvedSymbolTable::makeKey(*info);
+			if (m_symbolTable.contains(key))
+			{
+				continue;
+			}
+
+			uint64_t address = 0;
+			resolveSymbolInfo(mod, *info, &address);
+			if (!m_symbolTable.insert(key, address))
+			{
+				retVal = false;
+			}
+		}
+	};
+
+	for (auto const &mod : mods)
+	{
+		addSymbols(mod, mod.getImportSymbols());
+		addSymbols(mod, mod.getExportSymbols());
 	}
 
+	m_symbolTable.freeze();
 	return retVal;
 }
 
 void* CLinker::getSymbolAddress(std::string const& modName,
 								std::string const& libName,
-							    uint64_t nid) const
+								uint64_t nid,
+								Policy* policy) const
 {
-	auto pointer = m_modSystem.getSymbolAddress(modName, libName, nid);
+	auto pointer = m_modSystem.getSymbolAddress(modName, libName, nid, policy);
 	return const_cast<void*>(pointer);
 }
 
-void* CLinker::getSymbolAddress(std::string const& modName, std::string const& libName, std::string const& symbName) const
+void* CLinker::getSymbolAddress(std::string const& modName,
+								std::string const& libName,
+								std::string const& symbName,
+								Policy* policy) const
 {
-	auto symbolManager = m_modSystem.getSymbolManager();
-	auto policy = m_modSystem.getSymbolPolicy(modName, libName, symbName);
-	const void* pointer = nullptr;
-
-	if (policy == Policy::UseBuiltin)
-	{
-		pointer = symbolManager.findBuiltinSymbol(modName, libName, symbName);
-	}
-	else // Policy::UseNative
-	{
-		pointer = symbolManager.findNativeSymbol(modName, libName, symbName);
-	}
-
+	auto pointer = m_modSystem.getSymbolAddress(modName, libName, symbName, policy);
 	return const_cast<void*>(pointer);
 }
 
@@ -212,7 +300,7 @@ bool CLinker::relocateRela(NativeModule &mod)
 	bool retVal = false;
 	do
 	{
-		if (mod.getFileMemory().empty())
+		if (mod.getFileMapping() == nullptr)
 		{
 			break;
 		}
@@ -309,10 +397,9 @@ bool CLinker::relocatePltRela(NativeModule &mod)
 	bool bRet = false;
 	do
 	{
-		auto &fileData = mod.getFileMemory();
-		auto &info     = mod.getModuleInfo();
+		auto &info = mod.getModuleInfo();
 
-		if (fileData.empty())
+		if (mod.getFileMapping() == nullptr)
 		{
 			break;
 		}
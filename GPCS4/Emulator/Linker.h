@@ -3,6 +3,8 @@
 #include "GPCS4Common.h"
 #include "SceModuleSystem.h"
 #include "Module.h"
+#include "ResolvedSymbolTable.h"
+#include <mutex>
 #include <string>
 
 class CLinker
@@ -15,11 +17,18 @@ public:
 					   std::string const &name,
 					   uint64_t *addr) const;
 
+	// Relocation is done in two phases:
+	// first every imported and exported symbol of all modules is resolved
+	// into a frozen table, then modules are relocated concurrently.
 	bool relocateModules();
 
 private:
-	void* getSymbolAddress(std::string const &modName, std::string const& libName, uint64_t nid) const;
-	void* getSymbolAddress(std::string const& modName, std::string const& libName, std::string const& symbName) const;
+	bool buildSymbolTable();
+	bool resolveSymbolInfo(NativeModule const &mod,
+						   SymbolInfo const &info,
+						   uint64_t *addr) const;
+	void* getSymbolAddress(std::string const &modName, std::string const& libName, uint64_t nid, Policy* policy) const;
+	void* getSymbolAddress(std::string const& modName, std::string const& libName, std::string const& symbName, Policy* policy) const;
 	bool relocateModule(NativeModule &mod);
 	bool relocateRela(NativeModule &mod);
 	bool relocatePltRela(NativeModule &mod);
@@ -27,4 +36,8 @@ private:
 
 private:
 	CSceModuleSystem &m_modSystem;
+	ResolvedSymbolTable m_symbolTable;
+	// Serializes symbols missing from the table, relocation
+	// workers may resolve them and generate stubs concurrently.
+	mutable std::mutex m_resolveMutex;
 };
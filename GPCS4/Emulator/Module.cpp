@@ -11,8 +11,7 @@ LOG_CHANNEL(Module);
 const MODULE_INFO &NativeModule::getModuleInfo() const { return m_moduleInfo; }
 MODULE_INFO &NativeModule::getModuleInfo() { return m_moduleInfo; }
 
-const ByteArray &NativeModule::getFileMemory() const { return m_fileMemory; }
-ByteArray &NativeModule::getFileMemory() { return m_fileMemory; }
+const plat::MappedFile *NativeModule::getFileMapping() const { return m_fileMapping.get(); }
 
 bool NativeModule::isModule() const
 {
@@ -31,12 +30,17 @@ std::vector<size_t> &NativeModule::getExportSymbols()
 	return m_exportSymbols;
 }
 
-const plat::memory_ptr &NativeModule::getMappedMemory() const
+const std::vector<size_t> &NativeModule::getImportSymbols() const
+{
+	return m_importSymbols;
+}
+
+const plat::image_ptr &NativeModule::getMappedMemory() const
 {
 	return m_mappedMemory;
 }
 
-plat::memory_ptr &NativeModule::getMappedMemory()
+plat::image_ptr &NativeModule::getMappedMemory()
 {
 	return m_mappedMemory;
 }
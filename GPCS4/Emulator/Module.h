@@ -3,6 +3,7 @@
 #include "GPCS4Common.h"
 #include "Loader/elf.h"
 #include "PlatMemory.h"
+#include "PlatFile.h"
 
 #include <vector>
 #include <memory>
@@ -144,12 +145,12 @@ public:
 	const FileList &getNeededFiles() const;
 	const std::vector<size_t> &getExportSymbols() const;
 	std::vector<size_t> &getExportSymbols();
-	const plat::memory_ptr &getMappedMemory() const;
-	plat::memory_ptr &getMappedMemory();
+	const std::vector<size_t> &getImportSymbols() const;
+	const plat::image_ptr &getMappedMemory() const;
+	plat::image_ptr &getMappedMemory();
 	const MODULE_INFO &getModuleInfo() const;
 	MODULE_INFO &getModuleInfo();
-	const ByteArray &getFileMemory() const;
-	ByteArray &getFileMemory();
+	const plat::MappedFile *getFileMapping() const;
 	bool isModule() const;
 
 	int initialize();
@@ -212,9 +213,11 @@ private:
 	std::vector<size_t> m_exportSymbols;
 	std::vector<size_t> m_importSymbols;
 
-	plat::memory_ptr m_mappedMemory;
+	plat::image_ptr m_mappedMemory;
 	size_t m_mappedSize;
-	ByteArray m_fileMemory;
+	// Kept mapped for the module lifetime,
+	// dynamic tables point into it.
+	plat::mapped_file_ptr m_fileMapping;
 
 	Elf64_Ehdr *m_elfHeader;
 	MODULE_INFO m_moduleInfo;
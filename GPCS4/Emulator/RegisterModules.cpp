@@ -126,7 +126,11 @@ static bool registerOtherModules(CSceModuleSystem *pModuleSystem)
 
 		policyManager
 			.declareModule("libSceNpCommon").withDefault(Policy::UseNative);
-		policyManager.declareModule("libSceFios2").withDefault(Policy::UseNative);
+		policyManager.declareModule("libSceFios2").withDefault(Policy::UseBuiltin)
+			.declareSubLibrary("libSceFios2").with(Policy::UseBuiltin).except
+			({
+				0x466FA18B0BD29F1C,  // sceFiosDateToComponents
+			});
 		policyManager.declareModule("libSceRtc").withDefault(Policy::UseBuiltin)
 			.declareSubLibrary("libSceRtc").with(Policy::UseBuiltin).except
 			({
@@ -232,6 +236,12 @@ bool Emulator::registerModules()
 
 		//testPolicy();
 
+		// Builtin exports and policies are final now.
+		if (!pModuleSystem->freezeBuiltinSymbols())
+		{
+			break;
+		}
+
 		bRet = true;
 	} while (false);
 	return bRet;
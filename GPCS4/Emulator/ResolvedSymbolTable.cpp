@@ -0,0 +1,86 @@
+#include "ResolvedSymbolTable.h"
+
+LOG_CHANNEL(Emulator.ResolvedSymbolTable);
+
+SymbolKey ResolvedSymbolTable::makeKey(SymbolInfo const &info)
+{
+	return info.isEncoded ?
+		BuiltinSymbolTable::symbolKey(info.moduleName, info.libraryName, info.nid) :
+		BuiltinSymbolTable::symbolKey(info.moduleName, info.libraryName, info.symbolName);
+}
+
+bool ResolvedSymbolTable::contains(SymbolKey const &key) const
+{
+	return m_table.findPending(key) != nullptr;
+}
+
+bool ResolvedSymbolTable::insert(SymbolKey const &key, uint64_t address)
+{
+	LOG_ASSERT(!m_table.isFrozen(), "insert into a frozen symbol table");
+	bool retVal = true;
+	do
+	{
+		SymbolKey stored   = key;
+		stored.moduleName  = intern(key.moduleName);
+		stored.libraryName = intern(key.libraryName);
+		stored.name        = intern(key.name);
+		if (m_table.insert(stored, address))
+		{
+			break;
+		}
+
+		auto value = m_table.findPending(key);
+		if (value != nullptr && *value == address)
+		{
+			// resolved the same way twice
+			break;
+		}
+
+		LOG_ERR("symbol %s %s %s (nid %llx) %s.",
+				stored.moduleName.data(), stored.libraryName.data(), stored.name.data(), key.nid,
+				value ? "resolved to two addresses" : "collides with another symbol");
+		LOG_ASSERT(false, "conflicting resolved symbol");
+		retVal = false;
+	} while (false);
+
+	return retVal;
+}
+
+void ResolvedSymbolTable::freeze()
+{
+	m_table.freeze();
+}
+
+bool ResolvedSymbolTable::find(SymbolKey const &key, uint64_t *address) const
+{
+	bool retVal = false;
+	do
+	{
+		auto value = m_table.find(key);
+		if (value == nullptr)
+		{
+			break;
+		}
+
+		*address = *value;
+		retVal   = true;
+	} while (false);
+
+	return retVal;
+}
+
+void ResolvedSymbolTable::clear()
+{
+	m_table.clear();
+	m_names.clear();
+}
+
+std::string_view ResolvedSymbolTable::intern(std::string_view name)
+{
+	return *m_names.emplace(name).first;
+}
+
+size_t ResolvedSymbolTable::size() const
+{
+	return m_table.size();
+}
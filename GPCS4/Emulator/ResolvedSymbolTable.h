@@ -0,0 +1,81 @@
+#pragma once
+
+#include "GPCS4Common.h"
+#include "Module.h"
+#include "BuiltinSymbolTable.h"
+#include "UtilPerfectHash.h"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+
+/**
+ * @brief Read-only table of resolved symbol addresses.
+ *
+ * Filled once before relocation and then frozen into a perfect hash,
+ * so that lookups are a single probe and can be done from
+ * multiple relocation threads without locking.
+ *
+ * A symbol is keyed by its module, library and NID
+ * (or plain name for unencoded symbols), see BuiltinSymbolTable.
+ */
+class ResolvedSymbolTable
+{
+public:
+	ResolvedSymbolTable() = default;
+
+	/**
+	 * @brief Builds the key of a symbol
+	 *
+	 * @param info symbol info
+	 * @return symbol key, referring to info
+	 */
+	static SymbolKey makeKey(SymbolInfo const &info);
+
+	/**
+	 * @brief Checks if a key has been inserted
+	 *
+	 * Only valid before the table is frozen.
+	 */
+	bool contains(SymbolKey const &key) const;
+
+	/**
+	 * @brief Adds a resolved symbol
+	 *
+	 * Only valid before the table is frozen.
+	 *
+	 * @return false if the key is already in the table
+	 * with another address, or another key has the same hash
+	 */
+	bool insert(SymbolKey const &key, uint64_t address);
+
+	/**
+	 * @brief Builds the perfect hash and drops the build data
+	 */
+	void freeze();
+
+	/**
+	 * @brief Looks up a resolved symbol
+	 *
+	 * @param key symbol key
+	 * @param address resolved address
+	 * @return true if the symbol is in the table
+	 */
+	bool find(SymbolKey const &key, uint64_t *address) const;
+
+	/**
+	 * @brief Drops all entries
+	 */
+	void clear();
+
+	size_t size() const;
+
+private:
+	std::string_view intern(std::string_view name);
+
+private:
+	// Names of the stored keys
+	std::unordered_set<std::string> m_names;
+	util::PerfectHashMap<SymbolKey, uint64_t, SymbolKeyHash> m_table;
+};
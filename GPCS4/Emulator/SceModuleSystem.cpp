@@ -34,6 +34,7 @@ bool CSceModuleSystem::registerBuiltinModule(const SCE_EXPORT_MODULE &stModule)
 		const SCE_EXPORT_LIBRARY *pLib = stModule.pLibraries;
 
 		m_moduleManager.registerBuiltinModule(szModName);
+		m_builtinSymbolTable.addModule(stModule);
 
 		while (!pLib->isEndEntry())
 		{
@@ -187,21 +188,105 @@ const void* CSceModuleSystem::getSymbolAddress(std::string const& modName,
 											   std::string const& libName,
 										       uint64_t nid) const
 {
-	auto policy = m_policyManager.getSymbolPolicy(modName, libName, nid);
-	void* address = nullptr;
+	Policy policy = Policy::UseBuiltin;
+	return getSymbolAddress(modName, libName, nid, &policy);
+}
+
+const void* CSceModuleSystem::getSymbolAddress(std::string const& modName,
+											   std::string const& libName,
+											   uint64_t nid,
+											   Policy* policyOut) const
+{
+	const void* address = nullptr;
+	Policy      policy  = Policy::UseBuiltin;
 
-	if (policy == Policy::UseBuiltin)
+	do
 	{
-		address = const_cast<void*>(m_symbolManager.findBuiltinSymbol(modName, libName, nid));
-	}
-	else
+		if (m_builtinSymbolTable.isFrozen())
+		{
+			auto entry = m_builtinSymbolTable.find(BuiltinSymbolTable::symbolKey(modName, libName, nid));
+			if (entry != nullptr)
+			{
+				policy  = entry->policy;
+				address = policy == Policy::UseBuiltin ?
+					entry->address :
+					m_symbolManager.findNativeSymbol(modName, libName, nid);
+				break;
+			}
+
+			// There is no builtin implementation.
+			policy  = m_policyManager.getSymbolPolicy(modName, libName, nid);
+			address = policy == Policy::UseBuiltin ?
+				nullptr :
+				m_symbolManager.findNativeSymbol(modName, libName, nid);
+			break;
+		}
+
+		policy = m_policyManager.getSymbolPolicy(modName, libName, nid);
+		if (policy == Policy::UseBuiltin)
+		{
+			address = m_symbolManager.findBuiltinSymbol(modName, libName, nid);
+		}
+		else
+		{
+			address = m_symbolManager.findNativeSymbol(modName, libName, nid);
+		}
+	} while (false);
+
+	*policyOut = policy;
+	return address;
+}
+
+const void* CSceModuleSystem::getSymbolAddress(std::string const& modName,
+											   std::string const& libName,
+											   std::string const& name,
+											   Policy* policyOut) const
+{
+	const void* address = nullptr;
+	Policy      policy  = Policy::UseBuiltin;
+
+	do
 	{
-		address = const_cast<void*>(m_symbolManager.findNativeSymbol(modName, libName, nid));
-	}
+		if (m_builtinSymbolTable.isFrozen())
+		{
+			auto entry = m_builtinSymbolTable.find(BuiltinSymbolTable::symbolKey(modName, libName, name));
+			if (entry != nullptr)
+			{
+				policy  = entry->policy;
+				address = policy == Policy::UseBuiltin ?
+					entry->address :
+					m_symbolManager.findNativeSymbol(modName, libName, name);
+				break;
+			}
+
+			// There is no builtin implementation.
+			policy  = m_policyManager.getSymbolPolicy(modName, libName, name);
+			address = policy == Policy::UseBuiltin ?
+				nullptr :
+				m_symbolManager.findNativeSymbol(modName, libName, name);
+			break;
+		}
 
+		policy = m_policyManager.getSymbolPolicy(modName, libName, name);
+		if (policy == Policy::UseBuiltin)
+		{
+			address = m_symbolManager.findBuiltinSymbol(modName, libName, name);
+		}
+		else
+		{
+			address = m_symbolManager.findNativeSymbol(modName, libName, name);
+		}
+	} while (false);
+
+	*policyOut = policy;
 	return address;
 }
 
+bool CSceModuleSystem::freezeBuiltinSymbols()
+{
+	return m_builtinSymbolTable.freeze(m_policyManager);
+}
+
 // TODO: To be done
 void CSceModuleSystem::clearModules()
 {
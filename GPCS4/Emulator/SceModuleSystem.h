@@ -5,6 +5,7 @@
 #include "PolicyManager.h"
 #include "SymbolManager.h"
 #include "ModuleManger.h"
+#include "BuiltinSymbolTable.h"
 
 #include "Module.h"
 #include <string>
@@ -32,6 +33,44 @@ public:
 								 std::string const& libName,
 								 uint64_t nid) const;
 
+	/**
+	 * @brief Get symbol address and the policy applied to it
+	 *
+	 * Once builtin symbols are frozen, symbols with a builtin
+	 * implementation are resolved with a single lookup.
+	 *
+	 * @param modName module name
+	 * @param libName library name
+	 * @param nid symbol NID
+	 * @param policy [out] policy of the symbol
+	 * @return const void* symbol address
+	 */
+	const void *getSymbolAddress(std::string const& modName,
+								 std::string const& libName,
+								 uint64_t nid,
+								 Policy* policy) const;
+
+	/**
+	 * @brief Get symbol address and the policy applied to it
+	 *
+	 * @param modName module name
+	 * @param libName library name
+	 * @param name symbol name
+	 * @param policy [out] policy of the symbol
+	 * @return const void* symbol address
+	 */
+	const void *getSymbolAddress(std::string const& modName,
+								 std::string const& libName,
+								 std::string const& name,
+								 Policy* policy) const;
+
+	/**
+	 * @brief Builds the builtin symbol table.
+	 * Must be called after all builtin modules and policies are registered.
+	 * @return false if two builtin exports have the same key
+	 */
+	bool freezeBuiltinSymbols();
+
 	/**
 	 * @brief Clear modules. TODO: NOT IMPLEMENTED 
 	 * 
@@ -196,5 +235,6 @@ private:
 	ModuleManager m_moduleManager;
 	SymbolManager m_symbolManager;
 	PolicyManager m_policyManager;
+	BuiltinSymbolTable m_builtinSymbolTable;
 };
 
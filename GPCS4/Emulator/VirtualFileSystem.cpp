@@ -0,0 +1,260 @@
+#include "VirtualFileSystem.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <functional>
+#include <system_error>
+
+LOG_CHANNEL(Emulator.VirtualFileSystem);
+
+namespace fs = std::filesystem;
+
+static bool statHostFile(const std::string& strHostPath, VfsFileInfo* pInfo)
+{
+	bool bRet = false;
+	do
+	{
+		std::error_code ec;
+		auto            status = fs::status(strHostPath, ec);
+		if (ec || !fs::exists(status))
+		{
+			break;
+		}
+
+		pInfo->bDirectory = fs::is_directory(status);
+		pInfo->nSize      = 0;
+		if (!pInfo->bDirectory)
+		{
+			auto nSize = fs::file_size(strHostPath, ec);
+			if (!ec)
+			{
+				pInfo->nSize = nSize;
+			}
+		}
+
+		bRet = true;
+	} while (false);
+	return bRet;
+}
+
+VirtualFileSystem::VirtualFileSystem()
+{
+}
+
+VirtualFileSystem::~VirtualFileSystem()
+{
+}
+
+bool VirtualFileSystem::Init(const std::string& strAppRoot)
+{
+	bool bRet = false;
+	do
+	{
+		std::error_code ec;
+		fs::path        appRoot = fs::absolute(strAppRoot, ec).lexically_normal();
+		if (ec)
+		{
+			LOG_ERR("invalid app root %s", strAppRoot.c_str());
+			break;
+		}
+
+		if (!appRoot.has_filename())
+		{
+			appRoot = appRoot.parent_path();
+		}
+
+		// Writable devices live next to the game
+		// directory, one data directory per game.
+		fs::path dataRoot = appRoot;
+		dataRoot += "_data";
+
+		if (!Mount("/app0", appRoot.string(), true) ||
+			!Mount("/hostapp", appRoot.string(), true) ||
+			!Mount("/savedata0", (dataRoot / "savedata0").string(), false) ||
+			!Mount("/download0", (dataRoot / "download0").string(), false) ||
+			!Mount("/temp0", (dataRoot / "temp0").string(), false))
+		{
+			break;
+		}
+
+		bRet = true;
+	} while (false);
+	return bRet;
+}
+
+bool VirtualFileSystem::Mount(const std::string& strMountPoint, const std::string& strHostPath, bool bReadOnly)
+{
+	bool bRet = false;
+	do
+	{
+		if (strMountPoint.size() < 2 || strMountPoint.front() != '/' || strMountPoint.back() == '/')
+		{
+			LOG_ERR("invalid mount point %s", strMountPoint.c_str());
+			break;
+		}
+
+		if (!bReadOnly)
+		{
+			std::error_code ec;
+			fs::create_directories(strHostPath, ec);
+			if (ec)
+			{
+				LOG_ERR("create directory failed %s", strHostPath.c_str());
+				break;
+			}
+		}
+
+		std::string strHostRoot = strHostPath;
+		while (!strHostRoot.empty() && (strHostRoot.back() == '/' || strHostRoot.back() == '\\'))
+		{
+			strHostRoot.pop_back();
+		}
+
+		MountPoint mount = { strMountPoint, strHostRoot, bReadOnly };
+
+		// Keep longer mount points first, so nested
+		// mount points are matched before their parents.
+		auto iter = std::find_if(m_mounts.begin(), m_mounts.end(),
+								 [&strMountPoint](const MountPoint& m)
+								 { return m.strMountPoint.size() < strMountPoint.size(); });
+		m_mounts.insert(iter, mount);
+
+		LOG_DEBUG("mount %s -> %s%s", strMountPoint.c_str(), strHostRoot.c_str(), bReadOnly ? " (read only)" : "");
+		bRet = true;
+	} while (false);
+	return bRet;
+}
+
+std::string VirtualFileSystem::Resolve(const std::string& strPath)
+{
+	auto& shard = getShard(strPath);
+
+	std::lock_guard<std::mutex> lock(shard.mutex);
+	return getEntry(shard, strPath).strHostPath;
+}
+
+bool VirtualFileSystem::Stat(const std::string& strPath, VfsFileInfo* pInfo)
+{
+	auto& shard = getShard(strPath);
+
+	std::string strHostPath;
+	bool        bReadOnly = false;
+	{
+		std::lock_guard<std::mutex> lock(shard.mutex);
+		auto&                       entry = getEntry(shard, strPath);
+		if (entry.bStatValid)
+		{
+			if (entry.bExists)
+			{
+				*pInfo = entry.info;
+			}
+			return entry.bExists;
+		}
+
+		strHostPath = entry.strHostPath;
+		bReadOnly   = entry.bReadOnly;
+	}
+
+	// Don't hold the shard while waiting for the host.
+	VfsFileInfo info;
+	bool        bExists = statHostFile(strHostPath, &info);
+	info.bReadOnly      = bReadOnly;
+
+	if (bReadOnly)
+	{
+		std::lock_guard<std::mutex> lock(shard.mutex);
+		auto&                       entry = getEntry(shard, strPath);
+		entry.bStatValid                  = true;
+		entry.bExists                     = bExists;
+		entry.info                        = info;
+	}
+
+	if (bExists)
+	{
+		*pInfo = info;
+	}
+	return bExists;
+}
+
+void VirtualFileSystem::Invalidate(const std::string& strPath)
+{
+	auto& shard = getShard(strPath);
+
+	std::lock_guard<std::mutex> lock(shard.mutex);
+	auto                        iter = shard.map.find(strPath);
+	if (iter != shard.map.end())
+	{
+		iter->second->bStatValid = false;
+	}
+}
+
+VirtualFileSystem::CacheShard& VirtualFileSystem::getShard(const std::string& strPath)
+{
+	size_t nHash = std::hash<std::string>()(strPath);
+	return m_cache[nHash % CacheShardCount];
+}
+
+VirtualFileSystem::CacheEntry& VirtualFileSystem::getEntry(CacheShard& shard, const std::string& strPath)
+{
+	auto iter = shard.map.find(strPath);
+	if (iter != shard.map.end())
+	{
+		shard.lru.splice(shard.lru.begin(), shard.lru, iter->second);
+		return *iter->second;
+	}
+
+	if (shard.lru.size() == CacheShardCapacity)
+	{
+		shard.map.erase(shard.lru.back().strPath);
+		shard.lru.pop_back();
+	}
+
+	CacheEntry entry  = {};
+	entry.strPath     = strPath;
+	entry.strHostPath = resolvePath(strPath, &entry.bReadOnly);
+	entry.bStatValid  = false;
+	entry.bExists     = false;
+
+	shard.lru.push_front(std::move(entry));
+	shard.map.emplace(strPath, shard.lru.begin());
+	return shard.lru.front();
+}
+
+const VirtualFileSystem::MountPoint* VirtualFileSystem::findMount(const std::string& strPath) const
+{
+	const MountPoint* pMount = nullptr;
+	for (const auto& mount : m_mounts)
+	{
+		size_t nLength = mount.strMountPoint.size();
+		if (strPath.compare(0, nLength, mount.strMountPoint) == 0 &&
+			(strPath.size() == nLength || strPath[nLength] == '/'))
+		{
+			pMount = &mount;
+			break;
+		}
+	}
+	return pMount;
+}
+
+std::string VirtualFileSystem::resolvePath(const std::string& strPath, bool* pReadOnly) const
+{
+	std::string strHostPath;
+
+	const MountPoint* pMount = findMount(strPath);
+	if (pMount)
+	{
+		strHostPath = pMount->strHostPath + strPath.substr(pMount->strMountPoint.size());
+		*pReadOnly  = pMount->bReadOnly;
+	}
+	else
+	{
+		LOG_WARN("path is not mounted %s", strPath.c_str());
+		strHostPath = strPath;
+		*pReadOnly  = false;
+	}
+
+#ifdef GPCS4_WINDOWS
+	std::replace(strHostPath.begin(), strHostPath.end(), '/', '\\');
+#endif
+	return strHostPath;
+}
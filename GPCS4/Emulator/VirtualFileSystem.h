@@ -0,0 +1,92 @@
+#pragma once
+
+#include "GPCS4Common.h"
+
+#include <array>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct VfsFileInfo
+{
+	bool     bDirectory = false;
+	bool     bReadOnly  = false;
+	uint64_t nSize      = 0;
+};
+
+// Maps PS4 paths to host paths.
+// The mount table is set up once before the game starts and
+// is read only afterwards, so lookups don't need to lock it.
+// Resolved host paths are kept in a bounded cache shared by
+// all threads. Stat results are only cached for read only
+// mounts, whose content can't change while the game runs.
+
+class VirtualFileSystem final
+{
+public:
+	VirtualFileSystem();
+	~VirtualFileSystem();
+
+	// Mounts the default devices.
+	// strAppRoot is the host directory of the game package.
+	bool Init(const std::string& strAppRoot);
+
+	// Not thread safe, must be called before the game starts.
+	bool Mount(const std::string& strMountPoint, const std::string& strHostPath, bool bReadOnly);
+
+	// Returns the host path of a PS4 path.
+	// Paths outside of the mount table are passed through.
+	std::string Resolve(const std::string& strPath);
+
+	// Returns false if the file doesn't exist.
+	bool Stat(const std::string& strPath, VfsFileInfo* pInfo);
+
+	// Drops the cached stat result of a path which
+	// is going to be created or changed.
+	void Invalidate(const std::string& strPath);
+
+private:
+	struct MountPoint
+	{
+		std::string strMountPoint;
+		std::string strHostPath;
+		bool        bReadOnly;
+	};
+
+	struct CacheEntry
+	{
+		std::string strPath;
+		std::string strHostPath;
+		bool        bReadOnly;
+		bool        bStatValid;
+		bool        bExists;
+		VfsFileInfo info;
+	};
+
+	// Least recently used entries are dropped first.
+	struct CacheShard
+	{
+		std::mutex                                                       mutex;
+		std::list<CacheEntry>                                            lru;
+		std::unordered_map<std::string, std::list<CacheEntry>::iterator> map;
+	};
+
+	static constexpr size_t CacheShardCount    = 16;
+	static constexpr size_t CacheShardCapacity = 512;
+
+	CacheShard& getShard(const std::string& strPath);
+
+	// Looks up or inserts the entry of a path,
+	// the shard must be locked by the caller.
+	CacheEntry& getEntry(CacheShard& shard, const std::string& strPath);
+
+	const MountPoint* findMount(const std::string& strPath) const;
+
+	std::string resolvePath(const std::string& strPath, bool* pReadOnly) const;
+
+private:
+	std::vector<MountPoint>                 m_mounts;
+	std::array<CacheShard, CacheShardCount> m_cache;
+};
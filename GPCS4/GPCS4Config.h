@@ -13,6 +13,19 @@
 // #define GPCS4_DEBUG
 
 
+// Log severity
+// Log calls below GPCS4_LOG_MIN_SEVERITY are compiled out entirely.
+#define GPCS4_LOG_SEVERITY_TRACE   0
+#define GPCS4_LOG_SEVERITY_DEBUG   1
+#define GPCS4_LOG_SEVERITY_FIXME   2
+#define GPCS4_LOG_SEVERITY_WARNING 3
+#define GPCS4_LOG_SEVERITY_ERROR   4
+
+#ifndef GPCS4_LOG_MIN_SEVERITY
+#define GPCS4_LOG_MIN_SEVERITY GPCS4_LOG_SEVERITY_TRACE
+#endif
+
+
 // Windows compile
 #define GPCS4_WINDOWS
 
@@ -20,6 +33,12 @@
 // Linux compile
 // #define GPCS4_LINUX
 
+
+// Submit batched file reads to an io_uring on Linux.
+// Needs linux/io_uring.h to build, kernels without io_uring
+// fall back to the thread pool at runtime.
+// #define GPCS4_IO_URING
+
  
 // Graphics switch
 // Define this will turn off graphics output,
@@ -2,6 +2,7 @@
 #include "Emulator/SceModuleSystem.h"
 #include "Emulator/TLSHandler.h"
 #include "Loader/ModuleLoader.h"
+#include "SceModules/SceAudioOut/AudioOut.h"
 
 #include <cxxopts/cxxopts.hpp>
 #include <memory>
@@ -12,7 +13,7 @@ cxxopts::ParseResult processCommandLine(int argc, char* argv[])
 {
 	cxxopts::Options opts("GPCS4", "PlayStation 4 Emulator");
 	opts.allow_unrecognised_options();
-	opts.add_options()("E,eboot", "Set main executable. The current working directory will be mapped to /app0.", cxxopts::value<std::string>())("D,debug-channel", "Enable debug channel. 'ALL' for all channels.", cxxopts::value<std::vector<std::string>>())("L,list-channels", "List debug channels.")("H,help", "Print help message.");
+	opts.add_options()("E,eboot", "Set main executable. The current working directory will be mapped to /app0.", cxxopts::value<std::string>())("D,debug-channel", "Enable debug channel. 'ALL' for all channels. Append ':level' (debug/fixme/warn/error) to set the minimum level.", cxxopts::value<std::vector<std::string>>())("L,list-channels", "List debug channels.")("audio-backend", "Set audio output: rtaudio, null, or wav[:path] to write a wav file. null and wav keep real time pacing without a sound device.", cxxopts::value<std::string>())("audio-latency", "Number of audio grains a port may queue before output blocks.", cxxopts::value<uint32_t>())("H,help", "Print help message.");
 
 	// Backup arg count,
 	// because cxxopts will change argc value internally,
@@ -46,6 +47,18 @@ int main(int argc, char* argv[])
 			break;
 		}
 
+		if (optResult.count("audio-backend") &&
+			!AudioOut::setBackend(optResult["audio-backend"].as<std::string>()))
+		{
+			LOG_ERR("unknown audio backend %s", optResult["audio-backend"].as<std::string>().c_str());
+			break;
+		}
+
+		if (optResult.count("audio-latency"))
+		{
+			AudioOut::setLatency(optResult["audio-latency"].as<uint32_t>());
+		}
+
 		// Initialize the whole emulator.
 
 		LOG_DEBUG("GPCS4 start.");
@@ -81,5 +94,7 @@ int main(int argc, char* argv[])
 		nRet = 0;
 	} while (false);
 
+	logsys::shutdown();
+
 	return nRet;
 }
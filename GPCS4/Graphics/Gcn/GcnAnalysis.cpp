@@ -1,7 +1,85 @@
 #include "GcnAnalysis.h"
+#include "GcnInstruction.h"
+
+#include "UtilBit.h"
+
+#include <algorithm>
+
+LOG_CHANNEL(Graphic.Gcn.GcnAnalysis);
 
 namespace sce::gcn
 {
+	namespace
+	{
+		bool isWideType(GcnNumericType type)
+		{
+			return type == GcnNumericType::B64 ||
+				   type == GcnNumericType::F64 ||
+				   type == GcnNumericType::U64 ||
+				   type == GcnNumericType::I64;
+		}
+
+		bool isVopcOpcode(GcnOpcode opcode)
+		{
+			return uint32_t(opcode) >= uint32_t(GcnOpcodeMap::OP_MAP_VOPC) &&
+				   uint32_t(opcode) < uint32_t(GcnOpcodeMap::OP_MAP_VOP2);
+		}
+
+		bool getInlineConstant(const GcnInstOperand& operand, uint32_t& value)
+		{
+			bool result = true;
+			switch (operand.field)
+			{
+			case GcnOperandField::ConstZero: value = 0; break;
+			case GcnOperandField::SignedConstIntPos: value = operand.code - 128; break;
+			case GcnOperandField::SignedConstIntNeg: value = uint32_t(-int32_t(operand.code - 192)); break;
+			case GcnOperandField::ConstFloatPos_0_5: value = 0x3F000000; break;
+			case GcnOperandField::ConstFloatNeg_0_5: value = 0xBF000000; break;
+			case GcnOperandField::ConstFloatPos_1_0: value = 0x3F800000; break;
+			case GcnOperandField::ConstFloatNeg_1_0: value = 0xBF800000; break;
+			case GcnOperandField::ConstFloatPos_2_0: value = 0x40000000; break;
+			case GcnOperandField::ConstFloatNeg_2_0: value = 0xC0000000; break;
+			case GcnOperandField::ConstFloatPos_4_0: value = 0x40800000; break;
+			case GcnOperandField::ConstFloatNeg_4_0: value = 0xC0800000; break;
+			case GcnOperandField::LiteralConst: value = operand.literalConst; break;
+			default:
+				result = false;
+				break;
+			}
+			return result;
+		}
+
+		// Register range written through the destination operand,
+		// the decoder doesn't give wide or implicit scalar results.
+		GcnInstOperand getDstOperand(const GcnShaderInstruction& ins, uint32_t index, uint32_t& count)
+		{
+			GcnInstOperand dst = ins.dst[index];
+			if (ins.encoding == GcnInstEncoding::SMRD)
+			{
+				count = ins.control.smrd.count;
+				return dst;
+			}
+
+			bool isWide = std::any_of(ins.src, ins.src + ins.srcCount,
+									  [](const GcnInstOperand& src)
+									  { return isWideType(src.numericType); });
+
+			// Lane masks and lane reads write
+			// SGPRs despite the vector encoding.
+			bool isVop3Compare = ins.encoding == GcnInstEncoding::VOP3 && isVopcOpcode(ins.opcode);
+			bool isLaneRead    = ins.opcode == GcnOpcode::V_READFIRSTLANE_B32 ||
+							  ins.opcode == GcnOpcode::V_READLANE_B32;
+			if (isVop3Compare || isLaneRead)
+			{
+				dst.field = GcnOperandField::ScalarGPR;
+			}
+
+			bool wideDst = isWide || isVop3Compare || (dst.field == GcnOperandField::ScalarGPR && index == 1);
+			count        = wideDst ? 2 : 1;
+			return dst;
+		}
+	}  // namespace
+
 	GcnAnalyzer::GcnAnalyzer(
 		const GcnProgramInfo& programInfo,
 		GcnAnalysisInfo&      analysis) :
@@ -16,7 +94,350 @@ namespace sce::gcn
 	void GcnAnalyzer::processInstruction(
 		const GcnShaderInstruction& ins)
 	{
+		// Constants and uniformity depend on the
+		// register state before this instruction.
+		this->analyzeConstant(ins);
+		this->analyzeUniformity(ins);
+		this->analyzeRegisterAccess(ins);
+		this->analyzeBufferAccess(ins);
+
 		updateProgramCounter(ins);
+		++m_instructionIndex;
+	}
+
+	void GcnAnalyzer::analyzeRegisterAccess(
+		const GcnShaderInstruction& ins)
+	{
+		GcnGprAccess access = {};
+
+		auto read = [&](const GcnInstOperand& operand, uint32_t count)
+		{
+			if (getOperandAccess(operand, count, access))
+			{
+				markRead(access);
+			}
+		};
+
+		auto write = [&](const GcnInstOperand& operand, uint32_t count)
+		{
+			if (getOperandAccess(operand, count, access))
+			{
+				markWrite(access);
+			}
+		};
+
+		// Memory results differ per lane.
+		auto clearUniform = [&](const GcnInstOperand& operand, uint32_t count)
+		{
+			if (getOperandAccess(operand, count, access))
+			{
+				uint32_t end = uint32_t(std::min<size_t>(access.index + access.count, GcnMaxVGPR));
+				for (uint32_t i = access.index; i < end; ++i)
+				{
+					m_analysis->vgprUniform[i] = false;
+				}
+			}
+		};
+
+		switch (ins.encoding)
+		{
+		case GcnInstEncoding::SMRD:
+		{
+			// sbase is encoded in sgpr pairs, the
+			// buffer variants take a full V#.
+			bool isBufferLoad = ins.opcode >= GcnOpcode::S_BUFFER_LOAD_DWORD &&
+								ins.opcode <= GcnOpcode::S_BUFFER_LOAD_DWORDX16;
+			markRead({ false, ins.src[0].code * 2, isBufferLoad ? 4u : 2u });
+
+			uint32_t count = 0;
+			write(getDstOperand(ins, 0, count), count);
+		}
+			break;
+		case GcnInstEncoding::MUBUF:
+		case GcnInstEncoding::MTBUF:
+		{
+			bool     offen = ins.encoding == GcnInstEncoding::MUBUF ? ins.control.mubuf.offen : ins.control.mtbuf.offen;
+			bool     idxen = ins.encoding == GcnInstEncoding::MUBUF ? ins.control.mubuf.idxen : ins.control.mtbuf.idxen;
+			uint32_t count = ins.encoding == GcnInstEncoding::MUBUF ? ins.control.mubuf.count : ins.control.mtbuf.count;
+			// Sub-dword loads and atomics don't set a count,
+			// assume the widest.
+			count = count != 0 ? count : 4;
+
+			read(ins.src[0], uint32_t(offen) + uint32_t(idxen));
+			markRead({ false, ins.src[2].code * 4, 4 });
+			read(ins.src[3], 1);
+			// vdata is treated as both read and written
+			// for loads and stores, which is conservative.
+			read(ins.src[1], count);
+			write(ins.src[1], count);
+			clearUniform(ins.src[1], count);
+		}
+			break;
+		case GcnInstEncoding::MIMG:
+		{
+			// Address size depends on the image dimension,
+			// assume the maximum.
+			uint32_t count = util::bit::popcnt(uint32_t(ins.control.mimg.dmask));
+			read(ins.src[0], 4);
+			read(ins.src[1], count);
+			write(ins.src[1], count);
+			clearUniform(ins.src[1], count);
+			markRead({ false, ins.src[2].code * 4, ins.control.mimg.r128 ? 4u : 8u });
+			markRead({ false, ins.src[3].code * 4, 4 });
+		}
+			break;
+		case GcnInstEncoding::EXP:
+		{
+			for (uint32_t i = 0; i != 4; ++i)
+			{
+				if (ins.control.exp.en & (1u << i))
+				{
+					read(ins.src[i], 1);
+				}
+			}
+		}
+			break;
+		default:
+		{
+			for (uint32_t i = 0; i != ins.srcCount; ++i)
+			{
+				read(ins.src[i], isWideType(ins.src[i].numericType) ? 2 : 1);
+			}
+
+			for (uint32_t i = 0; i != ins.dstCount; ++i)
+			{
+				uint32_t count = 0;
+				write(getDstOperand(ins, i, count), count);
+			}
+		}
+			break;
+		}
+	}
+
+	void GcnAnalyzer::analyzeUniformity(
+		const GcnShaderInstruction& ins)
+	{
+		if (ins.dstCount == 0 ||
+			ins.dst[0].field != GcnOperandField::VectorGPR)
+		{
+			return;
+		}
+
+		GcnGprAccess access = {};
+		if (!getOperandAccess(ins.dst[0], 1, access))
+		{
+			return;
+		}
+
+		bool isUniform = ins.category == GcnInstCategory::VectorALU &&
+						 std::all_of(ins.src, ins.src + ins.srcCount,
+									 [this](const GcnInstOperand& src)
+									 { return isUniformOperand(src); });
+
+		// A register is uniform only if every
+		// value written to it is uniform.
+		auto& usage = m_analysis->vgpr;
+		bool  first = !usage.written[access.index];
+		m_analysis->vgprUniform[access.index] =
+			isUniform && (first || m_analysis->vgprUniform[access.index]);
+	}
+
+	void GcnAnalyzer::analyzeConstant(
+		const GcnShaderInstruction& ins)
+	{
+		uint32_t value      = 0;
+		bool     isConstant = ins.opcode == GcnOpcode::S_MOV_B32 &&
+						  getInlineConstant(ins.src[0], value);
+
+		for (uint32_t i = 0; i != ins.dstCount; ++i)
+		{
+			uint32_t       count = 0;
+			GcnInstOperand dst   = getDstOperand(ins, i, count);
+			if (dst.field != GcnOperandField::ScalarGPR)
+			{
+				continue;
+			}
+
+			// Every register of a wide result is varying.
+			uint32_t end = uint32_t(std::min<size_t>(dst.code + count, GcnMaxSGPR));
+			for (uint32_t index = dst.code; index < end; ++index)
+			{
+				bool untouched = m_analysis->sgpr.ranges[index].empty();
+				if (isConstant && untouched && !m_sgprVarying[index])
+				{
+					m_analysis->sgprConstant[index]      = true;
+					m_analysis->sgprConstantValue[index] = value;
+				}
+				else
+				{
+					m_analysis->sgprConstant[index] = false;
+					m_sgprVarying[index]            = true;
+				}
+			}
+		}
+	}
+
+	void GcnAnalyzer::analyzeBufferAccess(
+		const GcnShaderInstruction& ins)
+	{
+		switch (ins.encoding)
+		{
+		case GcnInstEncoding::SMRD:
+		{
+			if (ins.opcode < GcnOpcode::S_BUFFER_LOAD_DWORD ||
+				ins.opcode > GcnOpcode::S_BUFFER_LOAD_DWORDX16)
+			{
+				break;
+			}
+
+			// Without imm the offset is taken from an sgpr.
+			const auto& smrd = ins.control.smrd;
+			uint32_t    size = smrd.imm
+								   ? (smrd.offset + smrd.count) * sizeof(uint32_t)
+								   : GcnBufferSizeUnbounded;
+			updateBufferAccess(ins.src[0].code * 2, size);
+		}
+			break;
+		case GcnInstEncoding::MUBUF:
+		case GcnInstEncoding::MTBUF:
+		{
+			bool     isMubuf = ins.encoding == GcnInstEncoding::MUBUF;
+			bool     offen   = isMubuf ? ins.control.mubuf.offen : ins.control.mtbuf.offen;
+			bool     idxen   = isMubuf ? ins.control.mubuf.idxen : ins.control.mtbuf.idxen;
+			uint32_t offset  = isMubuf ? ins.control.mubuf.offset : ins.control.mtbuf.offset;
+			uint32_t count   = isMubuf ? ins.control.mubuf.count : ins.control.mtbuf.count;
+			count            = count != 0 ? count : 4;
+
+			// The address is static only if no vgpr
+			// takes part in it and soffset is a constant.
+			uint32_t soffset = 0;
+			uint32_t size    = GcnBufferSizeUnbounded;
+			if (!offen && !idxen && getInlineConstant(ins.src[3], soffset))
+			{
+				size = offset + soffset + count * sizeof(uint32_t);
+			}
+			updateBufferAccess(ins.src[2].code * 4, size);
+		}
+			break;
+		default:
+			break;
+		}
+	}
+
+	void GcnAnalyzer::updateBufferAccess(
+		uint32_t sgprIndex,
+		uint32_t size)
+	{
+		if (sgprIndex < GcnMaxSGPR)
+		{
+			auto& accessSize = m_analysis->bufferAccessSize[sgprIndex];
+			accessSize       = std::max(accessSize, size);
+		}
+	}
+
+	bool GcnAnalyzer::getOperandAccess(
+		const GcnInstOperand& operand,
+		uint32_t              count,
+		GcnGprAccess&         access) const
+	{
+		bool result = false;
+		do
+		{
+			if (count == 0)
+			{
+				break;
+			}
+
+			if (operand.field == GcnOperandField::VectorGPR)
+			{
+				// Operands decoded from 9 bit source
+				// fields carry the vgpr offset.
+				uint32_t index = operand.code >= GcnCodeVGPR0 ? operand.code - GcnCodeVGPR0 : operand.code;
+				access         = { true, index, count };
+				result         = index < GcnMaxVGPR;
+			}
+			else if (operand.field == GcnOperandField::ScalarGPR)
+			{
+				access = { false, operand.code, count };
+				result = operand.code < GcnMaxSGPR;
+			}
+		} while (false);
+
+		return result;
+	}
+
+	bool GcnAnalyzer::isUniformOperand(
+		const GcnInstOperand& operand) const
+	{
+		bool result = true;
+		switch (operand.field)
+		{
+		case GcnOperandField::VectorGPR:
+		{
+			GcnGprAccess access = {};
+			result              = getOperandAccess(operand, 1, access) &&
+					 m_analysis->vgpr.written[access.index] &&
+					 m_analysis->vgprUniform[access.index];
+		}
+			break;
+		case GcnOperandField::LdsDirect:
+			result = false;
+			break;
+		default:
+			// SGPRs, constants and special
+			// registers are uniform per wave.
+			break;
+		}
+		return result;
+	}
+
+	void GcnAnalyzer::markRead(const GcnGprAccess& access)
+	{
+		if (access.isVector)
+		{
+			markAccess(m_analysis->vgpr, access, false);
+		}
+		else
+		{
+			markAccess(m_analysis->sgpr, access, false);
+		}
+	}
+
+	void GcnAnalyzer::markWrite(const GcnGprAccess& access)
+	{
+		if (access.isVector)
+		{
+			markAccess(m_analysis->vgpr, access, true);
+		}
+		else
+		{
+			markAccess(m_analysis->sgpr, access, true);
+		}
+	}
+
+	template <size_t N>
+	void GcnAnalyzer::markAccess(
+		GcnGprUsage<N>&     usage,
+		const GcnGprAccess& access,
+		bool                write)
+	{
+		uint32_t end = std::min<uint32_t>(access.index + access.count, N);
+		for (uint32_t i = access.index; i < end; ++i)
+		{
+			if (write)
+			{
+				usage.written[i]    = true;
+				usage.firstWrite[i] = std::min(usage.firstWrite[i], m_instructionIndex);
+			}
+			else
+			{
+				usage.read[i] = true;
+			}
+
+			auto& range = usage.ranges[i];
+			range.first = std::min(range.first, m_instructionIndex);
+			range.last  = std::max(range.last, m_instructionIndex);
+		}
 	}
 
-}  // namespace sce::gcn
\ No newline at end of file
+}  // namespace sce::gcn
@@ -1,22 +1,86 @@
 #pragma once
 
 #include "GcnCommon.h"
+#include "GcnCompilerDefs.h"
 #include "GcnInstructionIterator.h"
 
+#include <array>
+#include <bitset>
 
 namespace sce::gcn
 {
 	class GcnProgramInfo;
 	struct GcnShaderInstruction;
+	struct GcnInstOperand;
+
+	/**
+	 * \brief Live range of a GPR
+	 *
+	 * Indices of the first and the last instruction
+	 * accessing the register. Empty if \c first is
+	 * larger than \c last.
+	 */
+	struct GcnGprRange
+	{
+		uint32_t first = ~0u;
+		uint32_t last  = 0;
+
+		bool empty() const
+		{
+			return first > last;
+		}
+	};
+
+	/**
+	 * \brief Register usage of a register file
+	 */
+	template <size_t N>
+	struct GcnGprUsage
+	{
+		std::bitset<N>             read;
+		std::bitset<N>             written;
+		std::array<GcnGprRange, N> ranges;
+		// First instruction writing the register
+		std::array<uint32_t, N> firstWrite;
+
+		GcnGprUsage()
+		{
+			firstWrite.fill(~0u);
+		}
+	};
+
+	/**
+	 * \brief Unbounded buffer access
+	 *
+	 * The buffer is accessed at an offset
+	 * which is not known at compile time.
+	 */
+	constexpr uint32_t GcnBufferSizeUnbounded = ~0u;
 
 	struct GcnAnalysisInfo
 	{
-		uint32_t placeHolder;
+		GcnGprUsage<GcnMaxSGPR> sgpr;
+		GcnGprUsage<GcnMaxVGPR> vgpr;
+
+		// VGPRs which only ever hold wave-uniform
+		// values, i.e. were computed from SGPRs and
+		// constants only.
+		std::bitset<GcnMaxVGPR> vgprUniform;
+
+		// SGPRs assigned a constant exactly once,
+		// before any read. Reads can be folded.
+		std::bitset<GcnMaxSGPR>           sgprConstant;
+		std::array<uint32_t, GcnMaxSGPR> sgprConstantValue = {};
+
+		// Bytes accessed in the buffer whose V# starts
+		// at the sgpr, i.e. the largest static offset
+		// plus the load size.
+		std::array<uint32_t, GcnMaxSGPR> bufferAccessSize = {};
 	};
 
 	/**
 	 * \brief GCN shader analyzer
-	 * 
+	 *
 	 * Pre-collect global information of a shader
 	 * which is not possible to get when stepping a instruction.
      * The information will later be used by the actual compiler.
@@ -36,8 +100,56 @@ namespace sce::gcn
 		virtual void processInstruction(
 			const GcnShaderInstruction& ins) override;
 
+	private:
+		struct GcnGprAccess
+		{
+			bool     isVector;
+			uint32_t index;
+			uint32_t count;
+		};
+
+		void analyzeRegisterAccess(
+			const GcnShaderInstruction& ins);
+
+		void analyzeUniformity(
+			const GcnShaderInstruction& ins);
+
+		void analyzeConstant(
+			const GcnShaderInstruction& ins);
+
+		void analyzeBufferAccess(
+			const GcnShaderInstruction& ins);
+
+		void updateBufferAccess(
+			uint32_t sgprIndex,
+			uint32_t size);
+
+		bool getOperandAccess(
+			const GcnInstOperand& operand,
+			uint32_t              count,
+			GcnGprAccess&         access) const;
+
+		bool isUniformOperand(
+			const GcnInstOperand& operand) const;
+
+		void markRead(const GcnGprAccess& access);
+		void markWrite(const GcnGprAccess& access);
+
+		template <size_t N>
+		void markAccess(
+			GcnGprUsage<N>&     usage,
+			const GcnGprAccess& access,
+			bool                write);
+
 	private:
 		GcnAnalysisInfo* m_analysis = nullptr;
+
+		// Index of the instruction being processed
+		uint32_t m_instructionIndex = 0;
+
+		// SGPRs written more than once, or by
+		// something other than a constant move.
+		std::bitset<GcnMaxSGPR> m_sgprVarying;
 	};
 
 
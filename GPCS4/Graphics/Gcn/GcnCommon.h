@@ -6,8 +6,11 @@
 
 #ifdef GPCS4_DEBUG
 
-// Dump shader to file
+// Dump shader to file,
+// offline tools define GCN_NO_SHADER_DUMP
+#ifndef GCN_NO_SHADER_DUMP
 #define GCN_DUMP_SHADER
+#endif
 
 // Enable some debug features during shader compile
 #define GCN_COMPILER_DEBUG
@@ -4,8 +4,10 @@
 #include "GcnHeader.h"
 #include "GcnUtil.h"
 #include "PlatFile.h"
+#include "UtilMath.h"
 
 #include "Gnm/GnmConstant.h"
+#include "Violet/VltSpecConst.h"
 
 #include <algorithm>
 
@@ -20,6 +22,10 @@ namespace sce::gcn
 	constexpr uint32_t PerVertex_CullDist = 1;
 	constexpr uint32_t PerVertex_ClipDist = 2;
 
+	// Size of uniform buffers which are accessed at
+	// offsets not known at compile time.
+	constexpr uint32_t MaxUniformBufferSize = 65536;
+
 	GcnCompiler::GcnCompiler(
 		const std::string&     fileName,
 		const GcnProgramInfo&  programInfo,
@@ -127,6 +133,11 @@ namespace sce::gcn
 							   m_entryPointInterfaces.data());
 		m_module.setDebugName(m_entryPointId, "main");
 
+		// GPRs which are only written, e.g. the
+		// results of the last block, are dead.
+		uint32_t removedVars = m_module.removeUnreadPrivateVars();
+		LOG_DEBUG("removed %d unread gpr variables", removedVars);
+
 		// Options is not used currently, pass a dummy value.
 		VltShaderOptions shaderOptions = {};
 
@@ -148,6 +159,7 @@ namespace sce::gcn
 
 		// Declare shader resource and input interfaces
 		this->emitDclInputSlots();
+		this->emitDclUserData();
 
 		// Initialize the shader module with capabilities
 		// etc. Each shader type has its own peculiarities.
@@ -183,6 +195,8 @@ namespace sce::gcn
 	{
 		if (m_insideFunction)
 		{
+			this->emitGprWriteBack();
+
 			m_module.opReturn();
 			m_module.functionEnd();
 		}
@@ -192,6 +206,10 @@ namespace sce::gcn
 
 	void GcnCompiler::emitFunctionLabel()
 	{
+		// Values known in the previous block
+		// are not valid in the new one.
+		this->emitGprInvalidate();
+
 		m_module.opLabel(m_module.allocateId());
 	}
 
@@ -255,6 +273,7 @@ namespace sce::gcn
 
 	void GcnCompiler::emitCsInit()
 	{
+		this->emitDclThreadGroup();
 	}
 
 	void GcnCompiler::emitVsFinalize()
@@ -262,6 +281,10 @@ namespace sce::gcn
 		this->emitMainFunctionBegin();
 		this->emitInputSetup();
 
+		// The called functions access GPRs
+		// through the private variables.
+		this->emitGprWriteBack();
+
 		// call fetch shader
 		m_module.opFunctionCall(
 			m_module.defVoidType(),
@@ -271,6 +294,8 @@ namespace sce::gcn
 		m_module.opFunctionCall(
 			m_module.defVoidType(),
 			m_vs.functionId, 0, nullptr);
+
+		this->emitGprInvalidate();
 		this->emitOutputSetup();
 		this->emitFunctionEnd();
 	}
@@ -360,10 +385,9 @@ namespace sce::gcn
 			(res.type == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
 
 		std::string name = util::str::formatex(asSsbo ? "sb" : "cb", regIdx);
-		// Declare the uniform buffer as max supported size.
-		// Will this produce bad impact?
-		constexpr uint32_t MaxUniformBufferSize = 65536;
-		uint32_t           numConstants         = asSsbo ? 0 : MaxUniformBufferSize / 16;
+		// Declare the uniform buffer as large as the shader
+		// accesses it, in vec4 units.
+		uint32_t numConstants = asSsbo ? 0 : getConstantBufferSize(res) / 16;
 
 		uint32_t arrayType = 0;
 		if (!asSsbo)
@@ -477,7 +501,7 @@ namespace sce::gcn
 		Gnm::TextureType   textureType   = textureInfo.textureType;
 		const uint32_t     sampledTypeId = getScalarTypeId(sampledType);
 		const GcnImageInfo typeInfo      = getImageType(
-				 textureType, isStorage, textureInfo.isDepth);
+				 textureType, isStorage, false);
 
 		// Declare additional capabilities if necessary
 		switch (textureType)
@@ -542,18 +566,6 @@ namespace sce::gcn
 		tex.sampledTypeId = sampledTypeId;
 		tex.imageTypeId   = imageTypeId;
 		tex.colorTypeId   = imageTypeId;
-		tex.depthTypeId   = 0;
-
-		if (textureInfo.isDepth &&
-			(sampledType == GcnScalarType::Float32) &&
-			(textureType == Gnm::kTextureType2d ||
-			 textureType == Gnm::kTextureType2dArray ||
-			 textureType == Gnm::kTextureTypeCubemap))
-		{
-			tex.depthTypeId = m_module.defImageType(sampledTypeId,
-													typeInfo.dim, 1, typeInfo.array, typeInfo.ms, typeInfo.sampled,
-													spv::ImageFormatUnknown);
-		}
 
 		m_textures.at(registerId) = tex;
 
@@ -611,7 +623,73 @@ namespace sce::gcn
 		resource.access = 0;
 		m_resourceSlots.push_back(resource);
 	}
+
+	void GcnCompiler::emitDclUserData()
+	{
+		uint32_t count = getUserSgprCount();
+		if (count == 0)
+		{
+			return;
+		}
+
+		// The push constant range is shared between
+		// graphics stages, each stage has its own block.
+		uint32_t offset = computeUserDataOffset(m_programInfo.type());
+
+		uint32_t arrayType = m_module.defArrayTypeUnique(
+			getScalarTypeId(GcnScalarType::Uint32),
+			m_module.constu32(count));
+		m_module.decorateArrayStride(arrayType, 4);
+
+		uint32_t structType = m_module.defStructTypeUnique(1, &arrayType);
+		m_module.decorateBlock(structType);
+		m_module.memberDecorateOffset(structType, 0, offset);
+
+		m_module.setDebugName(structType, "user_data_t");
+		m_module.setDebugMemberName(structType, 0, "s");
+
+		m_vUserDataArray = m_module.newVar(
+			m_module.defPointerType(structType, spv::StorageClassPushConstant),
+			spv::StorageClassPushConstant);
+		m_module.setDebugName(m_vUserDataArray, "user_data");
+
+		m_interfaceSlots.pushConstOffset = offset;
+		m_interfaceSlots.pushConstSize   = count * sizeof(uint32_t);
+	}
 	
+	void GcnCompiler::emitDclThreadGroup()
+	{
+		// The thread count comes with the dispatch, declare
+		// the workgroup size as specialization constants so
+		// a shader isn't compiled again for other counts.
+		const std::array<std::pair<uint32_t, GcnSpecConstant>, 3> threadCounts = { {
+			{ m_meta.cs.computeNumThreadX, GcnSpecConstant::ComputeNumThreadX },
+			{ m_meta.cs.computeNumThreadY, GcnSpecConstant::ComputeNumThreadY },
+			{ m_meta.cs.computeNumThreadZ, GcnSpecConstant::ComputeNumThreadZ },
+		} };
+
+		std::array<uint32_t, 3> sizeIds;
+		for (uint32_t i = 0; i != sizeIds.size(); ++i)
+		{
+			auto [count, specConst] = threadCounts[i];
+
+			sizeIds[i] = m_module.specConst32(
+				getScalarTypeId(GcnScalarType::Uint32),
+				std::max(count, 1u));
+			m_module.decorateSpecId(sizeIds[i], getSpecId(uint32_t(specConst)));
+		}
+
+		m_cs.workgroupSizeX = sizeIds[0];
+		m_cs.workgroupSizeY = sizeIds[1];
+		m_cs.workgroupSizeZ = sizeIds[2];
+
+		uint32_t workgroupSize = m_module.specConstComposite(
+			getVectorTypeId({ GcnScalarType::Uint32, 3 }),
+			sizeIds.size(), sizeIds.data());
+		m_module.decorateBuiltIn(workgroupSize, spv::BuiltInWorkgroupSize);
+		m_module.setDebugName(workgroupSize, "workgroup_size");
+	}
+
 	void GcnCompiler::emitDclInput(
 		const VertexInputSemantic& sema)
 	{
@@ -654,10 +732,21 @@ namespace sce::gcn
 
 	void GcnCompiler::emitInputSetup()
 	{
-		// The 16 user data registers is passed though push constants,
-		// here we copy them into predefined user data array.
+		// The 16 user data registers is passed though push constants.
+		// Read-only ones are loaded on use, user data sgprs which
+		// the shader overwrites got a variable when first accessed,
+		// it is initialized here.
+		uint32_t userSgprCount = getUserSgprCount();
+		for (uint32_t i = 0; i != userSgprCount; ++i)
+		{
+			const GcnGpr& sgpr = m_sgprs[i];
+			if (sgpr.ptr.id == 0)
+			{
+				continue;
+			}
 
-		// TODO
+			m_module.opStore(sgpr.ptr.id, this->emitUserDataLoad(i).id);
+		}
 	}
 
 	void GcnCompiler::emitFetchInput()
@@ -726,41 +815,41 @@ namespace sce::gcn
 	GcnRegisterValue GcnCompiler::emitVgprLoad(
 		const GcnInstOperand& reg)
 	{
-		uint32_t            vgprIndex = reg.code - GcnCodeVGPR0;
-		GcnRegisterPointer& vgpr      = m_vgprs[vgprIndex];
+		uint32_t vgprIndex = reg.code >= GcnCodeVGPR0 ? reg.code - GcnCodeVGPR0 : reg.code;
+		GcnGpr&  vgpr      = m_vgprs[vgprIndex];
 
 		// vgprs are not allowed to load before created.
 		// if this occurs, it is most likely a system value vgpr
 		// which should be initialized in emitInputSetup,
 		// please add it there.
-		LOG_ASSERT(vgpr.id != 0, "vgpr v%d is not initialized before load.", vgprIndex);
+		LOG_ASSERT(vgpr.ptr.id != 0 || vgpr.value.id != 0, "vgpr v%d is not initialized before load.", vgprIndex);
 
-		return this->emitValueLoad(vgpr);
+		return this->emitGprLoad(vgpr);
 	}
 
 	void GcnCompiler::emitVgprStore(
 		const GcnInstOperand&   reg,
 		const GcnRegisterValue& value)
 	{
-		uint32_t            vgprIndex = reg.code - GcnCodeVGPR0;
-		GcnRegisterPointer& vgpr      = m_vgprs[vgprIndex];
+		// Operands decoded from 9 bit source
+		// fields carry the vgpr offset.
+		uint32_t vgprIndex = reg.code >= GcnCodeVGPR0 ? reg.code - GcnCodeVGPR0 : reg.code;
+		GcnGpr&  vgpr      = m_vgprs[vgprIndex];
+
+		// Values never read back are dead,
+		// don't even declare a variable.
+		if (!m_analysis->vgpr.read[vgprIndex])
+		{
+			return;
+		}
 
 		// If the vgpr has not been used, we create one.
-		if (vgpr.id == 0)
+		if (vgpr.ptr.id == 0)
 		{
-			GcnRegisterInfo info;
-			info.type.ctype   = GcnScalarType::Float32;
-			info.type.ccount  = 1;
-			info.type.alength = 0;
-			info.sclass       = spv::StorageClassPrivate;
-			uint32_t id       = emitNewVariable(info);
-
-			vgpr.type.ctype  = info.type.ctype;
-			vgpr.type.ccount = info.type.ccount;
-			vgpr.id          = id;
+			this->emitDclGpr(vgpr, GcnScalarType::Float32);
 		}
 
-		return this->emitValueStore(vgpr, value, GcnRegMask(true, false, false, false));
+		this->emitGprStore(vgpr, value);
 	}
 
 	GcnRegisterValue GcnCompiler::emitVgprArrayLoad(
@@ -799,15 +888,86 @@ namespace sce::gcn
 		}
 	}
 
+	GcnRegisterValue GcnCompiler::emitUserDataLoad(
+		uint32_t index)
+	{
+		uint32_t typeId = getScalarTypeId(GcnScalarType::Uint32);
+
+		const std::array<uint32_t, 2> indices = {
+			m_module.constu32(0),
+			m_module.constu32(index),
+		};
+
+		uint32_t ptrId = m_module.opAccessChain(
+			m_module.defPointerType(typeId, spv::StorageClassPushConstant),
+			m_vUserDataArray,
+			indices.size(), indices.data());
+
+		GcnRegisterValue result;
+		result.type.ctype  = GcnScalarType::Uint32;
+		result.type.ccount = 1;
+		result.id          = m_module.opLoad(typeId, ptrId);
+		return result;
+	}
+
 	GcnRegisterValue GcnCompiler::emitSgprLoad(
 		const GcnInstOperand& reg)
 	{
+		uint32_t sgprIndex = reg.code;
+		GcnGpr&  sgpr      = m_sgprs[sgprIndex];
+
+		// Fold sgprs which only ever hold one constant.
+		if (m_analysis->sgprConstant[sgprIndex])
+		{
+			GcnRegisterValue result;
+			result.type.ctype  = GcnScalarType::Uint32;
+			result.type.ccount = 1;
+			result.id          = m_module.constu32(m_analysis->sgprConstantValue[sgprIndex]);
+			return result;
+		}
+
+		// User data the shader never writes is loaded from
+		// the push constant block, overwritten user data goes
+		// through the variable emitInputSetup initializes.
+		if (sgpr.ptr.id == 0 && sgpr.value.id == 0 &&
+			sgprIndex < getUserSgprCount())
+		{
+			if (m_analysis->sgpr.written[sgprIndex])
+			{
+				this->emitDclGpr(sgpr, GcnScalarType::Uint32);
+			}
+			else
+			{
+				sgpr.value = this->emitUserDataLoad(sgprIndex);
+			}
+		}
+
+		LOG_ASSERT(sgpr.ptr.id != 0 || sgpr.value.id != 0, "sgpr s%d is not initialized before load.", sgprIndex);
+
+		return this->emitGprLoad(sgpr);
 	}
 
 	void GcnCompiler::emitSgprStore(
 		const GcnInstOperand&   reg,
 		const GcnRegisterValue& value)
 	{
+		uint32_t sgprIndex = reg.code;
+		GcnGpr&  sgpr      = m_sgprs[sgprIndex];
+
+		// Constant sgprs are folded into their
+		// users and dead ones are never read.
+		if (m_analysis->sgprConstant[sgprIndex] ||
+			!m_analysis->sgpr.read[sgprIndex])
+		{
+			return;
+		}
+
+		if (sgpr.ptr.id == 0)
+		{
+			this->emitDclGpr(sgpr, GcnScalarType::Uint32);
+		}
+
+		this->emitGprStore(sgpr, value);
 	}
 
 	GcnRegisterValue GcnCompiler::emitSgprArrayLoad(
@@ -827,6 +987,70 @@ namespace sce::gcn
 		// e.g. vec3 -> s[4:6]
 	}
 
+	GcnRegisterValue GcnCompiler::emitGprLoad(
+		GcnGpr& gpr)
+	{
+		if (gpr.value.id == 0)
+		{
+			gpr.value = this->emitValueLoad(gpr.ptr);
+		}
+		return gpr.value;
+	}
+
+	void GcnCompiler::emitGprStore(
+		GcnGpr&                 gpr,
+		const GcnRegisterValue& value)
+	{
+		LOG_ASSERT(value.type.ccount == 1, "gpr store with %d components.", value.type.ccount);
+
+		gpr.value = value.type.ctype != gpr.ptr.type.ctype
+						? this->emitRegisterBitcast(value, gpr.ptr.type.ctype)
+						: value;
+		gpr.dirty = true;
+	}
+
+	void GcnCompiler::emitGprWriteBack()
+	{
+		auto writeBack = [this](GcnGpr& gpr)
+		{
+			if (gpr.dirty)
+			{
+				m_module.opStore(gpr.ptr.id, gpr.value.id);
+				gpr.dirty = false;
+			}
+		};
+
+		std::for_each(m_vgprs.begin(), m_vgprs.end(), writeBack);
+		std::for_each(m_sgprs.begin(), m_sgprs.end(), writeBack);
+	}
+
+	void GcnCompiler::emitGprInvalidate()
+	{
+		auto invalidate = [](GcnGpr& gpr)
+		{
+			LOG_ASSERT(!gpr.dirty, "gpr value not written back.");
+			gpr.value = GcnRegisterValue{};
+		};
+
+		std::for_each(m_vgprs.begin(), m_vgprs.end(), invalidate);
+		std::for_each(m_sgprs.begin(), m_sgprs.end(), invalidate);
+	}
+
+	void GcnCompiler::emitDclGpr(
+		GcnGpr&       gpr,
+		GcnScalarType type)
+	{
+		GcnRegisterInfo info;
+		info.type.ctype   = type;
+		info.type.ccount  = 1;
+		info.type.alength = 0;
+		info.sclass       = spv::StorageClassPrivate;
+
+		gpr.ptr.type.ctype  = info.type.ctype;
+		gpr.ptr.type.ccount = info.type.ccount;
+		gpr.ptr.id          = this->emitNewVariable(info);
+	}
+
 	GcnRegisterValue GcnCompiler::emitValueLoad(
 		GcnRegisterPointer ptr)
 	{
@@ -1411,6 +1635,31 @@ namespace sce::gcn
 		return count;
 	}
 
+	uint32_t GcnCompiler::getConstantBufferSize(
+		const GcnShaderResource& res) const
+	{
+		uint32_t size = MaxUniformBufferSize;
+
+		// Accesses are recorded by the sgpr holding the V#,
+		// so only V#s which stay in user data can be matched.
+		uint32_t sgprIndex = res.startRegister;
+		bool     isStatic  = !res.inEud && sgprIndex + 4 <= GcnMaxSGPR;
+		for (uint32_t i = 0; isStatic && i != 4; ++i)
+		{
+			isStatic = !m_analysis->sgpr.written[sgprIndex + i];
+		}
+
+		if (isStatic)
+		{
+			uint32_t accessSize = m_analysis->bufferAccessSize[sgprIndex];
+			if (accessSize != GcnBufferSizeUnbounded)
+			{
+				size = util::align(std::clamp(accessSize, 16u, MaxUniformBufferSize), 16u);
+			}
+		}
+		return size;
+	}
+
 	bool GcnCompiler::hasFetchShader() const
 	{
 		auto& resTable = m_header->getShaderResourceTable();
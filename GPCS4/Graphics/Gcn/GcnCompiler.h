@@ -125,6 +125,9 @@ namespace sce::gcn
 			const GcnShaderResource& res);
 		void emitDclSampler(
 			const GcnShaderResource& res);
+		void emitDclUserData();
+
+		void emitDclThreadGroup();
 		///////////////////////////////
 		// Variable definition methods
 		uint32_t emitNewVariable(
@@ -139,6 +142,8 @@ namespace sce::gcn
 		// SGPR/VGPR load/store methods
 		GcnRegisterValue emitVgprLoad(
 			const GcnInstOperand& reg);
+		GcnRegisterValue emitUserDataLoad(
+			uint32_t index);
 		GcnRegisterValue emitSgprLoad(
 			const GcnInstOperand& reg);
 		GcnRegisterValue emitVgprArrayLoad(
@@ -163,6 +168,26 @@ namespace sce::gcn
 			uint32_t                count,
 			const GcnRegisterValue& value);
 
+		///////////////////////////////////////////////
+		// GPR value tracking. Stores are forwarded to
+		// loads within a block, so every code path which
+		// ends a block, calls a function or branches must
+		// write the values back first.
+		GcnRegisterValue emitGprLoad(
+			GcnGpr& gpr);
+
+		void emitGprStore(
+			GcnGpr&                 gpr,
+			const GcnRegisterValue& value);
+
+		void emitGprWriteBack();
+
+		void emitGprInvalidate();
+
+		void emitDclGpr(
+			GcnGpr&       gpr,
+			GcnScalarType type);
+
 		//////////////////////////////
 		// Operand load/store methods
 		GcnRegisterValue emitValueLoad(
@@ -289,6 +314,9 @@ namespace sce::gcn
 
 		uint32_t getUserSgprCount() const;
 
+		uint32_t getConstantBufferSize(
+			const GcnShaderResource& res) const;
+
 		bool hasFetchShader() const;
 
 		std::pair<const VertexInputSemantic*, uint32_t>
@@ -324,10 +352,10 @@ namespace sce::gcn
 		///////////////////////////////////////////////////
 		// VGPR/SGPR registers
 		std::array<
-			GcnRegisterPointer,
+			GcnGpr,
 			GcnMaxVGPR> m_vgprs = {};
 		std::array<
-			GcnRegisterPointer,
+			GcnGpr,
 			GcnMaxSGPR> m_sgprs = {};
 
 		//////////////////////////////////////////////////////
@@ -342,7 +370,8 @@ namespace sce::gcn
 		// to properly end functions in some cases.
 		bool m_insideFunction = false;
 		///////////////////////////////////////////////////////////
-		// An array stores up to 16 user data registers.
+		// An array stores up to 16 user data registers,
+		// declared as a push constant block.
 		uint32_t m_vUserDataArray = 0;
 
 		////////////////////////////////////////////////////
@@ -100,6 +100,22 @@ namespace sce::gcn
 		uint32_t      id = 0;
 	};
 
+	/**
+	 * \brief General purpose register
+	 *
+	 * Stores the variable backing a GPR and the value
+	 * it holds within the current block, if known.
+	 * Stores only update the value and are written
+	 * to the variable when the block ends, so that
+	 * loads can use the value directly.
+	 */
+	struct GcnGpr
+	{
+		GcnRegisterPointer ptr;
+		GcnRegisterValue   value = {};
+		bool               dirty = false;
+	};
+
 	/**
 	 * \brief Vertex shader-specific structure
 	 */
@@ -205,7 +221,6 @@ namespace sce::gcn
 		uint32_t      sampledTypeId = 0;
 		uint32_t      imageTypeId   = 0;
 		uint32_t      colorTypeId   = 0;
-		uint32_t      depthTypeId   = 0;
 	};
 
 }  // namespace sce::gcn
\ No newline at end of file
@@ -0,0 +1,198 @@
+#include "GcnDecodedProgram.h"
+#include "GcnDecoder.h"
+
+#include <algorithm>
+#include <exception>
+
+LOG_CHANNEL(Graphic.Gcn.GcnDecodedProgram);
+
+using namespace sce::vlt;
+
+namespace sce::gcn
+{
+	// Rough guess used to avoid reallocations,
+	// the average instruction is a bit longer than a dword.
+	constexpr uint32_t GcnAverageInstructionSize = 6;
+
+	GcnDecodedProgram::GcnDecodedProgram(
+		GcnCodeSlice code)
+	{
+		this->decodeInstructions(code);
+		this->buildBasicBlocks();
+	}
+
+	GcnDecodedProgram::~GcnDecodedProgram()
+	{
+	}
+
+	void GcnDecodedProgram::decodeInstructions(GcnCodeSlice code)
+	{
+		GcnDecodeContext decoder;
+
+		while (!code.atEnd())
+		{
+			decoder.decodeInstruction(code);
+
+			auto& ins = decoder.getInstruction();
+			m_instructions.push_back(ins);
+			m_offsets.push_back(m_length);
+			m_length += ins.length;
+
+			if (m_instructions.size() == 1)
+			{
+				// We know the program size now,
+				// reserve after the first instruction.
+				uint32_t sizeGuess = uint32_t(code.size() * sizeof(uint32_t)) / GcnAverageInstructionSize;
+				m_instructions.reserve(sizeGuess + 1);
+				m_offsets.reserve(sizeGuess + 1);
+			}
+		}
+	}
+
+	void GcnDecodedProgram::buildBasicBlocks()
+	{
+		uint32_t count = instructionCount();
+		if (count == 0)
+		{
+			return;
+		}
+
+		// Mark block leaders, which are the first instruction,
+		// branch targets and instructions following a branch.
+		std::vector<bool> leaders(count, false);
+		leaders[0] = true;
+
+		for (uint32_t i = 0; i != count; ++i)
+		{
+			auto& ins = m_instructions[i];
+
+			bool isBranch = false;
+			switch (ins.opcode)
+			{
+			case GcnOpcode::S_BRANCH:
+			case GcnOpcode::S_CBRANCH_SCC0:
+			case GcnOpcode::S_CBRANCH_SCC1:
+			case GcnOpcode::S_CBRANCH_VCCZ:
+			case GcnOpcode::S_CBRANCH_VCCNZ:
+			case GcnOpcode::S_CBRANCH_EXECZ:
+			case GcnOpcode::S_CBRANCH_EXECNZ:
+			{
+				// Target is relative to the next instruction, in dwords.
+				int32_t  simm   = int16_t(ins.control.sopp.simm);
+				uint32_t target = m_offsets[i] + ins.length + simm * sizeof(uint32_t);
+				uint32_t index  = findInstruction(target);
+				if (index != count)
+				{
+					leaders[index] = true;
+				}
+				else
+				{
+					LOG_WARN("branch target %X out of program", target);
+				}
+				isBranch = true;
+			}
+				break;
+			case GcnOpcode::S_ENDPGM:
+			case GcnOpcode::S_SETPC_B64:
+			case GcnOpcode::S_SWAPPC_B64:
+				isBranch = true;
+				break;
+			default:
+				break;
+			}
+
+			if (isBranch && i + 1 != count)
+			{
+				leaders[i + 1] = true;
+			}
+		}
+
+		for (uint32_t i = 0; i != count; ++i)
+		{
+			if (leaders[i])
+			{
+				m_blocks.push_back(GcnBasicBlock{ i, 0, m_offsets[i] });
+			}
+			++m_blocks.back().instructionCount;
+		}
+	}
+
+	uint32_t GcnDecodedProgram::findInstruction(uint32_t offset) const
+	{
+		auto iter = std::lower_bound(m_offsets.begin(), m_offsets.end(), offset);
+		return iter != m_offsets.end() && *iter == offset
+				   ? uint32_t(iter - m_offsets.begin())
+				   : instructionCount();
+	}
+
+	GcnDecodedProgramCache::GcnDecodedProgramCache()
+	{
+	}
+
+	GcnDecodedProgramCache::~GcnDecodedProgramCache()
+	{
+	}
+
+	Rc<GcnDecodedProgram> GcnDecodedProgramCache::getProgram(
+		uint64_t     key,
+		GcnCodeSlice code)
+	{
+		std::promise<Rc<GcnDecodedProgram>> promise;
+		GcnDecodedProgramFuture             future;
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+
+			auto iter = m_programs.find(key);
+			if (iter != m_programs.end())
+			{
+				m_lru.splice(m_lru.begin(), m_lru, iter->second.lruEntry);
+				future = iter->second.program;
+			}
+			else
+			{
+				m_lru.push_front(key);
+				m_programs.emplace(key, Entry{ promise.get_future().share(), m_lru.begin() });
+
+				// Users of a dropped program keep their reference.
+				if (m_programs.size() > MaxProgramCount)
+				{
+					m_programs.erase(m_lru.back());
+					m_lru.pop_back();
+				}
+			}
+		}
+
+		if (future.valid())
+		{
+			return future.get();
+		}
+
+		Rc<GcnDecodedProgram> program;
+		try
+		{
+			program = new GcnDecodedProgram(code);
+		}
+		catch (...)
+		{
+			// Waiters get the exception, later calls decode again.
+			promise.set_exception(std::current_exception());
+
+			std::lock_guard<std::mutex> lock(m_mutex);
+
+			// If ours was evicted meanwhile, this may drop a newer
+			// entry of the same key, which only costs a decode.
+			auto iter = m_programs.find(key);
+			if (iter != m_programs.end())
+			{
+				m_lru.erase(iter->second.lruEntry);
+				m_programs.erase(iter);
+			}
+			throw;
+		}
+
+		promise.set_value(program);
+		return program;
+	}
+
+}  // namespace sce::gcn
@@ -0,0 +1,155 @@
+#pragma once
+
+#include "GcnCommon.h"
+#include "GcnInstruction.h"
+#include "Violet/VltRc.h"
+
+#include <future>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace sce::gcn
+{
+	class GcnCodeSlice;
+
+	/**
+	 * \brief Basic block
+	 *
+	 * A range of instructions with a single entry
+	 * and a single exit, given as indices into
+	 * the instruction list of a decoded program.
+	 */
+	struct GcnBasicBlock
+	{
+		uint32_t firstInstruction;
+		uint32_t instructionCount;
+		// Byte offset of the first instruction
+		uint32_t offset;
+	};
+
+	/**
+	 * \brief Decoded GCN program
+	 *
+	 * The shader binary decoded once into flat arrays,
+	 * instructions and their byte offsets are stored
+	 * side by side, followed by basic block boundaries.
+	 * The program only depends on the shader code, so it
+	 * can be shared by all passes and all shader variants.
+	 */
+	class GcnDecodedProgram : public vlt::RcObject
+	{
+	public:
+		GcnDecodedProgram(
+			GcnCodeSlice code);
+		~GcnDecodedProgram();
+
+		/**
+		 * \brief Number of instructions
+		 */
+		uint32_t instructionCount() const
+		{
+			return uint32_t(m_instructions.size());
+		}
+
+		/**
+		 * \brief Decoded instructions in program order
+		 */
+		const std::vector<GcnShaderInstruction>& instructions() const
+		{
+			return m_instructions;
+		}
+
+		/**
+		 * \brief Byte offset of each instruction
+		 */
+		const std::vector<uint32_t>& offsets() const
+		{
+			return m_offsets;
+		}
+
+		/**
+		 * \brief Basic blocks in program order
+		 */
+		const std::vector<GcnBasicBlock>& blocks() const
+		{
+			return m_blocks;
+		}
+
+		/**
+		 * \brief Code size in bytes
+		 */
+		uint32_t length() const
+		{
+			return m_length;
+		}
+
+	private:
+		void decodeInstructions(GcnCodeSlice code);
+
+		void buildBasicBlocks();
+
+		uint32_t findInstruction(uint32_t offset) const;
+
+	private:
+		std::vector<GcnShaderInstruction> m_instructions;
+		std::vector<uint32_t>             m_offsets;
+		std::vector<GcnBasicBlock>        m_blocks;
+		uint32_t                          m_length = 0;
+	};
+
+	using GcnDecodedProgramFuture = std::shared_future<vlt::Rc<GcnDecodedProgram>>;
+
+	/**
+	 * \brief Decoded program cache
+	 *
+	 * Keeps decoded programs by shader key, so that
+	 * compiling another variant of the same shader
+	 * doesn't decode the binary again. The least
+	 * recently used programs are dropped once the
+	 * cache is full.
+	 */
+	class GcnDecodedProgramCache
+	{
+	public:
+		GcnDecodedProgramCache();
+		~GcnDecodedProgramCache();
+
+		/**
+		 * \brief Retrieves a decoded program
+		 *
+		 * Decodes the code on first use, outside of the
+		 * lock. Others asking for the same key meanwhile
+		 * wait for that decode. If the decode throws, the
+		 * exception is passed on to them and the program
+		 * is not cached.
+		 * \param [in] key Shader key
+		 * \param [in] code Shader code
+		 * \returns The decoded program
+		 */
+		vlt::Rc<GcnDecodedProgram> getProgram(
+			uint64_t     key,
+			GcnCodeSlice code);
+
+	private:
+		static constexpr size_t MaxProgramCount = 1024;
+
+		struct Entry
+		{
+			GcnDecodedProgramFuture       program;
+			std::list<uint64_t>::iterator lruEntry;
+		};
+
+		std::mutex m_mutex;
+
+		// Most recently used first
+		std::list<uint64_t> m_lru;
+
+		std::unordered_map<
+			uint64_t,
+			Entry>
+			m_programs;
+	};
+
+}  // namespace sce::gcn
@@ -154,6 +154,11 @@ namespace sce::gcn
 			return m_ptr == m_end;
 		}
 
+		size_t size() const
+		{
+			return size_t(m_end - m_ptr);
+		}
+
 	private:
 		const uint32_t* m_ptr = nullptr;
 		const uint32_t* m_end = nullptr;
@@ -1,13 +1,21 @@
 #include "GcnModule.h"
 #include "GcnAnalysis.h"
 #include "GcnCompiler.h"
+#include "GcnDecodedProgram.h"
 #include "GcnDecoder.h"
+#include "GcnShaderDump.h"
 
+#include <algorithm>
+#include <cstring>
 
 using namespace sce::vlt;
 
 namespace sce::gcn
 {
+	// Decoded programs live as long as the emulator,
+	// same as the shader code in guest memory.
+	static GcnDecodedProgramCache g_programCache;
+
 	GcnModule::GcnModule(
 		GcnProgramType type,
 		const uint8_t* code) :
@@ -21,19 +29,34 @@ namespace sce::gcn
 	{
 	}
 
-	Rc<VltShader> GcnModule::compile(
-		const GcnShaderMeta& meta) const
+	Rc<GcnDecodedProgram> GcnModule::decode() const
 	{
 		const uint32_t* start = reinterpret_cast<const uint32_t*>(m_code);
 		const uint32_t* end   = reinterpret_cast<const uint32_t*>(m_code + m_header.length());
 		GcnCodeSlice    codeSlice(start, end);
 
+		return g_programCache.getProgram(
+			m_header.key().key(), codeSlice);
+	}
+
+	Rc<VltShader> GcnModule::compile(
+		const GcnShaderMeta& meta) const
+	{
+		auto program = this->decode();
+
+#ifdef GCN_DUMP_SHADER
+		// Shaders dumped here can be translated
+		// offline by gcn-translate.
+		gcnDumpShader("shader_dump", m_programInfo.type(),
+					  m_code, m_header, meta);
+#endif
+
 		GcnAnalysisInfo analysisInfo;
 
 		GcnAnalyzer analyzer(
 			m_programInfo, analysisInfo);
 
-		this->runInstructionIterator(&analyzer, codeSlice);
+		this->runInstructionIterator(&analyzer, *program);
 
 		GcnCompiler compiler(
 			m_header.key().name(),
@@ -42,24 +65,86 @@ namespace sce::gcn
 			meta,
 			analysisInfo);
 
-		this->runInstructionIterator(&compiler, codeSlice);
+		this->runInstructionIterator(&compiler, *program);
 
 		return compiler.finalize();
 	}
 
-
-	void GcnModule::runInstructionIterator(
-		GcnInstructionIterator* insIterator,
-		GcnCodeSlice            slice) const
+	GcnShaderMeta GcnModule::getVariantMeta(
+		const GcnShaderMeta& meta) const
 	{
-		GcnDecodeContext decoder;
+		// Variants are keyed by the raw meta bytes,
+		// so everything not copied must stay zero.
+		GcnShaderMeta result;
+		std::memset(&result, 0, sizeof(GcnShaderMeta));
 
-		while (!slice.atEnd())
+		switch (m_programInfo.type())
 		{
-			decoder.decodeInstruction(slice);
+			case GcnProgramType::VertexShader:
+			{
+				uint32_t count = std::min<uint32_t>(meta.vs.inputSemanticCount, kMaxVertexBufferCount);
+
+				result.vs.userSgprCount      = meta.vs.userSgprCount;
+				result.vs.inputSemanticCount = count;
+				std::memcpy(result.vs.inputSemanticTable,
+							meta.vs.inputSemanticTable,
+							sizeof(VertexInputSemantic) * count);
+			}
+				break;
+			case GcnProgramType::PixelShader:
+			{
+				result.ps.userSgprCount      = meta.ps.userSgprCount;
+				result.ps.inputSemanticCount = meta.ps.inputSemanticCount;
+
+				for (const auto& res : getResourceTable())
+				{
+					bool isTexture =
+						(res.usage == Gnm::kShaderInputUsageImmResource ||
+						 res.usage == Gnm::kShaderInputUsageImmRwResource) &&
+						res.type != VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+					if (!isTexture)
+					{
+						continue;
+					}
+
+					const auto& info  = meta.ps.textureInfos[res.startRegister];
+					auto&       dst   = result.ps.textureInfos[res.startRegister];
+					dst.textureType   = info.textureType;
+					// Normalized formats are sampled as float, and
+					// depth textures use the same image type.
+					dst.channelType = info.channelType == Gnm::kTextureChannelTypeUNorm ||
+											  info.channelType == Gnm::kTextureChannelTypeSNorm
+										  ? Gnm::kTextureChannelTypeFloat
+										  : info.channelType;
+					dst.isDepth = false;
+				}
+			}
+				break;
+			case GcnProgramType::ComputeShader:
+				// The thread counts are specialization constants.
+				result.cs.userSgprCount = meta.cs.userSgprCount;
+				break;
+			case GcnProgramType::GeometryShader:
+				result.gs.userSgprCount = meta.gs.userSgprCount;
+				break;
+			case GcnProgramType::HullShader:
+				result.hs.userSgprCount = meta.hs.userSgprCount;
+				break;
+			case GcnProgramType::DomainShader:
+				result.ds.userSgprCount = meta.ds.userSgprCount;
+				break;
+		}
 
-			insIterator->processInstruction(
-				decoder.getInstruction());
+		return result;
+	}
+
+	void GcnModule::runInstructionIterator(
+		GcnInstructionIterator*  insIterator,
+		const GcnDecodedProgram& program) const
+	{
+		for (const auto& ins : program.instructions())
+		{
+			insIterator->processInstruction(ins);
 		}
 	}
 
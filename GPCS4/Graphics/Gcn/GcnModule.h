@@ -17,6 +17,7 @@ namespace sce::vlt
 namespace sce::gcn
 {
 	class GcnInstructionIterator;
+	class GcnDecodedProgram;
 	union GcnShaderMeta;
 
 	class GcnModule
@@ -36,6 +37,14 @@ namespace sce::gcn
 			return m_programInfo;
 		}
 
+		/**
+		 * \brief Shader key
+		 */
+		GcnShaderKey key() const
+		{
+			return m_header.key();
+		}
+
 		/**
 		 * \brief Get resources bound to the shader
 		 */
@@ -46,6 +55,14 @@ namespace sce::gcn
 		}
 
 
+		/**
+		 * \brief Decoded shader code
+		 *
+		 * Decoded on first use and shared by all
+		 * modules with the same shader key.
+		 */
+		vlt::Rc<GcnDecodedProgram> decode() const;
+
 		/**
          * \brief Compiles GCN shader to SPIR-V module
          * 
@@ -54,11 +71,24 @@ namespace sce::gcn
 		vlt::Rc<vlt::VltShader> compile(
 			const GcnShaderMeta& meta) const;
 
+		/**
+		 * \brief Strips meta the module doesn't depend on
+		 *
+		 * Clears everything passed as specialization constants
+		 * or not used by this shader, and folds texture infos
+		 * which declare the same resource type. Draws whose
+		 * meta only differ in those share a compiled shader.
+		 * \param [in] meta Meta information of the draw
+		 * \returns Meta information to compile with
+		 */
+		GcnShaderMeta getVariantMeta(
+			const GcnShaderMeta& meta) const;
+
 	private:
 
 		void runInstructionIterator(
-			GcnInstructionIterator* insIterator,
-			GcnCodeSlice            slice) const;
+			GcnInstructionIterator*  insIterator,
+			const GcnDecodedProgram& program) const;
 
 	private:
 		GcnProgramInfo           m_programInfo;
@@ -0,0 +1,126 @@
+#include "GcnShaderCompileService.h"
+#include "GcnDecodedProgram.h"
+#include "GcnHeader.h"
+#include "GcnModule.h"
+
+#include "Violet/VltShader.h"
+
+#include <cstring>
+
+LOG_CHANNEL(Graphic.Gcn.GcnShaderCompileService);
+
+using namespace sce::vlt;
+
+namespace sce::gcn
+{
+	bool GcnShaderVariantKey::eq(const GcnShaderVariantKey& other) const
+	{
+		return shaderKey == other.shaderKey &&
+			   type == other.type &&
+			   !std::memcmp(&meta, &other.meta, sizeof(GcnShaderMeta));
+	}
+
+	size_t GcnShaderVariantKey::hash() const
+	{
+		// Meta is zero initialized by the command buffer,
+		// so hashing the raw bytes is well defined.
+		const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&meta);
+
+		uint64_t metaHash = 0xcbf29ce484222325ull;
+		for (size_t i = 0; i != sizeof(GcnShaderMeta); ++i)
+		{
+			metaHash = (metaHash ^ bytes[i]) * 0x100000001b3ull;
+		}
+
+		VltHashState state;
+		state.add(shaderKey);
+		state.add(uint32_t(type));
+		state.add(metaHash);
+		return state;
+	}
+
+	GcnShaderCompileService::GcnShaderCompileService(
+		uint32_t threadCount) :
+		m_workers(threadCount)
+	{
+		LOG_DEBUG("shader compile workers: %d", m_workers.size());
+	}
+
+	GcnShaderCompileService::~GcnShaderCompileService()
+	{
+	}
+
+	GcnShaderFuture GcnShaderCompileService::compile(
+		GcnProgramType       type,
+		const void*          code,
+		const GcnShaderMeta& meta)
+	{
+		GcnModule module(type, reinterpret_cast<const uint8_t*>(code));
+
+		// Only meta the module depends on is part of the key,
+		// the rest is set as specialization constants.
+		GcnShaderVariantKey key;
+		key.shaderKey = module.key().key();
+		key.type      = type;
+		key.meta      = module.getVariantMeta(meta);
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_lastMeta[key.shaderKey] = key.meta;
+		return compileVariant(key, code);
+	}
+
+	void GcnShaderCompileService::prefetch(
+		GcnProgramType type,
+		const void*    code)
+	{
+		GcnHeader header(reinterpret_cast<const uint8_t*>(code));
+		uint64_t  shaderKey = header.key().key();
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		auto iter = m_lastMeta.find(shaderKey);
+		if (iter != m_lastMeta.end())
+		{
+			GcnShaderVariantKey key;
+			key.shaderKey = shaderKey;
+			key.type      = type;
+			key.meta      = iter->second;
+			compileVariant(key, code);
+		}
+		else
+		{
+			// Decoding doesn't depend on meta,
+			// so at least get that out of the way.
+			m_workers.submit([type, code]()
+							 {
+								 GcnModule module(type, reinterpret_cast<const uint8_t*>(code));
+								 module.decode();
+							 });
+		}
+	}
+
+	GcnShaderFuture GcnShaderCompileService::compileVariant(
+		const GcnShaderVariantKey& key,
+		const void*                code)
+	{
+		auto iter = m_shaders.find(key);
+		if (iter != m_shaders.end())
+		{
+			return iter->second;
+		}
+
+		GcnShaderMeta  meta = key.meta;
+		GcnProgramType type = key.type;
+
+		GcnShaderFuture future = m_workers.submit([type, code, meta]()
+												  {
+													  GcnModule module(type, reinterpret_cast<const uint8_t*>(code));
+													  return module.compile(meta);
+												  })
+									 .share();
+
+		m_shaders.emplace(key, future);
+		return future;
+	}
+
+}  // namespace sce::gcn
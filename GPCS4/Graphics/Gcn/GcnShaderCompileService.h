@@ -0,0 +1,109 @@
+#pragma once
+
+#include "GcnCommon.h"
+#include "GcnProgramInfo.h"
+#include "GcnShaderMeta.h"
+#include "UtilThreadPool.h"
+#include "Violet/VltHash.h"
+#include "Violet/VltRc.h"
+
+#include <future>
+#include <mutex>
+#include <unordered_map>
+
+namespace sce::vlt
+{
+	class VltShader;
+}  // namespace sce::vlt
+
+namespace sce::gcn
+{
+	/**
+	 * \brief Shader variant key
+	 *
+	 * Identifies a compiled shader by the
+	 * shader binary, its stage and the meta
+	 * information it was compiled with.
+	 */
+	struct GcnShaderVariantKey
+	{
+		uint64_t       shaderKey;
+		GcnProgramType type;
+		GcnShaderMeta  meta;
+
+		bool eq(const GcnShaderVariantKey& other) const;
+
+		size_t hash() const;
+	};
+
+	using GcnShaderFuture = std::shared_future<vlt::Rc<vlt::VltShader>>;
+
+	/**
+	 * \brief Shader compile service
+	 *
+	 * Translates GCN shaders to SPIR-V on a pool of
+	 * worker threads. Compiled shaders are kept per
+	 * variant, so requesting a shader which is already
+	 * compiled or in flight doesn't compile it again.
+	 */
+	class GcnShaderCompileService
+	{
+	public:
+		GcnShaderCompileService(
+			uint32_t threadCount = 0);
+		~GcnShaderCompileService();
+
+		/**
+		 * \brief Requests a compiled shader
+		 *
+		 * \param [in] type Program type
+		 * \param [in] code Shader code in guest memory
+		 * \param [in] meta Shader meta information
+		 * \returns Future holding the compiled shader
+		 */
+		GcnShaderFuture compile(
+			GcnProgramType       type,
+			const void*          code,
+			const GcnShaderMeta& meta);
+
+		/**
+		 * \brief Starts compiling a shader ahead of use
+		 *
+		 * Meant to be called as soon as a shader is set,
+		 * before the draw which uses it is recorded.
+		 * The final meta information is only known at draw
+		 * time, so the shader is compiled with the meta
+		 * it was last drawn with. Shaders which were never
+		 * drawn are only decoded.
+		 * \param [in] type Program type
+		 * \param [in] code Shader code in guest memory
+		 */
+		void prefetch(
+			GcnProgramType type,
+			const void*    code);
+
+	private:
+		GcnShaderFuture compileVariant(
+			const GcnShaderVariantKey& key,
+			const void*                code);
+
+	private:
+		std::mutex m_mutex;
+
+		std::unordered_map<
+			GcnShaderVariantKey,
+			GcnShaderFuture,
+			vlt::VltHash, vlt::VltEq>
+			m_shaders;
+
+		std::unordered_map<
+			uint64_t,
+			GcnShaderMeta>
+			m_lastMeta;
+
+		// Declared last, workers must be
+		// joined before the maps are destroyed.
+		util::ThreadPool m_workers;
+	};
+
+}  // namespace sce::gcn
@@ -0,0 +1,138 @@
+#include "GcnShaderDump.h"
+#include "GcnHeader.h"
+#include "PlatFile.h"
+#include "UtilString.h"
+
+#include <cstring>
+#include <filesystem>
+
+LOG_CHANNEL(Graphic.Gcn.GcnShaderDump);
+
+namespace sce::gcn
+{
+	namespace
+	{
+		/**
+		 * \brief Size of the whole shader binary
+		 *
+		 * The header follows the code, at the offset
+		 * encoded in the leading s_mov_b32 vcc_hi.
+		 */
+		uint32_t getBinarySize(const uint8_t* code)
+		{
+			const uint32_t* token = reinterpret_cast<const uint32_t*>(code);
+			return (token[1] + 1) * 2 * sizeof(uint32_t) + sizeof(ShaderBinaryInfo);
+		}
+
+		uint32_t hashMeta(const GcnShaderMeta& meta)
+		{
+			const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&meta);
+
+			uint32_t hash = 0x811c9dc5u;
+			for (size_t i = 0; i != sizeof(GcnShaderMeta); ++i)
+			{
+				hash = (hash ^ bytes[i]) * 0x01000193u;
+			}
+			return hash;
+		}
+	}  // namespace
+
+	bool gcnDumpShader(
+		const std::string&   directory,
+		GcnProgramType       type,
+		const uint8_t*       code,
+		const GcnHeader&     header,
+		const GcnShaderMeta& meta)
+	{
+		bool result = false;
+		do
+		{
+			std::error_code ec;
+			std::filesystem::create_directories(directory, ec);
+			if (ec)
+			{
+				LOG_ERR("failed to create dump directory %s", directory.c_str());
+				break;
+			}
+
+			std::string name = util::str::format("%s_%s_%08X",
+												 header.key().name().c_str(),
+												 gcnProgramTypeName(type),
+												 hashMeta(meta));
+			std::string path = directory + "/" + name;
+
+			GcnShaderDumpMeta info = {};
+			info.magic             = GcnShaderDumpMagic;
+			info.version           = GcnShaderDumpVersion;
+			info.type              = type;
+			info.meta              = meta;
+
+			if (!plat::StoreFile(path + ".bin", code, getBinarySize(code)) ||
+				!plat::StoreFile(path + ".meta", &info, sizeof(info)))
+			{
+				LOG_ERR("failed to dump shader %s", name.c_str());
+				break;
+			}
+
+			result = true;
+		} while (false);
+		return result;
+	}
+
+	bool gcnLoadShaderDump(
+		const std::string& metaPath,
+		GcnShaderDump&     dump)
+	{
+		bool result = false;
+		do
+		{
+			std::filesystem::path path(metaPath);
+
+			std::vector<uint8_t> metaData;
+			if (!plat::LoadFile(metaPath, metaData) ||
+				metaData.size() != sizeof(GcnShaderDumpMeta))
+			{
+				break;
+			}
+
+			std::memcpy(&dump.info, metaData.data(), sizeof(GcnShaderDumpMeta));
+			if (dump.info.magic != GcnShaderDumpMagic ||
+				dump.info.version != GcnShaderDumpVersion)
+			{
+				break;
+			}
+
+			auto binPath = path;
+			binPath.replace_extension(".bin");
+			if (!plat::LoadFile(binPath.string(), dump.code) ||
+				dump.code.size() < 2 * sizeof(uint32_t) ||
+				dump.code.size() < getBinarySize(dump.code.data()))
+			{
+				break;
+			}
+
+			dump.name = path.stem().string();
+			result    = true;
+		} while (false);
+		return result;
+	}
+
+	const char* gcnProgramTypeName(
+		GcnProgramType type)
+	{
+		const char* name = "unknown";
+		// clang-format off
+		switch (type)
+		{
+		case GcnProgramType::VertexShader:   name = "vs"; break;
+		case GcnProgramType::PixelShader:    name = "ps"; break;
+		case GcnProgramType::ComputeShader:  name = "cs"; break;
+		case GcnProgramType::GeometryShader: name = "gs"; break;
+		case GcnProgramType::HullShader:     name = "hs"; break;
+		case GcnProgramType::DomainShader:   name = "ds"; break;
+		}
+		// clang-format on
+		return name;
+	}
+
+}  // namespace sce::gcn
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "GcnCommon.h"
+#include "GcnProgramInfo.h"
+#include "GcnShaderMeta.h"
+
+#include <string>
+#include <vector>
+
+namespace sce::gcn
+{
+	class GcnHeader;
+
+	constexpr uint32_t GcnShaderDumpMagic   = 0x4D4E4347;  // 'GCNM'
+	constexpr uint32_t GcnShaderDumpVersion = 1;
+
+	/**
+	 * \brief Meta blob of a dumped shader
+	 *
+	 * Stored next to the shader binary, holds
+	 * everything besides the code which is needed
+	 * to compile the same shader variant again.
+	 */
+	struct GcnShaderDumpMeta
+	{
+		uint32_t       magic;
+		uint32_t       version;
+		GcnProgramType type;
+		GcnShaderMeta  meta;
+	};
+
+	/**
+	 * \brief Dumped shader
+	 */
+	struct GcnShaderDump
+	{
+		std::string          name;
+		std::vector<uint8_t> code;
+		GcnShaderDumpMeta    info;
+	};
+
+	/**
+	 * \brief Dumps a shader variant to a directory
+	 *
+	 * Writes the shader binary as found in guest memory,
+	 * including the header, to \c <name>.bin and the
+	 * meta information to \c <name>.meta. The name is
+	 * made of the shader key, the stage and a hash of
+	 * the meta information.
+	 * \param [in] directory Output directory
+	 * \param [in] type Program type
+	 * \param [in] code Shader code in guest memory
+	 * \param [in] header Parsed shader header
+	 * \param [in] meta Meta information
+	 * \returns \c true on success
+	 */
+	bool gcnDumpShader(
+		const std::string&   directory,
+		GcnProgramType       type,
+		const uint8_t*       code,
+		const GcnHeader&     header,
+		const GcnShaderMeta& meta);
+
+	/**
+	 * \brief Loads a shader dumped by \ref gcnDumpShader
+	 *
+	 * \param [in] metaPath Path of the \c .meta file,
+	 *        the binary is expected next to it
+	 * \param [out] dump The loaded shader
+	 * \returns \c true on success
+	 */
+	bool gcnLoadShaderDump(
+		const std::string& metaPath,
+		GcnShaderDump&     dump);
+
+	/**
+	 * \brief Short name of a program type
+	 */
+	const char* gcnProgramTypeName(
+		GcnProgramType type);
+
+}  // namespace sce::gcn
@@ -64,6 +64,23 @@ namespace sce::gcn
 		GcnXfbInfo*  xfb;
 	};
 
+	/**
+	 * \brief Specialization constants
+	 *
+	 * Meta information which doesn't change the shader
+	 * interface is not compiled into the shader but set
+	 * as specialization constants at pipeline creation,
+	 * so one compiled shader serves all values.
+	 * The value is the index into the pipeline's spec
+	 * constant array, see \c vlt::getSpecId.
+	 */
+	enum class GcnSpecConstant : uint32_t
+	{
+		ComputeNumThreadX = 0,
+		ComputeNumThreadY = 1,
+		ComputeNumThreadZ = 2,
+	};
+
 	struct GcnTextureInfo
 	{
 		Gnm::TextureType        textureType;
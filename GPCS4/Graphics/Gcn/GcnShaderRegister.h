@@ -20,6 +20,11 @@ namespace sce::gcn
 		{
 			return (void*)(uintptr_t(computePgmHi) << 40 | uintptr_t(computePgmLo) << 8);
 		}
+
+		uint32_t getUserSgprCount() const
+		{
+			return reinterpret_cast<const COMPUTE_PGM_RSRC2*>(&computePgmRsrc2)->user_sgpr;
+		}
 	};
 
 	struct VsStageRegisters
@@ -36,6 +41,11 @@ namespace sce::gcn
 		{
 			return (void*)(uintptr_t(spiShaderPgmHiVs) << 40 | uintptr_t(spiShaderPgmLoVs) << 8);
 		}
+
+		uint32_t getUserSgprCount() const
+		{
+			return reinterpret_cast<const SPI_SHADER_PGM_RSRC2_VS*>(&spiShaderPgmRsrc2Vs)->user_sgpr;
+		}
 	};
 
 	struct PsStageRegisters
@@ -57,6 +67,11 @@ namespace sce::gcn
 		{
 			return (void*)(uintptr_t(spiShaderPgmHiPs) << 40 | uintptr_t(spiShaderPgmLoPs) << 8);
 		}
+
+		uint32_t getUserSgprCount() const
+		{
+			return reinterpret_cast<const SPI_SHADER_PGM_RSRC2_PS*>(&spiShaderPgmRsrc2Ps)->user_sgpr;
+		}
 	};
 
 }  // namespace sce::gcn
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "GcnCommon.h"
+#include "GcnConstants.h"
 #include "GcnProgramInfo.h"
 
 #include "Gnm/GnmConstant.h"
@@ -80,4 +81,22 @@ namespace sce::gcn
 	{
 		return computeStageBindingOffset(stage) + GcnSamplerBindingIndex + index;
 	}
+
+	/**
+     * \brief Computes user data push constant offset
+	 * 
+	 * User data registers are passed as push constants.
+	 * Graphics stages share one push constant range, so
+	 * the pixel shader gets the block after the vertex
+	 * shader's. Compute pipelines start at zero.
+     * 
+     * \param [in] stage Shader stage
+     * \returns Offset in bytes
+     */
+	inline uint32_t computeUserDataOffset(GcnProgramType stage)
+	{
+		return stage == GcnProgramType::PixelShader
+				   ? kMaxUserDataCount * sizeof(uint32_t)
+				   : 0;
+	}
 }  // namespace sce::gcn
\ No newline at end of file
@@ -42,7 +42,7 @@ namespace sce::Gnm
          * \brief Begins command buffer recording
          * 
          */
-		void beginRecording();
+		virtual void beginRecording();
 
 		/**
          * \brief Ends command buffer recording
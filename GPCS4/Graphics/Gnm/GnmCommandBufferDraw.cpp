@@ -7,6 +7,7 @@
 #include "GnmTexture.h"
 #include "GpuAddress/GnmGpuAddress.h"
 
+#include "Gcn/GcnShaderCompileService.h"
 #include "Gcn/GcnUtil.h"
 #include "Platform/PlatFile.h"
 #include "Sce/SceResourceTracker.h"
@@ -35,14 +36,36 @@ namespace sce::Gnm
 	}
 
 	GnmCommandBufferDraw::GnmCommandBufferDraw(vlt::VltDevice* device) :
-		GnmCommandBuffer(device)
+		GnmCommandBuffer(device),
+		m_rebinder(device)
 	{
+		// Violet state is not known yet. Input assembly and
+		// viewport are only sent once set by the game.
+		m_flags.set(
+			GnmContextFlag::GpDirtyRasterizer,
+			GnmContextFlag::GpDirtyDepthStencil,
+			GnmContextFlag::GpDirtyColorBlend);
 	}
 
 	GnmCommandBufferDraw::~GnmCommandBufferDraw()
 	{
 	}
 
+	void GnmCommandBufferDraw::beginRecording()
+	{
+		GnmCommandBuffer::beginRecording();
+
+		m_rebinder.reset();
+		m_recordStart = std::chrono::steady_clock::now();
+
+		// Memory referenced by the user data may have been
+		// rewritten since the last submission.
+		m_flags.set(
+			GnmContextFlag::GpDirtyVsShader,
+			GnmContextFlag::GpDirtyPsShader,
+			GnmContextFlag::CpDirtyCsShader);
+	}
+
 	void GnmCommandBufferDraw::initializeDefaultHardwareState()
 	{
 	}
@@ -54,22 +77,7 @@ namespace sce::Gnm
 
 	void GnmCommandBufferDraw::setPrimitiveSetup(PrimitiveSetup reg)
 	{
-		VkFrontFace     frontFace = reg.getFrontFace() == kPrimitiveSetupFrontFaceCcw ? 
-			VK_FRONT_FACE_COUNTER_CLOCKWISE : VK_FRONT_FACE_CLOCKWISE;
-		VkPolygonMode   polyMode  = cvt::convertPolygonMode(reg.getPolygonModeFront());
-		VkCullModeFlags cullMode  = cvt::convertCullMode(reg.getCullFace());
-
-		VltRasterizerState rs = {
-			polyMode,
-			cullMode,
-			frontFace,
-			VK_FALSE,
-			VK_FALSE,
-			VK_SAMPLE_COUNT_1_BIT,
-			VK_CONSERVATIVE_RASTERIZATION_MODE_DISABLED_EXT
-		};
-
-		m_context->setRasterizerState(rs);
+		updateState(m_state.rs.primitiveSetup, reg, GnmContextFlag::GpDirtyRasterizer);
 	}
 
 	void GnmCommandBufferDraw::setScreenScissor(int32_t left, int32_t top, int32_t right, int32_t bottom)
@@ -79,7 +87,7 @@ namespace sce::Gnm
 		scissor.offset.y      = top;
 		scissor.extent.width  = right - left;
 		scissor.extent.height = bottom - top;
-		m_context->setScissors(1, &scissor);
+		updateState(m_state.vp.scissor, scissor, GnmContextFlag::GpDirtyViewport);
 	}
 
 	void GnmCommandBufferDraw::setViewport(uint32_t viewportId, float dmin, float dmax, const float scale[3], const float offset[3])
@@ -107,7 +115,7 @@ namespace sce::Gnm
 		viewport.minDepth = dmin;
 		viewport.maxDepth = dmax;
 
-		m_context->setViewports(1, &viewport);
+		updateState(m_state.vp.viewport, viewport, GnmContextFlag::GpDirtyViewport);
 	}
 
 	void GnmCommandBufferDraw::setHardwareScreenOffset(uint32_t offsetX, uint32_t offsetY)
@@ -125,6 +133,7 @@ namespace sce::Gnm
 		// TODO:
 		// Parse the input table
 		m_state.shaderContext[kShaderStagePs].meta.ps.inputSemanticCount = numItems;
+		m_flags.set(GnmContextFlag::GpDirtyPsShader);
 	}
 
 	void GnmCommandBufferDraw::setActiveShaderStages(ActiveShaderStages activeStages)
@@ -136,6 +145,12 @@ namespace sce::Gnm
 	{
 		auto& ctx = m_state.shaderContext[kShaderStagePs];
 		ctx.code  = psRegs->getCodeAddress();
+
+		ctx.meta.ps.userSgprCount = psRegs->getUserSgprCount();
+		m_flags.set(GnmContextFlag::GpDirtyPsShader);
+
+		GPU().shaderCompileService().prefetch(
+			GcnProgramType::PixelShader, ctx.code);
 	}
 
 	void GnmCommandBufferDraw::updatePsShader(const gcn::PsStageRegisters* psRegs)
@@ -146,6 +161,12 @@ namespace sce::Gnm
 	{
 		auto& ctx = m_state.shaderContext[kShaderStageVs];
 		ctx.code  = vsRegs->getCodeAddress();
+
+		ctx.meta.vs.userSgprCount = vsRegs->getUserSgprCount();
+		m_flags.set(GnmContextFlag::GpDirtyVsShader);
+
+		GPU().shaderCompileService().prefetch(
+			GcnProgramType::VertexShader, ctx.code);
 	}
 
 	void GnmCommandBufferDraw::setEmbeddedVsShader(EmbeddedVsShader shaderId, uint32_t shaderModifier)
@@ -218,6 +239,7 @@ namespace sce::Gnm
 		};
 
 		m_state.shaderContext[kShaderStageVs].code = reinterpret_cast<const void*>(embeddedVsShaderFullScreen);
+		m_flags.set(GnmContextFlag::GpDirtyVsShader);
 	}
 
 	void GnmCommandBufferDraw::updateVsShader(const gcn::VsStageRegisters* vsRegs, uint32_t shaderModifier)
@@ -357,7 +379,107 @@ namespace sce::Gnm
 
 	void GnmCommandBufferDraw::setRenderTargetMask(uint32_t mask)
 	{
-		auto writeMasks = cvt::convertRenderTargetMask(mask);
+		updateState(m_state.cb.renderTargetMask, mask, GnmContextFlag::GpDirtyColorBlend);
+	}
+
+	void GnmCommandBufferDraw::setBlendControl(uint32_t rtSlot, BlendControl blendControl)
+	{
+		updateState(m_state.cb.blendControl[rtSlot], blendControl, GnmContextFlag::GpDirtyColorBlend);
+	}
+
+	void GnmCommandBufferDraw::setDepthStencilControl(DepthStencilControl depthControl)
+	{
+		LOG_ASSERT(depthControl.stencilEnable == false, "stencil test not supported yet.");
+
+		updateState(m_state.ds.depthControl, depthControl, GnmContextFlag::GpDirtyDepthStencil);
+	}
+
+	void GnmCommandBufferDraw::setDbRenderControl(DbRenderControl reg)
+	{
+		updateState(m_state.ds.renderControl, reg, GnmContextFlag::GpDirtyDepthStencil);
+	}
+
+	void GnmCommandBufferDraw::updateRenderState()
+	{
+		if (m_flags.test(GnmContextFlag::GpDirtyInputAssembly) &&
+			m_state.ia.topology != VK_PRIMITIVE_TOPOLOGY_MAX_ENUM)
+		{
+			VltInputAssemblyState ia = {
+				m_state.ia.topology,
+				VK_FALSE,
+				0
+			};
+			m_context->setInputAssemblyState(ia);
+		}
+
+		if (m_flags.test(GnmContextFlag::GpDirtyRasterizer))
+		{
+			updateRasterizerState();
+		}
+
+		if (m_flags.test(GnmContextFlag::GpDirtyViewport))
+		{
+			if (m_state.vp.viewport.width != 0.0f)
+			{
+				m_context->setViewports(1, &m_state.vp.viewport);
+			}
+
+			if (m_state.vp.scissor.extent.width != 0)
+			{
+				m_context->setScissors(1, &m_state.vp.scissor);
+			}
+		}
+
+		if (m_flags.test(GnmContextFlag::GpDirtyDepthStencil))
+		{
+			updateDepthStencilState();
+		}
+
+		if (m_flags.test(GnmContextFlag::GpDirtyColorBlend))
+		{
+			updateColorBlendState();
+		}
+
+		m_flags.clr(
+			GnmContextFlag::GpDirtyInputAssembly,
+			GnmContextFlag::GpDirtyRasterizer,
+			GnmContextFlag::GpDirtyViewport,
+			GnmContextFlag::GpDirtyDepthStencil,
+			GnmContextFlag::GpDirtyColorBlend);
+	}
+
+	void GnmCommandBufferDraw::updateRasterizerState()
+	{
+		auto& reg = m_state.rs.primitiveSetup;
+
+		VkFrontFace     frontFace = reg.getFrontFace() == kPrimitiveSetupFrontFaceCcw ? 
+			VK_FRONT_FACE_COUNTER_CLOCKWISE : VK_FRONT_FACE_CLOCKWISE;
+		VkPolygonMode   polyMode  = cvt::convertPolygonMode(reg.getPolygonModeFront());
+		VkCullModeFlags cullMode  = cvt::convertCullMode(reg.getCullFace());
+
+		VltRasterizerState rs = {
+			polyMode,
+			cullMode,
+			frontFace,
+			VK_FALSE,
+			VK_FALSE,
+			VK_SAMPLE_COUNT_1_BIT,
+			VK_CONSERVATIVE_RASTERIZATION_MODE_DISABLED_EXT
+		};
+
+		m_context->setRasterizerState(rs);
+	}
+
+	void GnmCommandBufferDraw::updateColorBlendState()
+	{
+		for (uint32_t rtSlot = 0; rtSlot != m_state.cb.blendControl.size(); ++rtSlot)
+		{
+			updateBlendMode(rtSlot, m_state.cb.blendControl[rtSlot]);
+		}
+
+		// Blend modes come with a full write mask,
+		// so the mask is applied after them.
+		auto writeMasks = cvt::convertRenderTargetMask(m_state.cb.renderTargetMask);
 		for (uint32_t attachment = 0; attachment != writeMasks.size(); ++attachment)
 		{
 			m_context->setBlendMask(
@@ -365,7 +487,7 @@ namespace sce::Gnm
 		}
 	}
 
-	void GnmCommandBufferDraw::setBlendControl(uint32_t rtSlot, BlendControl blendControl)
+	void GnmCommandBufferDraw::updateBlendMode(uint32_t rtSlot, BlendControl blendControl)
 	{
 		VkBlendFactor colorSrcFactor = cvt::convertBlendMultiplier(blendControl.getColorEquationSourceMultiplier());
 		VkBlendFactor colorDstFactor = cvt::convertBlendMultiplier(blendControl.getColorEquationDestinationMultiplier());
@@ -398,9 +520,10 @@ namespace sce::Gnm
 		m_context->setBlendMode(rtSlot, blend);
 	}
 
-	void GnmCommandBufferDraw::setDepthStencilControl(DepthStencilControl depthControl)
+	void GnmCommandBufferDraw::updateDepthStencilState()
 	{
-		LOG_ASSERT(depthControl.stencilEnable == false, "stencil test not supported yet.");
+		auto& depthControl = m_state.ds.depthControl;
+		auto& reg          = m_state.ds.renderControl;
 
 		VkCompareOp depthCmpOp = cvt::convertCompareFunc(depthControl.getDepthControlZCompareFunction());
 		VkCompareOp stencilFront = cvt::convertCompareFunc(depthControl.getStencilFunction());
@@ -420,12 +543,8 @@ namespace sce::Gnm
 			backOp
 		};
 
-		m_context->setDepthBoundsTestEnable(depthControl.depthBoundsEnable);
 		m_context->setDepthStencilState(ds);
-	}
 
-	void GnmCommandBufferDraw::setDbRenderControl(DbRenderControl reg)
-	{
 		if (reg.getDepthClearEnable() && !reg.getHtileResummarizeEnable())
 		{
 			// In Gnm, when depth clear enable and HTILE compress disable
@@ -449,7 +568,7 @@ namespace sce::Gnm
 		}
 		else
 		{
-			m_context->setDepthBoundsTestEnable(VK_FALSE);
+			m_context->setDepthBoundsTestEnable(depthControl.depthBoundsEnable);
 		}
 	}
 
@@ -471,14 +590,7 @@ namespace sce::Gnm
 		}
 
 		LOG_ASSERT(topology != VK_PRIMITIVE_TOPOLOGY_MAX_ENUM, "primType not supported.");
-		m_state.ia.topology = topology;
-
-		VltInputAssemblyState ia = {
-			topology,
-			VK_FALSE,
-			0
-		};
-		m_context->setInputAssemblyState(ia);
+		updateState(m_state.ia.topology, topology, GnmContextFlag::GpDirtyInputAssembly);
 	}
 
 	void GnmCommandBufferDraw::setIndexSize(IndexSize indexSize, CachePolicy cachePolicy)
@@ -495,6 +607,7 @@ namespace sce::Gnm
 		commitGraphicsState();
 
 		m_context->drawIndexed(indexCount, 1, 0, 0, 0);
+		++m_counters.drawCalls;
 	}
 
 	void GnmCommandBufferDraw::drawIndexAuto(uint32_t indexCount)
@@ -517,6 +630,7 @@ namespace sce::Gnm
 		commitComputeState();
 
 		m_context->dispatch(threadGroupX, threadGroupY, threadGroupZ);
+		++m_counters.dispatchCalls;
 	}
 
 	void GnmCommandBufferDraw::dispatchWithOrderedAppend(uint32_t threadGroupX, uint32_t threadGroupY, uint32_t threadGroupZ, DispatchOrderedAppendMode orderedAppendMode)
@@ -623,6 +737,11 @@ namespace sce::Gnm
 		ctx.meta.cs.computeNumThreadX = computeData->computeNumThreadX;
 		ctx.meta.cs.computeNumThreadY = computeData->computeNumThreadY;
 		ctx.meta.cs.computeNumThreadZ = computeData->computeNumThreadZ;
+		ctx.meta.cs.userSgprCount     = computeData->getUserSgprCount();
+		m_flags.set(GnmContextFlag::CpDirtyCsShader);
+
+		GPU().shaderCompileService().prefetch(
+			GcnProgramType::ComputeShader, ctx.code);
 	}
 
 	void GnmCommandBufferDraw::writeReleaseMemEventWithInterrupt(ReleaseMemEventType eventType, EventWriteDest dstSelector, void* dstGpuAddr, EventWriteSource srcSelector, uint64_t immValue, CacheAction cacheAction, CachePolicy writePolicy)
@@ -846,6 +965,28 @@ namespace sce::Gnm
 		// Update vertex input
 		auto& ctx = m_state.shaderContext[kShaderStageVs];
 
+		auto bind = getStageBind(kShaderStageVs, GnmContextFlag::GpDirtyVsShader);
+		if (bind == GnmStageBind::Skip)
+		{
+			return;
+		}
+
+		if (bind == GnmStageBind::UserData)
+		{
+			pushUserData(kShaderStageVs,
+						 VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+						 ctx.meta.vs.userSgprCount);
+			return;
+		}
+
+		if (bind == GnmStageBind::Constants)
+		{
+			bindStageConstants(kShaderStageVs,
+							   VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+							   ctx.meta.vs.userSgprCount);
+			return;
+		}
+
 		GcnModule vsModule(
 			GcnProgramType::VertexShader,
 			reinterpret_cast<const uint8_t*>(ctx.code));
@@ -858,16 +999,47 @@ namespace sce::Gnm
 		// create and bind shader resources
 		bindResource(VK_PIPELINE_STAGE_VERTEX_SHADER_BIT, resTable, ctx.userData);
 
+		// user data sgprs are read from push constants
+		pushUserData(kShaderStageVs,
+					 VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+					 ctx.meta.vs.userSgprCount);
+
 		// bind the shader
+		auto shader = GPU().shaderCompileService().compile(
+			GcnProgramType::VertexShader, ctx.code, ctx.meta);
 		m_context->bindShader(
 			VK_SHADER_STAGE_VERTEX_BIT,
-			vsModule.compile(ctx.meta));
+			shader.get());
+
+		m_rebinder.beginRun(kShaderStageVs, resTable);
 	}
 
 	void GnmCommandBufferDraw::updatePixelShaderStage()
 	{
 		auto& ctx = m_state.shaderContext[kShaderStagePs];
 
+		auto bind = getStageBind(kShaderStagePs, GnmContextFlag::GpDirtyPsShader);
+		if (bind == GnmStageBind::Skip)
+		{
+			return;
+		}
+
+		if (bind == GnmStageBind::UserData)
+		{
+			pushUserData(kShaderStagePs,
+						 VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+						 ctx.meta.ps.userSgprCount);
+			return;
+		}
+
+		if (bind == GnmStageBind::Constants)
+		{
+			bindStageConstants(kShaderStagePs,
+							   VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+							   ctx.meta.ps.userSgprCount);
+			return;
+		}
+
 		GcnModule psModule(
 			GcnProgramType::PixelShader,
 			reinterpret_cast<const uint8_t*>(ctx.code));
@@ -877,14 +1049,121 @@ namespace sce::Gnm
 		// create and bind shader resources
 		bindResource(VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, resTable, ctx.userData);
 
+		pushUserData(kShaderStagePs,
+					 VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+					 ctx.meta.ps.userSgprCount);
+
 		// bind the shader
+		auto shader = GPU().shaderCompileService().compile(
+			GcnProgramType::PixelShader, ctx.code, ctx.meta);
 		m_context->bindShader(
 			VK_SHADER_STAGE_COMPUTE_BIT,
-			psModule.compile(ctx.meta));
+			shader.get());
+
+		m_rebinder.beginRun(kShaderStagePs, resTable);
+	}
+
+	GnmStageBind GnmCommandBufferDraw::getStageBind(
+		ShaderStage    stage,
+		GnmContextFlag flag)
+	{
+		auto& ctx = m_state.shaderContext[stage];
+
+		// Memory referenced by the user data can't change
+		// within a command buffer, so the same shader with
+		// the same user data binds the same resources.
+		bool dirty = m_flags.test(flag) ||
+					 ctx.code != ctx.boundCode ||
+					 ctx.userData != ctx.boundUserData;
+
+		GnmContextFlag userDataFlag = GnmContextFlag::CpDirtyCsUserData;
+		if (stage == kShaderStageVs)
+		{
+			userDataFlag = GnmContextFlag::GpDirtyVsUserData;
+		}
+		else if (stage == kShaderStagePs)
+		{
+			userDataFlag = GnmContextFlag::GpDirtyPsUserData;
+		}
+
+		GnmStageBind bind = m_flags.test(userDataFlag)
+								? GnmStageBind::UserData
+								: GnmStageBind::Skip;
+		if (dirty)
+		{
+			bind = GnmStageBind::Full;
+#ifdef GNM_CONSTANT_REBINDING
+			if (!m_flags.test(flag) && m_rebinder.continueRun(stage, ctx))
+			{
+				bind = GnmStageBind::Constants;
+			}
+#endif
+			ctx.boundCode     = ctx.code;
+			ctx.boundUserData = ctx.userData;
+			m_flags.clr(flag);
+		}
+
+		++m_counters.stageBinds;
+		if (bind == GnmStageBind::Skip || bind == GnmStageBind::UserData)
+		{
+			++m_counters.skippedBinds;
+		}
+		else if (bind == GnmStageBind::Constants)
+		{
+			++m_counters.constantBinds;
+		}
+		return bind;
+	}
+
+	void GnmCommandBufferDraw::bindStageConstants(
+		ShaderStage          stage,
+		VkPipelineStageFlags pipeStage,
+		uint32_t             userSgprCount)
+	{
+		auto& ctx = m_state.shaderContext[stage];
+
+		// Shader and resources are still bound,
+		// only constant buffers and user data differ.
+		for (const auto& res : m_rebinder.constantBuffers(stage))
+		{
+			const Buffer* vsharp = reinterpret_cast<const Buffer*>(&ctx.userData[res.startRegister]);
+			bindConstantBuffer(vsharp, res.startRegister, pipeStage);
+		}
+
+		pushUserData(stage, pipeStage, userSgprCount);
+	}
+
+	void GnmCommandBufferDraw::pushUserData(
+		ShaderStage          stage,
+		VkPipelineStageFlags pipeStage,
+		uint32_t             userSgprCount)
+	{
+		auto& ctx = m_state.shaderContext[stage];
+
+		m_context->pushConstants(
+			computeUserDataOffset(gcnProgramTypeFromVkStage(pipeStage)),
+			userSgprCount * sizeof(uint32_t),
+			ctx.userData.data());
+
+		if (stage == kShaderStageCs)
+		{
+			m_flags.clr(GnmContextFlag::CpDirtyCsUserData);
+			m_flags.set(GnmContextFlag::GpDirtyVsUserData,
+						GnmContextFlag::GpDirtyPsUserData);
+		}
+		else
+		{
+			m_flags.clr(stage == kShaderStageVs
+							? GnmContextFlag::GpDirtyVsUserData
+							: GnmContextFlag::GpDirtyPsUserData);
+			m_flags.set(GnmContextFlag::CpDirtyCsUserData);
+		}
 	}
 
 	void GnmCommandBufferDraw::commitGraphicsState()
 	{
+		updateRenderState();
+
 		updateVertexShaderStage();
 
 		updatePixelShaderStage();
@@ -894,6 +1173,28 @@ namespace sce::Gnm
 	{
 		auto& ctx = m_state.shaderContext[kShaderStageCs];
 
+		auto bind = getStageBind(kShaderStageCs, GnmContextFlag::CpDirtyCsShader);
+		if (bind == GnmStageBind::Skip)
+		{
+			return;
+		}
+
+		if (bind == GnmStageBind::UserData)
+		{
+			pushUserData(kShaderStageCs,
+						 VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+						 ctx.meta.cs.userSgprCount);
+			return;
+		}
+
+		if (bind == GnmStageBind::Constants)
+		{
+			bindStageConstants(kShaderStageCs,
+							   VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+							   ctx.meta.cs.userSgprCount);
+			return;
+		}
+
 		GcnModule csModule(
 			GcnProgramType::ComputeShader,
 			reinterpret_cast<const uint8_t*>(ctx.code));
@@ -903,58 +1204,90 @@ namespace sce::Gnm
 		// create and bind shader resources
 		bindResource(VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, resTable, ctx.userData);
 
+		pushUserData(kShaderStageCs,
+					 VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+					 ctx.meta.cs.userSgprCount);
+
+		// thread counts are specialization constants of the shader
+		m_context->setSpecConstant(VK_PIPELINE_BIND_POINT_COMPUTE,
+								   uint32_t(GcnSpecConstant::ComputeNumThreadX),
+								   ctx.meta.cs.computeNumThreadX);
+		m_context->setSpecConstant(VK_PIPELINE_BIND_POINT_COMPUTE,
+								   uint32_t(GcnSpecConstant::ComputeNumThreadY),
+								   ctx.meta.cs.computeNumThreadY);
+		m_context->setSpecConstant(VK_PIPELINE_BIND_POINT_COMPUTE,
+								   uint32_t(GcnSpecConstant::ComputeNumThreadZ),
+								   ctx.meta.cs.computeNumThreadZ);
+
 		// bind the shader
+		auto shader = GPU().shaderCompileService().compile(
+			GcnProgramType::ComputeShader, ctx.code, ctx.meta);
 		m_context->bindShader(
 			VK_SHADER_STAGE_COMPUTE_BIT,
-			csModule.compile(ctx.meta));
+			shader.get());
+
+		m_rebinder.beginRun(kShaderStageCs, resTable);
 	}
 
-	void GnmCommandBufferDraw::bindResourceBuffer(
+	void GnmCommandBufferDraw::bindConstantBuffer(
 		const Buffer*         vsharp,
 		uint32_t              startRegister,
-		VkBufferUsageFlags    usage,
-		VkPipelineStageFlags2 stage,
-		VkAccessFlagBits2     access)
+		VkPipelineStageFlags2 stage)
 	{
+		uint32_t slot = computeConstantBufferBinding(
+			gcnProgramTypeFromVkStage(stage), startRegister);
+
+#ifdef GNM_CONSTANT_REBINDING
+		m_context->bindResourceBuffer(slot, m_rebinder.packConstants(vsharp));
+#else
 		SceBuffer buffer;
 
 		GnmBufferCreateInfo info;
-		info.vsharp = vsharp;
-		info.usage  = usage;
-		info.stage  = stage;
-		info.access = access;
-
-		uint32_t slot = 0;
-		if (usage == VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT)
-		{
-			info.memoryType = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
-							  VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+		info.vsharp     = vsharp;
+		info.usage      = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
+		info.stage      = stage;
+		info.access     = VK_ACCESS_UNIFORM_READ_BIT;
+		info.memoryType = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+						  VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
 
-			m_factory.createBuffer(info, buffer);
+		m_factory.createBuffer(info, buffer);
 
-			void* bufferMem = buffer.buffer->mapPtr(0);
-			std::memcpy(bufferMem,
-						buffer.gnmBuffer.getBaseAddress(),
-						buffer.gnmBuffer.getSize());
+		void* bufferMem = buffer.buffer->mapPtr(0);
+		std::memcpy(bufferMem,
+					buffer.gnmBuffer.getBaseAddress(),
+					buffer.gnmBuffer.getSize());
 
-			slot = computeConstantBufferBinding(
-				gcnProgramTypeFromVkStage(stage), startRegister);
-		}
-		else
-		{
-			info.memoryType = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+		m_tracker->track(buffer);
 
-			m_factory.createBuffer(info, buffer);
+		m_context->bindResourceBuffer(slot, VltBufferSlice(buffer.buffer));
+#endif
+	}
 
-			m_context->uploadBuffer(buffer.buffer,
-									buffer.gnmBuffer.getBaseAddress());
+	void GnmCommandBufferDraw::bindResourceBuffer(
+		const Buffer*         vsharp,
+		uint32_t              startRegister,
+		VkBufferUsageFlags    usage,
+		VkPipelineStageFlags2 stage,
+		VkAccessFlagBits2     access)
+	{
+		SceBuffer buffer;
 
-			slot = computeResourceBinding(
-				gcnProgramTypeFromVkStage(stage), startRegister);
-		}
+		GnmBufferCreateInfo info;
+		info.vsharp     = vsharp;
+		info.usage      = usage;
+		info.stage      = stage;
+		info.access     = access;
+		info.memoryType = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
 
+		m_factory.createBuffer(info, buffer);
 		m_tracker->track(buffer);
 
+		m_context->uploadBuffer(buffer.buffer,
+								buffer.gnmBuffer.getBaseAddress());
+
+		uint32_t slot = computeResourceBinding(
+			gcnProgramTypeFromVkStage(stage), startRegister);
+
 		m_context->bindResourceBuffer(slot, VltBufferSlice(buffer.buffer));
 	}
 
@@ -998,12 +1331,7 @@ namespace sce::Gnm
 		subresourceLayers.baseArrayLayer = 0;
 		subresourceLayers.layerCount     = 1;
 
-		m_context->transformImage(
-			image,
-			image->getAvailableSubresources(),
-			VK_IMAGE_LAYOUT_UNDEFINED,
-			image->info().layout);
-
+		// The upload leaves the image in its default layout.
 		m_context->uploadImage(
 			image,
 			subresourceLayers,
@@ -1046,12 +1374,10 @@ namespace sce::Gnm
 			{
 				const Buffer* vsharp = reinterpret_cast<const Buffer*>(findUserData(res, eudIndex, userData));
 
-				bindResourceBuffer(
+				bindConstantBuffer(
 					vsharp,
 					res.startRegister,
-					VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-					stage,
-					VK_ACCESS_UNIFORM_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT);
+					stage);
 			}
 				break;
 			case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
@@ -1172,6 +1498,25 @@ namespace sce::Gnm
 		// This is the last cmd for a command buffer submission,
 		// we can do some finish works before submit and present.
 
+		// Submissions are recorded synchronously,
+		// so this is the CPU time of the whole frame.
+		auto recordTime = std::chrono::duration_cast<std::chrono::microseconds>(
+			std::chrono::steady_clock::now() - m_recordStart);
+
+		LOG_DEBUG("draws %d, dispatches %d, recorded in %lld us",
+				  m_counters.drawCalls, m_counters.dispatchCalls,
+				  static_cast<long long>(recordTime.count()));
+		LOG_DEBUG("state calls %d (%d redundant), stage binds %d (%d skipped, %d constants only)",
+				  m_counters.stateCalls, m_counters.redundantCalls,
+				  m_counters.stageBinds, m_counters.skippedBinds,
+				  m_counters.constantBinds);
+		m_counters = {};
+
+		const auto& stats = m_context->stats();
+		LOG_DEBUG("barriers %d, rendering scopes %d, skipped layout transitions %d",
+				  stats.barrierCount, stats.renderingCount, stats.skippedTransitions);
+		m_context->resetStats();
+
 		if (m_state.om.displayRenderTarget)
 		{
 			auto& image = m_state.om.displayRenderTarget->renderTarget().image;
@@ -2,10 +2,14 @@
 
 #include "GnmCommandBuffer.h"
 #include "GnmCommon.h"
+#include "GnmConstantRebinder.h"
 #include "GnmRenderState.h"
 
 #include "Gcn/GcnShaderBinary.h"
 
+#include <chrono>
+#include <cstring>
+
 namespace sce::gcn
 {
 	class GcnModule;
@@ -27,6 +31,8 @@ namespace sce::Gnm
 
 		virtual ~GnmCommandBufferDraw();
 
+		virtual void beginRecording() override;
+
 		virtual void initializeDefaultHardwareState() override;
 
 		virtual void setViewportTransformControl(ViewportTransformControl vportControl) override;
@@ -162,6 +168,11 @@ namespace sce::Gnm
 		inline void bindVertexBuffer(
 			const Buffer* vsharp, uint32_t binding);
 
+		void bindConstantBuffer(
+			const Buffer*         vsharp,
+			uint32_t              startRegister,
+			VkPipelineStageFlags2 stage);
+
 		void bindResourceBuffer(
 			const Buffer*         vsharp,
 			uint32_t              startRegister,
@@ -193,6 +204,64 @@ namespace sce::Gnm
 		void updateVertexShaderStage();
 		void updatePixelShaderStage();
 
+		/**
+		 * \brief Records a render state block
+		 *
+		 * Dirties the block only if the value changes,
+		 * otherwise the call is counted as redundant.
+		 */
+		template <typename T>
+		void updateState(T& state, const T& value, GnmContextFlag flag)
+		{
+			++m_counters.stateCalls;
+			if (std::memcmp(&state, &value, sizeof(T)) == 0)
+			{
+				++m_counters.redundantCalls;
+				return;
+			}
+
+			state = value;
+			m_flags.set(flag);
+		}
+
+		void updateRenderState();
+		void updateRasterizerState();
+		void updateDepthStencilState();
+		void updateColorBlendState();
+		void updateBlendMode(uint32_t rtSlot, BlendControl blendControl);
+
+		/**
+		 * \brief Checks how a stage needs to be bound
+		 *
+		 * A stage is dirty if its shader, meta or user data
+		 * changed since it was last bound. Records the current
+		 * state as bound if so. A dirty stage which continues
+		 * a run of the constant rebinder only needs its constants.
+		 * A clean stage still needs its user data pushed if
+		 * the other bind point overwrote the push constants.
+		 * \returns How the stage needs to be bound
+		 */
+		GnmStageBind getStageBind(
+			ShaderStage    stage,
+			GnmContextFlag flag);
+
+		void bindStageConstants(
+			ShaderStage          stage,
+			VkPipelineStageFlags pipeStage,
+			uint32_t             userSgprCount);
+
+		/**
+		 * \brief Pushes the user data of a stage
+		 *
+		 * Graphics and compute share one push constant
+		 * block, so the stages of the other bind point
+		 * are marked to push theirs again.
+		 */
+		void pushUserData(
+			ShaderStage          stage,
+			VkPipelineStageFlags pipeStage,
+			uint32_t             userSgprCount);
+
 		void commitGraphicsState();
 		void commitComputeState();
 
@@ -210,6 +279,10 @@ namespace sce::Gnm
 	private:
 		GnmGraphicsState m_state;
 		GnmContextFlags  m_flags; 
+		GnmStateCounters    m_counters;
+		GnmConstantRebinder m_rebinder;
+
+		std::chrono::steady_clock::time_point m_recordStart;
 	};
 
 }  // namespace sce::Gnm
@@ -2,4 +2,9 @@
 
 #include "GPCS4Common.h"
 
-#include <vulkan/vulkan.h>
\ No newline at end of file
+#include <vulkan/vulkan.h>
+
+// Bind runs of draws which only differ in constant
+// buffers with their constants only, see GnmConstantRebinder.
+// Each draw is still recorded on its own.
+#define GNM_CONSTANT_REBINDING
@@ -0,0 +1,142 @@
+#include "GnmConstantRebinder.h"
+
+#include "GnmBuffer.h"
+
+#include "Violet/VltDevice.h"
+
+#include <algorithm>
+#include <cstring>
+
+LOG_CHANNEL(Graphic.Gnm.GnmConstantRebinder);
+
+using namespace sce::vlt;
+using namespace sce::gcn;
+
+namespace sce::Gnm
+{
+
+	GnmConstantRebinder::GnmConstantRebinder(vlt::VltDevice* device) :
+		m_device(device)
+	{
+		const auto& limits = m_device->properties().core.properties.limits;
+		m_alignment        = std::max(VkDeviceSize(limits.minUniformBufferOffsetAlignment),
+									  VkDeviceSize(limits.nonCoherentAtomSize));
+	}
+
+	GnmConstantRebinder::~GnmConstantRebinder()
+	{
+	}
+
+	void GnmConstantRebinder::reset()
+	{
+		m_runs       = {};
+		m_chunkIndex = 0;
+		m_offset     = 0;
+		m_largeBuffers.clear();
+	}
+
+	void GnmConstantRebinder::beginRun(
+		ShaderStage                   stage,
+		const GcnShaderResourceTable& table)
+	{
+		auto& run = m_runs[stage];
+		run.mask.reset();
+		run.constants.clear();
+
+		for (const auto& res : table)
+		{
+			// Constant buffers in the extended user data
+			// can only change along with the EUD pointer,
+			// which ends the run.
+			if (res.type != VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER || res.inEud)
+			{
+				continue;
+			}
+
+			for (uint32_t i = 0; i != res.sizeInDwords; ++i)
+			{
+				run.mask.set(res.startRegister + i);
+			}
+			run.constants.push_back(res);
+		}
+	}
+
+	bool GnmConstantRebinder::continueRun(
+		ShaderStage             stage,
+		const GnmShaderContext& ctx) const
+	{
+		const auto& run = m_runs[stage];
+
+		bool result = false;
+		do
+		{
+			if (run.constants.empty() ||
+				ctx.code != ctx.boundCode)
+			{
+				break;
+			}
+
+			bool sameResources = true;
+			for (uint32_t i = 0; i != ctx.userData.size(); ++i)
+			{
+				if (ctx.userData[i] != ctx.boundUserData[i] && !run.mask.test(i))
+				{
+					sameResources = false;
+					break;
+				}
+			}
+
+			result = sameResources;
+		} while (false);
+		return result;
+	}
+
+	vlt::VltBufferSlice GnmConstantRebinder::packConstants(
+		const Buffer* vsharp)
+	{
+		VkDeviceSize size = vsharp->getSize();
+
+		if (size > ChunkSize)
+		{
+			auto buffer = createChunk(size);
+			std::memcpy(buffer->mapPtr(0), vsharp->getBaseAddress(), size);
+
+			m_largeBuffers.push_back(buffer);
+			return VltBufferSlice(buffer, 0, size);
+		}
+
+		if (m_offset + size > ChunkSize)
+		{
+			++m_chunkIndex;
+			m_offset = 0;
+		}
+
+		if (m_chunkIndex == m_chunks.size())
+		{
+			m_chunks.push_back(createChunk(ChunkSize));
+		}
+
+		const auto&  chunk  = m_chunks[m_chunkIndex];
+		VkDeviceSize offset = m_offset;
+		std::memcpy(chunk->mapPtr(offset), vsharp->getBaseAddress(), size);
+
+		m_offset = util::align(offset + size, m_alignment);
+		return VltBufferSlice(chunk, offset, size);
+	}
+
+	Rc<VltBuffer> GnmConstantRebinder::createChunk(VkDeviceSize size)
+	{
+		VltBufferCreateInfo info = {};
+		info.size                = size;
+		info.usage               = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
+		info.stages              = VK_PIPELINE_STAGE_VERTEX_SHADER_BIT |
+								   VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT |
+								   VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+		info.access              = VK_ACCESS_UNIFORM_READ_BIT;
+
+		return m_device->createBuffer(info,
+									  VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+									  VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+	}
+
+}  // namespace sce::Gnm
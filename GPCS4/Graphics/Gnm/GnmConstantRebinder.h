@@ -0,0 +1,141 @@
+#pragma once
+
+#include "GnmCommon.h"
+#include "GnmConstant.h"
+#include "GnmRenderState.h"
+
+#include "Gcn/GcnHeader.h"
+#include "Violet/VltBuffer.h"
+
+#include <array>
+#include <bitset>
+#include <vector>
+
+namespace sce::vlt
+{
+	class VltDevice;
+}  // namespace sce::vlt
+
+namespace sce::Gnm
+{
+	class Buffer;
+
+	/**
+	 * \brief How a shader stage needs to be bound
+	 */
+	enum class GnmStageBind : uint32_t
+	{
+		Skip,       ///< Nothing changed since the last bind
+		UserData,   ///< Only the push constants need to be pushed again
+		Constants,  ///< Only constant buffers changed
+		Full,       ///< Shader or resources changed
+	};
+
+	/**
+	 * \brief Constant rebinder
+	 *
+	 * Games often issue long runs of draws with the same
+	 * shaders and resources which only differ in their
+	 * constant buffers. The rebinder detects such runs per
+	 * shader stage, so only the constant buffers and user
+	 * data have to be bound again. Every draw of a run is
+	 * still recorded as a draw of its own, draws are not
+	 * merged.
+	 *
+	 * Constants of all draws are packed into a few large
+	 * uniform buffers. Violet binds uniform buffers as
+	 * dynamic descriptors, so a draw in a run only moves
+	 * the dynamic offsets instead of creating a buffer
+	 * and writing a new descriptor set.
+	 */
+	class GnmConstantRebinder
+	{
+		constexpr static VkDeviceSize ChunkSize = 1 << 20;  // 1 MiB
+
+		using UserDataMask = std::bitset<gcn::kMaxUserDataCount>;
+
+	public:
+		GnmConstantRebinder(vlt::VltDevice* device);
+
+		~GnmConstantRebinder();
+
+		/**
+		 * \brief Starts a new command buffer
+		 *
+		 * Ends all runs and recycles the constant memory.
+		 * Submissions are synchronous, so memory packed
+		 * for the previous command buffer is no longer
+		 * read by the GPU.
+		 */
+		void reset();
+
+		/**
+		 * \brief Starts a run on a stage
+		 *
+		 * Called when a stage is fully bound. Records the
+		 * constant buffers of the shader which may change
+		 * without ending the run.
+		 * \param [in] stage Shader stage
+		 * \param [in] table Resource table of the shader
+		 */
+		void beginRun(
+			ShaderStage                        stage,
+			const gcn::GcnShaderResourceTable& table);
+
+		/**
+		 * \brief Checks whether a stage continues its run
+		 *
+		 * The run continues if the shader is the one the run
+		 * was started with and the user data only differs in
+		 * the constant buffer registers.
+		 * \param [in] stage Shader stage
+		 * \param [in] ctx Shader context to be bound
+		 * \returns \c true if only constants need to be bound
+		 */
+		bool continueRun(
+			ShaderStage             stage,
+			const GnmShaderContext& ctx) const;
+
+		/**
+		 * \brief Constant buffers of the current run
+		 */
+		const gcn::GcnShaderResourceTable& constantBuffers(
+			ShaderStage stage) const
+		{
+			return m_runs[stage].constants;
+		}
+
+		/**
+		 * \brief Packs a constant buffer
+		 *
+		 * Copies the buffer's content to the constant
+		 * memory of the command buffer.
+		 * \param [in] vsharp The constant buffer
+		 * \returns Slice holding the constants
+		 */
+		vlt::VltBufferSlice packConstants(
+			const Buffer* vsharp);
+
+	private:
+		struct GnmDrawRun
+		{
+			UserDataMask                mask;
+			gcn::GcnShaderResourceTable constants;
+		};
+
+		vlt::Rc<vlt::VltBuffer> createChunk(
+			VkDeviceSize size);
+
+	private:
+		vlt::VltDevice* m_device;
+		VkDeviceSize    m_alignment;
+
+		std::array<GnmDrawRun, kShaderStageCount> m_runs;
+
+		std::vector<vlt::Rc<vlt::VltBuffer>> m_chunks;
+		std::vector<vlt::Rc<vlt::VltBuffer>> m_largeBuffers;
+		size_t                               m_chunkIndex = 0;
+		VkDeviceSize                         m_offset     = 0;
+	};
+
+}  // namespace sce::Gnm
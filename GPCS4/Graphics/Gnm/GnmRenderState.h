@@ -7,6 +7,7 @@
 #include "Gcn/GcnConstants.h"
 #include "Gcn/GcnShaderMeta.h"
 #include "Gcn/GcnModule.h"
+#include "Violet/VltLimit.h"
 
 #include <array>
 
@@ -32,7 +33,17 @@ namespace sce::Gnm
      */
 	enum class GnmContextFlag : uint32_t
 	{
-		GpPlaceHolder,            ///< PlaceHolder
+		GpDirtyInputAssembly,  ///< Primitive type has changed
+		GpDirtyRasterizer,     ///< Primitive setup has changed
+		GpDirtyViewport,       ///< Viewport or scissor has changed
+		GpDirtyDepthStencil,   ///< Depth stencil or DB render control has changed
+		GpDirtyColorBlend,     ///< Blend control or render target mask has changed
+		GpDirtyVsShader,       ///< Vertex shader or its meta has changed
+		GpDirtyPsShader,       ///< Pixel shader or its meta has changed
+		CpDirtyCsShader,       ///< Compute shader has changed
+		GpDirtyVsUserData,     ///< Vertex shader push constants were overwritten
+		GpDirtyPsUserData,     ///< Pixel shader push constants were overwritten
+		CpDirtyCsUserData,     ///< Compute shader push constants were overwritten
 	};
 
 	using GnmContextFlags = util::Flags<GnmContextFlag>;
@@ -44,6 +55,11 @@ namespace sce::Gnm
 		const void*        code     = nullptr;
 		UserDataArray      userData = {};
 		gcn::GcnShaderMeta meta     = {};
+
+		// Shader and user data the stage's resources
+		// were last bound with.
+		const void*   boundCode     = nullptr;
+		UserDataArray boundUserData = {};
 	};
 
 	struct GnmInputAssemblerState
@@ -53,17 +69,72 @@ namespace sce::Gnm
 		VkPrimitiveTopology     topology    = VK_PRIMITIVE_TOPOLOGY_MAX_ENUM;
 	};
 
+	struct GnmRasterizerState
+	{
+		PrimitiveSetup primitiveSetup = {};
+	};
+
+	struct GnmViewportState
+	{
+		VkViewport viewport = {};
+		VkRect2D   scissor  = {};
+	};
+
+	struct GnmDepthStencilState
+	{
+		DepthStencilControl depthControl  = {};
+		DbRenderControl     renderControl = {};
+	};
+
+	struct GnmColorBlendState
+	{
+		std::array<BlendControl, vlt::MaxNumRenderTargets> blendControl     = {};
+		uint32_t                                           renderTargetMask = ~0u;
+	};
+
 	struct GnmOutputMergerState
 	{
 		// Display buffer back render target
 		SceResource* displayRenderTarget = nullptr;
 	};
 
+	/**
+	 * \brief Graphics state
+	 *
+	 * Render state is recorded in blocks, each with a
+	 * dirty flag in \ref GnmContextFlag. Setting a block
+	 * to the value it already has doesn't dirty it, and
+	 * only dirty blocks are sent to Violet on draw.
+	 */
 	struct GnmGraphicsState
 	{
 		std::array<GnmShaderContext, kShaderStageCount> shaderContext = {};
 
 		GnmInputAssemblerState ia = {};
+		GnmRasterizerState     rs = {};
+		GnmViewportState       vp = {};
+		GnmDepthStencilState   ds = {};
+		GnmColorBlendState     cb = {};
 		GnmOutputMergerState   om = {};
 	};
+
+	/**
+	 * \brief State counters
+	 *
+	 * Counts state calls and resource binds, and
+	 * how many of them were dropped because they
+	 * didn't change anything, or only rebound the
+	 * constants of a draw run. Also counts the draws
+	 * and dispatches recorded. Reset every frame.
+	 */
+	struct GnmStateCounters
+	{
+		uint32_t stateCalls     = 0;
+		uint32_t redundantCalls = 0;
+		uint32_t stageBinds     = 0;
+		uint32_t skippedBinds   = 0;
+		uint32_t constantBinds  = 0;
+		uint32_t drawCalls      = 0;
+		uint32_t dispatchCalls  = 0;
+	};
 }  // namespace sce::Gnm
\ No newline at end of file
@@ -164,11 +164,6 @@ namespace sce
 		};
 		ctx->bindRenderTarget(0, targetAttachment);
 		ctx->setColorClearValue(0, VkClearValue());
-		ctx->transformImage(
-			dstView->image(),
-			dstView->subresources(),
-			VK_IMAGE_LAYOUT_UNDEFINED,
-			VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
 
 		ctx->bindResourceSampler(BindingIds::Image, m_samplerPresent);
 		ctx->bindResourceView(BindingIds::Image, srcView, nullptr);
@@ -187,6 +182,14 @@ namespace sce
 		ctx->pushConstants(0, sizeof(args), &args);
 
 		ctx->draw(3, 1, 0, 0);
+
+		// Barriers are recorded before the next draw or at the
+		// end of the command list, so this must follow the draw.
+		ctx->transformImage(
+			dstView->image(),
+			dstView->subresources(),
+			VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+			VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
 	}
 
 	void SceSwapchainBlitter::createSampler()
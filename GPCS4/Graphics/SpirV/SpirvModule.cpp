@@ -35,6 +35,71 @@ namespace sce::gcn
   }
   
   
+  uint32_t SpirvModule::removeUnreadPrivateVars() {
+    std::unordered_set<uint32_t> candidates;
+
+    for (auto ins : m_variables) {
+      if (ins.opCode() == spv::OpVariable
+       && ins.arg(3) == spv::StorageClassPrivate)
+        candidates.insert(ins.arg(2));
+    }
+
+    // Any reference other than the pointer operand of
+    // a store counts as a read. Literals may alias ids,
+    // which only makes this more conservative.
+    auto markReads = [&candidates] (SpirvCodeBuffer& code) {
+      for (auto ins : code) {
+        uint32_t first = ins.opCode() == spv::OpStore ? 2 : 1;
+
+        for (uint32_t i = first; i < ins.length(); i++)
+          candidates.erase(ins.arg(i));
+      }
+    };
+
+    markReads(m_entryPoints);
+    markReads(m_annotations);
+    markReads(m_code);
+
+    if (candidates.empty())
+      return 0;
+
+    removeInstructions(m_variables, [&candidates] (const SpirvInstruction& ins) {
+      return ins.opCode() == spv::OpVariable
+          && candidates.find(ins.arg(2)) != candidates.end();
+    });
+
+    removeInstructions(m_debugNames, [&candidates] (const SpirvInstruction& ins) {
+      return ins.opCode() == spv::OpName
+          && candidates.find(ins.arg(1)) != candidates.end();
+    });
+
+    removeInstructions(m_code, [&candidates] (const SpirvInstruction& ins) {
+      return ins.opCode() == spv::OpStore
+          && candidates.find(ins.arg(1)) != candidates.end();
+    });
+
+    return uint32_t(candidates.size());
+  }
+  
+  
+  template<typename Pred>
+  void SpirvModule::removeInstructions(
+          SpirvCodeBuffer&        code,
+    const Pred&                   pred) {
+    SpirvCodeBuffer result;
+
+    for (auto ins : code) {
+      if (pred(ins))
+        continue;
+
+      for (uint32_t i = 0; i < ins.length(); i++)
+        result.putWord(ins.arg(i));
+    }
+
+    code = std::move(result);
+  }
+  
+  
   uint32_t SpirvModule::allocateId() {
     return m_id++;
   }
@@ -535,6 +600,22 @@ namespace sce::gcn
   }
   
   
+  uint32_t SpirvModule::specConstComposite(
+          uint32_t                typeId,
+          uint32_t                constCount,
+    const uint32_t*               constIds) {
+    uint32_t resultId = this->allocateId();
+    
+    m_typeConstDefs.putIns  (spv::OpSpecConstantComposite, 3 + constCount);
+    m_typeConstDefs.putWord (typeId);
+    m_typeConstDefs.putWord (resultId);
+    
+    for (uint32_t i = 0; i < constCount; i++)
+      m_typeConstDefs.putWord(constIds[i]);
+    return resultId;
+  }
+  
+  
   void SpirvModule::decorate(
           uint32_t                object,
           spv::Decoration         decoration) {
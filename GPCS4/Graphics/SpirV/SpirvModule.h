@@ -52,6 +52,16 @@ namespace sce::gcn
     
     SpirvCodeBuffer compile() const;
     
+    /**
+     * \brief Removes private variables which are never read
+     * 
+     * Drops the variable declarations together with
+     * all stores to them and their debug names. Must
+     * only be called after all code has been emitted.
+     * \returns Number of removed variables
+     */
+    uint32_t removeUnreadPrivateVars();
+    
     size_t getInsertionPtr() {
       return m_code.getInsertionPtr();
     }
@@ -220,6 +230,11 @@ namespace sce::gcn
             uint32_t                typeId,
             uint32_t                value);
     
+    uint32_t specConstComposite(
+            uint32_t                typeId,
+            uint32_t                constCount,
+      const uint32_t*               constIds);
+    
     void decorate(
             uint32_t                object,
             spv::Decoration         decoration);
@@ -1286,6 +1301,11 @@ namespace sce::gcn
     
     void instImportGlsl450();
     
+    template<typename Pred>
+    static void removeInstructions(
+            SpirvCodeBuffer&        code,
+      const Pred&                   pred);
+    
     uint32_t getImageOperandWordCount(
       const SpirvImageOperands&     op) const;
     
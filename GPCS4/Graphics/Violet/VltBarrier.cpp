@@ -95,6 +95,8 @@ namespace sce::vlt
 			barrier.subresourceRange            = subresources;
 			barrier.subresourceRange.aspectMask = image->formatInfo()->aspectMask;
 			m_imgBarriers.push_back(barrier);
+
+			image->trackLayout(subresources, dstLayout);
 		}
 
 		m_imgSlices.push_back({ image.ptr(), subresources, access });
@@ -183,6 +185,8 @@ namespace sce::vlt
 		barrier.dstAccessMask = dstAccess;
 		acquire.m_imgBarriers.push_back(barrier);
 
+		image->trackLayout(subresources, dstLayout);
+
 		VltAccessFlags access(VltAccess::Read, VltAccess::Write);
 		release.m_imgSlices.push_back({ image.ptr(), subresources, access });
 		acquire.m_imgSlices.push_back({ image.ptr(), subresources, access });
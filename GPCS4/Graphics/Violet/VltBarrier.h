@@ -94,6 +94,20 @@ namespace sce::vlt
 			return m_memBarrier.srcStageMask;
 		}
 
+		/**
+		 * \brief Checks whether any barrier is pending
+		 * \returns \c true if there is nothing to record
+		 */
+		bool empty() const
+		{
+			return !(m_memBarrier.srcStageMask | m_memBarrier.dstStageMask);
+		}
+
+		VltCmdType cmdBuffer() const
+		{
+			return m_cmdBuffer;
+		}
+
 		void recordCommands(
 			const Rc<VltCommandList>& commandList);
 
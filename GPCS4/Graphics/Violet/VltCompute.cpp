@@ -2,6 +2,7 @@
 
 #include "VltDevice.h"
 #include "VltPipeManager.h"
+#include "VltSpecConst.h"
 
 namespace sce::vlt
 {
@@ -15,6 +16,11 @@ namespace sce::vlt
 	{
 		m_shaders.cs->defineResourceSlots(m_slotMapping);
 
+		const auto& limits = m_device->properties().core.properties.limits;
+		m_slotMapping.makeDescriptorsDynamic(
+			limits.maxDescriptorSetUniformBuffersDynamic,
+			limits.maxDescriptorSetStorageBuffersDynamic);
+
 		m_layout = new VltPipelineLayout(m_device,
 										 m_slotMapping, VK_PIPELINE_BIND_POINT_COMPUTE);
 	}
@@ -90,6 +96,13 @@ namespace sce::vlt
 			Logger::debug(util::str::formatex("  cs  : ", m_shaders.cs->debugName()));
 		}
 
+		VltSpecConstants specData;
+
+		for (uint32_t i = 0; i < MaxNumSpecConstants; i++)
+			specData.set(getSpecId(i), state.sc.specConstants[i], 0u);
+
+		VkSpecializationInfo specInfo = specData.getSpecInfo();
+
 		VltShaderModuleCreateInfo moduleInfo;
 		moduleInfo.fsDualSrcBlend = false;
 
@@ -99,7 +112,7 @@ namespace sce::vlt
 		info.sType              = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
 		info.pNext              = nullptr;
 		info.flags              = 0;
-		info.stage              = csm.stageInfo(nullptr);
+		info.stage              = csm.stageInfo(&specInfo);
 		info.layout             = m_layout->pipelineLayout();
 		info.basePipelineHandle = VK_NULL_HANDLE;
 		info.basePipelineIndex  = -1;
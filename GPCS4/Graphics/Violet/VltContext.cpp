@@ -60,10 +60,11 @@ namespace sce::vlt
 	Rc<VltCommandList> VltContext::endRecording()
 	{
 		this->endRendering();
+		this->flushImageUploads();
 
-		m_execBarriers.recordCommands(m_cmd);
-		m_transBarriers.recordCommands(m_cmd);
-		m_initBarriers.recordCommands(m_cmd);
+		this->recordBarriers(m_execBarriers);
+		this->recordBarriers(m_transBarriers);
+		this->recordBarriers(m_initBarriers);
 
 		m_cmd->endRecording();
 		return std::exchange(m_cmd, nullptr);
@@ -124,6 +125,25 @@ namespace sce::vlt
 		m_flags.set(VltContextFlag::DirtyPushConstants);
 	}
 
+	void VltContext::setSpecConstant(
+		VkPipelineBindPoint pipeline,
+		uint32_t            index,
+		uint32_t            value)
+	{
+		auto& specConst = pipeline == VK_PIPELINE_BIND_POINT_GRAPHICS
+							  ? m_state.gp.state.sc.specConstants[index]
+							  : m_state.cp.state.sc.specConstants[index];
+
+		if (specConst != value)
+		{
+			specConst = value;
+
+			m_flags.set(pipeline == VK_PIPELINE_BIND_POINT_GRAPHICS
+							? VltContextFlag::GpDirtyPipelineState
+							: VltContextFlag::CpDirtyPipelineState);
+		}
+	}
+
 	void VltContext::draw(
 		uint32_t vertexCount,
 		uint32_t instanceCount,
@@ -161,6 +181,8 @@ namespace sce::vlt
 	{
 		if (this->commitComputeState())
 		{
+			this->endRendering();
+
 			this->commitComputePrevBarriers();
 
 			m_cmd->cmdDispatch(x, y, z);
@@ -175,8 +197,6 @@ namespace sce::vlt
 	{
 		if (image->info().layout != layout)
 		{
-			this->endRendering();
-
 			VkImageSubresourceRange subresources;
 			subresources.aspectMask     = image->formatInfo()->aspectMask;
 			subresources.baseArrayLayer = 0;
@@ -185,7 +205,7 @@ namespace sce::vlt
 			subresources.levelCount     = image->info().mipLevels;
 
 			if (m_execBarriers.isImageDirty(image, subresources, VltAccess::Write))
-				m_execBarriers.recordCommands(m_cmd);
+				this->recordBarriers(m_execBarriers);
 
 			m_execBarriers.accessImage(image, subresources,
 									   image->info().layout,
@@ -226,9 +246,30 @@ namespace sce::vlt
 		VkPipelineStageFlags2          dstStages,
 		VkAccessFlags2                 dstAccess)
 	{
-		if (srcLayout != dstLayout)
+		if (srcLayout == dstLayout)
+		{
+			/* nothing to do */
+		}
+		else if (dstImage->trackedLayout() == dstLayout)
 		{
-			m_execBarriers.recordCommands(m_cmd);
+			// The image already is in the requested layout, a
+			// transition would at best discard its content. Keep
+			// the execution dependency the caller asked for.
+			if (srcStages)
+			{
+				m_execBarriers.accessMemory(
+					srcStages, srcAccess,
+					dstStages, dstAccess);
+			}
+
+			++m_stats.skippedTransitions;
+		}
+		else
+		{
+			// The transition is recorded along with all other
+			// barriers before the next draw or dispatch.
+			if (m_execBarriers.isImageDirty(dstImage, dstSubresources, VltAccess::Write))
+				this->recordBarriers(m_execBarriers);
 
 			m_execBarriers.accessImage(
 				dstImage, dstSubresources,
@@ -371,6 +412,12 @@ namespace sce::vlt
 				return false;
 		}
 
+		// Barriers requested since the last draw, e.g. layout
+		// transitions and compute shader writes, are recorded
+		// at once, so the rendering scope is only interrupted
+		// once per batch of draws.
+		this->recordBarriers(m_execBarriers);
+
 		if (!m_flags.test(VltContextFlag::GpRenderingActive))
 		{
 			this->beginRendering();
@@ -567,7 +614,21 @@ namespace sce::vlt
 		uint32_t              slot,
 		const VltBufferSlice& buffer)
 	{
-		if (likely(!m_rc[slot].bufferSlice.matches(buffer)))
+		// Moving a slice within the same buffer only changes
+		// the dynamic offset, the descriptor can be reused.
+		// Uniform buffers are the only dynamic descriptors, a
+		// buffer which may be bound as storage buffer needs a
+		// new descriptor.
+		bool isUniform = buffer.defined() &&
+						 (buffer.buffer()->info().usage &
+						  (VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT)) ==
+							 VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
+
+		bool needsUpdate = !isUniform ||
+						   !m_rc[slot].bufferSlice.matchesBuffer(buffer) ||
+						   m_rc[slot].bufferSlice.length() != buffer.length();
+
+		if (likely(needsUpdate))
 		{
 			m_flags.set(
 				VltContextFlag::CpDirtyResources,
@@ -849,6 +910,11 @@ namespace sce::vlt
 							 elementCount, formatInfo->elementSize,
 							 pitchPerRow, pitchPerLayer);
 
+		// Copies of all uploads share one acquire barrier,
+		// unless the same subresources are uploaded twice.
+		if (m_transAcquires.isImageDirty(image, vutil::makeSubresourceRange(subresources), VltAccess::Write))
+			this->flushImageUploads();
+
 		// Discard previous subresource contents
 		m_transAcquires.accessImage(image,
 									vutil::makeSubresourceRange(subresources),
@@ -857,21 +923,18 @@ namespace sce::vlt
 									VK_PIPELINE_STAGE_TRANSFER_BIT,
 									VK_ACCESS_TRANSFER_WRITE_BIT);
 
-		m_transAcquires.recordCommands(m_cmd);
-
 		// Perform copy on the transfer queue
-		VkBufferImageCopy region;
-		region.bufferOffset      = stagingHandle.offset;
-		region.bufferRowLength   = 0;
-		region.bufferImageHeight = 0;
-		region.imageSubresource  = subresources;
-		region.imageOffset       = imageOffset;
-		region.imageExtent       = imageExtent;
-
-		m_cmd->cmdCopyBufferToImage(VltCmdType::TransferBuffer,
-									stagingHandle.handle, image->handle(),
-									image->pickLayout(VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL),
-									1, &region);
+		VltImageUpload upload;
+		upload.buffer                   = stagingHandle.handle;
+		upload.image                    = image->handle();
+		upload.layout                   = image->pickLayout(VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+		upload.region.bufferOffset      = stagingHandle.offset;
+		upload.region.bufferRowLength   = 0;
+		upload.region.bufferImageHeight = 0;
+		upload.region.imageSubresource  = subresources;
+		upload.region.imageOffset       = imageOffset;
+		upload.region.imageExtent       = imageExtent;
+		m_imageUploads.push_back(upload);
 
 		// Transfer ownership to graphics queue
 		m_transBarriers.releaseImage(m_initBarriers,
@@ -931,7 +994,7 @@ namespace sce::vlt
 									   initialLayout, 0, 0, clearLayout,
 									   VK_PIPELINE_STAGE_TRANSFER_BIT,
 									   VK_ACCESS_TRANSFER_WRITE_BIT);
-			m_execAcquires.recordCommands(m_cmd);
+			this->recordBarriers(m_execAcquires);
 
 			auto formatInfo = image->formatInfo();
 
@@ -1028,6 +1091,8 @@ namespace sce::vlt
 			m_cmd->cmdBeginRendering(&renderInfo);
 
 			m_flags.set(VltContextFlag::GpRenderingActive);
+
+			++m_stats.renderingCount;
 		}
 	}
 
@@ -1041,6 +1106,36 @@ namespace sce::vlt
 		}
 	}
 
+	void VltContext::recordBarriers(
+		VltBarrierSet& barriers)
+	{
+		if (!barriers.empty())
+		{
+			// We never record self dependencies, so barriers
+			// on the exec buffer end the rendering scope.
+			if (barriers.cmdBuffer() == VltCmdType::ExecBuffer)
+				this->endRendering();
+
+			barriers.recordCommands(m_cmd);
+
+			++m_stats.barrierCount;
+		}
+	}
+
+	void VltContext::flushImageUploads()
+	{
+		this->recordBarriers(m_transAcquires);
+
+		for (const auto& upload : m_imageUploads)
+		{
+			m_cmd->cmdCopyBufferToImage(VltCmdType::TransferBuffer,
+										upload.buffer, upload.image,
+										upload.layout, 1, &upload.region);
+		}
+
+		m_imageUploads.clear();
+	}
+
 	bool VltContext::commitComputeState()
 	{
 		if (m_flags.test(VltContextFlag::CpDirtyPipeline))
@@ -1456,7 +1551,7 @@ namespace sce::vlt
 		}
 
 		if (requiresBarrier)
-			m_execBarriers.recordCommands(m_cmd);
+			this->recordBarriers(m_execBarriers);
 	}
 
 	void VltContext::commitComputePostBarriers()
@@ -1533,12 +1628,22 @@ namespace sce::vlt
 		if (framebuffer == nullptr ||
 			!framebuffer->matchTargets(m_state.cb.renderTargets))
 		{
+			this->endRendering();
+
 			framebuffer = m_device->createFramebuffer(
 				m_state.cb.renderTargets);
 		}
 
+		// Only attachments which are not in their attachment
+		// layout yet need a transition. Pending barriers may
+		// touch the same images, so they have to go first.
 		framebuffer->prepareRenderingLayout(m_execAcquires);
-		m_execAcquires.recordCommands(m_cmd);
+
+		if (!m_execAcquires.empty())
+		{
+			this->recordBarriers(m_execBarriers);
+			this->recordBarriers(m_execAcquires);
+		}
 
 		m_flags.clr(VltContextFlag::GpDirtyFramebuffer);
 	}
@@ -309,6 +309,21 @@ namespace sce::vlt
 			uint32_t    size,
 			const void* data);
 
+		/**
+         * \brief Sets specialization constants
+         * 
+         * Replaces current specialization constants with
+         * the given list of constant entries. The specId
+         * in the shader can be computed with \c getSpecId.
+         * \param [in] pipeline Graphics or Compute pipeline
+         * \param [in] index Constant index
+         * \param [in] value Constant value
+         */
+		void setSpecConstant(
+			VkPipelineBindPoint pipeline,
+			uint32_t            index,
+			uint32_t            value);
+
 		/**
          * \brief Draws primitive without using an index buffer
          * 
@@ -400,6 +415,9 @@ namespace sce::vlt
          * \brief Uses transfer queue to initialize image
          * 
          * Only safe to use if the image is not in use by the GPU.
+         * Copies are deferred and recorded together with a single
+         * barrier when the command list ends, or earlier if the
+         * same subresources are uploaded again.
          * \param [in] image The image to initialize
          * \param [in] subresources Subresources to initialize
          * \param [in] data Source data
@@ -471,6 +489,8 @@ namespace sce::vlt
          * \brief Transforms image subresource layouts
 		 * 
 		 * Note the internal image info layout is not changed.
+		 * The transition is deferred to the next draw or dispatch
+		 * and skipped if the image already is in \p dstLayout.
          */
 		void transformImage(
 			const Rc<VltImage>&            dstImage,
@@ -523,11 +543,43 @@ namespace sce::vlt
 			const Rc<util::sync::Signal>& signal,
 			uint64_t                      value);
 
+		/**
+         * \brief Context statistics
+         * 
+         * Accumulated until reset with \ref resetStats.
+         * \returns Barrier and rendering scope counts
+         */
+		const VltContextStats& stats() const
+		{
+			return m_stats;
+		}
+
+		/**
+         * \brief Resets context statistics
+         */
+		void resetStats()
+		{
+			m_stats = {};
+		}
+
 	private:
+		struct VltImageUpload
+		{
+			VkBuffer          buffer;
+			VkImage           image;
+			VkImageLayout     layout;
+			VkBufferImageCopy region;
+		};
+
 		void beginRendering();
 
 		void endRendering();
 
+		void recordBarriers(
+			VltBarrierSet& barriers);
+
+		void flushImageUploads();
+
 		void updateIndexBufferBinding();
 		void updateVertexBufferBindings();
 
@@ -592,6 +644,9 @@ namespace sce::vlt
 		VltBarrierSet          m_transAcquires;
 		VltBarrierControlFlags m_barrierControl;
 
+		std::vector<VltImageUpload> m_imageUploads;
+		VltContextStats             m_stats;
+
 		VkDescriptorSet m_gpSet = VK_NULL_HANDLE;
 		VkDescriptorSet m_cpSet = VK_NULL_HANDLE;
 
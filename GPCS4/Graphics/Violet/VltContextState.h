@@ -158,4 +158,19 @@ namespace sce::vlt
 		VltComputePipelineState  cp;
 	};
 
+	/**
+     * \brief Context statistics
+     * 
+     * Counts recorded pipeline barriers, rendering
+     * scopes and image layout transitions that were
+     * dropped because the image already was in the
+     * requested layout.
+     */
+	struct VltContextStats
+	{
+		uint32_t barrierCount       = 0;
+		uint32_t renderingCount     = 0;
+		uint32_t skippedTransitions = 0;
+	};
+
 }  // namespace sce::vlt
\ No newline at end of file
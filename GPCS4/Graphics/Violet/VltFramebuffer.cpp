@@ -131,7 +131,7 @@ namespace sce::vlt
 			if (colorView != nullptr)
 			{
 				auto& colorImage = colorView->image();
-				if (colorImage->info().layout == VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL)
+				if (colorImage->trackedLayout() == VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL)
 				{
 					continue;
 				}
@@ -159,7 +159,7 @@ namespace sce::vlt
 		if (depthView != nullptr)
 		{
 			auto& depthImage = depthView->image();
-			if (depthImage->info().layout != VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL)
+			if (depthImage->trackedLayout() != VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL)
 			{
 				VkImageSubresourceRange subresources;
 				subresources.aspectMask     = depthImage->formatInfo()->aspectMask;
@@ -138,6 +138,8 @@ namespace sce::vlt
 		/**
 		 * \brief Transform attachment images to rendering-ready layout.
 		 * 
+		 * Attachments whose tracked layout already is the
+		 * attachment layout are skipped.
 		 */
 		void prepareRenderingLayout(VltBarrierSet& barrier);
 
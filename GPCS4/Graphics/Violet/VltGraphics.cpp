@@ -3,6 +3,7 @@
 #include "VltDevice.h"
 #include "VltPipeManager.h"
 #include "VltShader.h"
+#include "VltSpecConst.h"
 
 
 namespace sce::vlt
@@ -29,6 +30,11 @@ namespace sce::vlt
 		m_vsIn  = m_shaders.vs != nullptr ? m_shaders.vs->interfaceSlots().inputSlots : 0;
 		m_fsOut = m_shaders.fs != nullptr ? m_shaders.fs->interfaceSlots().outputSlots : 0;
 
+		const auto& limits = m_device->properties().core.properties.limits;
+		m_slotMapping.makeDescriptorsDynamic(
+			limits.maxDescriptorSetUniformBuffersDynamic,
+			limits.maxDescriptorSetStorageBuffersDynamic);
+
 		m_layout = new VltPipelineLayout(m_device,
 										 m_slotMapping, VK_PIPELINE_BIND_POINT_GRAPHICS);
 	}
@@ -160,6 +166,14 @@ namespace sce::vlt
 		else if (state.rs.sampleCount())
 			sampleCount = VkSampleCountFlagBits(state.rs.sampleCount());
 
+		VltSpecConstants specData;
+		specData.set(uint32_t(VltSpecConstantId::RasterizerSampleCount), sampleCount, VK_SAMPLE_COUNT_1_BIT);
+
+		for (uint32_t i = 0; i < MaxNumSpecConstants; i++)
+			specData.set(getSpecId(i), state.sc.specConstants[i], 0u);
+
+		VkSpecializationInfo specInfo = specData.getSpecInfo();
+
 		auto vsm  = createShaderModule(m_shaders.vs, state);
 		auto tcsm = createShaderModule(m_shaders.tcs, state);
 		auto tesm = createShaderModule(m_shaders.tes, state);
@@ -168,11 +182,11 @@ namespace sce::vlt
 
 		// clang-format off
 		std::vector<VkPipelineShaderStageCreateInfo> stages;
-		if (vsm)  stages.push_back(vsm.stageInfo(nullptr));
-		if (tcsm) stages.push_back(tcsm.stageInfo(nullptr));
-		if (tesm) stages.push_back(tesm.stageInfo(nullptr));
-		if (gsm)  stages.push_back(gsm.stageInfo(nullptr));
-		if (fsm)  stages.push_back(fsm.stageInfo(nullptr));
+		if (vsm)  stages.push_back(vsm.stageInfo(&specInfo));
+		if (tcsm) stages.push_back(tcsm.stageInfo(&specInfo));
+		if (tesm) stages.push_back(tesm.stageInfo(&specInfo));
+		if (gsm)  stages.push_back(gsm.stageInfo(&specInfo));
+		if (fsm)  stages.push_back(fsm.stageInfo(&specInfo));
 		// clang-format on
 		
 		// Fix up color write masks using the component mappings
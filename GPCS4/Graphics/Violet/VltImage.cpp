@@ -12,7 +12,8 @@ namespace sce::vlt
 		VltMemoryAllocator&       memAlloc,
 		VkMemoryPropertyFlags     memFlags) :
 		m_device(device),
-		m_info(createInfo), m_memFlags(memFlags)
+		m_info(createInfo), m_memFlags(memFlags),
+		m_trackedLayout(createInfo.initialLayout)
 	{
 		// Copy the compatible view formats to a persistent array
 		m_viewFormats.resize(createInfo.viewFormatCount);
@@ -123,7 +124,8 @@ namespace sce::vlt
 		const VltImageCreateInfo& info,
 		VkImage                   image) :
 		m_device(device),
-		m_info(info), m_image({ image })
+		m_info(info), m_image({ image }),
+		m_trackedLayout(info.initialLayout)
 	{
 
 		m_viewFormats.resize(info.viewFormatCount);
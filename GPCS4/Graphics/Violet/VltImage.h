@@ -267,6 +267,38 @@ namespace sce::vlt
 			m_info.layout = layout;
 		}
 
+		/**
+         * \brief Layout in recorded commands
+         * 
+         * The layout the last recorded transition left the
+         * image in. \c VK_IMAGE_LAYOUT_MAX_ENUM if only part
+         * of the image was transitioned, since subresources
+         * are not tracked individually.
+         * \returns Tracked image layout
+         */
+		VkImageLayout trackedLayout() const
+		{
+			return m_trackedLayout;
+		}
+
+		/**
+         * \brief Tracks a layout transition
+         * 
+         * \param [in] subresources Transitioned subresources
+         * \param [in] layout New layout of the subresources
+         */
+		void trackLayout(
+			const VkImageSubresourceRange& subresources,
+			VkImageLayout                  layout)
+		{
+			bool fullImage = subresources.baseMipLevel == 0 &&
+							 subresources.levelCount >= m_info.mipLevels &&
+							 subresources.baseArrayLayer == 0 &&
+							 subresources.layerCount >= m_info.numLayers;
+
+			m_trackedLayout = fullImage ? layout : VK_IMAGE_LAYOUT_MAX_ENUM;
+		}
+
 		/**
          * \brief Checks whether a subresource is entirely covered
          * 
@@ -330,6 +362,7 @@ namespace sce::vlt
 		VltImageCreateInfo    m_info;
 		VkMemoryPropertyFlags m_memFlags;
 		VltPhysicalImage      m_image;
+		VkImageLayout         m_trackedLayout;
 
 		std::vector<VkFormat> m_viewFormats;
 	};
@@ -0,0 +1,38 @@
+#include "VltSpecConst.h"
+
+#include <cstring>
+
+namespace sce::vlt
+{
+	VltSpecConstants::VltSpecConstants()
+	{
+	}
+
+	VltSpecConstants::~VltSpecConstants()
+	{
+	}
+
+	VkSpecializationInfo VltSpecConstants::getSpecInfo() const
+	{
+		VkSpecializationInfo specInfo;
+		specInfo.mapEntryCount = m_map.size();
+		specInfo.pMapEntries   = m_map.data();
+		specInfo.dataSize      = m_data.size();
+		specInfo.pData         = m_data.data();
+		return specInfo;
+	}
+
+	void VltSpecConstants::setAsUint32(uint32_t specId, uint32_t value)
+	{
+		uint32_t dataOffset = m_data.size();
+		m_data.resize(dataOffset + sizeof(uint32_t));
+		std::memcpy(&m_data[dataOffset], &value, sizeof(uint32_t));
+
+		VkSpecializationMapEntry mapEntry;
+		mapEntry.constantID = specId;
+		mapEntry.offset     = dataOffset;
+		mapEntry.size       = sizeof(uint32_t);
+		m_map.push_back(mapEntry);
+	}
+
+}  // namespace sce::vlt
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "VltCommon.h"
+#include "VltLimit.h"
+#include "VltShader.h"
+
+#include <vector>
+
+namespace sce::vlt
+{
+	/**
+     * \brief Specialization constant data
+     *
+     * Collects the specialization constants of
+     * a pipeline and builds the specialization
+     * info passed to the shader stages.
+     */
+	class VltSpecConstants
+	{
+
+	public:
+		VltSpecConstants();
+
+		~VltSpecConstants();
+
+		/**
+         * \brief Sets specialization constant value
+         *
+         * If the given value is different from the constant's
+         * default value, this will store the new value and add
+         * a map entry so that it gets applied properly. Each
+         * constant may only be set once.
+         * \param [in] specId Specialization constant ID
+         * \param [in] value Specialization constant value
+         * \param [in] defaultValue Default value
+         */
+		template <typename T>
+		void set(uint32_t specId, T value, T defaultValue)
+		{
+			if (value != defaultValue)
+				setAsUint32(specId, uint32_t(value));
+		}
+
+		/**
+         * \brief Generates specialization info structure
+         * \returns Specialization info for shader module
+         */
+		VkSpecializationInfo getSpecInfo() const;
+
+	private:
+		std::vector<VkSpecializationMapEntry> m_map;
+		std::vector<char>                     m_data;
+
+		void setAsUint32(uint32_t specId, uint32_t value);
+	};
+
+	/**
+     * \brief Spec ID of a pipeline specialization constant
+     *
+     * \param [in] index Index into the pipeline state's
+     *        specialization constant array
+     * \returns The SPIR-V spec ID of the constant
+     */
+	inline uint32_t getSpecId(uint32_t index)
+	{
+		return uint32_t(VltSpecConstantId::FirstPipelineConstant) + index;
+	}
+
+}  // namespace sce::vlt
@@ -3,6 +3,7 @@
 #include "SceUserService/user_service_defs.h"
 #include "sce_errors.h"
 
+#include "Gcn/GcnShaderCompileService.h"
 #include "Gnm/GnmConstant.h"
 #include "Sce/SceGnmDriver.h"
 #include "Sce/SceResourceTracker.h"
@@ -17,6 +18,8 @@ namespace sce
 	{
 		m_gnmDriver = std::make_shared<SceGnmDriver>();
 		m_tracker   = std::make_shared<SceResourceTracker>();
+
+		m_shaderCompiler = std::make_shared<gcn::GcnShaderCompileService>();
 	}
 
 	VirtualGPU::~VirtualGPU()
@@ -75,6 +78,11 @@ namespace sce
 		return *m_tracker;
 	}
 
+	gcn::GcnShaderCompileService& VirtualGPU::shaderCompileService()
+	{
+		return *m_shaderCompiler;
+	}
+
 	Gnm::GpuMode VirtualGPU::mode()
 	{
 		return Gnm::kGpuModeNeo;
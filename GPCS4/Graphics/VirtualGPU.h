@@ -14,6 +14,11 @@ namespace sce
 		enum GpuMode;
 	}  // namespace Gnm
 
+	namespace gcn
+	{
+		class GcnShaderCompileService;
+	}  // namespace gcn
+
 	class SceVideoOut;
 	class SceGnmDriver;
 	class SceResourceTracker;
@@ -53,6 +58,11 @@ namespace sce
 		 */
 		SceResourceTracker& resourceTracker();
 
+		/**
+		 * \brief Get shader compile service.
+		 */
+		gcn::GcnShaderCompileService& shaderCompileService();
+
 		/**
 		 * \brief Global GPU mode.
 		 * 
@@ -74,6 +84,8 @@ namespace sce
 		std::shared_ptr<SceGnmDriver> m_gnmDriver = nullptr;
 
 		std::shared_ptr<SceResourceTracker> m_tracker = nullptr;
+
+		std::shared_ptr<gcn::GcnShaderCompileService> m_shaderCompiler = nullptr;
 	};
 
 }  // namespace sce
\ No newline at end of file
@@ -18,8 +18,7 @@ LOG_CHANNEL(Loader.ELFMapper);
 
 bool ELFMapper::loadFile(std::string const &filePath, NativeModule *mod)
 {
-	plat::file_uptr file = {};
-	bool retVal              = false;
+	bool retVal = false;
 
 	do
 	{
@@ -31,9 +30,12 @@ bool ELFMapper::loadFile(std::string const &filePath, NativeModule *mod)
 
 		m_moduleData = mod;
 
-		if (!plat::LoadFile(filePath, mod->m_fileMemory))
+		// Map the file instead of reading it, headers and dynamic tables
+		// are accessed in place and segments are mapped from the page cache.
+		mod->m_fileMapping = plat::MapFile(filePath);
+		if (!mod->m_fileMapping)
 		{
-			LOG_ERR("failed to load file %s", filePath.c_str());
+			LOG_ERR("failed to map file %s", filePath.c_str());
 			break;
 		}
 
@@ -45,8 +47,7 @@ bool ELFMapper::loadFile(std::string const &filePath, NativeModule *mod)
 bool ELFMapper::validateHeader()
 {
 
-	bool retVal      = false;
-	auto &fileMemory = m_moduleData->m_fileMemory;
+	bool retVal = false;
 
 	do
 	{
@@ -56,13 +57,14 @@ bool ELFMapper::validateHeader()
 			break;
 		}
 
-		if (fileMemory.size() < sizeof(*m_moduleData->m_elfHeader))
+		auto fileMapping = m_moduleData->m_fileMapping.get();
+		if (fileMapping->nSize < sizeof(*m_moduleData->m_elfHeader))
 		{
-			LOG_ERR("file size error. size=%d", fileMemory.size());
+			LOG_ERR("file size error. size=%d", fileMapping->nSize);
 			break;
 		}
 
-		m_moduleData->m_elfHeader = reinterpret_cast<Elf64_Ehdr *>(fileMemory.data());
+		m_moduleData->m_elfHeader = reinterpret_cast<Elf64_Ehdr *>(fileMapping->pData);
 		auto elfHeader            = m_moduleData->m_elfHeader;
 
 		if (strncmp((const char *)elfHeader->e_ident, ELFMAG, SELFMAG))
@@ -100,9 +102,9 @@ bool ELFMapper::parseSegmentHeaders()
 			break;
 		}
 
-		auto&        fileMemory     = m_moduleData->m_fileMemory;
+		auto         fileMapping    = m_moduleData->m_fileMapping.get();
 		MODULE_INFO& info           = m_moduleData->m_moduleInfo;
-		uint8_t*     pSegmentHeader = fileMemory.data() + m_moduleData->m_elfHeader->e_phoff;
+		uint8_t*     pSegmentHeader = fileMapping->pData + m_moduleData->m_elfHeader->e_phoff;
 		uint32_t     shCount        = m_moduleData->m_elfHeader->e_phnum;
 
 		m_moduleData->m_segmentHeaders.resize(shCount);
@@ -110,7 +112,7 @@ bool ELFMapper::parseSegmentHeaders()
 		memcpy(m_moduleData->m_segmentHeaders.data(), pSegmentHeader,
 			   shCount * sizeof(Elf64_Phdr));
 
-		uint8_t *pBuffer = fileMemory.data();
+		uint8_t *pBuffer = fileMapping->pData;
 
 		for (auto &hdr : m_moduleData->m_segmentHeaders)
 		{
@@ -240,18 +242,27 @@ bool ELFMapper::mapImageIntoMemory()
 			break;
 		}
 
-		uint8_t* buffer = reinterpret_cast<uint8_t*>(plat::VMAllocateAlign(
-			nullptr,
-			totalSize, plat::VM_PAGE_SIZE,
-			plat::VMAT_RESERVE_COMMIT, plat::VMPF_CPU_RWX));
+		// File views can only be placed at granularity boundaries,
+		// so the image is placed inside a region of whole granules,
+		// at the offset which lets most of its segments be views.
+		size_t granularity = plat::VMMapGranularity();
+		size_t imageBias   = granularity ? chooseImageBias(granularity) : 0;
+		size_t regionSize  = granularity ? util::align(imageBias + totalSize, granularity) : totalSize;
 
-		if (buffer == nullptr)
+		// Segment addresses are aligned down relative to the image,
+		// so it must be aligned to the segments.
+		uint8_t* region = reinterpret_cast<uint8_t*>(
+			plat::VMReserveImage(regionSize, getImageAlignment()));
+
+		if (region == nullptr)
 		{
 			break;
 		}
 
-		m_moduleData->m_mappedMemory.reset(buffer);
-		m_moduleData->m_mappedSize = totalSize;
+		uint8_t* buffer = region + imageBias;
+
+		m_moduleData->m_mappedMemory = plat::image_ptr(buffer, plat::ImageUnMapper{ regionSize, imageBias });
+		m_moduleData->m_mappedSize   = totalSize;
 
 		LOG_DEBUG("Module %s loaded. start %p end %p size=%ld",
 				  m_moduleData->fileName.c_str(), buffer, buffer + totalSize, totalSize);
@@ -259,8 +270,18 @@ bool ELFMapper::mapImageIntoMemory()
 		info.pMappedAddr = buffer;
 		info.nMappedSize = totalSize;
 
-		for (auto const &phdr : m_moduleData->m_segmentHeaders)
+		size_t residentSize = plat::VMResidentSize();
+
+		retVal = mapFileViews(granularity, imageBias, regionSize);
+		if (!retVal)
+		{
+			LOG_ERR("failed to commit image memory of %s", m_moduleData->fileName.c_str());
+			break;
+		}
+
+		for (auto phdrPtr : getMappedSegments())
 		{
+			auto const &phdr = *phdrPtr;
 			if (phdr.p_flags & PF_X)
 			{
 				retVal = mapCodeSegment(phdr);
@@ -271,17 +292,26 @@ bool ELFMapper::mapImageIntoMemory()
 			{
 				retVal = mapSecReloSegment(phdr);
 			}
-			else if (phdr.p_flags & PF_W)
+			else
 			{
 				retVal = mapDataSegment(phdr);
 				LOG_DEBUG("data segment at 0x%x size=%ld", info.pDataAddr,
 						  info.nDataSize);
-				// there should no longer be segment to be mapped,
-				// and we stop enumerating right here.
-				break;
 			}
 		}
 
+		size_t viewSize = 0;
+		for (auto const &view : m_views)
+		{
+			viewSize += view.size;
+		}
+
+		// Views are only resident once touched, so the growth
+		// is mostly the copied data and the pages written to.
+		LOG_DEBUG("module %s: %zu bytes mapped from file, %zu bytes copied, resident set grew by %zd KiB",
+				  m_moduleData->fileName.c_str(), viewSize, m_copiedSize,
+				  (static_cast<ptrdiff_t>(plat::VMResidentSize()) - static_cast<ptrdiff_t>(residentSize)) / 1024);
+
 	} while (false);
 
 	return retVal;
@@ -685,21 +715,21 @@ bool ELFMapper::mapCodeSegment(Elf64_Phdr const &phdr)
 {
 	bool retVal       = false;
 	MODULE_INFO &info = m_moduleData->m_moduleInfo;
-	auto &fileData    = m_moduleData->m_fileMemory;
 	do
 	{
-		if (fileData.empty())
+		if (!m_moduleData->m_fileMapping)
 		{
 			break;
 		}
 
 		info.nCodeSize = phdr.p_memsz;
-		info.pCodeAddr = reinterpret_cast<uint8_t*>(
-			util::alignDown(size_t(info.pMappedAddr + phdr.p_vaddr), phdr.p_align));
+		info.pCodeAddr = getSegmentAddress(phdr);
 
-		uint8_t *fileDataPtr = fileData.data() + phdr.p_offset;
+		if (!copySegment(phdr))
+		{
+			break;
+		}
 
-		memcpy(info.pCodeAddr, fileDataPtr, phdr.p_filesz);
 		if (m_moduleData->m_elfHeader->e_entry != 0)
 		{
 			//info.pEntryPoint = info.pCodeAddr + m_moduleData->elfHeader->e_entry;
@@ -726,23 +756,16 @@ bool ELFMapper::mapCodeSegment(Elf64_Phdr const &phdr)
 
 bool ELFMapper::mapSecReloSegment(Elf64_Phdr const &phdr)
 {
-	bool retVal       = false;
-	MODULE_INFO &info = m_moduleData->m_moduleInfo;
-	auto &fileData    = m_moduleData->m_fileMemory;
+	bool retVal = false;
 
 	do
 	{
-		if (fileData.empty())
+		if (!m_moduleData->m_fileMapping)
 		{
 			break;
 		}
 
-		uint8_t *relroAddr = reinterpret_cast<uint8_t *>(
-			util::alignDown(size_t(info.pMappedAddr + phdr.p_vaddr), phdr.p_align));
-		uint8_t *fileDataPtr = fileData.data() + phdr.p_offset;
-
-		memcpy(relroAddr, fileDataPtr, phdr.p_filesz);
-		retVal = true;
+		retVal = copySegment(phdr);
 
 	} while (false);
 
@@ -753,21 +776,21 @@ bool ELFMapper::mapDataSegment(Elf64_Phdr const &phdr)
 {
 	bool retVal       = false;
 	MODULE_INFO &info = m_moduleData->m_moduleInfo;
-	auto &fileData    = m_moduleData->m_fileMemory;
 
 	do
 	{
-		if (fileData.empty())
+		if (!m_moduleData->m_fileMapping)
 		{
 			break;
 		}
 
 		info.nDataSize = phdr.p_memsz;
-		info.pDataAddr = reinterpret_cast<uint8_t *>(
-			util::alignDown(size_t(info.pMappedAddr) + phdr.p_vaddr, phdr.p_align));
+		info.pDataAddr = getSegmentAddress(phdr);
 
-		uint8_t *fileDataPtr = fileData.data() + phdr.p_offset;
-		memcpy(info.pDataAddr, fileDataPtr, phdr.p_filesz);
+		if (!copySegment(phdr))
+		{
+			break;
+		}
 
 		if (info.pProcParam != nullptr)
 		{
@@ -780,3 +803,213 @@ bool ELFMapper::mapDataSegment(Elf64_Phdr const &phdr)
 
 	return retVal;
 }
+
+std::vector<const Elf64_Phdr *> ELFMapper::getMappedSegments() const
+{
+	std::vector<const Elf64_Phdr *> segments;
+	for (auto const &phdr : m_moduleData->m_segmentHeaders)
+	{
+		if (phdr.p_flags & PF_X || phdr.p_type == PT_SCE_RELRO)
+		{
+			segments.push_back(&phdr);
+		}
+		else if (phdr.p_flags & PF_W)
+		{
+			// there should no longer be segment to be mapped,
+			// and we stop enumerating right here.
+			segments.push_back(&phdr);
+			break;
+		}
+	}
+	return segments;
+}
+
+uint8_t *ELFMapper::getSegmentAddress(Elf64_Phdr const &phdr) const
+{
+	auto &info = m_moduleData->m_moduleInfo;
+	return reinterpret_cast<uint8_t *>(
+		util::alignDown(size_t(info.pMappedAddr + phdr.p_vaddr), phdr.p_align));
+}
+
+bool ELFMapper::getSegmentView(Elf64_Phdr const &phdr, size_t imageAddress,
+							   size_t granularity, SegmentView *view) const
+{
+	bool retVal       = false;
+	auto &fileMapping = *m_moduleData->m_fileMapping;
+
+	do
+	{
+		// Same as getSegmentAddress, for an image placed at imageAddress.
+		size_t address = util::alignDown(imageAddress + phdr.p_vaddr, phdr.p_align);
+		if ((address - phdr.p_offset) % granularity != 0)
+		{
+			break;
+		}
+
+		// Only granules which lie entirely within the file data.
+		uint64_t fileEnd   = std::min<uint64_t>(phdr.p_offset + phdr.p_filesz, fileMapping.nSize);
+		uint64_t viewBegin = util::align(phdr.p_offset, granularity);
+		uint64_t viewEnd   = fileEnd - fileEnd % granularity;
+		if (viewEnd <= viewBegin)
+		{
+			break;
+		}
+
+		view->fileOffset  = viewBegin;
+		view->imageOffset = address + (viewBegin - phdr.p_offset) - imageAddress;
+		view->size        = viewEnd - viewBegin;
+
+		retVal = true;
+	} while (false);
+
+	return retVal;
+}
+
+size_t ELFMapper::getImageAlignment() const
+{
+	size_t imageAlign = plat::VM_PAGE_SIZE;
+	for (auto phdrPtr : getMappedSegments())
+	{
+		imageAlign = std::max<size_t>(imageAlign, phdrPtr->p_align);
+	}
+	return imageAlign;
+}
+
+size_t ELFMapper::chooseImageBias(size_t granularity) const
+{
+	// The image only has to be aligned to its segments, which is
+	// usually less than the granularity. A view needs the address
+	// and file offset of a segment to be congruent modulo the
+	// granularity, which depends on where the image starts.
+	size_t imageAlign   = getImageAlignment();
+	size_t bestBias     = 0;
+	size_t bestViewSize = 0;
+	for (size_t bias = 0; bias < granularity; bias += imageAlign)
+	{
+		// The region starts at a granule, so bias
+		// stands in for the image address.
+		size_t viewSize = 0;
+		for (auto phdrPtr : getMappedSegments())
+		{
+			SegmentView view = {};
+			if (getSegmentView(*phdrPtr, bias, granularity, &view))
+			{
+				viewSize += view.size;
+			}
+		}
+
+		if (viewSize > bestViewSize)
+		{
+			bestBias     = bias;
+			bestViewSize = viewSize;
+		}
+	}
+
+	return bestBias;
+}
+
+bool ELFMapper::mapFileViews(size_t granularity, size_t imageBias, size_t regionSize)
+{
+	bool retVal       = false;
+	auto &fileMapping = *m_moduleData->m_fileMapping;
+	auto imageBase    = m_moduleData->m_moduleInfo.pMappedAddr;
+	auto regionBase   = imageBase - imageBias;
+
+	m_views.clear();
+	m_copiedSize = 0;
+
+	// Map every granule which lies entirely within a segment's file data.
+	for (auto phdrPtr : getMappedSegments())
+	{
+		if (granularity == 0)
+		{
+			break;
+		}
+
+		auto const &phdr = *phdrPtr;
+		SegmentView view = {};
+		if (!getSegmentView(phdr, reinterpret_cast<size_t>(imageBase), granularity, &view))
+		{
+			LOG_DEBUG("segment at offset 0x%lx can't be mapped as a view, it is copied",
+					  phdr.p_offset);
+			continue;
+		}
+
+		if (!plat::VMMapFileView(imageBase + view.imageOffset, view.size, fileMapping, view.fileOffset))
+		{
+			LOG_WARN("failed to map view of segment at offset 0x%lx, it is copied", phdr.p_offset);
+			continue;
+		}
+
+		m_views.push_back(view);
+	}
+
+	// Commit anonymous memory for everything else in the region,
+	// which is zero filled as required for bss.
+	std::sort(m_views.begin(), m_views.end(), [](SegmentView const &a, SegmentView const &b)
+			  { return a.imageOffset < b.imageOffset; });
+
+	size_t cursor = 0;
+	retVal        = true;
+	for (auto const &view : m_views)
+	{
+		size_t viewOffset = imageBias + view.imageOffset;
+		if (viewOffset > cursor)
+		{
+			retVal = retVal && plat::VMCommitImage(regionBase + cursor, viewOffset - cursor);
+		}
+		cursor = viewOffset + view.size;
+	}
+
+	if (regionSize > cursor)
+	{
+		retVal = retVal && plat::VMCommitImage(regionBase + cursor, regionSize - cursor);
+	}
+
+	LOG_DEBUG("%zu file views mapped for module %s, image at granule offset 0x%zx",
+			  m_views.size(), m_moduleData->fileName.c_str(), imageBias);
+	return retVal;
+}
+
+bool ELFMapper::copySegment(Elf64_Phdr const &phdr)
+{
+	bool retVal       = false;
+	auto &fileMapping = *m_moduleData->m_fileMapping;
+	auto imageBase    = m_moduleData->m_moduleInfo.pMappedAddr;
+
+	do
+	{
+		if (phdr.p_offset + phdr.p_filesz > fileMapping.nSize)
+		{
+			LOG_ERR("segment at offset 0x%lx exceeds file size", phdr.p_offset);
+			break;
+		}
+
+		uint8_t *dst       = getSegmentAddress(phdr);
+		const uint8_t *src = fileMapping.pData + phdr.p_offset;
+		size_t imageOffset = dst - imageBase;
+
+		auto view = std::find_if(m_views.begin(), m_views.end(), [&](SegmentView const &v)
+								 { return v.imageOffset >= imageOffset &&
+										  v.imageOffset < imageOffset + phdr.p_filesz; });
+
+		if (view == m_views.end())
+		{
+			memcpy(dst, src, phdr.p_filesz);
+			m_copiedSize += phdr.p_filesz;
+		}
+		else
+		{
+			// Only the unaligned head and tail are not backed by the view.
+			size_t headSize = view->imageOffset - imageOffset;
+			size_t tailBase = headSize + view->size;
+			memcpy(dst, src, headSize);
+			memcpy(dst + tailBase, src + tailBase, phdr.p_filesz - tailBase);
+			m_copiedSize += phdr.p_filesz - view->size;
+		}
+
+		retVal = true;
+	} while (false);
+
+	return retVal;
+}
@@ -36,5 +36,25 @@ private:
 	bool mapSecReloSegment(Elf64_Phdr const &phdr);
 	bool mapDataSegment(Elf64_Phdr const &phdr);
 
+	std::vector<const Elf64_Phdr *> getMappedSegments() const;
+	uint8_t *getSegmentAddress(Elf64_Phdr const &phdr) const;
+	bool copySegment(Elf64_Phdr const &phdr);
+
+	// Part of a segment mapped directly from the file.
+	struct SegmentView
+	{
+		uint64_t fileOffset;
+		size_t imageOffset;
+		size_t size;
+	};
+
+	bool getSegmentView(Elf64_Phdr const &phdr, size_t imageAddress,
+						size_t granularity, SegmentView *view) const;
+	size_t getImageAlignment() const;
+	size_t chooseImageBias(size_t granularity) const;
+	bool mapFileViews(size_t granularity, size_t imageBias, size_t regionSize);
+
 	NativeModule *m_moduleData;
+	std::vector<SegmentView> m_views;
+	size_t m_copiedSize = 0;
 };
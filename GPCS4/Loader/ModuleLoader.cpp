@@ -1,8 +1,12 @@
 #include "ModuleLoader.h"
 
 #include "UtilString.h"
+#include "UtilThreadPool.h"
 #include "Platform.h"
 
+#include <chrono>
+#include <memory>
+
 LOG_CHANNEL(Loader.ModuleLoader);
 
 #define ADD_BLACK_MODULE(name) (name".sprx")
@@ -29,10 +33,24 @@ bool ModuleLoader::loadModule(std::string const &fileName,
 	bool retVal = false;
 	do
 	{
+		using Clock = std::chrono::steady_clock;
+		auto elapsedUs = [](Clock::time_point from, Clock::time_point to)
+		{
+			return static_cast<long long>(
+				std::chrono::duration_cast<std::chrono::microseconds>(to - from).count());
+		};
+
+		auto loadBegin = Clock::now();
+
 		NativeModule mod = {};
 
-		bool exist = false;
-		retVal = loadModuleFromFile(fileName, &mod, &exist);
+		retVal = mapFilePathToModuleName(fileName, &mod.fileName);
+		if (!retVal)
+		{
+			break;
+		}
+
+		retVal = parseModuleFile(fileName, &mod);
 		if (!retVal)
 		{
 			break;
@@ -43,10 +61,9 @@ bool ModuleLoader::loadModule(std::string const &fileName,
 		mod.outputUnresolvedSymbols("unresolved_HLE.txt");
 #endif // MODSYS_OUTPUT_NOT_IMPLEMENTED_HLE
 
-		retVal = m_modSystem.registerNativeModule(mod.fileName, std::move(mod));
+		retVal = registerModule(std::move(mod));
 		if (!retVal)
 		{
-			LOG_ERR("Failed to register module: %s", mod.fileName.c_str());
 			break;
 		}
 
@@ -56,18 +73,30 @@ bool ModuleLoader::loadModule(std::string const &fileName,
 			break;
 		}
 
+		auto relocateBegin = Clock::now();
+
 		retVal = m_linker.relocateModules();
 		if (!retVal)
 		{
 			break;
 		}
 
+		auto initBegin = Clock::now();
+
 		retVal = initializeModules();
 		if (!retVal)
 		{
 			break;
 		}
 
+		auto initEnd = Clock::now();
+
+		LOG_DEBUG("startup timing: load %lld us, relocate %lld us, initialize %lld us, total %lld us",
+				  elapsedUs(loadBegin, relocateBegin),
+				  elapsedUs(relocateBegin, initBegin),
+				  elapsedUs(initBegin, initEnd),
+				  elapsedUs(loadBegin, initEnd));
+
 		*modOut = &(m_modSystem.getAllNativeModules()[0]);
 		retVal  = true;
 	} while (false);
@@ -75,135 +104,175 @@ bool ModuleLoader::loadModule(std::string const &fileName,
 	return retVal;
 }
 
-bool ModuleLoader::loadModuleFromFile(std::string const &fileName,
-									  NativeModule *mod,
-									  bool *exist)
+bool ModuleLoader::parseModuleFile(std::string const &filePath,
+								   NativeModule *mod) const
 {
 	LOG_ASSERT(mod != nullptr, "mod is nullpointer");
-	LOG_ASSERT(exist != nullptr, "mod is nullpointer");
 
-	*exist = false;
+	// ELFMapper keeps per-module state, so every module gets its own one.
+	ELFMapper mapper;
 	bool retVal = false;
 	do
 	{
-		retVal = mapFilePathToModuleName(fileName, &mod->fileName);
+		retVal = mapper.loadFile(filePath, mod);
 		if (!retVal)
 		{
 			break;
 		}
 
-		bool isLoaded = m_modSystem.isNativeModuleLoaded(mod->fileName);
-		if (isLoaded)
-		{
-			LOG_DEBUG("module %s has already been loaded", mod->fileName.c_str());
-			retVal = true;
-			*exist = true;
-			break;
-		}
-
-		retVal = m_mapper.loadFile(fileName, mod);
+		retVal = mapper.validateHeader();
 		if (!retVal)
 		{
 			break;
 		}
 
-		retVal = m_mapper.validateHeader();
+		retVal = mapper.parseSegmentHeaders();
 		if (!retVal)
 		{
 			break;
 		}
 
-		retVal = m_mapper.parseSegmentHeaders();
+		retVal = mapper.parseDynamicSection();
 		if (!retVal)
 		{
 			break;
 		}
 
-		retVal = m_mapper.parseDynamicSection();
+		retVal = mapper.mapImageIntoMemory();
 		if (!retVal)
 		{
 			break;
 		}
 
-		retVal = m_mapper.mapImageIntoMemory();
+		retVal = mapper.parseSymbols();
 		if (!retVal)
 		{
 			break;
 		}
 
-		retVal = m_mapper.parseSymbols();
-		if (!retVal)
-		{
-			break;
-		}
+		retVal = true;
+	} while (false);
+
+	return retVal;
+}
 
-		retVal = addDepedenciesToLoad(*mod);
+bool ModuleLoader::registerModule(NativeModule &&mod)
+{
+	bool retVal = false;
+	do
+	{
+		retVal = addDepedenciesToLoad(mod);
 		if (!retVal)
 		{
 			break;
 		}
 
-		for (auto &id : mod->getExportSymbols())
+		for (auto &id : mod.getExportSymbols())
 		{
 			const SymbolInfo *info = nullptr;
-			mod->getSymbol(id, &info);
+			mod.getSymbol(id, &info);
 
-			registerSymbol(*mod, info->symbolName,
+			registerSymbol(mod, info->symbolName,
 						   reinterpret_cast<void *>(info->address));
 		}
 
+		auto modName = mod.fileName;
+		retVal = m_modSystem.registerNativeModule(modName, std::move(mod));
+		if (!retVal)
+		{
+			LOG_ERR("Failed to register module: %s", modName.c_str());
+			break;
+		}
+
 		retVal = true;
 	} while (false);
 
 	return retVal;
 }
 
+// Dependencies are loaded level by level, every level is parsed
+// in parallel and then registered in queue order, so module indices
+// and TLS module ids stay the same as with serial loading.
 bool ModuleLoader::loadDependencies()
 {
 	bool retVal = true;
 	bool moduleNotFoundIgnore = false;
 
-	while (!m_filesToLoad.empty())
+	util::ThreadPool pool;
+
+	while (retVal && !m_filesToLoad.empty())
 	{
-		auto fileName = m_filesToLoad.front();
-		m_filesToLoad.pop();
+		std::vector<std::string> paths;
+		std::vector<NativeModule> mods;
+		std::set<std::string> pending;
 
-		if (!m_modSystem.isFileAllowedToLoad(fileName))
+		while (!m_filesToLoad.empty())
 		{
-			LOG_DEBUG("File %s is not loadable", fileName.c_str());
-			continue;
-		}
+			auto fileName = m_filesToLoad.front();
+			m_filesToLoad.pop();
+
+			if (!m_modSystem.isFileAllowedToLoad(fileName))
+			{
+				LOG_DEBUG("File %s is not loadable", fileName.c_str());
+				continue;
+			}
+
+			std::string path = {};
+
+			retVal = mapModuleNameToFilePath(fileName, &path);
+			if (!retVal)
+			{
+				LOG_ERR("Unable to locate file %s", fileName.c_str());
+				break;
+			}
+
+			std::string modName = {};
+			retVal = mapFilePathToModuleName(path, &modName);
+			if (!retVal)
+			{
+				break;
+			}
+
+			if (m_modSystem.isNativeModuleLoaded(modName) ||
+				pending.find(modName) != pending.end())
+			{
+				LOG_DEBUG("module %s has already been loaded", modName.c_str());
+				continue;
+			}
 
-		std::string path = {};
+			pending.insert(modName);
+			paths.push_back(std::move(path));
+			mods.emplace_back();
+			mods.back().fileName = std::move(modName);
+		}
 
-		retVal = mapModuleNameToFilePath(fileName, &path);
 		if (!retVal)
 		{
-			LOG_ERR("Unable to locate file %s", fileName.c_str());
 			break;
 		}
 
-		bool exist = false;
-		auto mod = NativeModule{};
-		retVal   = loadModuleFromFile(path, &mod, &exist);
-		if (!retVal)
+		std::unique_ptr<bool[]> results(new bool[mods.size()]);
+		pool.parallelFor(mods.size(), [&](size_t i)
+						 { results[i] = parseModuleFile(paths[i], &mods[i]); });
+
+		for (size_t i = 0; i != mods.size(); ++i)
 		{
-			LOG_ERR("Failed to load module %s", fileName.c_str());
+			if (!results[i])
+			{
+				LOG_ERR("Failed to load module %s", mods[i].fileName.c_str());
 
 #ifdef MODSYS_IGNORE_NOT_FOUND_MODULES
-			moduleNotFoundIgnore = true;
-			continue;
+				moduleNotFoundIgnore = true;
+				continue;
 #else  // MODSYS_IGNORE_NOT_FOUND_MODULES
-			break;
+				retVal = false;
+				break;
 #endif // MODSYS_IGNORE_NOT_FOUND_MODULES
-		}
+			}
 
-		if (!exist)
-		{
-			retVal = m_modSystem.registerNativeModule(mod.fileName, std::move(mod));
+			retVal = registerModule(std::move(mods[i]));
 			if (!retVal)
 			{
-				LOG_ERR("Failed to register module: %s", mod.fileName.c_str());
 				break;
 			}
 		}
@@ -11,6 +11,7 @@
 #include <queue>
 #include <set>
 #include <string>
+#include <vector>
 
 class ModuleLoader
 {
@@ -18,9 +19,9 @@ public:
 	ModuleLoader(CSceModuleSystem &modSystem, CLinker &linker);
 	bool loadModule(std::string const &fileName, NativeModule **mod);
 private:
-	bool loadModuleFromFile(std::string const &fileName,
-							NativeModule *mod,
-							bool *exist);
+	// Maps and parses a module file, safe to call concurrently.
+	bool parseModuleFile(std::string const &filePath, NativeModule *mod) const;
+	bool registerModule(NativeModule &&mod);
 	bool loadDependencies();
 	bool addDepedenciesToLoad(NativeModule const &mod);
 	bool mapModuleNameToFilePath(std::string const &modName, std::string *path);
@@ -37,7 +38,6 @@ private:
 	std::queue<std::string> m_filesToLoad;
 	CSceModuleSystem &m_modSystem;
 	CLinker &m_linker;
-	ELFMapper m_mapper;
 
 	// init_proc of modules in this black list will not be called.
 	const static std::set<std::string> m_moduleInitBlackList;
@@ -0,0 +1,190 @@
+#include "PlatFiber.h"
+
+#include <cstring>
+
+// PlatFiberSwitch(ppFromStack, pToStack)
+// Pushes the callee saved registers, stores the stack pointer to
+// *ppFromStack, loads pToStack and pops the registers saved there.
+//
+// PlatFiberStart
+// First return address of a new context, calls r12(r13).
+
+#ifdef GPCS4_WINDOWS
+
+// Microsoft x64 ABI.
+// rdi, rsi and xmm6-xmm15 are callee saved as well. The stack bounds
+// in the TIB are switched too, the unwinder and stack probes check
+// rsp against them.
+
+asm(R"(
+	.text
+	.globl PlatFiberSwitch
+	.p2align 4
+PlatFiberSwitch:
+	pushq	%rbp
+	pushq	%rbx
+	pushq	%rdi
+	pushq	%rsi
+	pushq	%r12
+	pushq	%r13
+	pushq	%r14
+	pushq	%r15
+	pushq	%gs:0x10
+	pushq	%gs:0x08
+	subq	$0xa8, %rsp
+	movups	%xmm6, 0x00(%rsp)
+	movups	%xmm7, 0x10(%rsp)
+	movups	%xmm8, 0x20(%rsp)
+	movups	%xmm9, 0x30(%rsp)
+	movups	%xmm10, 0x40(%rsp)
+	movups	%xmm11, 0x50(%rsp)
+	movups	%xmm12, 0x60(%rsp)
+	movups	%xmm13, 0x70(%rsp)
+	movups	%xmm14, 0x80(%rsp)
+	movups	%xmm15, 0x90(%rsp)
+	stmxcsr	0xa0(%rsp)
+	fnstcw	0xa4(%rsp)
+
+	movq	%rsp, (%rcx)
+	movq	%rdx, %rsp
+
+	movups	0x00(%rsp), %xmm6
+	movups	0x10(%rsp), %xmm7
+	movups	0x20(%rsp), %xmm8
+	movups	0x30(%rsp), %xmm9
+	movups	0x40(%rsp), %xmm10
+	movups	0x50(%rsp), %xmm11
+	movups	0x60(%rsp), %xmm12
+	movups	0x70(%rsp), %xmm13
+	movups	0x80(%rsp), %xmm14
+	movups	0x90(%rsp), %xmm15
+	ldmxcsr	0xa0(%rsp)
+	fldcw	0xa4(%rsp)
+	addq	$0xa8, %rsp
+	popq	%gs:0x08
+	popq	%gs:0x10
+	popq	%r15
+	popq	%r14
+	popq	%r13
+	popq	%r12
+	popq	%rsi
+	popq	%rdi
+	popq	%rbx
+	popq	%rbp
+	ret
+
+	.globl PlatFiberStart
+	.p2align 4
+PlatFiberStart:
+	movq	%r13, %rcx
+	andq	$-16, %rsp
+	subq	$32, %rsp
+	callq	*%r12
+	ud2
+)");
+
+#else
+
+// System V x64 ABI.
+
+asm(R"(
+	.text
+	.globl PlatFiberSwitch
+	.type PlatFiberSwitch, @function
+	.p2align 4
+PlatFiberSwitch:
+	pushq	%rbp
+	pushq	%rbx
+	pushq	%r12
+	pushq	%r13
+	pushq	%r14
+	pushq	%r15
+	subq	$8, %rsp
+	stmxcsr	(%rsp)
+	fnstcw	4(%rsp)
+
+	movq	%rsp, (%rdi)
+	movq	%rsi, %rsp
+
+	ldmxcsr	(%rsp)
+	fldcw	4(%rsp)
+	addq	$8, %rsp
+	popq	%r15
+	popq	%r14
+	popq	%r13
+	popq	%r12
+	popq	%rbx
+	popq	%rbp
+	ret
+	.size PlatFiberSwitch, .-PlatFiberSwitch
+
+	.globl PlatFiberStart
+	.type PlatFiberStart, @function
+	.p2align 4
+PlatFiberStart:
+	movq	%r13, %rdi
+	andq	$-16, %rsp
+	callq	*%r12
+	ud2
+	.size PlatFiberStart, .-PlatFiberStart
+)");
+
+#endif  // GPCS4_WINDOWS
+
+extern "C" void PlatFiberStart();
+
+namespace plat
+{;
+
+// Register frame as PlatFiberSwitch leaves it, lowest address first.
+struct FiberFrame
+{
+#ifdef GPCS4_WINDOWS
+	uint8_t  xmm[10][16];
+	uint32_t mxcsr;
+	uint16_t fpucw;
+	uint16_t padding;
+	void*    pStackBase;
+	void*    pStackLimit;
+	uint64_t r15;
+	uint64_t r14;
+	uint64_t r13;
+	uint64_t r12;
+	uint64_t rsi;
+	uint64_t rdi;
+	uint64_t rbx;
+	uint64_t rbp;
+#else
+	uint32_t mxcsr;
+	uint16_t fpucw;
+	uint16_t padding;
+	uint64_t r15;
+	uint64_t r14;
+	uint64_t r13;
+	uint64_t r12;
+	uint64_t rbx;
+	uint64_t rbp;
+#endif  // GPCS4_WINDOWS
+	void* pReturn;
+};
+
+void FiberContextInit(FiberContext* pContext, void* pStack, size_t nStackSize, FiberEntry fnEntry, void* pParam)
+{
+	uintptr_t nTop   = (reinterpret_cast<uintptr_t>(pStack) + nStackSize) & ~uintptr_t(15);
+	auto      pFrame = reinterpret_cast<FiberFrame*>(nTop - sizeof(FiberFrame));
+
+	std::memset(pFrame, 0, sizeof(FiberFrame));
+	pFrame->mxcsr = 0x1F80;
+	pFrame->fpucw = 0x037F;
+	pFrame->r12   = reinterpret_cast<uint64_t>(fnEntry);
+	pFrame->r13   = reinterpret_cast<uint64_t>(pParam);
+#ifdef GPCS4_WINDOWS
+	pFrame->pStackBase  = reinterpret_cast<void*>(nTop);
+	pFrame->pStackLimit = pStack;
+#endif  // GPCS4_WINDOWS
+	pFrame->pReturn = reinterpret_cast<void*>(&PlatFiberStart);
+
+	pContext->pStack = pFrame;
+}
+
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "GPCS4Common.h"
+
+// User mode context switching.
+// A suspended context is just a stack pointer, the registers the
+// host ABI asks a callee to preserve are pushed onto its own stack.
+// Nothing segment based is touched, so fibers running on a thread
+// keep the thread's host TLS and its emulated guest fs base.
+
+extern "C" void PlatFiberSwitch(void** ppFromStack, void* pToStack);
+
+namespace plat
+{
+
+struct FiberContext
+{
+	void* pStack;
+};
+
+typedef void (*FiberEntry)(void* pParam);
+
+// The context starts running fnEntry(pParam) on the given stack
+// the first time it is switched to, with the default floating
+// point control state. fnEntry must never return.
+void FiberContextInit(FiberContext* pContext, void* pStack, size_t nStackSize, FiberEntry fnEntry, void* pParam);
+
+// Suspends the running code into pFrom and resumes pTo.
+// Returns once something switches back to pFrom.
+inline void FiberContextSwitch(FiberContext* pFrom, const FiberContext* pTo)
+{
+	PlatFiberSwitch(&pFrom->pStack, pTo->pStack);
+}
+
+}
@@ -1,4 +1,7 @@
 #include "PlatFile.h"
+#include "UtilThreadPool.h"
+#include <algorithm>
+#include <atomic>
 #include <fstream>
 
 namespace plat
@@ -70,18 +73,863 @@ bool StoreFile(const std::string& strFilename, const std::vector<uint8_t>& vtDat
 }
 
 
+mapped_file_ptr MapFile(const std::string& strFilename)
+{
+	mapped_file_ptr pFile(new MappedFile{});
+	if (!MapFile(strFilename, pFile.get()))
+	{
+		pFile.reset();
+	}
+	return pFile;
+}
+
 #ifdef GPCS4_WINDOWS
 
 #define WIN32_LEAN_AND_MEAN
 #include <Windows.h>
 #undef WIN32_LEAN_AND_MEAN
 
+bool MapFile(const std::string& strFilename, MappedFile* pFile)
+{
+	bool   bRet     = false;
+	HANDLE hFile    = INVALID_HANDLE_VALUE;
+	HANDLE hMapping = nullptr;
+	do
+	{
+		if (strFilename.empty() || !pFile)
+		{
+			break;
+		}
+
+		// Execute access is required to map code segments from the file.
+		hFile = CreateFileA(strFilename.c_str(), GENERIC_READ | GENERIC_EXECUTE, FILE_SHARE_READ,
+							nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (hFile == INVALID_HANDLE_VALUE)
+		{
+			break;
+		}
+
+		LARGE_INTEGER nFileSize = {};
+		if (!GetFileSizeEx(hFile, &nFileSize) || nFileSize.QuadPart == 0)
+		{
+			break;
+		}
+
+		hMapping = CreateFileMappingA(hFile, nullptr, PAGE_EXECUTE_WRITECOPY, 0, 0, nullptr);
+		if (!hMapping)
+		{
+			break;
+		}
+
+		void* pData = MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+		if (!pData)
+		{
+			break;
+		}
+
+		pFile->pData   = reinterpret_cast<uint8_t*>(pData);
+		pFile->nSize   = static_cast<size_t>(nFileSize.QuadPart);
+		pFile->nHandle = reinterpret_cast<intptr_t>(hMapping);
+
+		hMapping = nullptr;
+		bRet     = true;
+	} while (false);
+
+	if (hMapping)
+	{
+		CloseHandle(hMapping);
+	}
+
+	// The mapping object keeps the file open.
+	if (hFile != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(hFile);
+	}
+	return bRet;
+}
+
+void UnmapFile(MappedFile* pFile)
+{
+	if (pFile->pData)
+	{
+		UnmapViewOfFile(pFile->pData);
+	}
+
+	if (pFile->nHandle)
+	{
+		CloseHandle(reinterpret_cast<HANDLE>(pFile->nHandle));
+	}
+
+	*pFile = {};
+}
+
+// ReadFile and WriteFile transfer at most 4 GiB per call.
+constexpr size_t FILE_IO_CHUNK = 0x80000000;
+
+// Handles are opened for overlapped I/O, otherwise the system
+// serializes all requests on a handle. Each thread waits on
+// its own event for the requests it issues.
+struct FileEvent
+{
+	HANDLE hEvent = CreateEventA(nullptr, TRUE, FALSE, nullptr);
+
+	~FileEvent()
+	{
+		CloseHandle(hEvent);
+	}
+};
+
+static thread_local FileEvent t_fileEvent;
+
+FileHandle FileOpen(const std::string& strFilename, uint32_t nFlags)
+{
+	DWORD dwAccess = 0;
+	if (nFlags & FOF_READ)
+	{
+		dwAccess |= GENERIC_READ;
+	}
+	if (nFlags & FOF_WRITE)
+	{
+		dwAccess |= GENERIC_WRITE;
+	}
+
+	DWORD dwDisposition = OPEN_EXISTING;
+	if (nFlags & FOF_CREATE)
+	{
+		if (nFlags & FOF_EXCLUSIVE)
+		{
+			dwDisposition = CREATE_NEW;
+		}
+		else
+		{
+			dwDisposition = (nFlags & FOF_TRUNCATE) ? CREATE_ALWAYS : OPEN_ALWAYS;
+		}
+	}
+	else if (nFlags & FOF_TRUNCATE)
+	{
+		dwDisposition = TRUNCATE_EXISTING;
+	}
+
+	HANDLE hFile = CreateFileA(strFilename.c_str(), dwAccess,
+							   FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+							   nullptr, dwDisposition,
+							   FILE_ATTRIBUTE_NORMAL | FILE_FLAG_OVERLAPPED, nullptr);
+	return reinterpret_cast<FileHandle>(hFile);
+}
+
+void FileClose(FileHandle hFile)
+{
+	CloseHandle(reinterpret_cast<HANDLE>(hFile));
+}
+
+template <bool bWrite, typename T>
+static int64_t FileTransferAt(FileHandle hFile, T* pBuffer, size_t nSize, uint64_t nOffset)
+{
+	HANDLE   hHandle = reinterpret_cast<HANDLE>(hFile);
+	uint8_t* pData   = (uint8_t*)pBuffer;
+	int64_t  nDone   = 0;
+	while (nDone < (int64_t)nSize)
+	{
+		DWORD    dwChunk  = (DWORD)std::min<size_t>(nSize - nDone, FILE_IO_CHUNK);
+		uint64_t nAt      = nOffset + nDone;
+		DWORD    dwResult = 0;
+
+		OVERLAPPED ov   = {};
+		ov.Offset       = (DWORD)nAt;
+		ov.OffsetHigh   = (DWORD)(nAt >> 32);
+		ov.hEvent       = t_fileEvent.hEvent;
+
+		BOOL bOk = bWrite ? ::WriteFile(hHandle, pData + nDone, dwChunk, nullptr, &ov)
+						  : ::ReadFile(hHandle, pData + nDone, dwChunk, nullptr, &ov);
+		if (!bOk && GetLastError() != ERROR_IO_PENDING)
+		{
+			if (GetLastError() == ERROR_HANDLE_EOF)
+			{
+				break;
+			}
+			return -1;
+		}
 
+		if (!GetOverlappedResult(hHandle, &ov, &dwResult, TRUE))
+		{
+			if (GetLastError() == ERROR_HANDLE_EOF)
+			{
+				break;
+			}
+			return -1;
+		}
+
+		nDone += dwResult;
+		if (dwResult != dwChunk)
+		{
+			break;
+		}
+	}
+	return nDone;
+}
 
+int64_t FileReadAt(FileHandle hFile, void* pBuffer, size_t nSize, uint64_t nOffset)
+{
+	return FileTransferAt<false>(hFile, pBuffer, nSize, nOffset);
+}
+
+int64_t FileWriteAt(FileHandle hFile, const void* pBuffer, size_t nSize, uint64_t nOffset)
+{
+	return FileTransferAt<true>(hFile, pBuffer, nSize, nOffset);
+}
+
+int64_t FileGetSize(FileHandle hFile)
+{
+	LARGE_INTEGER nFileSize = {};
+	if (!GetFileSizeEx(reinterpret_cast<HANDLE>(hFile), &nFileSize))
+	{
+		return -1;
+	}
+	return nFileSize.QuadPart;
+}
+
+bool FileSetSize(FileHandle hFile, uint64_t nSize)
+{
+	FILE_END_OF_FILE_INFO info = {};
+	info.EndOfFile.QuadPart    = nSize;
+	return SetFileInformationByHandle(reinterpret_cast<HANDLE>(hFile),
+									  FileEndOfFileInfo, &info, sizeof(info));
+}
+
+bool FileSync(FileHandle hFile)
+{
+	return FlushFileBuffers(reinterpret_cast<HANDLE>(hFile));
+}
 
 #else
 
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+bool MapFile(const std::string& strFilename, MappedFile* pFile)
+{
+	bool bRet = false;
+	int  fd   = -1;
+	do
+	{
+		if (strFilename.empty() || !pFile)
+		{
+			break;
+		}
+
+		fd = open(strFilename.c_str(), O_RDONLY | O_CLOEXEC);
+		if (fd < 0)
+		{
+			break;
+		}
+
+		struct stat st = {};
+		if (fstat(fd, &st) != 0 || st.st_size == 0)
+		{
+			break;
+		}
+
+		void* pData = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (pData == MAP_FAILED)
+		{
+			break;
+		}
+
+		pFile->pData   = reinterpret_cast<uint8_t*>(pData);
+		pFile->nSize   = static_cast<size_t>(st.st_size);
+		pFile->nHandle = fd;
+
+		fd   = -1;
+		bRet = true;
+	} while (false);
+
+	if (fd >= 0)
+	{
+		close(fd);
+	}
+	return bRet;
+}
+
+void UnmapFile(MappedFile* pFile)
+{
+	if (pFile->pData)
+	{
+		munmap(pFile->pData, pFile->nSize);
+		close(static_cast<int>(pFile->nHandle));
+	}
+
+	*pFile = {};
+}
+
+FileHandle FileOpen(const std::string& strFilename, uint32_t nFlags)
+{
+	int oflag = O_CLOEXEC;
+	switch (nFlags & FOF_READ_WRITE)
+	{
+	case FOF_WRITE:
+		oflag |= O_WRONLY;
+		break;
+	case FOF_READ_WRITE:
+		oflag |= O_RDWR;
+		break;
+	default:
+		oflag |= O_RDONLY;
+		break;
+	}
+
+	if (nFlags & FOF_CREATE)
+	{
+		oflag |= O_CREAT;
+	}
+	if (nFlags & FOF_TRUNCATE)
+	{
+		oflag |= O_TRUNC;
+	}
+	if (nFlags & FOF_EXCLUSIVE)
+	{
+		oflag |= O_EXCL;
+	}
+
+	return open(strFilename.c_str(), oflag, 0644);
+}
+
+void FileClose(FileHandle hFile)
+{
+	close(static_cast<int>(hFile));
+}
+
+template <bool bWrite, typename T>
+static int64_t FileTransferAt(FileHandle hFile, T* pBuffer, size_t nSize, uint64_t nOffset)
+{
+	int      fd    = static_cast<int>(hFile);
+	uint8_t* pData = (uint8_t*)pBuffer;
+	int64_t  nDone = 0;
+	while (nDone < (int64_t)nSize)
+	{
+		ssize_t nResult = bWrite ? pwrite(fd, pData + nDone, nSize - nDone, nOffset + nDone)
+								 : pread(fd, pData + nDone, nSize - nDone, nOffset + nDone);
+		if (nResult < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+			return -1;
+		}
+
+		if (nResult == 0)
+		{
+			break;
+		}
+		nDone += nResult;
+	}
+	return nDone;
+}
+
+int64_t FileReadAt(FileHandle hFile, void* pBuffer, size_t nSize, uint64_t nOffset)
+{
+	return FileTransferAt<false>(hFile, pBuffer, nSize, nOffset);
+}
+
+int64_t FileWriteAt(FileHandle hFile, const void* pBuffer, size_t nSize, uint64_t nOffset)
+{
+	return FileTransferAt<true>(hFile, pBuffer, nSize, nOffset);
+}
+
+int64_t FileGetSize(FileHandle hFile)
+{
+	struct stat st = {};
+	if (fstat(static_cast<int>(hFile), &st) != 0)
+	{
+		return -1;
+	}
+	return st.st_size;
+}
+
+bool FileSetSize(FileHandle hFile, uint64_t nSize)
+{
+	return ftruncate(static_cast<int>(hFile), nSize) == 0;
+}
+
+bool FileSync(FileHandle hFile)
+{
+	return fsync(static_cast<int>(hFile)) == 0;
+}
+
+
+#ifdef GPCS4_IO_URING
+
+#include <cstring>
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+
+// One ring per thread, so submitting needs no lock.
+// Reads small enough for a bounce buffer go through the
+// registered buffers, which saves pinning the guest pages
+// on every read, larger ones read into the guest buffer.
+class FileRing
+{
+	static constexpr uint32_t QueueDepth  = 64;
+	static constexpr uint32_t BounceCount = 32;
+	static constexpr size_t   BounceSize  = 64 * 1024;
+
+public:
+	FileRing();
+	~FileRing();
+
+	bool IsValid() const
+	{
+		return m_fd >= 0;
+	}
+
+	void ReadBatch(FileReadRequest* pRequests, size_t nCount);
+
+	static bool IsSupported();
+
+private:
+	bool setup();
+
+	void release();
+
+	void prepRead(FileReadRequest& request, size_t nIndex, int32_t& nBounce, iovec& iov);
+
+	int enter(uint32_t nSubmit, uint32_t nWait);
+
+private:
+	int m_fd = -1;
+
+	void*  m_pSqRing    = nullptr;
+	size_t m_nSqRingSize = 0;
+	void*  m_pCqRing    = nullptr;
+	size_t m_nCqRingSize = 0;
+
+	uint32_t*     m_pSqTail  = nullptr;
+	uint32_t*     m_pSqMask  = nullptr;
+	uint32_t*     m_pSqArray = nullptr;
+	io_uring_sqe* m_pSqes    = nullptr;
+	uint32_t      m_nSqes    = 0;
+
+	uint32_t*     m_pCqHead = nullptr;
+	uint32_t*     m_pCqTail = nullptr;
+	uint32_t*     m_pCqMask = nullptr;
+	io_uring_cqe* m_pCqes   = nullptr;
+
+	uint8_t*              m_pBounce = nullptr;
+	bool                  m_bFixed  = false;
+	std::vector<uint32_t> m_vtFreeBounce;
+
+	// Prepared but not taken by the kernel yet
+	uint32_t m_nUnsubmitted = 0;
+};
+
+FileRing::FileRing()
+{
+	if (!setup())
+	{
+		release();
+	}
+}
+
+FileRing::~FileRing()
+{
+	release();
+}
+
+void FileRing::release()
+{
+	if (m_pBounce)
+	{
+		munmap(m_pBounce, BounceCount * BounceSize);
+		m_pBounce = nullptr;
+	}
+	if (m_pSqes)
+	{
+		munmap(m_pSqes, m_nSqes * sizeof(io_uring_sqe));
+		m_pSqes = nullptr;
+	}
+	if (m_pCqRing && m_pCqRing != m_pSqRing)
+	{
+		munmap(m_pCqRing, m_nCqRingSize);
+	}
+	m_pCqRing = nullptr;
+	if (m_pSqRing)
+	{
+		munmap(m_pSqRing, m_nSqRingSize);
+		m_pSqRing = nullptr;
+	}
+	if (m_fd >= 0)
+	{
+		close(m_fd);
+		m_fd = -1;
+	}
+}
+
+bool FileRing::IsSupported()
+{
+	static const bool s_bSupported = []()
+	{
+		io_uring_params params = {};
+		int             fd     = syscall(__NR_io_uring_setup, 1, &params);
+		if (fd < 0)
+		{
+			return false;
+		}
+		close(fd);
+		return true;
+	}();
+	return s_bSupported;
+}
+
+bool FileRing::setup()
+{
+	bool bRet = false;
+	do
+	{
+		io_uring_params params = {};
+		m_fd = syscall(__NR_io_uring_setup, QueueDepth, &params);
+		if (m_fd < 0)
+		{
+			break;
+		}
+
+		m_nSqRingSize = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+		m_nCqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+		bool bSingleMap = params.features & IORING_FEAT_SINGLE_MMAP;
+		if (bSingleMap)
+		{
+			m_nSqRingSize = m_nCqRingSize = std::max(m_nSqRingSize, m_nCqRingSize);
+		}
+
+		void* pRing = mmap(nullptr, m_nSqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_SQ_RING);
+		if (pRing == MAP_FAILED)
+		{
+			break;
+		}
+		m_pSqRing = pRing;
+
+		if (bSingleMap)
+		{
+			m_pCqRing = m_pSqRing;
+		}
+		else
+		{
+			pRing = mmap(nullptr, m_nCqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_CQ_RING);
+			if (pRing == MAP_FAILED)
+			{
+				break;
+			}
+			m_pCqRing = pRing;
+		}
+
+		void* pSqes = mmap(nullptr, params.sq_entries * sizeof(io_uring_sqe), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_SQES);
+		if (pSqes == MAP_FAILED)
+		{
+			break;
+		}
+		m_pSqes = reinterpret_cast<io_uring_sqe*>(pSqes);
+		m_nSqes = params.sq_entries;
+
+		uint8_t* pSq = reinterpret_cast<uint8_t*>(m_pSqRing);
+		m_pSqTail    = reinterpret_cast<uint32_t*>(pSq + params.sq_off.tail);
+		m_pSqMask    = reinterpret_cast<uint32_t*>(pSq + params.sq_off.ring_mask);
+		m_pSqArray   = reinterpret_cast<uint32_t*>(pSq + params.sq_off.array);
+
+		uint8_t* pCq = reinterpret_cast<uint8_t*>(m_pCqRing);
+		m_pCqHead    = reinterpret_cast<uint32_t*>(pCq + params.cq_off.head);
+		m_pCqTail    = reinterpret_cast<uint32_t*>(pCq + params.cq_off.tail);
+		m_pCqMask    = reinterpret_cast<uint32_t*>(pCq + params.cq_off.ring_mask);
+		m_pCqes      = reinterpret_cast<io_uring_cqe*>(pCq + params.cq_off.cqes);
+
+		// Registering fails if the memlock limit is too low,
+		// the ring still works without fixed buffers then.
+		void* pBounce = mmap(nullptr, BounceCount * BounceSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (pBounce != MAP_FAILED)
+		{
+			m_pBounce = reinterpret_cast<uint8_t*>(pBounce);
+
+			iovec vecs[BounceCount];
+			for (uint32_t i = 0; i != BounceCount; ++i)
+			{
+				vecs[i].iov_base = m_pBounce + i * BounceSize;
+				vecs[i].iov_len  = BounceSize;
+			}
+
+			m_bFixed = syscall(__NR_io_uring_register, m_fd, IORING_REGISTER_BUFFERS, vecs, BounceCount) == 0;
+			for (uint32_t i = 0; m_bFixed && i != BounceCount; ++i)
+			{
+				m_vtFreeBounce.push_back(i);
+			}
+		}
+
+		bRet = true;
+	} while (false);
+	return bRet;
+}
+
+int FileRing::enter(uint32_t nSubmit, uint32_t nWait)
+{
+	int nRet = syscall(__NR_io_uring_enter, m_fd, nSubmit, nWait, nWait ? IORING_ENTER_GETEVENTS : 0, nullptr, 0);
+	return nRet < 0 ? -errno : nRet;
+}
+
+void FileRing::prepRead(FileReadRequest& request, size_t nIndex, int32_t& nBounce, iovec& iov)
+{
+	uint32_t nTail = *m_pSqTail;
+	uint32_t nSlot = nTail & *m_pSqMask;
+
+	size_t   nRemain = request.nSize - request.nResult;
+	uint64_t nOffset = request.nOffset + request.nResult;
+
+	if (nBounce < 0 && nRemain <= BounceSize && !m_vtFreeBounce.empty())
+	{
+		nBounce = m_vtFreeBounce.back();
+		m_vtFreeBounce.pop_back();
+	}
+
+	io_uring_sqe* pSqe = &m_pSqes[nSlot];
+	std::memset(pSqe, 0, sizeof(io_uring_sqe));
+	pSqe->fd        = static_cast<int>(request.hFile);
+	pSqe->off       = nOffset;
+	pSqe->user_data = nIndex;
+	if (nBounce >= 0)
+	{
+		pSqe->opcode    = IORING_OP_READ_FIXED;
+		pSqe->addr      = reinterpret_cast<uint64_t>(m_pBounce + nBounce * BounceSize);
+		pSqe->len       = nRemain;
+		pSqe->buf_index = nBounce;
+	}
+	else
+	{
+		iov.iov_base = reinterpret_cast<uint8_t*>(request.pBuffer) + request.nResult;
+		iov.iov_len  = nRemain;
+
+		pSqe->opcode = IORING_OP_READV;
+		pSqe->addr   = reinterpret_cast<uint64_t>(&iov);
+		pSqe->len    = 1;
+	}
+
+	m_pSqArray[nSlot] = nSlot;
+	__atomic_store_n(m_pSqTail, nTail + 1, __ATOMIC_RELEASE);
+	++m_nUnsubmitted;
+}
+
+void FileRing::ReadBatch(FileReadRequest* pRequests, size_t nCount)
+{
+	std::vector<int32_t> vtBounce(nCount, -1);
+	std::vector<iovec>   vtIov(nCount);
+	std::vector<bool>    vtFailed(nCount, false);
+
+	// Requests to submit, reads which came back short are queued again.
+	std::vector<size_t> vtQueue(nCount);
+	for (size_t i = 0; i != nCount; ++i)
+	{
+		pRequests[i].nResult = 0;
+		vtQueue[i]           = i;
+	}
+
+	size_t   nQueueHead = 0;
+	uint32_t nInFlight  = 0;
+	while (nQueueHead != vtQueue.size() || nInFlight)
+	{
+		while (nQueueHead != vtQueue.size() && nInFlight + m_nUnsubmitted < m_nSqes)
+		{
+			size_t nIndex = vtQueue[nQueueHead++];
+			prepRead(pRequests[nIndex], nIndex, vtBounce[nIndex], vtIov[nIndex]);
+		}
+
+		// Submit and wait in one call.
+		int nSubmitted = enter(m_nUnsubmitted, 1);
+		if (nSubmitted < 0)
+		{
+			if (nSubmitted == -EINTR || nSubmitted == -EAGAIN || nSubmitted == -EBUSY)
+			{
+				continue;
+			}
+
+			// Nothing was taken, read the prepared requests
+			// and the rest of the queue without the ring.
+			__atomic_store_n(m_pSqTail, *m_pSqTail - m_nUnsubmitted, __ATOMIC_RELEASE);
+			for (size_t i = nQueueHead - m_nUnsubmitted; i != vtQueue.size(); ++i)
+			{
+				size_t           nIndex  = vtQueue[i];
+				FileReadRequest& request = pRequests[nIndex];
+				if (vtBounce[nIndex] >= 0)
+				{
+					m_vtFreeBounce.push_back(vtBounce[nIndex]);
+					vtBounce[nIndex] = -1;
+				}
+
+				int64_t nResult = FileReadAt(request.hFile, reinterpret_cast<uint8_t*>(request.pBuffer) + request.nResult,
+											 request.nSize - request.nResult, request.nOffset + request.nResult);
+				if (nResult < 0)
+				{
+					vtFailed[nIndex] = true;
+				}
+				else
+				{
+					request.nResult += nResult;
+				}
+			}
+			vtQueue.resize(nQueueHead - m_nUnsubmitted);
+			nQueueHead     = vtQueue.size();
+			m_nUnsubmitted = 0;
+
+			// Reads already in flight still have to complete.
+			if (nInFlight && enter(0, 1) < 0)
+			{
+				continue;
+			}
+		}
+		else
+		{
+			m_nUnsubmitted -= nSubmitted;
+			nInFlight += nSubmitted;
+		}
+
+		uint32_t nHead = *m_pCqHead;
+		uint32_t nTail = __atomic_load_n(m_pCqTail, __ATOMIC_ACQUIRE);
+		for (; nHead != nTail; ++nHead)
+		{
+			const io_uring_cqe& cqe     = m_pCqes[nHead & *m_pCqMask];
+			size_t              nIndex  = cqe.user_data;
+			int32_t             nResult = cqe.res;
+			FileReadRequest&    request = pRequests[nIndex];
+			--nInFlight;
+
+			bool bDone = true;
+			if (nResult == -EINTR || nResult == -EAGAIN)
+			{
+				bDone = false;
+			}
+			else if (nResult < 0)
+			{
+				vtFailed[nIndex] = true;
+			}
+			else
+			{
+				if (vtBounce[nIndex] >= 0)
+				{
+					std::memcpy(reinterpret_cast<uint8_t*>(request.pBuffer) + request.nResult,
+								m_pBounce + vtBounce[nIndex] * BounceSize, nResult);
+				}
+				request.nResult += nResult;
+				bDone = nResult == 0 || request.nResult == int64_t(request.nSize);
+			}
+
+			if (bDone)
+			{
+				if (vtBounce[nIndex] >= 0)
+				{
+					m_vtFreeBounce.push_back(vtBounce[nIndex]);
+					vtBounce[nIndex] = -1;
+				}
+			}
+			else
+			{
+				vtQueue.push_back(nIndex);
+			}
+		}
+		__atomic_store_n(m_pCqHead, nHead, __ATOMIC_RELEASE);
+	}
+
+	for (size_t i = 0; i != nCount; ++i)
+	{
+		if (vtFailed[i])
+		{
+			pRequests[i].nResult = -1;
+		}
+	}
+}
+
+static FileRing* GetFileRing()
+{
+	thread_local std::unique_ptr<FileRing> t_pRing;
+	if (!t_pRing)
+	{
+		t_pRing = std::make_unique<FileRing>();
+	}
+	return t_pRing->IsValid() ? t_pRing.get() : nullptr;
+}
+
+#endif  // GPCS4_IO_URING
 
 #endif  //GPCS4_WINDOWS
 
+static util::ThreadPool& GetFileIoPool()
+{
+	// Leaked, reads may still be issued while statics are destroyed.
+	static util::ThreadPool* s_pPool = new util::ThreadPool(
+		std::min(8u, std::max(1u, std::thread::hardware_concurrency())));
+	return *s_pPool;
+}
+
+static bool IsIoUringSupported()
+{
+#ifdef GPCS4_IO_URING
+	return FileRing::IsSupported();
+#else
+	return false;
+#endif
+}
+
+static std::atomic<FILE_IO_BACKEND>& IoBackend()
+{
+	static std::atomic<FILE_IO_BACKEND> s_nBackend(
+		IsIoUringSupported() ? FIB_IO_URING : FIB_THREAD_POOL);
+	return s_nBackend;
+}
+
+void FileReadBatch(FileReadRequest* pRequests, size_t nCount)
+{
+	do
+	{
+		if (nCount == 1)
+		{
+			pRequests[0].nResult = FileReadAt(pRequests[0].hFile, pRequests[0].pBuffer,
+											  pRequests[0].nSize, pRequests[0].nOffset);
+			break;
+		}
+
+#ifdef GPCS4_IO_URING
+		if (IoBackend().load(std::memory_order_relaxed) == FIB_IO_URING)
+		{
+			// Setting up the ring of this thread may still fail.
+			FileRing* pRing = GetFileRing();
+			if (pRing)
+			{
+				pRing->ReadBatch(pRequests, nCount);
+				break;
+			}
+		}
+#endif
+
+		GetFileIoPool().parallelFor(nCount, [pRequests](size_t i)
+									{
+										FileReadRequest& request = pRequests[i];
+										request.nResult          = FileReadAt(request.hFile, request.pBuffer,
+																			  request.nSize, request.nOffset);
+									});
+	} while (false);
+}
+
+FILE_IO_BACKEND FileGetIoBackend()
+{
+	return IoBackend().load();
+}
+
+bool FileSetIoBackend(FILE_IO_BACKEND nBackend)
+{
+	if (nBackend == FIB_IO_URING && !IsIoUringSupported())
+	{
+		return false;
+	}
+	IoBackend().store(nBackend);
+	return true;
+}
+
 }
@@ -28,4 +28,102 @@ struct FileCloser
 
 typedef std::unique_ptr<FILE, FileCloser> file_uptr;
 
+// A read only view of a whole file, backed by the page cache.
+// Parts of the file can be mapped copy-on-write into
+// an image region using VMMapFileView.
+struct MappedFile
+{
+	uint8_t* pData;
+	size_t   nSize;
+	// file mapping object on Windows, file descriptor on Linux
+	intptr_t nHandle;
+};
+
+bool MapFile(const std::string& strFilename, MappedFile* pFile);
+
+void UnmapFile(MappedFile* pFile);
+
+struct FileUnMapper
+{
+	void operator()(MappedFile* pFile) const noexcept
+	{
+		if (pFile != nullptr)
+		{
+			UnmapFile(pFile);
+			delete pFile;
+		}
+	}
+};
+
+typedef std::unique_ptr<MappedFile, FileUnMapper> mapped_file_ptr;
+
+mapped_file_ptr MapFile(const std::string& strFilename);
+
+// Host files
+// Reads and writes are positional, they neither use nor move
+// a file position, so any number of threads can issue them
+// on the same handle in parallel. Keeping a file position,
+// if needed, is up to the caller.
+
+// HANDLE on Windows, file descriptor on Linux
+typedef intptr_t FileHandle;
+
+constexpr FileHandle INVALID_FILE_HANDLE = -1;
+
+enum FILE_OPEN_FLAG
+{
+	FOF_READ       = 0x00000001,
+	FOF_WRITE      = 0x00000002,
+	FOF_READ_WRITE = FOF_READ | FOF_WRITE,
+	FOF_CREATE     = 0x00000010,
+	FOF_TRUNCATE   = 0x00000020,
+	FOF_EXCLUSIVE  = 0x00000040,
+};
+
+FileHandle FileOpen(const std::string& strFilename, uint32_t nFlags);
+
+void FileClose(FileHandle hFile);
+
+// Return the number of bytes transferred, which is only less than
+// nSize at the end of the file, or -1 on error.
+int64_t FileReadAt(FileHandle hFile, void* pBuffer, size_t nSize, uint64_t nOffset);
+
+int64_t FileWriteAt(FileHandle hFile, const void* pBuffer, size_t nSize, uint64_t nOffset);
+
+// Returns -1 on error.
+int64_t FileGetSize(FileHandle hFile);
+
+bool FileSetSize(FileHandle hFile, uint64_t nSize);
+
+bool FileSync(FileHandle hFile);
+
+// Batched reads
+// All reads of a batch are in flight at the same time. Linux builds
+// with GPCS4_IO_URING submit them to an io_uring, other hosts, and
+// kernels without io_uring, spread them over a thread pool.
+
+struct FileReadRequest
+{
+	FileHandle hFile;
+	void*      pBuffer;
+	size_t     nSize;
+	uint64_t   nOffset;
+	// Set to what FileReadAt would return.
+	int64_t nResult;
+};
+
+enum FILE_IO_BACKEND
+{
+	FIB_THREAD_POOL,
+	FIB_IO_URING,
+};
+
+// Blocks until all requests are done.
+void FileReadBatch(FileReadRequest* pRequests, size_t nCount);
+
+FILE_IO_BACKEND FileGetIoBackend();
+
+// Returns false if the backend is not supported.
+bool FileSetIoBackend(FILE_IO_BACKEND nBackend);
+
 }
@@ -1,4 +1,6 @@
 #include "PlatMemory.h"
+#include "PlatFile.h"
+#include "UtilMath.h"
 
 LOG_CHANNEL(Platform.UtilMemory);
 
@@ -11,6 +13,7 @@ namespace plat
 
 #define WIN32_LEAN_AND_MEAN
 #include <Windows.h>
+#include <Psapi.h>
 #undef WIN32_LEAN_AND_MEAN
 
 // GPCS4 flag to Windows flag
@@ -209,11 +212,232 @@ bool VMQuery(void* pAddress, MemoryInformation* pInfo)
 	return ret;
 }
 
+size_t VMResidentSize()
+{
+	PROCESS_MEMORY_COUNTERS pmc = {};
+	pmc.cb                      = sizeof(pmc);
+	return GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)) ? pmc.WorkingSetSize : 0;
+}
+
+// Placeholder APIs are only available since Windows 10 1803,
+// load them at runtime and fall back to committed memory without them.
+struct PlaceholderApi
+{
+	decltype(&VirtualAlloc2)  pfnVirtualAlloc2  = nullptr;
+	decltype(&MapViewOfFile3) pfnMapViewOfFile3 = nullptr;
+
+	PlaceholderApi()
+	{
+		HMODULE hKernelBase = GetModuleHandleA("kernelbase.dll");
+		if (hKernelBase)
+		{
+			pfnVirtualAlloc2 = reinterpret_cast<decltype(&VirtualAlloc2)>(
+				GetProcAddress(hKernelBase, "VirtualAlloc2"));
+			pfnMapViewOfFile3 = reinterpret_cast<decltype(&MapViewOfFile3)>(
+				GetProcAddress(hKernelBase, "MapViewOfFile3"));
+		}
+	}
+
+	bool supported() const
+	{
+		return pfnVirtualAlloc2 && pfnMapViewOfFile3;
+	}
+};
+
+static const PlaceholderApi& GetPlaceholderApi()
+{
+	static PlaceholderApi api;
+	return api;
+}
+
+// Splits the placeholder containing the range, so that the range
+// becomes a placeholder on its own. This fails if the range
+// already is a whole placeholder, which is fine.
+inline void SplitPlaceholder(void* pAddress, size_t nSize)
+{
+	VirtualFree(pAddress, nSize, MEM_RELEASE | MEM_PRESERVE_PLACEHOLDER);
+}
+
+size_t VMMapGranularity()
+{
+	size_t nGranularity = 0;
+	if (GetPlaceholderApi().supported())
+	{
+		SYSTEM_INFO si = {};
+		GetSystemInfo(&si);
+		nGranularity = si.dwAllocationGranularity;
+	}
+	return nGranularity;
+}
+
+void* VMReserveImage(size_t nSize, size_t nAlign)
+{
+	auto& api = GetPlaceholderApi();
+	if (!api.supported())
+	{
+		return VMAllocateAlign(nullptr, nSize, nAlign, VMAT_RESERVE_COMMIT, VMPF_CPU_RWX);
+	}
+
+#ifdef GPCS4_DEBUG
+	// Same as VMAllocateAlign, keep image addresses
+	// identical to those in Ida Pro.
+	nAlign = 0x10000000;
+#endif
+
+	MEM_ADDRESS_REQUIREMENTS addressReqs = {};
+	addressReqs.Alignment                = util::align(nAlign, VMMapGranularity());
+
+	MEM_EXTENDED_PARAMETER param = {};
+	param.Type                   = MemExtendedParameterAddressRequirements;
+	param.Pointer                = &addressReqs;
+
+	return api.pfnVirtualAlloc2(GetCurrentProcess(), nullptr, nSize,
+								MEM_RESERVE | MEM_RESERVE_PLACEHOLDER, PAGE_NOACCESS,
+								&param, 1);
+}
+
+bool VMMapFileView(void* pAddress, size_t nSize,
+	const MappedFile& file, uint64_t nOffset)
+{
+	auto& api = GetPlaceholderApi();
+	if (!api.supported())
+	{
+		return false;
+	}
+
+	SplitPlaceholder(pAddress, nSize);
+	void* pView = api.pfnMapViewOfFile3(reinterpret_cast<HANDLE>(file.nHandle), GetCurrentProcess(),
+										pAddress, nOffset, nSize,
+										MEM_REPLACE_PLACEHOLDER, PAGE_EXECUTE_WRITECOPY,
+										nullptr, 0);
+	return pView == pAddress;
+}
+
+bool VMCommitImage(void* pAddress, size_t nSize)
+{
+	auto& api = GetPlaceholderApi();
+	if (!api.supported())
+	{
+		// already committed by VMReserveImage
+		return true;
+	}
+
+	SplitPlaceholder(pAddress, nSize);
+	void* pMem = api.pfnVirtualAlloc2(GetCurrentProcess(), pAddress, nSize,
+									  MEM_RESERVE | MEM_COMMIT | MEM_REPLACE_PLACEHOLDER,
+									  PAGE_EXECUTE_READWRITE, nullptr, 0);
+	return pMem == pAddress;
+}
+
+void VMFreeImage(void* pAddress, size_t nSize)
+{
+	// An image is made of multiple allocations and views,
+	// release them one by one.
+	uint8_t* pCurrent = reinterpret_cast<uint8_t*>(pAddress);
+	uint8_t* pEnd     = pCurrent + nSize;
+	while (pCurrent < pEnd)
+	{
+		MEMORY_BASIC_INFORMATION mbi = {};
+		if (VirtualQuery(pCurrent, &mbi, sizeof(mbi)) == 0)
+		{
+			break;
+		}
+
+		if (mbi.Type == MEM_MAPPED)
+		{
+			UnmapViewOfFile(mbi.AllocationBase);
+		}
+		else if (mbi.State != MEM_FREE)
+		{
+			VirtualFree(mbi.AllocationBase, 0, MEM_RELEASE);
+		}
+
+		pCurrent = reinterpret_cast<uint8_t*>(mbi.BaseAddress) + mbi.RegionSize;
+	}
+}
 
 #elif defined(GPCS4_LINUX)
 
 //TODO: Other platform implementation 
 
+#include <cstdio>
+#include <sys/mman.h>
+#include <unistd.h>
+
+size_t VMResidentSize()
+{
+	size_t nResident = 0;
+	FILE*  fp        = fopen("/proc/self/statm", "r");
+	if (fp)
+	{
+		unsigned long nPages = 0, nResidentPages = 0;
+		if (fscanf(fp, "%lu %lu", &nPages, &nResidentPages) == 2)
+		{
+			nResident = nResidentPages * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+		}
+		fclose(fp);
+	}
+	return nResident;
+}
+
+size_t VMMapGranularity()
+{
+	return static_cast<size_t>(sysconf(_SC_PAGESIZE));
+}
+
+void* VMReserveImage(size_t nSize, size_t nAlign)
+{
+	void* pAlignedAddr = nullptr;
+	do
+	{
+		nAlign = util::align(nAlign, VMMapGranularity());
+
+		// Over reserve and trim to get an aligned region.
+		size_t nReserveSize = nSize + nAlign;
+		void*  pAddr        = mmap(nullptr, nReserveSize, PROT_NONE,
+							   MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+		if (pAddr == MAP_FAILED)
+		{
+			break;
+		}
+
+		uintptr_t nBegin   = reinterpret_cast<uintptr_t>(pAddr);
+		uintptr_t nAligned = util::align(nBegin, nAlign);
+		uintptr_t nEnd     = nBegin + nReserveSize;
+		if (nAligned != nBegin)
+		{
+			munmap(pAddr, nAligned - nBegin);
+		}
+		if (nAligned + nSize != nEnd)
+		{
+			munmap(reinterpret_cast<void*>(nAligned + nSize), nEnd - nAligned - nSize);
+		}
+
+		pAlignedAddr = reinterpret_cast<void*>(nAligned);
+	} while (false);
+	return pAlignedAddr;
+}
+
+bool VMMapFileView(void* pAddress, size_t nSize,
+	const MappedFile& file, uint64_t nOffset)
+{
+	void* pView = mmap(pAddress, nSize, PROT_READ | PROT_WRITE | PROT_EXEC,
+					   MAP_PRIVATE | MAP_FIXED, static_cast<int>(file.nHandle), nOffset);
+	return pView == pAddress;
+}
+
+bool VMCommitImage(void* pAddress, size_t nSize)
+{
+	void* pMem = mmap(pAddress, nSize, PROT_READ | PROT_WRITE | PROT_EXEC,
+					  MAP_PRIVATE | MAP_FIXED | MAP_ANONYMOUS, -1, 0);
+	return pMem == pAddress;
+}
+
+void VMFreeImage(void* pAddress, size_t nSize)
+{
+	munmap(pAddress, nSize);
+}
+
 #endif  //GPCS4_WINDOWS
 
 }
\ No newline at end of file
@@ -61,6 +61,33 @@ bool VMProtect(void* pAddress, size_t nSize,
 
 bool VMQuery(void* pAddress, MemoryInformation* pInfo);
 
+// Resident set size of the process in bytes, 0 if unknown.
+size_t VMResidentSize();
+
+// Image regions
+// A module image is reserved first, then every part of it is either
+// mapped copy-on-write from a file, or committed as anonymous memory.
+// Unless touched, file backed pages are shared with the page cache.
+
+struct MappedFile;
+
+// Granularity of file views inside an image region,
+// both the file offset and the address must be aligned to it.
+// An image need not start at a granule, it may be placed
+// anywhere inside a larger region, see ImageUnMapper.
+// Returns 0 if file views are not supported, in which case
+// VMReserveImage returns committed memory.
+size_t VMMapGranularity();
+
+void* VMReserveImage(size_t nSize, size_t nAlign);
+
+bool VMMapFileView(void* pAddress, size_t nSize,
+	const MappedFile& file, uint64_t nOffset);
+
+bool VMCommitImage(void* pAddress, size_t nSize);
+
+void VMFreeImage(void* pAddress, size_t nSize);
+
 struct MemoryUnMapper
 {
 	void operator()(void* pMem) const noexcept
@@ -75,4 +102,22 @@ struct MemoryUnMapper
 // auto release smart memory pointer
 typedef std::unique_ptr<uint8_t, MemoryUnMapper> memory_ptr;
 
+// Frees the region an image was placed in,
+// which starts nBias bytes before the image.
+struct ImageUnMapper
+{
+	size_t nSize = 0;
+	size_t nBias = 0;
+
+	void operator()(uint8_t* pMem) const noexcept
+	{
+		if (pMem != nullptr)
+		{
+			VMFreeImage(pMem - nBias, nSize);
+		}
+	}
+};
+
+typedef std::unique_ptr<uint8_t, ImageUnMapper> image_ptr;
+
 }
\ No newline at end of file
@@ -7,8 +7,6 @@
 namespace plat
 {
 
-std::string PS4PathToPCPath(const std::string& strPs4Path);
-
 size_t FileCountInDirectory(const std::string& path);
 
 bool splitFileName(std::string const &fileName,
@@ -1,5 +1,8 @@
 #include "PlatThread.h"
 
+#include <cerrno>
+#include <limits>
+
 namespace plat
 {;
 
@@ -9,6 +12,8 @@ namespace plat
 #include <Windows.h>
 #undef WIN32_LEAN_AND_MEAN
 
+#pragma comment(lib, "Synchronization.lib")
+
 
 uint64_t GetThreadId(void)
 {
@@ -20,10 +25,55 @@ void ThreadYield()
 	SwitchToThread();
 }
 
+bool FutexWait(volatile uint32_t* addr, uint32_t expected, const uint64_t* timeoutUs)
+{
+	DWORD timeoutMs = INFINITE;
+	if (timeoutUs)
+	{
+		// round up, so that a short timeout won't become a busy poll
+		uint64_t ms = (*timeoutUs + 999) / 1000;
+		timeoutMs   = ms >= INFINITE ? INFINITE - 1 : static_cast<DWORD>(ms);
+	}
+
+	BOOL ret = WaitOnAddress(addr, &expected, sizeof(uint32_t), timeoutMs);
+	return ret || GetLastError() != ERROR_TIMEOUT;
+}
+
+void FutexWakeOne(volatile uint32_t* addr)
+{
+	WakeByAddressSingle(const_cast<uint32_t*>(addr));
+}
+
+void FutexWakeAll(volatile uint32_t* addr)
+{
+	WakeByAddressAll(const_cast<uint32_t*>(addr));
+}
+
+bool FutexSupportPriorityInherit()
+{
+	// There's no priority inheritance primitive on Windows,
+	// the scheduler's priority boost for lock owners is the best we can get.
+	return false;
+}
+
+int FutexLockPi(volatile uint32_t* addr, const uint64_t* timeoutUs)
+{
+	return EINVAL;
+}
+
+void FutexUnlockPi(volatile uint32_t* addr)
+{
+}
 
 #elif defined(GPCS4_LINUX)
 
 #include <sys/types.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include <unistd.h>
+#include <sched.h>
+#include <time.h>
+
 uint64_t GetThreadId(void)
 {
 	return gettid();
@@ -32,11 +82,73 @@ uint64_t GetThreadId(void)
 
 void ThreadYield()
 {
+	sched_yield();
+}
 
+static long futex(volatile uint32_t* addr, int op, uint32_t val, const timespec* timeout)
+{
+	return syscall(SYS_futex, addr, op, val, timeout, nullptr, 0);
+}
+
+bool FutexWait(volatile uint32_t* addr, uint32_t expected, const uint64_t* timeoutUs)
+{
+	timespec  ts    = {};
+	timespec* pTime = nullptr;
+	if (timeoutUs)
+	{
+		ts.tv_sec  = *timeoutUs / 1000000;
+		ts.tv_nsec = (*timeoutUs % 1000000) * 1000;
+		pTime      = &ts;
+	}
+
+	long ret = futex(addr, FUTEX_WAIT_PRIVATE, expected, pTime);
+	return ret == 0 || errno != ETIMEDOUT;
+}
+
+void FutexWakeOne(volatile uint32_t* addr)
+{
+	futex(addr, FUTEX_WAKE_PRIVATE, 1, nullptr);
+}
+
+void FutexWakeAll(volatile uint32_t* addr)
+{
+	futex(addr, FUTEX_WAKE_PRIVATE, std::numeric_limits<int>::max(), nullptr);
+}
+
+bool FutexSupportPriorityInherit()
+{
+	return true;
+}
+
+int FutexLockPi(volatile uint32_t* addr, const uint64_t* timeoutUs)
+{
+	// FUTEX_LOCK_PI takes an absolute CLOCK_REALTIME timeout
+	timespec  ts    = {};
+	timespec* pTime = nullptr;
+	if (timeoutUs)
+	{
+		clock_gettime(CLOCK_REALTIME, &ts);
+		uint64_t nsec = ts.tv_nsec + (*timeoutUs % 1000000) * 1000;
+		ts.tv_sec += *timeoutUs / 1000000 + nsec / 1000000000;
+		ts.tv_nsec = nsec % 1000000000;
+		pTime      = &ts;
+	}
+
+	long ret = 0;
+	do
+	{
+		ret = futex(addr, FUTEX_LOCK_PI_PRIVATE, 0, pTime);
+	} while (ret != 0 && errno == EINTR);
+	return ret == 0 ? 0 : errno;
+}
+
+void FutexUnlockPi(volatile uint32_t* addr)
+{
+	futex(addr, FUTEX_UNLOCK_PI_PRIVATE, 0, nullptr);
 }
 
 #endif  //GPCS4_WINDOWS
 
 
 
-}
\ No newline at end of file
+}
@@ -9,4 +9,24 @@ uint64_t GetThreadId(void);
 
 void ThreadYield();
 
+// Address based wait/wake, futex on Linux and WaitOnAddress on Windows.
+// timeoutUs == nullptr means wait infinitely.
+// Returns false if the wait timed out.
+bool FutexWait(volatile uint32_t* addr, uint32_t expected, const uint64_t* timeoutUs = nullptr);
+
+void FutexWakeOne(volatile uint32_t* addr);
+
+void FutexWakeAll(volatile uint32_t* addr);
+
+// Priority inheritance lock word, the word must hold the owner's
+// thread id (GetThreadId) in the low 30 bits.
+// Only supported when FutexSupportPriorityInherit returns true.
+bool FutexSupportPriorityInherit();
+
+// Returns 0 once the lock is held, otherwise the errno of the failure,
+// ETIMEDOUT, EDEADLK for a self lock, EPERM or EINVAL for a broken word.
+int FutexLockPi(volatile uint32_t* addr, const uint64_t* timeoutUs = nullptr);
+
+void FutexUnlockPi(volatile uint32_t* addr);
+
 }
@@ -0,0 +1,134 @@
+#include "SceAjmCodec.h"
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <unordered_map>
+
+LOG_CHANNEL(SceModules.SceAjm.codec);
+
+class CSceAjmPcmPassthrough : public CSceAjmCodecInstance
+{
+public:
+	int32_t Reset() override
+	{
+		return 0;
+	}
+
+	int32_t Initialize(const void* pParam, size_t nSize) override
+	{
+		return 0;
+	}
+
+	void Decode(SceAjmDecodeJob* pJob) override
+	{
+		auto itIn  = pJob->vtInputs.begin();
+		auto itOut = pJob->vtOutputs.begin();
+
+		uint64_t nInOffset  = 0;
+		uint64_t nOutOffset = 0;
+		uint64_t nCopied    = 0;
+		while (itIn != pJob->vtInputs.end() && itOut != pJob->vtOutputs.end())
+		{
+			uint64_t nCount = std::min(itIn->szSize - nInOffset, itOut->szSize - nOutOffset);
+			std::memcpy(itOut->pAddress + nOutOffset, itIn->pAddress + nInOffset, nCount);
+			nInOffset += nCount;
+			nOutOffset += nCount;
+			nCopied += nCount;
+
+			if (nInOffset == itIn->szSize)
+			{
+				++itIn;
+				nInOffset = 0;
+			}
+			if (nOutOffset == itOut->szSize)
+			{
+				++itOut;
+				nOutOffset = 0;
+			}
+		}
+
+		// Skip empty buffers at the end before deciding
+		// whether any input was left over.
+		while (itIn != pJob->vtInputs.end() && itIn->szSize == nInOffset)
+		{
+			++itIn;
+		}
+
+		pJob->nConsumed = nCopied;
+		pJob->nProduced = nCopied;
+		pJob->nSamples  = nCopied / sizeof(int16_t);
+		pJob->iResult   = itIn != pJob->vtInputs.end() ? SCE_AJM_RESULT_NOT_ENOUGH_ROOM : 0;
+	}
+};
+
+class CSceAjmSilence : public CSceAjmCodecInstance
+{
+public:
+	int32_t Reset() override
+	{
+		return 0;
+	}
+
+	int32_t Initialize(const void* pParam, size_t nSize) override
+	{
+		return 0;
+	}
+
+	void Decode(SceAjmDecodeJob* pJob) override
+	{
+		for (const auto& input : pJob->vtInputs)
+		{
+			pJob->nConsumed += input.szSize;
+		}
+
+		for (const auto& output : pJob->vtOutputs)
+		{
+			std::memset(output.pAddress, 0, output.szSize);
+			pJob->nProduced += output.szSize;
+		}
+
+		pJob->nSamples = pJob->nProduced / sizeof(int16_t);
+	}
+};
+
+static std::mutex                                               g_codecMutex;
+static std::unordered_map<SceAjmCodecType, SceAjmCodecFactory> g_codecs = {
+	{ SCE_AJM_CODEC_PCM_PASSTHROUGH, [](uint64_t) { return std::make_unique<CSceAjmPcmPassthrough>(); } },
+};
+
+void RegisterAjmCodec(SceAjmCodecType nType, SceAjmCodecFactory&& fnFactory)
+{
+	std::lock_guard<std::mutex> lock(g_codecMutex);
+	g_codecs[nType] = std::move(fnFactory);
+}
+
+bool IsAjmCodecType(SceAjmCodecType nType)
+{
+	std::lock_guard<std::mutex> lock(g_codecMutex);
+	return nType < SCE_AJM_CODEC_MAX || g_codecs.count(nType) != 0;
+}
+
+std::unique_ptr<CSceAjmCodecInstance> CreateAjmCodecInstance(SceAjmCodecType nType, uint64_t uiFlags)
+{
+	std::unique_ptr<CSceAjmCodecInstance> instance;
+	do
+	{
+		{
+			std::lock_guard<std::mutex> lock(g_codecMutex);
+			auto                        iter = g_codecs.find(nType);
+			if (iter != g_codecs.end())
+			{
+				instance = iter->second(uiFlags);
+				break;
+			}
+		}
+
+		if (nType < SCE_AJM_CODEC_MAX)
+		{
+			LOG_FIXME("codec %d not implemented, decoding to silence", nType);
+			instance = std::make_unique<CSceAjmSilence>();
+		}
+	} while (false);
+	return instance;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "GPCS4Common.h"
+#include "sce_ajm_types.h"
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+// Not a PS4 codec. Copies the input to the output unchanged, which
+// lets the batch scheduler be exercised without a real decoder.
+#define SCE_AJM_CODEC_PCM_PASSTHROUGH 0x8000
+
+// One run job as the codec sees it.
+// The input stream may be split across several buffers, so may the
+// output. The codec fills in the result and the sizes, the scheduler
+// writes them to the sideband.
+struct SceAjmDecodeJob
+{
+	uint64_t                  uiFlags;
+	std::vector<SceAjmBuffer> vtInputs;
+	std::vector<SceAjmBuffer> vtOutputs;
+
+	int32_t  iResult         = 0;
+	int32_t  iInternalResult = 0;
+	uint64_t nConsumed       = 0;
+	uint64_t nProduced       = 0;
+	uint64_t nSamples        = 0;
+};
+
+// Decoder state of one Ajm instance.
+// Jobs of an instance are never run at the same time,
+// so implementations don't need to lock.
+
+class CSceAjmCodecInstance
+{
+public:
+	virtual ~CSceAjmCodecInstance()
+	{
+	}
+
+	// Both return SCE_AJM_RESULT_* bits.
+	virtual int32_t Reset() = 0;
+
+	virtual int32_t Initialize(const void* pParam, size_t nSize) = 0;
+
+	virtual void Decode(SceAjmDecodeJob* pJob) = 0;
+};
+
+using SceAjmCodecFactory = std::function<std::unique_ptr<CSceAjmCodecInstance>(uint64_t uiFlags)>;
+
+// Replaces the decoder of a codec type.
+void RegisterAjmCodec(SceAjmCodecType nType, SceAjmCodecFactory&& fnFactory);
+
+bool IsAjmCodecType(SceAjmCodecType nType);
+
+// PS4 codecs which have no decoder yet get one that consumes the
+// input and outputs silence, so streams keep going.
+std::unique_ptr<CSceAjmCodecInstance> CreateAjmCodecInstance(SceAjmCodecType nType, uint64_t uiFlags);
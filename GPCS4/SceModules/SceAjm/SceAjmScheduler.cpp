@@ -0,0 +1,608 @@
+#include "SceAjmScheduler.h"
+#include "sce_ajm_error.h"
+#include "sce_errors.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+LOG_CHANNEL(SceModules.SceAjm.scheduler);
+
+CSceAjmScheduler::CSceAjmScheduler()
+{
+	// Decoding is compute bound, leave
+	// the other half of the cores to the game.
+	uint32_t nWorkerCount = std::clamp(std::thread::hardware_concurrency() / 2, 1u, MaxWorkerCount);
+
+	m_workers.reserve(nWorkerCount);
+	for (uint32_t i = 0; i != nWorkerCount; ++i)
+	{
+		m_workers.emplace_back([this] { run(); });
+	}
+}
+
+CSceAjmScheduler::~CSceAjmScheduler()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_bStopped = true;
+	}
+	m_queueCond.notify_all();
+
+	for (auto& worker : m_workers)
+	{
+		worker.join();
+	}
+}
+
+int CSceAjmScheduler::CreateContext(SceAjmContextId* pContext)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	SceAjmContextId uiContext = m_uiNextContext++;
+	m_contexts[uiContext];
+	*pContext = uiContext;
+	return SCE_OK;
+}
+
+int CSceAjmScheduler::DestroyContext(SceAjmContextId uiContext)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	int                          nRet = SCE_AJM_ERROR_INVALID_CONTEXT;
+	do
+	{
+		auto pContext = findContext(uiContext);
+		if (!pContext)
+		{
+			break;
+		}
+
+		std::vector<BatchRef> vtBatches;
+		for (const auto& pair : pContext->batches)
+		{
+			const auto& batch = pair.second;
+			if (batch->nState == BS_PENDING)
+			{
+				m_queue.erase(batch);
+				batch->bCancelled = true;
+				finish(batch);
+			}
+			vtBatches.push_back(batch);
+		}
+
+		m_queueCond.notify_all();
+		m_doneCond.wait(lock, [&vtBatches]()
+						{ return std::all_of(vtBatches.begin(), vtBatches.end(),
+											 [](const BatchRef& batch) { return batch->nState == BS_DONE; }); });
+
+		m_contexts.erase(uiContext);
+		nRet = SCE_OK;
+	} while (false);
+	return nRet;
+}
+
+int CSceAjmScheduler::RegisterCodec(SceAjmContextId uiContext, SceAjmCodecType nCodec)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	int                         nRet = SCE_OK;
+	do
+	{
+		auto pContext = findContext(uiContext);
+		if (!pContext)
+		{
+			nRet = SCE_AJM_ERROR_INVALID_CONTEXT;
+			break;
+		}
+
+		if (!IsAjmCodecType(nCodec))
+		{
+			nRet = SCE_AJM_ERROR_CODEC_NOT_SUPPORTED;
+			break;
+		}
+
+		if (!pContext->codecs.insert(nCodec).second)
+		{
+			nRet = SCE_AJM_ERROR_CODEC_ALREADY_REGISTERED;
+			break;
+		}
+	} while (false);
+	return nRet;
+}
+
+int CSceAjmScheduler::UnregisterCodec(SceAjmContextId uiContext, SceAjmCodecType nCodec)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	int                         nRet = SCE_OK;
+	do
+	{
+		auto pContext = findContext(uiContext);
+		if (!pContext)
+		{
+			nRet = SCE_AJM_ERROR_INVALID_CONTEXT;
+			break;
+		}
+
+		if (pContext->codecs.erase(nCodec) == 0)
+		{
+			nRet = SCE_AJM_ERROR_CODEC_NOT_REGISTERED;
+			break;
+		}
+	} while (false);
+	return nRet;
+}
+
+int CSceAjmScheduler::CreateInstance(SceAjmContextId   uiContext,
+									 SceAjmCodecType   nCodec,
+									 uint64_t          uiFlags,
+									 SceAjmInstanceId* pInstance)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	int                         nRet = SCE_OK;
+	do
+	{
+		auto pContext = findContext(uiContext);
+		if (!pContext)
+		{
+			nRet = SCE_AJM_ERROR_INVALID_CONTEXT;
+			break;
+		}
+
+		if (pContext->codecs.count(nCodec) == 0)
+		{
+			nRet = SCE_AJM_ERROR_CODEC_NOT_REGISTERED;
+			break;
+		}
+
+		auto instance    = std::make_shared<Instance>();
+		instance->nCodec = nCodec;
+		instance->codec  = CreateAjmCodecInstance(nCodec, uiFlags);
+		if (!instance->codec)
+		{
+			nRet = SCE_AJM_ERROR_CODEC_NOT_SUPPORTED;
+			break;
+		}
+
+		SceAjmInstanceId uiInstance = pContext->uiNextInstance++;
+		pContext->instances.emplace(uiInstance, std::move(instance));
+		*pInstance = uiInstance;
+	} while (false);
+	return nRet;
+}
+
+int CSceAjmScheduler::DestroyInstance(SceAjmContextId uiContext, SceAjmInstanceId uiInstance)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	int                         nRet = SCE_OK;
+	do
+	{
+		auto pContext = findContext(uiContext);
+		if (!pContext)
+		{
+			nRet = SCE_AJM_ERROR_INVALID_CONTEXT;
+			break;
+		}
+
+		// Batches already started keep the instance alive.
+		if (pContext->instances.erase(uiInstance) == 0)
+		{
+			nRet = SCE_AJM_ERROR_INVALID_INSTANCE;
+			break;
+		}
+	} while (false);
+	return nRet;
+}
+
+uint8_t* CSceAjmScheduler::EncodeJob(uint8_t*            pPosition,
+									 JOB_OPCODE          nOpcode,
+									 SceAjmInstanceId    uiInstance,
+									 uint64_t            uiFlags,
+									 const SceAjmBuffer* pInputs,
+									 size_t              nInputCount,
+									 const SceAjmBuffer* pOutputs,
+									 size_t              nOutputCount,
+									 SceAjmBuffer        sideband,
+									 void*               pReturnAddress)
+{
+	// A job must fit the room games reserve for it. Split jobs
+	// take the same room per buffer, so checking no buffers
+	// covers every count.
+	static_assert(JobSize(1, 0) <= SCE_AJM_JOB_CONTROL_SIZE, "control job larger than reserved");
+	static_assert(JobSize(1, 1) <= SCE_AJM_JOB_RUN_SIZE, "run job larger than reserved");
+	static_assert(JobSize(0, 0) <= SCE_AJM_JOB_RUN_SPLIT_SIZE(0, 0) &&
+					  sizeof(SceAjmBuffer) <= SCE_AJM_JOB_RUN_SPLIT_SIZE(1, 0) - SCE_AJM_JOB_RUN_SPLIT_SIZE(0, 0),
+				  "split run job larger than reserved");
+
+	JobRecord record;
+	record.nOpcode        = nOpcode;
+	record.nSize          = static_cast<uint32_t>(JobSize(nInputCount, nOutputCount));
+	record.uiInstance     = uiInstance;
+	record.nInputCount    = static_cast<uint16_t>(nInputCount);
+	record.nOutputCount   = static_cast<uint16_t>(nOutputCount);
+	record.uiFlags        = uiFlags;
+	record.sideband       = sideband;
+	record.pReturnAddress = pReturnAddress;
+
+	// The batch buffer is only guaranteed to be byte aligned.
+	uint8_t* pBuffers = pPosition + sizeof(JobRecord);
+	std::memcpy(pPosition, &record, sizeof(JobRecord));
+	std::memcpy(pBuffers, pInputs, nInputCount * sizeof(SceAjmBuffer));
+	std::memcpy(pBuffers + nInputCount * sizeof(SceAjmBuffer), pOutputs, nOutputCount * sizeof(SceAjmBuffer));
+	return pPosition + record.nSize;
+}
+
+int CSceAjmScheduler::StartBatch(SceAjmContextId   uiContext,
+								 const uint8_t*    pBatch,
+								 uint32_t          nSize,
+								 int               nPriority,
+								 SceAjmBatchError* pError,
+								 SceAjmBatchId*    pBatchId)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	int                          nRet = SCE_OK;
+	do
+	{
+		auto pContext = findContext(uiContext);
+		if (!pContext)
+		{
+			nRet = SCE_AJM_ERROR_INVALID_CONTEXT;
+			break;
+		}
+
+		auto batch = std::make_shared<Batch>();
+		nRet       = parseBatch(pContext, pBatch, nSize, batch.get(), pError);
+		if (nRet != SCE_OK)
+		{
+			break;
+		}
+
+		batch->id         = pContext->uiNextBatch++;
+		batch->uiContext  = uiContext;
+		batch->nPriority  = nPriority;
+		batch->nSequence  = m_nSequence++;
+		batch->nState     = BS_PENDING;
+		batch->bCancelled = false;
+		for (const auto& instance : batch->vtInstances)
+		{
+			instance->vtUnfinished.push_back(batch->nSequence);
+		}
+
+		pContext->batches.emplace(batch->id, batch);
+		m_queue.insert(batch);
+		*pBatchId = batch->id;
+
+		if (pError)
+		{
+			std::memset(pError, 0, sizeof(SceAjmBatchError));
+		}
+	} while (false);
+
+	lock.unlock();
+	if (nRet == SCE_OK)
+	{
+		m_queueCond.notify_one();
+	}
+	return nRet;
+}
+
+int CSceAjmScheduler::WaitBatch(SceAjmContextId   uiContext,
+								SceAjmBatchId     uiBatch,
+								uint32_t          nTimeout,
+								SceAjmBatchError* pError)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	int                          nRet = SCE_OK;
+	do
+	{
+		auto pContext = findContext(uiContext);
+		if (!pContext)
+		{
+			nRet = SCE_AJM_ERROR_INVALID_CONTEXT;
+			break;
+		}
+
+		auto iter = pContext->batches.find(uiBatch);
+		if (iter == pContext->batches.end())
+		{
+			nRet = SCE_AJM_ERROR_INVALID_BATCH;
+			break;
+		}
+
+		BatchRef batch  = iter->second;
+		auto     isDone = [&batch]() { return batch->nState == BS_DONE; };
+		if (nTimeout == SCE_AJM_WAIT_INFINITE)
+		{
+			m_doneCond.wait(lock, isDone);
+		}
+		else if (!m_doneCond.wait_for(lock, std::chrono::milliseconds(nTimeout), isDone))
+		{
+			nRet = nTimeout == 0 ? SCE_AJM_ERROR_BUSY : SCE_AJM_ERROR_IN_PROGRESS;
+			break;
+		}
+
+		// The context may have gone while waiting.
+		pContext = findContext(uiContext);
+		if (pContext)
+		{
+			pContext->batches.erase(uiBatch);
+		}
+
+		nRet = batch->bCancelled ? SCE_AJM_ERROR_CANCELLED : SCE_OK;
+		if (pError)
+		{
+			std::memset(pError, 0, sizeof(SceAjmBatchError));
+			pError->iErrorCode = nRet;
+		}
+	} while (false);
+	return nRet;
+}
+
+int CSceAjmScheduler::CancelBatch(SceAjmContextId uiContext, SceAjmBatchId uiBatch)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	int                          nRet = SCE_OK;
+	do
+	{
+		auto pContext = findContext(uiContext);
+		if (!pContext)
+		{
+			nRet = SCE_AJM_ERROR_INVALID_CONTEXT;
+			break;
+		}
+
+		auto iter = pContext->batches.find(uiBatch);
+		if (iter == pContext->batches.end())
+		{
+			nRet = SCE_AJM_ERROR_INVALID_BATCH;
+			break;
+		}
+
+		const auto& batch = iter->second;
+		if (batch->nState != BS_PENDING)
+		{
+			break;
+		}
+
+		m_queue.erase(batch);
+		batch->bCancelled = true;
+		finish(batch);
+
+		lock.unlock();
+		m_queueCond.notify_all();
+		m_doneCond.notify_all();
+	} while (false);
+	return nRet;
+}
+
+bool CSceAjmScheduler::BatchOrder::operator()(const BatchRef& a, const BatchRef& b) const
+{
+	// Lower priority values run first.
+	if (a->nPriority != b->nPriority)
+	{
+		return a->nPriority < b->nPriority;
+	}
+	return a->nSequence < b->nSequence;
+}
+
+CSceAjmScheduler::Context* CSceAjmScheduler::findContext(SceAjmContextId uiContext)
+{
+	auto iter = m_contexts.find(uiContext);
+	return iter != m_contexts.end() ? &iter->second : nullptr;
+}
+
+int CSceAjmScheduler::parseBatch(Context*          pContext,
+								 const uint8_t*    pBuffer,
+								 uint32_t          nSize,
+								 Batch*            pBatch,
+								 SceAjmBatchError* pError)
+{
+	int      nRet    = SCE_OK;
+	uint32_t nOffset = 0;
+	while (nOffset < nSize)
+	{
+		const uint8_t* pRecord = pBuffer + nOffset;
+
+		JobRecord   record = {};
+		InstanceRef instance;
+		if (nSize - nOffset < sizeof(JobRecord))
+		{
+			nRet = SCE_AJM_ERROR_MALFORMED_BATCH;
+		}
+		else
+		{
+			std::memcpy(&record, pRecord, sizeof(JobRecord));
+
+			auto iter = pContext->instances.find(record.uiInstance);
+			if (record.nSize != JobSize(record.nInputCount, record.nOutputCount) ||
+				record.nSize > nSize - nOffset)
+			{
+				nRet = SCE_AJM_ERROR_MALFORMED_BATCH;
+			}
+			else if (record.nOpcode != JOB_CONTROL && record.nOpcode != JOB_RUN)
+			{
+				nRet = SCE_AJM_ERROR_INVALID_OPCODE;
+			}
+			else if (iter == pContext->instances.end())
+			{
+				nRet = SCE_AJM_ERROR_INVALID_INSTANCE;
+			}
+			else
+			{
+				instance = iter->second;
+			}
+		}
+
+		if (nRet != SCE_OK)
+		{
+			LOG_WARN("bad job at offset %d of batch, error %x", nOffset, nRet);
+			if (pError)
+			{
+				std::memset(pError, 0, sizeof(SceAjmBatchError));
+				pError->iErrorCode      = nRet;
+				pError->pJobAddress     = pRecord;
+				pError->uiCommandOffset = nOffset;
+				pError->pJobOriginRa    = record.pReturnAddress;
+			}
+			break;
+		}
+
+		Job job;
+		job.pRecord        = pRecord;
+		job.nOpcode        = static_cast<JOB_OPCODE>(record.nOpcode);
+		job.instance       = instance;
+		job.decode.uiFlags = record.uiFlags;
+		job.sideband       = record.sideband;
+
+		const uint8_t* pBuffers = pRecord + sizeof(JobRecord);
+		job.decode.vtInputs.resize(record.nInputCount);
+		job.decode.vtOutputs.resize(record.nOutputCount);
+		std::memcpy(job.decode.vtInputs.data(), pBuffers, record.nInputCount * sizeof(SceAjmBuffer));
+		std::memcpy(job.decode.vtOutputs.data(), pBuffers + record.nInputCount * sizeof(SceAjmBuffer),
+					record.nOutputCount * sizeof(SceAjmBuffer));
+
+		if (std::find(pBatch->vtInstances.begin(), pBatch->vtInstances.end(), instance) == pBatch->vtInstances.end())
+		{
+			pBatch->vtInstances.push_back(instance);
+		}
+		pBatch->vtJobs.push_back(std::move(job));
+
+		nOffset += record.nSize;
+	}
+	return nRet;
+}
+
+void CSceAjmScheduler::run()
+{
+	while (true)
+	{
+		BatchRef batch;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_queueCond.wait(lock, [this, &batch]()
+							 { return m_bStopped || (batch = popRunnable()) != nullptr; });
+
+			if (!batch)
+			{
+				break;
+			}
+		}
+
+		execute(batch.get());
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			finish(batch);
+		}
+		m_queueCond.notify_all();
+		m_doneCond.notify_all();
+	}
+}
+
+CSceAjmScheduler::BatchRef CSceAjmScheduler::popRunnable()
+{
+	BatchRef batch;
+	for (auto iter = m_queue.begin(); iter != m_queue.end(); ++iter)
+	{
+		const auto& instances = (*iter)->vtInstances;
+		uint64_t    nSequence = (*iter)->nSequence;
+		bool        bRunnable = std::all_of(instances.begin(), instances.end(), [nSequence](const InstanceRef& instance)
+											{ return instance->vtUnfinished.front() == nSequence; });
+		if (bRunnable)
+		{
+			batch         = *iter;
+			batch->nState = BS_RUNNING;
+			m_queue.erase(iter);
+			break;
+		}
+	}
+	return batch;
+}
+
+void CSceAjmScheduler::execute(Batch* pBatch)
+{
+	for (auto& job : pBatch->vtJobs)
+	{
+		runJob(&job);
+	}
+}
+
+void CSceAjmScheduler::runJob(Job* pJob)
+{
+	auto  pInstance = pJob->instance.get();
+	auto& decode    = pJob->decode;
+
+	if (pJob->nOpcode == JOB_CONTROL)
+	{
+		if (decode.uiFlags & SCE_AJM_FLAG_CONTROL_RESET)
+		{
+			decode.iResult |= pInstance->codec->Reset();
+			pInstance->nTotalSamples = 0;
+		}
+
+		if (decode.uiFlags & SCE_AJM_FLAG_CONTROL_INITIALIZE)
+		{
+			const SceAjmBuffer* pParam = decode.vtInputs.empty() ? nullptr : &decode.vtInputs.front();
+			decode.iResult |= pInstance->codec->Initialize(pParam ? pParam->pAddress : nullptr,
+														   pParam ? pParam->szSize : 0);
+		}
+	}
+	else
+	{
+		pInstance->codec->Decode(&decode);
+		pInstance->nTotalSamples += decode.nSamples;
+	}
+
+	writeSideband(*pJob, pInstance->nTotalSamples);
+}
+
+void CSceAjmScheduler::finish(const BatchRef& batch)
+{
+	for (const auto& instance : batch->vtInstances)
+	{
+		auto& vtUnfinished = instance->vtUnfinished;
+		vtUnfinished.erase(std::find(vtUnfinished.begin(), vtUnfinished.end(), batch->nSequence));
+	}
+	batch->nState = BS_DONE;
+}
+
+void CSceAjmScheduler::writeSideband(const Job& job, uint64_t nTotalSamples)
+{
+	const auto& sideband = job.sideband;
+	const auto& decode   = job.decode;
+	do
+	{
+		if (!sideband.pAddress || sideband.szSize < sizeof(SceAjmSidebandResult))
+		{
+			break;
+		}
+
+		// Parts no codec fills in yet read as zero.
+		std::memset(sideband.pAddress, 0, sideband.szSize);
+
+		SceAjmSidebandResult result = { decode.iResult, decode.iInternalResult };
+		uint64_t             nOffset = sizeof(SceAjmSidebandResult);
+		if (decode.uiFlags & SCE_AJM_FLAG_SIDEBAND_STREAM)
+		{
+			if (sideband.szSize - nOffset >= sizeof(SceAjmSidebandStream))
+			{
+				SceAjmSidebandStream stream;
+				stream.iSizeConsumed         = static_cast<int32_t>(decode.nConsumed);
+				stream.iSizeProduced         = static_cast<int32_t>(decode.nProduced);
+				stream.uiTotalDecodedSamples = nTotalSamples;
+				std::memcpy(sideband.pAddress + nOffset, &stream, sizeof(stream));
+			}
+			else
+			{
+				result.iResult |= SCE_AJM_RESULT_SIDEBAND_TRUNCATED;
+			}
+		}
+
+		std::memcpy(sideband.pAddress, &result, sizeof(result));
+	} while (false);
+}
+
+CSceAjmScheduler& GetAjmScheduler()
+{
+	// Never destroyed, the workers run until the process exits.
+	static CSceAjmScheduler* s_scheduler = new CSceAjmScheduler();
+	return *s_scheduler;
+}
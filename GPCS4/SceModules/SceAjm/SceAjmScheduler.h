@@ -0,0 +1,193 @@
+#pragma once
+
+#include "GPCS4Common.h"
+#include "SceAjmCodec.h"
+#include "sce_ajm_types.h"
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Ajm contexts, instances and batches.
+// The sceAjmBatchJob* functions encode jobs into the guest batch
+// buffer, sceAjmBatchStartBuffer parses and queues the batch, and a
+// fixed set of worker threads runs the queued batches. Jobs of a
+// batch run in order. Batches run in parallel unless they share an
+// instance, batches of the same instance run in the order they were
+// started.
+
+class CSceAjmScheduler
+{
+public:
+	enum JOB_OPCODE
+	{
+		JOB_CONTROL = 1,
+		JOB_RUN     = 2,
+	};
+
+	CSceAjmScheduler();
+	~CSceAjmScheduler();
+
+	int CreateContext(SceAjmContextId* pContext);
+
+	// Waits for the batches of the context still running.
+	int DestroyContext(SceAjmContextId uiContext);
+
+	int RegisterCodec(SceAjmContextId uiContext, SceAjmCodecType nCodec);
+
+	int UnregisterCodec(SceAjmContextId uiContext, SceAjmCodecType nCodec);
+
+	int CreateInstance(SceAjmContextId uiContext, SceAjmCodecType nCodec, uint64_t uiFlags, SceAjmInstanceId* pInstance);
+
+	int DestroyInstance(SceAjmContextId uiContext, SceAjmInstanceId uiInstance);
+
+	// Writes one job at pPosition and returns the end of it.
+	// Control jobs pass the sideband input as their only input.
+	static uint8_t* EncodeJob(uint8_t*            pPosition,
+							  JOB_OPCODE          nOpcode,
+							  SceAjmInstanceId    uiInstance,
+							  uint64_t            uiFlags,
+							  const SceAjmBuffer* pInputs,
+							  size_t              nInputCount,
+							  const SceAjmBuffer* pOutputs,
+							  size_t              nOutputCount,
+							  SceAjmBuffer        sideband,
+							  void*               pReturnAddress);
+
+	// pError may be null.
+	int StartBatch(SceAjmContextId   uiContext,
+				   const uint8_t*    pBatch,
+				   uint32_t          nSize,
+				   int               nPriority,
+				   SceAjmBatchError* pError,
+				   SceAjmBatchId*    pBatchId);
+
+	// nTimeout is in milliseconds. A batch can be waited for
+	// successfully only once, its id is released afterwards.
+	int WaitBatch(SceAjmContextId uiContext, SceAjmBatchId uiBatch, uint32_t nTimeout, SceAjmBatchError* pError);
+
+	// Batches which have started running are not cancelled.
+	int CancelBatch(SceAjmContextId uiContext, SceAjmBatchId uiBatch);
+
+private:
+	static constexpr uint32_t MaxWorkerCount = 4;
+
+	enum BATCH_STATE
+	{
+		BS_PENDING,
+		BS_RUNNING,
+		BS_DONE,
+	};
+
+	// Layout of a job in the batch buffer, the input and the output
+	// buffers follow the record. Kept compact, games size their batch
+	// buffers with the SCE_AJM_JOB_*_SIZE macros, see EncodeJob.
+	struct JobRecord
+	{
+		uint32_t         nOpcode;
+		uint32_t         nSize;  // whole record, buffers included
+		SceAjmInstanceId uiInstance;
+		uint16_t         nInputCount;
+		uint16_t         nOutputCount;
+		uint64_t         uiFlags;
+		SceAjmBuffer     sideband;
+		void*            pReturnAddress;
+	};
+
+	static constexpr size_t JobSize(size_t nInputCount, size_t nOutputCount)
+	{
+		return sizeof(JobRecord) + (nInputCount + nOutputCount) * sizeof(SceAjmBuffer);
+	}
+
+	struct Instance
+	{
+		SceAjmCodecType                       nCodec;
+		std::unique_ptr<CSceAjmCodecInstance> codec;
+		uint64_t                              nTotalSamples = 0;
+
+		// Sequence numbers of the unfinished batches using the instance,
+		// only the batch at the front may run.
+		std::deque<uint64_t> vtUnfinished;
+	};
+
+	using InstanceRef = std::shared_ptr<Instance>;
+
+	struct Job
+	{
+		const uint8_t*  pRecord;
+		JOB_OPCODE      nOpcode;
+		InstanceRef     instance;
+		SceAjmDecodeJob decode;
+		SceAjmBuffer    sideband;
+	};
+
+	struct Batch
+	{
+		SceAjmBatchId    id;
+		SceAjmContextId  uiContext;
+		int              nPriority;
+		uint64_t         nSequence;
+		BATCH_STATE      nState;
+		bool             bCancelled;
+		std::vector<Job> vtJobs;
+
+		// Every instance once
+		std::vector<InstanceRef> vtInstances;
+	};
+
+	using BatchRef = std::shared_ptr<Batch>;
+
+	struct BatchOrder
+	{
+		bool operator()(const BatchRef& a, const BatchRef& b) const;
+	};
+
+	struct Context
+	{
+		std::set<SceAjmCodecType>                         codecs;
+		std::unordered_map<SceAjmInstanceId, InstanceRef> instances;
+		std::unordered_map<SceAjmBatchId, BatchRef>       batches;
+		SceAjmInstanceId                                  uiNextInstance = 1;
+		SceAjmBatchId                                     uiNextBatch    = 1;
+	};
+
+	Context* findContext(SceAjmContextId uiContext);
+
+	// Parses the batch buffer into jobs. On error fills pError
+	// and returns the error code.
+	int parseBatch(Context* pContext, const uint8_t* pBuffer, uint32_t nSize, Batch* pBatch, SceAjmBatchError* pError);
+
+	void run();
+
+	// Takes the first queued batch none of whose instances
+	// is used by a batch started earlier.
+	BatchRef popRunnable();
+
+	void execute(Batch* pBatch);
+
+	void runJob(Job* pJob);
+
+	// Marks the batch done and lets the next batches of its
+	// instances run. Called with m_mutex held.
+	void finish(const BatchRef& batch);
+
+	static void writeSideband(const Job& job, uint64_t nTotalSamples);
+
+private:
+	std::mutex                                   m_mutex;
+	std::condition_variable                      m_queueCond;
+	std::condition_variable                      m_doneCond;
+	std::unordered_map<SceAjmContextId, Context> m_contexts;
+	std::set<BatchRef, BatchOrder>               m_queue;
+	SceAjmContextId                              m_uiNextContext = 1;
+	uint64_t                                     m_nSequence     = 0;
+	bool                                         m_bStopped      = false;
+	std::vector<std::thread>                     m_workers;
+};
+
+CSceAjmScheduler& GetAjmScheduler();
@@ -1,4 +1,5 @@
 #include "sce_ajm.h"
+#include "SceAjmScheduler.h"
 
 
 // Note:
@@ -13,76 +14,115 @@ LOG_CHANNEL(SceModules.SceAjm);
 
 int PS4API sceAjmInitialize(int64_t iReserved, SceAjmContextId * const pContext)
 {
-	LOG_FIXME("Not implemented");
-	*pContext = 0x123;
-	return SCE_OK;
+	LOG_SCE_TRACE("context %p", pContext);
+	if (!pContext)
+	{
+		return SCE_AJM_ERROR_INVALID_PARAMETER;
+	}
+	return GetAjmScheduler().CreateContext(pContext);
 }
 
 
 int PS4API sceAjmFinalize(const SceAjmContextId uiContext)
 {
-	LOG_FIXME("Not implemented");
-	return SCE_OK;
+	LOG_SCE_TRACE("context %d", uiContext);
+	return GetAjmScheduler().DestroyContext(uiContext);
 }
 
 
 int PS4API sceAjmModuleRegister(const SceAjmContextId uiContext, const SceAjmCodecType uiCodec, int64_t iReserved)
 {
-	LOG_FIXME("Not implemented");
-	return SCE_OK;
+	LOG_SCE_TRACE("context %d codec %d", uiContext, uiCodec);
+	return GetAjmScheduler().RegisterCodec(uiContext, uiCodec);
 }
 
 
-int PS4API sceAjmModuleUnregister(void)
+int PS4API sceAjmModuleUnregister(const SceAjmContextId uiContext, const SceAjmCodecType uiCodec)
 {
-	LOG_FIXME("Not implemented");
-	return SCE_OK;
+	LOG_SCE_TRACE("context %d codec %d", uiContext, uiCodec);
+	return GetAjmScheduler().UnregisterCodec(uiContext, uiCodec);
 }
 
 
-int PS4API sceAjmBatchJobControlBufferRa(void)
+void* PS4API sceAjmBatchJobControlBufferRa(void* pBatchPosition, SceAjmInstanceId uiInstance, uint64_t uiFlags,
+	const void* pSidebandInput, size_t szSidebandInputSize,
+	void* pSidebandOutput, size_t szSidebandOutputSize, void* pReturnAddress)
 {
-	LOG_FIXME("Not implemented");
-	return SCE_OK;
+	LOG_SCE_TRACE("batch %p instance %d flags %llx", pBatchPosition, uiInstance, uiFlags);
+	SceAjmBuffer input    = { (uint8_t*)pSidebandInput, szSidebandInputSize };
+	SceAjmBuffer sideband = { (uint8_t*)pSidebandOutput, szSidebandOutputSize };
+	return CSceAjmScheduler::EncodeJob((uint8_t*)pBatchPosition, CSceAjmScheduler::JOB_CONTROL, uiInstance, uiFlags,
+									   &input, 1, nullptr, 0, sideband, pReturnAddress);
 }
 
 
-int PS4API sceAjmBatchJobRunSplitBufferRa(void)
+void* PS4API sceAjmBatchJobRunBufferRa(void* pBatchPosition, SceAjmInstanceId uiInstance, uint64_t uiFlags,
+	const void* pDataInput, size_t szDataInputSize,
+	void* pDataOutput, size_t szDataOutputSize,
+	void* pSidebandOutput, size_t szSidebandOutputSize, void* pReturnAddress)
 {
-	LOG_FIXME("Not implemented");
-	return SCE_OK;
+	LOG_SCE_TRACE("batch %p instance %d flags %llx", pBatchPosition, uiInstance, uiFlags);
+	SceAjmBuffer input    = { (uint8_t*)pDataInput, szDataInputSize };
+	SceAjmBuffer output   = { (uint8_t*)pDataOutput, szDataOutputSize };
+	SceAjmBuffer sideband = { (uint8_t*)pSidebandOutput, szSidebandOutputSize };
+	return CSceAjmScheduler::EncodeJob((uint8_t*)pBatchPosition, CSceAjmScheduler::JOB_RUN, uiInstance, uiFlags,
+									   &input, 1, &output, 1, sideband, pReturnAddress);
 }
 
 
-int PS4API sceAjmBatchStartBuffer(void)
+void* PS4API sceAjmBatchJobRunSplitBufferRa(void* pBatchPosition, SceAjmInstanceId uiInstance, uint64_t uiFlags,
+	const SceAjmBuffer* pDataInputBuffers, size_t szNumDataInputBuffers,
+	const SceAjmBuffer* pDataOutputBuffers, size_t szNumDataOutputBuffers,
+	void* pSidebandOutput, size_t szSidebandOutputSize, void* pReturnAddress)
 {
-	LOG_FIXME("Not implemented");
-	return SCE_OK;
+	LOG_SCE_TRACE("batch %p instance %d flags %llx", pBatchPosition, uiInstance, uiFlags);
+	SceAjmBuffer sideband = { (uint8_t*)pSidebandOutput, szSidebandOutputSize };
+	return CSceAjmScheduler::EncodeJob((uint8_t*)pBatchPosition, CSceAjmScheduler::JOB_RUN, uiInstance, uiFlags,
+									   pDataInputBuffers, szNumDataInputBuffers,
+									   pDataOutputBuffers, szNumDataOutputBuffers,
+									   sideband, pReturnAddress);
 }
 
 
-int PS4API sceAjmBatchWait(void)
+int PS4API sceAjmBatchStartBuffer(const SceAjmContextId uiContext, const uint8_t* pBatch, uint32_t uiBatchSize,
+	int iPriority, SceAjmBatchError* pBatchError, SceAjmBatchId* pBatchId)
 {
-	LOG_FIXME("Not implemented");
-	return SCE_OK;
+	LOG_SCE_TRACE("context %d batch %p size %d priority %d", uiContext, pBatch, uiBatchSize, iPriority);
+	if (!pBatch || !pBatchId)
+	{
+		return SCE_AJM_ERROR_INVALID_PARAMETER;
+	}
+	return GetAjmScheduler().StartBatch(uiContext, pBatch, uiBatchSize, iPriority, pBatchError, pBatchId);
 }
 
 
-int PS4API sceAjmInstanceCreate(void)
+int PS4API sceAjmBatchWait(const SceAjmContextId uiContext, const SceAjmBatchId uiBatch, uint32_t uiTimeout, SceAjmBatchError* pBatchError)
 {
-	LOG_FIXME("Not implemented");
-	return SCE_OK;
+	LOG_SCE_TRACE("context %d batch %d timeout %d", uiContext, uiBatch, uiTimeout);
+	return GetAjmScheduler().WaitBatch(uiContext, uiBatch, uiTimeout, pBatchError);
 }
 
 
-int PS4API sceAjmInstanceDestroy(void)
+int PS4API sceAjmBatchCancel(const SceAjmContextId uiContext, const SceAjmBatchId uiBatch)
 {
-	LOG_FIXME("Not implemented");
-	return SCE_OK;
+	LOG_SCE_TRACE("context %d batch %d", uiContext, uiBatch);
+	return GetAjmScheduler().CancelBatch(uiContext, uiBatch);
 }
 
 
+int PS4API sceAjmInstanceCreate(const SceAjmContextId uiContext, const SceAjmCodecType uiCodec, uint64_t uiFlags, SceAjmInstanceId* pInstance)
+{
+	LOG_SCE_TRACE("context %d codec %d flags %llx", uiContext, uiCodec, uiFlags);
+	if (!pInstance)
+	{
+		return SCE_AJM_ERROR_INVALID_PARAMETER;
+	}
+	return GetAjmScheduler().CreateInstance(uiContext, uiCodec, uiFlags, pInstance);
+}
 
 
-
-
+int PS4API sceAjmInstanceDestroy(const SceAjmContextId uiContext, const SceAjmInstanceId uiInstance)
+{
+	LOG_SCE_TRACE("context %d instance %d", uiContext, uiInstance);
+	return GetAjmScheduler().DestroyInstance(uiContext, uiInstance);
+}
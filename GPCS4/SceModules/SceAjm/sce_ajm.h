@@ -11,6 +11,7 @@
 
 #include "sce_module_common.h"
 #include "sce_ajm_types.h"
+#include "sce_ajm_error.h"
 
 
 extern const SCE_EXPORT_MODULE g_ExpModuleSceAjm;
@@ -26,34 +27,49 @@ extern const SCE_EXPORT_MODULE g_ExpModuleSceAjm;
 // library: libSceAjm
 //////////////////////////////////////////////////////////////////////////
 
-int PS4API sceAjmBatchJobControlBufferRa(void);
+void* PS4API sceAjmBatchJobControlBufferRa(void* pBatchPosition, SceAjmInstanceId uiInstance, uint64_t uiFlags,
+	const void* pSidebandInput, size_t szSidebandInputSize,
+	void* pSidebandOutput, size_t szSidebandOutputSize, void* pReturnAddress);
 
 
-int PS4API sceAjmBatchJobRunSplitBufferRa(void);
+void* PS4API sceAjmBatchJobRunBufferRa(void* pBatchPosition, SceAjmInstanceId uiInstance, uint64_t uiFlags,
+	const void* pDataInput, size_t szDataInputSize,
+	void* pDataOutput, size_t szDataOutputSize,
+	void* pSidebandOutput, size_t szSidebandOutputSize, void* pReturnAddress);
 
 
-int PS4API sceAjmBatchStartBuffer(void);
+void* PS4API sceAjmBatchJobRunSplitBufferRa(void* pBatchPosition, SceAjmInstanceId uiInstance, uint64_t uiFlags,
+	const SceAjmBuffer* pDataInputBuffers, size_t szNumDataInputBuffers,
+	const SceAjmBuffer* pDataOutputBuffers, size_t szNumDataOutputBuffers,
+	void* pSidebandOutput, size_t szSidebandOutputSize, void* pReturnAddress);
 
 
-int PS4API sceAjmBatchWait(void);
+int PS4API sceAjmBatchStartBuffer(const SceAjmContextId uiContext, const uint8_t* pBatch, uint32_t uiBatchSize,
+	int iPriority, SceAjmBatchError* pBatchError, SceAjmBatchId* pBatchId);
 
 
-int PS4API sceAjmFinalize(PS4UNUSED const SceAjmContextId uiContext);
+int PS4API sceAjmBatchWait(const SceAjmContextId uiContext, const SceAjmBatchId uiBatch, uint32_t uiTimeout, SceAjmBatchError* pBatchError);
+
+
+int PS4API sceAjmBatchCancel(const SceAjmContextId uiContext, const SceAjmBatchId uiBatch);
+
+
+int PS4API sceAjmFinalize(const SceAjmContextId uiContext);
 
 
 int PS4API sceAjmInitialize(PS4UNUSED int64_t iReserved, SceAjmContextId * const pContext);
 
 
-int PS4API sceAjmInstanceCreate(void);
+int PS4API sceAjmInstanceCreate(const SceAjmContextId uiContext, const SceAjmCodecType uiCodec, uint64_t uiFlags, SceAjmInstanceId* pInstance);
 
 
-int PS4API sceAjmInstanceDestroy(void);
+int PS4API sceAjmInstanceDestroy(const SceAjmContextId uiContext, const SceAjmInstanceId uiInstance);
 
 
-int PS4API sceAjmModuleRegister(PS4UNUSED const SceAjmContextId uiContext, PS4UNUSED const SceAjmCodecType uiCodec, PS4UNUSED int64_t iReserved);
+int PS4API sceAjmModuleRegister(const SceAjmContextId uiContext, const SceAjmCodecType uiCodec, PS4UNUSED int64_t iReserved);
 
 
-int PS4API sceAjmModuleUnregister(void);
+int PS4API sceAjmModuleUnregister(const SceAjmContextId uiContext, const SceAjmCodecType uiCodec);
 
 
 
@@ -0,0 +1,27 @@
+#pragma once
+
+
+
+// AJM errors
+#define SCE_AJM_ERROR_INVALID_CONTEXT			-2137849854	 //0x80930002
+#define SCE_AJM_ERROR_INVALID_INSTANCE			-2137849853	 //0x80930003
+#define SCE_AJM_ERROR_INVALID_BATCH				-2137849852	 //0x80930004
+#define SCE_AJM_ERROR_INVALID_PARAMETER			-2137849851	 //0x80930005
+#define SCE_AJM_ERROR_OUT_OF_MEMORY				-2137849850	 //0x80930006
+#define SCE_AJM_ERROR_OUT_OF_RESOURCES			-2137849849	 //0x80930007
+#define SCE_AJM_ERROR_CODEC_NOT_SUPPORTED		-2137849848	 //0x80930008
+#define SCE_AJM_ERROR_CODEC_ALREADY_REGISTERED	-2137849847	 //0x80930009
+#define SCE_AJM_ERROR_CODEC_NOT_REGISTERED		-2137849846	 //0x8093000A
+#define SCE_AJM_ERROR_WRONG_REVISION_FLAG		-2137849845	 //0x8093000B
+#define SCE_AJM_ERROR_FLAG_NOT_SUPPORTED		-2137849844	 //0x8093000C
+#define SCE_AJM_ERROR_BUSY						-2137849843	 //0x8093000D
+#define SCE_AJM_ERROR_BAD_PRIORITY				-2137849842	 //0x8093000E
+#define SCE_AJM_ERROR_IN_PROGRESS				-2137849841	 //0x8093000F
+#define SCE_AJM_ERROR_RETRY						-2137849840	 //0x80930010
+#define SCE_AJM_ERROR_MALFORMED_BATCH			-2137849839	 //0x80930011
+#define SCE_AJM_ERROR_JOB_CREATION				-2137849838	 //0x80930012
+#define SCE_AJM_ERROR_INVALID_OPCODE			-2137849837	 //0x80930013
+#define SCE_AJM_ERROR_PRIORITY_VIOLATION		-2137849836	 //0x80930014
+#define SCE_AJM_ERROR_BUFFER_TOO_BIG			-2137849835	 //0x80930015
+#define SCE_AJM_ERROR_INVALID_ADDRESS			-2137849834	 //0x80930016
+#define SCE_AJM_ERROR_CANCELLED					-2137849833	 //0x80930017
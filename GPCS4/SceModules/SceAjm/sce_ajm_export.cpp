@@ -10,8 +10,10 @@ static const SCE_EXPORT_FUNCTION g_pSceAjm_libSceAjm_FunctionTable[] =
 {
 	{ 0x7660F26CDFFF167F, "sceAjmBatchJobControlBufferRa", (void*)sceAjmBatchJobControlBufferRa },
 	{ 0xEE37405CAFB67CCA, "sceAjmBatchJobRunSplitBufferRa", (void*)sceAjmBatchJobRunSplitBufferRa },
+	{ 0x125B25382A4E227B, "sceAjmBatchJobRunBufferRa", (void*)sceAjmBatchJobRunBufferRa },
 	{ 0x7C5164934C5F196B, "sceAjmBatchStartBuffer", (void*)sceAjmBatchStartBuffer },
 	{ 0xFEA2EC7C3032C086, "sceAjmBatchWait", (void*)sceAjmBatchWait },
+	{ 0x3550D78947AC49B0, "sceAjmBatchCancel", (void*)sceAjmBatchCancel },
 	{ 0x307BABEAA0AC52EB, "sceAjmFinalize", (void*)sceAjmFinalize },
 	{ 0x765FB87874B352EE, "sceAjmInitialize", (void*)sceAjmInitialize },
 	{ 0x031A03AC8369E09F, "sceAjmInstanceCreate", (void*)sceAjmInstanceCreate },
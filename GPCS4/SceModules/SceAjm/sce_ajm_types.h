@@ -1,5 +1,82 @@
 #pragma once
 
+#include "GPCS4Common.h"
+
+
+
+#define SCE_AJM_CODEC_MP3_DEC   0
+#define SCE_AJM_CODEC_AT9_DEC   1
+#define SCE_AJM_CODEC_M4AAC_DEC 2
+#define SCE_AJM_CODEC_MAX       23
+
+#define SCE_AJM_WAIT_INFINITE 0xFFFFFFFF
+
+#define SCE_AJM_PRIORITY_MIN 0
+#define SCE_AJM_PRIORITY_MAX 6
+
+// Batch buffer space of a job, games size their batch buffers with these.
+// Every part of a job takes 16 bytes: the job header, the return address,
+// the flags and every buffer, the sideband output included.
+#define SCE_AJM_JOB_CONTROL_SIZE                 (5 * 16)
+#define SCE_AJM_JOB_RUN_SIZE                     (6 * 16)
+#define SCE_AJM_JOB_RUN_SPLIT_SIZE(nIn, nOut)    ((4 + (nIn) + (nOut)) * 16)
+
+// Job flags, the low bits hold the revision
+#define SCE_AJM_FLAG_REVISION(x)          ((uint64_t)(x) & 0x7)
+#define SCE_AJM_FLAG_RUN_GET_CODEC_INFO   (1ULL << 11)
+#define SCE_AJM_FLAG_RUN_MULTIPLE_FRAMES  (1ULL << 12)
+#define SCE_AJM_FLAG_CONTROL_RESET        (1ULL << 13)
+#define SCE_AJM_FLAG_CONTROL_INITIALIZE   (1ULL << 14)
+#define SCE_AJM_FLAG_CONTROL_RESAMPLE     (1ULL << 15)
+#define SCE_AJM_FLAG_SIDEBAND_GAPLESS     (1ULL << 45)
+#define SCE_AJM_FLAG_SIDEBAND_FORMAT      (1ULL << 46)
+#define SCE_AJM_FLAG_SIDEBAND_STREAM      (1ULL << 47)
+
+// Bits of SceAjmSidebandResult::iResult
+#define SCE_AJM_RESULT_NOT_INITIALIZED     (1 << 0)
+#define SCE_AJM_RESULT_INVALID_DATA        (1 << 1)
+#define SCE_AJM_RESULT_INVALID_PARAMETER   (1 << 2)
+#define SCE_AJM_RESULT_PARTIAL_INPUT       (1 << 3)
+#define SCE_AJM_RESULT_NOT_ENOUGH_ROOM     (1 << 4)
+#define SCE_AJM_RESULT_STREAM_CHANGE       (1 << 5)
+#define SCE_AJM_RESULT_TOO_MANY_CHANNELS   (1 << 6)
+#define SCE_AJM_RESULT_UNSUPPORTED_FLAG    (1 << 7)
+#define SCE_AJM_RESULT_SIDEBAND_TRUNCATED  (1 << 8)
+#define SCE_AJM_RESULT_PRIORITY_PASSED     (1 << 9)
+#define SCE_AJM_RESULT_CODEC_ERROR         (1 << 30)
+#define SCE_AJM_RESULT_FATAL               (1 << 31)
+
 typedef unsigned int SceAjmCodecType;
 
 typedef unsigned int SceAjmContextId;
+
+typedef unsigned int SceAjmInstanceId;
+
+typedef unsigned int SceAjmBatchId;
+
+typedef struct {
+	uint8_t* pAddress;
+	uint64_t szSize;
+} SceAjmBuffer;
+
+typedef struct {
+	int iErrorCode;
+	int32_t reserved1;
+	const void* pJobAddress;	// record in the batch buffer of the failed job
+	uint32_t uiCommandOffset;	// offset of that record from the start of the batch
+	int32_t reserved2;
+	const void* pJobOriginRa;	// return address passed with the job
+} SceAjmBatchError;
+
+// Every sideband output starts with the result,
+// the parts asked for by the sideband flags follow.
+typedef struct {
+	int32_t iResult;			// SCE_AJM_RESULT_* bits
+	int32_t iInternalResult;	// codec specific
+} SceAjmSidebandResult;
+
+typedef struct {
+	int32_t iSizeConsumed;
+	int32_t iSizeProduced;
+	uint64_t uiTotalDecodedSamples;
+} SceAjmSidebandStream;
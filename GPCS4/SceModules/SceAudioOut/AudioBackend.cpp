@@ -0,0 +1,319 @@
+#include "AudioBackend.h"
+#include "AudioMixer.h"
+#include "rtaudio/rtaudio_c.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+LOG_CHANNEL(SceModules.SceAudioOut.AudioBackend);
+
+// Frames mixed per period, the grain size of most PS4 ports.
+constexpr uint32_t PeriodFrames = 256;
+// The timer driven backends run at the rate of PS4 ports.
+constexpr uint32_t TimerSampleRate = 48000;
+
+//////////////////////////////////////////////////////////////////////////
+// rtaudio
+
+class RtAudioBackend : public AudioBackend
+{
+public:
+	RtAudioBackend()
+	{
+		m_audioHandle = rtaudio_create(RTAUDIO_API_UNSPECIFIED);
+		m_deviceId    = rtaudio_get_default_output_device(m_audioHandle);
+
+		auto devInfo = rtaudio_get_device_info(m_audioHandle, m_deviceId);
+		m_sampleRate = devInfo.preferred_sample_rate ? devInfo.preferred_sample_rate : TimerSampleRate;
+	}
+
+	~RtAudioBackend()
+	{
+		stop();
+		rtaudio_destroy(m_audioHandle);
+	}
+
+	uint32_t sampleRate() const override
+	{
+		return m_sampleRate;
+	}
+
+	bool start(AudioMixer* mixer) override
+	{
+		bool bRet = false;
+		do
+		{
+			rtaudio_stream_parameters_t streamParam;
+			streamParam.device_id     = m_deviceId;
+			streamParam.first_channel = 0;
+			streamParam.num_channels  = 2;
+
+			unsigned int bufferFrameSize = PeriodFrames;
+			int          err             = rtaudio_open_stream(m_audioHandle,
+												   &streamParam,
+												   nullptr,
+												   RTAUDIO_FORMAT_FLOAT32,
+												   m_sampleRate,
+												   &bufferFrameSize,
+												   outputCallBack,
+												   mixer,
+												   nullptr,
+												   nullptr);
+			if (err != 0 || rtaudio_start_stream(m_audioHandle) != 0)
+			{
+				LOG_WARN("open audio stream failed %s", rtaudio_error(m_audioHandle));
+				break;
+			}
+
+			bRet = true;
+		} while (false);
+		return bRet;
+	}
+
+	void stop() override
+	{
+		if (rtaudio_is_stream_open(m_audioHandle))
+		{
+			rtaudio_close_stream(m_audioHandle);
+		}
+	}
+
+private:
+	static int outputCallBack(void* outputBuffer,
+							  void* in,
+							  unsigned int nFrames,
+							  double stream_time,
+							  rtaudio_stream_status_t status,
+							  void* userdata)
+	{
+		auto mixer = reinterpret_cast<AudioMixer*>(userdata);
+		mixer->mix(reinterpret_cast<float*>(outputBuffer), nFrames);
+		return 0;
+	}
+
+private:
+	rtaudio_t    m_audioHandle;
+	unsigned int m_deviceId;
+	uint32_t     m_sampleRate;
+};
+
+//////////////////////////////////////////////////////////////////////////
+// Timer driven backends
+// Pull one period from the mixer at the pace a device would. Deadlines
+// are absolute, so sleeping late doesn't make the stream drift.
+
+class TimerAudioBackend : public AudioBackend
+{
+public:
+	~TimerAudioBackend()
+	{
+		stop();
+	}
+
+	uint32_t sampleRate() const override
+	{
+		return TimerSampleRate;
+	}
+
+	bool start(AudioMixer* mixer) override
+	{
+		m_stopFlag.store(false);
+		m_thread = std::thread([this, mixer]() { run(mixer); });
+		return true;
+	}
+
+	void stop() override
+	{
+		if (m_thread.joinable())
+		{
+			m_stopFlag.store(true);
+			m_thread.join();
+		}
+	}
+
+protected:
+	// Called on the timer thread with every mixed period.
+	virtual void onPeriod(const float* samples, uint32_t frames)
+	{
+	}
+
+private:
+	void run(AudioMixer* mixer)
+	{
+		using Clock = std::chrono::steady_clock;
+
+		std::vector<float> buffer(PeriodFrames * 2);
+
+		auto     startTime = Clock::now();
+		uint64_t periods   = 0;
+		while (!m_stopFlag.load())
+		{
+			mixer->mix(buffer.data(), PeriodFrames);
+			onPeriod(buffer.data(), PeriodFrames);
+			++periods;
+
+			auto deadline = startTime + std::chrono::nanoseconds(
+											periods * PeriodFrames * 1000000000ull / TimerSampleRate);
+
+			// Deadlines are absolute, a late wake up
+			// only shortens the next wait.
+			std::this_thread::sleep_until(deadline);
+		}
+	}
+
+private:
+	std::thread       m_thread;
+	std::atomic<bool> m_stopFlag = { false };
+};
+
+class NullAudioBackend : public TimerAudioBackend
+{
+};
+
+class WavAudioBackend : public TimerAudioBackend
+{
+public:
+	WavAudioBackend(const std::string& path) :
+		m_path(path)
+	{
+	}
+
+	~WavAudioBackend()
+	{
+		stop();
+	}
+
+	bool start(AudioMixer* mixer) override
+	{
+		bool bRet = false;
+		do
+		{
+			m_file = fopen(m_path.c_str(), "wb");
+			if (!m_file)
+			{
+				LOG_ERR("open wav file failed %s", m_path.c_str());
+				break;
+			}
+
+			m_dataSize = 0;
+			writeHeader();
+
+			bRet = TimerAudioBackend::start(mixer);
+		} while (false);
+		return bRet;
+	}
+
+	void stop() override
+	{
+		TimerAudioBackend::stop();
+		if (m_file)
+		{
+			writeHeader();
+			fclose(m_file);
+			m_file = nullptr;
+		}
+	}
+
+protected:
+	void onPeriod(const float* samples, uint32_t frames) override
+	{
+		// 16 bit PCM, every player reads that.
+		m_pcm.resize(frames * 2);
+		for (uint32_t i = 0; i != frames * 2; ++i)
+		{
+			m_pcm[i] = static_cast<int16_t>(samples[i] * 32767.0f);
+		}
+		fwrite(m_pcm.data(), sizeof(int16_t), m_pcm.size(), m_file);
+		m_dataSize += static_cast<uint32_t>(m_pcm.size() * sizeof(int16_t));
+
+		// Keep the sizes valid about once a second,
+		// in case the process doesn't exit cleanly.
+		if (++m_periods % (TimerSampleRate / PeriodFrames) == 0)
+		{
+			writeHeader();
+		}
+	}
+
+private:
+	void writeHeader()
+	{
+		struct WavHeader
+		{
+			char     riff[4];
+			uint32_t riffSize;
+			char     wave[4];
+			char     fmt[4];
+			uint32_t fmtSize;
+			uint16_t formatTag;
+			uint16_t channels;
+			uint32_t sampleRate;
+			uint32_t byteRate;
+			uint16_t blockAlign;
+			uint16_t bitsPerSample;
+			char     data[4];
+			uint32_t dataSize;
+		};
+
+		WavHeader header = {
+			{ 'R', 'I', 'F', 'F' },
+			static_cast<uint32_t>(sizeof(WavHeader) - 8 + m_dataSize),
+			{ 'W', 'A', 'V', 'E' },
+			{ 'f', 'm', 't', ' ' },
+			16,
+			1,  // PCM
+			2,
+			TimerSampleRate,
+			TimerSampleRate * 2 * sizeof(int16_t),
+			2 * sizeof(int16_t),
+			16,
+			{ 'd', 'a', 't', 'a' },
+			m_dataSize
+		};
+
+		long pos = ftell(m_file);
+		fseek(m_file, 0, SEEK_SET);
+		fwrite(&header, sizeof(header), 1, m_file);
+		fseek(m_file, std::max<long>(pos, sizeof(header)), SEEK_SET);
+	}
+
+private:
+	std::string          m_path;
+	FILE*                m_file     = nullptr;
+	uint32_t             m_dataSize = 0;
+	uint64_t             m_periods  = 0;
+	std::vector<int16_t> m_pcm;
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+bool isAudioBackendName(const std::string& name)
+{
+	return name == "rtaudio" || name == "null" || name == "wav" || name.compare(0, 4, "wav:") == 0;
+}
+
+std::unique_ptr<AudioBackend> createAudioBackend(const std::string& name)
+{
+	std::unique_ptr<AudioBackend> backend;
+	if (name == "rtaudio")
+	{
+		backend = std::make_unique<RtAudioBackend>();
+	}
+	else if (name == "null")
+	{
+		backend = std::make_unique<NullAudioBackend>();
+	}
+	else if (name == "wav" || name.compare(0, 4, "wav:") == 0)
+	{
+		std::string path = name.size() > 4 ? name.substr(4) : "audio.wav";
+		backend          = std::make_unique<WavAudioBackend>(path);
+	}
+	else
+	{
+		LOG_ERR("unknown audio backend %s", name.c_str());
+	}
+	return backend;
+}
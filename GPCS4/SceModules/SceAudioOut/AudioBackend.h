@@ -0,0 +1,38 @@
+#pragma once
+
+#include "GPCS4Common.h"
+
+#include <memory>
+#include <string>
+
+class AudioMixer;
+
+// Host side of the audio output.
+// A backend pulls the mixed stream from the mixer, either from a
+// device callback or from its own thread. The mixer is created
+// for the rate of the backend, so the rate is known before start.
+
+class AudioBackend
+{
+public:
+	virtual ~AudioBackend()
+	{
+	}
+
+	virtual uint32_t sampleRate() const = 0;
+
+	// Returns false if the output could not be opened.
+	virtual bool start(AudioMixer* mixer) = 0;
+
+	// Once this returns the mixer is no longer called.
+	virtual void stop() = 0;
+};
+
+// name is one of
+//   rtaudio      the default output device
+//   null         discards the output, paced by a timer
+//   wav[:path]   writes the output to a wav file, paced by a timer
+// Returns null for an unknown name.
+std::unique_ptr<AudioBackend> createAudioBackend(const std::string& name);
+
+bool isAudioBackendName(const std::string& name);
@@ -0,0 +1,456 @@
+#include "AudioMixer.h"
+#include "sce_audioout.h"
+
+#include <algorithm>
+#include <cstring>
+#include <immintrin.h>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Clang and GCC need the target to compile the AVX2 kernels
+// without building the whole module for AVX2. Spelled as a
+// standard attribute, IntellisenseClang.h blanks __attribute__
+// for compilers other than clang.
+#if defined(__clang__) || defined(__GNUC__)
+#define AUDIO_TARGET_AVX2 [[gnu::target("avx2")]]
+#else
+#define AUDIO_TARGET_AVX2
+#endif
+
+LOG_CHANNEL(SceModules.SceAudioOut.mixer);
+
+// -3dB, for the center and surround channels in the stereo downmix.
+constexpr float DownmixGain = 0.70710678f;
+constexpr float S16Scale    = 1.0f / 32768.0f;
+
+static bool hasAvx2()
+{
+#ifdef _MSC_VER
+	int info[4] = {};
+	__cpuid(info, 0);
+	if (info[0] < 7)
+	{
+		return false;
+	}
+
+	// The OS has to save the ymm registers too.
+	__cpuid(info, 1);
+	bool bOsxsave = info[2] & (1 << 27);
+	bool bAvx     = info[2] & (1 << 28);
+	if (!bOsxsave || !bAvx || (_xgetbv(0) & 6) != 6)
+	{
+		return false;
+	}
+
+	__cpuidex(info, 7, 0);
+	return info[1] & (1 << 5);
+#else
+	return __builtin_cpu_supports("avx2");
+#endif
+}
+
+static const bool g_hasAvx2 = hasAvx2();
+
+//////////////////////////////////////////////////////////////////////////
+// Kernels
+// SSE2 is always there on x64, AVX2 versions are picked at runtime.
+
+static void convertS16Sse2(const int16_t* input, float* output, size_t count)
+{
+	const __m128 scale = _mm_set1_ps(S16Scale);
+
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		// Sign extend by moving each sample to the high half.
+		__m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i));
+		__m128i lo      = _mm_srai_epi32(_mm_unpacklo_epi16(samples, samples), 16);
+		__m128i hi      = _mm_srai_epi32(_mm_unpackhi_epi16(samples, samples), 16);
+		_mm_storeu_ps(output + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+		_mm_storeu_ps(output + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+	}
+
+	for (; i != count; ++i)
+	{
+		output[i] = input[i] * S16Scale;
+	}
+}
+
+AUDIO_TARGET_AVX2 static void convertS16Avx2(const int16_t* input, float* output, size_t count)
+{
+	const __m256 scale = _mm256_set1_ps(S16Scale);
+
+	size_t i = 0;
+	for (; i + 16 <= count; i += 16)
+	{
+		__m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i));
+		__m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i + 8));
+		_mm256_storeu_ps(output + i, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(lo)), scale));
+		_mm256_storeu_ps(output + i + 8, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(hi)), scale));
+	}
+
+	for (; i != count; ++i)
+	{
+		output[i] = input[i] * S16Scale;
+	}
+}
+
+static void accumulateSse2(float* output, const float* input, size_t count)
+{
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		_mm_storeu_ps(output + i, _mm_add_ps(_mm_loadu_ps(output + i), _mm_loadu_ps(input + i)));
+	}
+
+	for (; i != count; ++i)
+	{
+		output[i] += input[i];
+	}
+}
+
+AUDIO_TARGET_AVX2 static void accumulateAvx2(float* output, const float* input, size_t count)
+{
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		_mm256_storeu_ps(output + i, _mm256_add_ps(_mm256_loadu_ps(output + i), _mm256_loadu_ps(input + i)));
+	}
+
+	for (; i != count; ++i)
+	{
+		output[i] += input[i];
+	}
+}
+
+static void clampSse2(float* samples, size_t count)
+{
+	const __m128 lower = _mm_set1_ps(-1.0f);
+	const __m128 upper = _mm_set1_ps(1.0f);
+
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		_mm_storeu_ps(samples + i, _mm_min_ps(_mm_max_ps(_mm_loadu_ps(samples + i), lower), upper));
+	}
+
+	for (; i != count; ++i)
+	{
+		samples[i] = std::min(std::max(samples[i], -1.0f), 1.0f);
+	}
+}
+
+AUDIO_TARGET_AVX2 static void clampAvx2(float* samples, size_t count)
+{
+	const __m256 lower = _mm256_set1_ps(-1.0f);
+	const __m256 upper = _mm256_set1_ps(1.0f);
+
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		_mm256_storeu_ps(samples + i, _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(samples + i), lower), upper));
+	}
+
+	for (; i != count; ++i)
+	{
+		samples[i] = std::min(std::max(samples[i], -1.0f), 1.0f);
+	}
+}
+
+static void convertS16(const int16_t* input, float* output, size_t count)
+{
+	g_hasAvx2 ? convertS16Avx2(input, output, count) : convertS16Sse2(input, output, count);
+}
+
+static void accumulate(float* output, const float* input, size_t count)
+{
+	g_hasAvx2 ? accumulateAvx2(output, input, count) : accumulateSse2(output, input, count);
+}
+
+static void clamp(float* samples, size_t count)
+{
+	g_hasAvx2 ? clampAvx2(samples, count) : clampSse2(samples, count);
+}
+
+// Applies a channels x 2 gain matrix, gainsL and gainsR
+// hold the weight of every input channel in each output.
+static void downmix(const float* input, uint32_t channels,
+					const float* gainsL, const float* gainsR,
+					float* output, uint32_t frames)
+{
+	uint32_t i = 0;
+	switch (channels)
+	{
+	case 1:
+	{
+		const __m128 gains = _mm_setr_ps(gainsL[0], gainsR[0], gainsL[0], gainsR[0]);
+		for (; i + 4 <= frames; i += 4)
+		{
+			__m128 samples = _mm_loadu_ps(input + i);
+			_mm_storeu_ps(output + i * 2, _mm_mul_ps(_mm_unpacklo_ps(samples, samples), gains));
+			_mm_storeu_ps(output + i * 2 + 4, _mm_mul_ps(_mm_unpackhi_ps(samples, samples), gains));
+		}
+		break;
+	}
+	case 2:
+	{
+		const __m128 gainsFromL = _mm_setr_ps(gainsL[0], gainsR[0], gainsL[0], gainsR[0]);
+		const __m128 gainsFromR = _mm_setr_ps(gainsL[1], gainsR[1], gainsL[1], gainsR[1]);
+		for (; i + 2 <= frames; i += 2)
+		{
+			__m128 samples = _mm_loadu_ps(input + i * 2);
+			__m128 left    = _mm_shuffle_ps(samples, samples, _MM_SHUFFLE(2, 2, 0, 0));
+			__m128 right   = _mm_shuffle_ps(samples, samples, _MM_SHUFFLE(3, 3, 1, 1));
+			_mm_storeu_ps(output + i * 2, _mm_add_ps(_mm_mul_ps(left, gainsFromL), _mm_mul_ps(right, gainsFromR)));
+		}
+		break;
+	}
+	case 8:
+	{
+		const __m128 gainsL0 = _mm_loadu_ps(gainsL);
+		const __m128 gainsL1 = _mm_loadu_ps(gainsL + 4);
+		const __m128 gainsR0 = _mm_loadu_ps(gainsR);
+		const __m128 gainsR1 = _mm_loadu_ps(gainsR + 4);
+		for (; i != frames; ++i)
+		{
+			__m128 lo = _mm_loadu_ps(input + i * 8);
+			__m128 hi = _mm_loadu_ps(input + i * 8 + 4);
+			__m128 l  = _mm_add_ps(_mm_mul_ps(lo, gainsL0), _mm_mul_ps(hi, gainsL1));
+			__m128 r  = _mm_add_ps(_mm_mul_ps(lo, gainsR0), _mm_mul_ps(hi, gainsR1));
+
+			// [l0+l2, r0+r2, l1+l3, r1+r3], then fold the upper half.
+			__m128 sums = _mm_add_ps(_mm_unpacklo_ps(l, r), _mm_unpackhi_ps(l, r));
+			sums        = _mm_add_ps(sums, _mm_movehl_ps(sums, sums));
+			_mm_storel_pi(reinterpret_cast<__m64*>(output + i * 2), sums);
+		}
+		break;
+	}
+	default:
+		break;
+	}
+
+	for (; i != frames; ++i)
+	{
+		float left  = 0.0f;
+		float right = 0.0f;
+		for (uint32_t c = 0; c != channels; ++c)
+		{
+			left += input[i * channels + c] * gainsL[c];
+			right += input[i * channels + c] * gainsR[c];
+		}
+		output[i * 2]     = left;
+		output[i * 2 + 1] = right;
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+AudioMixerInput::AudioMixerInput(AudioRingBuffer* ring, uint32_t param, uint32_t freq) :
+	ring(ring),
+	numChannels(0),
+	bytesPerSample(2),
+	isFloat(false),
+	freq(freq)
+{
+	switch (param & SCE_AUDIO_OUT_PARAM_FORMAT_MASK)
+	{
+	case SCE_AUDIO_OUT_PARAM_FORMAT_S16_MONO:
+		numChannels = 1;
+		break;
+	case SCE_AUDIO_OUT_PARAM_FORMAT_S16_STEREO:
+		numChannels = 2;
+		break;
+	case SCE_AUDIO_OUT_PARAM_FORMAT_S16_8CH:
+	case SCE_AUDIO_OUT_PARAM_FORMAT_S16_8CH_STD:
+		numChannels = 8;
+		break;
+	case SCE_AUDIO_OUT_PARAM_FORMAT_FLOAT_MONO:
+		numChannels = 1;
+		isFloat     = true;
+		break;
+	case SCE_AUDIO_OUT_PARAM_FORMAT_FLOAT_STEREO:
+		numChannels = 2;
+		isFloat     = true;
+		break;
+	case SCE_AUDIO_OUT_PARAM_FORMAT_FLOAT_8CH:
+	case SCE_AUDIO_OUT_PARAM_FORMAT_FLOAT_8CH_STD:
+		numChannels = 8;
+		isFloat     = true;
+		break;
+	default:
+		LOG_ERR("unknown format %x", param);
+		break;
+	}
+
+	if (isFloat)
+	{
+		bytesPerSample = 4;
+	}
+
+	for (uint32_t i = 0; i != AUDIO_CHANNEL_COUNT; ++i)
+	{
+		channelMap[i] = static_cast<AudioChannel>(i);
+		volumes[i].store(1.0f);
+	}
+
+	uint32_t format = param & SCE_AUDIO_OUT_PARAM_FORMAT_MASK;
+	if (format == SCE_AUDIO_OUT_PARAM_FORMAT_S16_8CH_STD ||
+		format == SCE_AUDIO_OUT_PARAM_FORMAT_FLOAT_8CH_STD)
+	{
+		std::swap(channelMap[AUDIO_CHANNEL_LS], channelMap[AUDIO_CHANNEL_LE]);
+		std::swap(channelMap[AUDIO_CHANNEL_RS], channelMap[AUDIO_CHANNEL_RE]);
+	}
+}
+
+void AudioMixerInput::setVolume(AudioChannel channel, float volume)
+{
+	volumes[channel].store(volume, std::memory_order_relaxed);
+}
+
+AudioMixer::AudioMixer(uint32_t sampleRate) :
+	m_sampleRate(sampleRate)
+{
+	LOG_DEBUG("mixer rate %d avx2 %d", sampleRate, g_hasAvx2);
+}
+
+AudioMixer::~AudioMixer()
+{
+}
+
+void AudioMixer::addInput(AudioMixerInput* input)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_inputs.push_back(input);
+}
+
+void AudioMixer::removeInput(AudioMixerInput* input)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_inputs.erase(std::remove(m_inputs.begin(), m_inputs.end(), input), m_inputs.end());
+}
+
+size_t AudioMixer::inputCount()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_inputs.size();
+}
+
+void AudioMixer::mix(float* output, uint32_t frames)
+{
+	std::fill(output, output + frames * 2, 0.0f);
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		for (auto input : m_inputs)
+		{
+			mixInput(input, output, frames);
+		}
+	}
+
+	clamp(output, frames * 2);
+}
+
+void AudioMixer::mixInput(AudioMixerInput* input, float* output, uint32_t frames)
+{
+	if (input->freq == m_sampleRate)
+	{
+		uint32_t count = readStereo(input, frames);
+		accumulate(output, m_stereo.data(), count * 2);
+		return;
+	}
+
+	// Linear interpolation between the pending frames.
+	// Frames the input is short of are played as silence.
+	auto&  pending = input->pending;
+	double step    = double(input->freq) / m_sampleRate;
+	size_t needed  = size_t(input->position + (frames - 1) * step) + 2;
+	size_t have    = pending.size() / 2;
+	if (have < needed)
+	{
+		uint32_t count = readStereo(input, static_cast<uint32_t>(needed - have));
+		pending.insert(pending.end(), m_stereo.begin(), m_stereo.begin() + count * 2);
+		pending.resize(needed * 2, 0.0f);
+	}
+
+	double position = input->position;
+	for (uint32_t i = 0; i != frames; ++i)
+	{
+		size_t index    = size_t(position);
+		float  fraction = float(position - index);
+
+		const float* frame = pending.data() + index * 2;
+		output[i * 2] += frame[0] + (frame[2] - frame[0]) * fraction;
+		output[i * 2 + 1] += frame[1] + (frame[3] - frame[1]) * fraction;
+
+		position += step;
+	}
+
+	size_t consumed = std::min(size_t(position), pending.size() / 2);
+	pending.erase(pending.begin(), pending.begin() + consumed * 2);
+	input->position = position - consumed;
+}
+
+uint32_t AudioMixer::readStereo(AudioMixerInput* input, uint32_t frames)
+{
+	uint32_t channels   = input->numChannels;
+	size_t   frameBytes = channels * input->bytesPerSample;
+	if (frameBytes == 0)
+	{
+		return 0;
+	}
+
+	m_raw.resize(frames * frameBytes);
+	size_t   bytesRead = input->ring->read(m_raw.data(), m_raw.size());
+	uint32_t count     = static_cast<uint32_t>(bytesRead / frameBytes);
+	if (bytesRead != 0 && input->onConsumed)
+	{
+		input->onConsumed();
+	}
+
+	const float* samples = reinterpret_cast<const float*>(m_raw.data());
+	if (!input->isFloat)
+	{
+		m_samples.resize(count * channels);
+		convertS16(reinterpret_cast<const int16_t*>(m_raw.data()), m_samples.data(), count * channels);
+		samples = m_samples.data();
+	}
+
+	float gainsL[AUDIO_CHANNEL_COUNT] = {};
+	float gainsR[AUDIO_CHANNEL_COUNT] = {};
+	for (uint32_t c = 0; c != channels; ++c)
+	{
+		AudioChannel channel = input->channelMap[c];
+		float        volume  = input->volumes[channel].load(std::memory_order_relaxed);
+		switch (channels == 1 ? AUDIO_CHANNEL_C : channel)
+		{
+		case AUDIO_CHANNEL_L:
+			gainsL[c] = volume;
+			break;
+		case AUDIO_CHANNEL_R:
+			gainsR[c] = volume;
+			break;
+		case AUDIO_CHANNEL_C:
+			// Mono goes to both sides at full level.
+			gainsL[c] = channels == 1 ? volume : volume * DownmixGain;
+			gainsR[c] = gainsL[c];
+			break;
+		case AUDIO_CHANNEL_LS:
+		case AUDIO_CHANNEL_LE:
+			gainsL[c] = volume * DownmixGain;
+			break;
+		case AUDIO_CHANNEL_RS:
+		case AUDIO_CHANNEL_RE:
+			gainsR[c] = volume * DownmixGain;
+			break;
+		default:
+			// LFE is dropped
+			break;
+		}
+	}
+
+	m_stereo.resize(count * 2);
+	downmix(samples, channels, gainsL, gainsR, m_stereo.data(), count);
+	return count;
+}
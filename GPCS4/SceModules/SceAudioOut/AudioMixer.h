@@ -0,0 +1,99 @@
+#pragma once
+
+#include "GPCS4Common.h"
+#include "AudioRingBuffer.h"
+
+#include <array>
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+// Channels in the order of the 8ch formats.
+// The _STD formats swap the surround and extended pairs.
+enum AudioChannel
+{
+	AUDIO_CHANNEL_L,
+	AUDIO_CHANNEL_R,
+	AUDIO_CHANNEL_C,
+	AUDIO_CHANNEL_LFE,
+	AUDIO_CHANNEL_LS,
+	AUDIO_CHANNEL_RS,
+	AUDIO_CHANNEL_LE,
+	AUDIO_CHANNEL_RE,
+	AUDIO_CHANNEL_COUNT
+};
+
+// One open port as seen by the mixer.
+// The port writes grains into the ring, the mixer pulls them
+// from the output thread and calls onConsumed after reading.
+struct AudioMixerInput
+{
+	AudioMixerInput(AudioRingBuffer* ring, uint32_t param, uint32_t freq);
+
+	// Channel volumes, 1.0 is 0dB.
+	void setVolume(AudioChannel channel, float volume);
+
+	AudioRingBuffer*      ring;
+	std::function<void()> onConsumed;
+
+	uint32_t numChannels;
+	uint32_t bytesPerSample;
+	bool     isFloat;
+	uint32_t freq;
+
+	// Maps the channels of a frame to AudioChannel
+	std::array<AudioChannel, AUDIO_CHANNEL_COUNT> channelMap;
+	std::array<std::atomic<float>, AUDIO_CHANNEL_COUNT> volumes;
+
+	// Resampler state, only touched by the mixer.
+	// Stereo frames read from the ring but not played yet.
+	std::vector<float> pending;
+	double             position = 0.0;
+};
+
+// Software mixer.
+// Sums all inputs into interleaved float stereo at the output
+// rate. Each input is converted to float, scaled by its channel
+// volumes, downmixed to stereo and resampled to the output rate.
+// The mixer doesn't own a device, whoever drives the output
+// calls mix for every buffer it needs.
+
+class AudioMixer
+{
+public:
+	explicit AudioMixer(uint32_t sampleRate);
+	~AudioMixer();
+
+	uint32_t sampleRate() const
+	{
+		return m_sampleRate;
+	}
+
+	void addInput(AudioMixerInput* input);
+
+	// Once this returns the mixer no longer touches the input.
+	void removeInput(AudioMixerInput* input);
+
+	size_t inputCount();
+
+	void mix(float* output, uint32_t frames);
+
+private:
+	void mixInput(AudioMixerInput* input, float* output, uint32_t frames);
+
+	// Reads up to frames frames of the input as stereo
+	// float into m_stereo, returns the number read.
+	uint32_t readStereo(AudioMixerInput* input, uint32_t frames);
+
+private:
+	uint32_t m_sampleRate;
+
+	std::mutex                    m_mutex;
+	std::vector<AudioMixerInput*> m_inputs;
+
+	// Scratch buffers of the output thread
+	std::vector<uint8_t> m_raw;
+	std::vector<float>   m_samples;
+	std::vector<float>   m_stereo;
+};
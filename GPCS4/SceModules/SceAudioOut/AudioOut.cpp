@@ -1,12 +1,22 @@
 #include "AudioOut.h"
-#include "rtaudio/rtaudio_c.h"
-#include "BlockingQueue.h"
+#include "AudioBackend.h"
+#include "AudioMixer.h"
+#include "AudioRingBuffer.h"
 
 #include <mutex>
 #include <condition_variable>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
 #include <string>
 
+LOG_CHANNEL(SceModules.SceAudioOut.AudioOut);
+
+// Number of grains a port may have queued before
+// sceAudioOutOutput blocks. A grain is len samples.
+static std::atomic<uint32_t> g_latencyGrains = { 2 };
+
 // #define DUMP_AUDIO
 #ifdef DUMP_AUDIO
 class AudioDumper
@@ -26,6 +36,83 @@ private:
 };
 #endif
 
+// All ports are mixed into one host stream,
+// which is opened along with the first port.
+class AudioHostOutput
+{
+public:
+	// Stops pulling from the mixer, the mixer itself stays
+	// so ports can still be closed afterwards.
+	void close()
+	{
+		std::lock_guard<std::mutex> lock{ m_mutex };
+		if (m_backend)
+		{
+			m_backend->stop();
+		}
+	}
+
+	void setBackend(const std::string& name)
+	{
+		std::lock_guard<std::mutex> lock{ m_mutex };
+		m_backendName = name;
+	}
+
+	AudioMixer* open()
+	{
+		std::lock_guard<std::mutex> lock{ m_mutex };
+		do
+		{
+			if (m_mixer)
+			{
+				break;
+			}
+
+			auto backend = createAudioBackend(m_backendName);
+			auto mixer   = backend ? std::make_unique<AudioMixer>(backend->sampleRate()) : nullptr;
+			if (!backend || !backend->start(mixer.get()))
+			{
+				// Without a device keep the timing games pace themselves with.
+				LOG_WARN("audio backend %s failed, fall back to null", m_backendName.c_str());
+				backend = createAudioBackend("null");
+				mixer   = std::make_unique<AudioMixer>(backend->sampleRate());
+				if (!backend->start(mixer.get()))
+				{
+					break;
+				}
+			}
+
+			m_mixer   = std::move(mixer);
+			m_backend = std::move(backend);
+
+			// Let the wav backend finish its file.
+			std::atexit(closeHostOutput);
+		} while (false);
+		return m_mixer.get();
+	}
+
+private:
+	static void closeHostOutput();
+
+private:
+	std::mutex m_mutex;
+	std::string m_backendName = "rtaudio";
+	std::unique_ptr<AudioMixer> m_mixer;
+	std::unique_ptr<AudioBackend> m_backend;
+};
+
+static AudioHostOutput& getHostOutput()
+{
+	// Never destroyed, ports may be closed while statics are destroyed.
+	static AudioHostOutput* s_output = new AudioHostOutput();
+	return *s_output;
+}
+
+void AudioHostOutput::closeHostOutput()
+{
+	getHostOutput().close();
+}
+
 struct AudioOutContext
 {
 	struct
@@ -38,277 +125,199 @@ struct AudioOutContext
 		uint32_t param;
 	} apiParams;
 
-	struct
-	{
-		uint32_t numChannels;
-		uint32_t bytesConsumesPerSample;
-	} requestedArgs;
+	uint32_t grainSize;
 
-	struct
-	{
-		uint32_t numChannels;
-		uint32_t bytesConsumesPerSample;
-	} supportedArgs;
+	// Grains are copied in when they are submitted,
+	// the game never waits for the output thread itself.
+	std::unique_ptr<AudioRingBuffer> ring;
+	std::unique_ptr<AudioMixerInput> input;
+	std::chrono::microseconds grainDuration;
 
-	rtaudio_t audioHandle;
-	uint32_t bytesPerSample;
+	AudioMixer* mixer = nullptr;
 
+	// The game thread checks the fill and waits for room under the
+	// mutex, the output thread takes it after every read to notify.
 	std::mutex mutex;
-	std::condition_variable condDone;
-	BlockingQueue<const void*> queue;
+	std::condition_variable condConsumed;
+	bool waiting = false;
 
-	bool doneFlag = false;
-	bool streamOpenFlag = false;
 	int lastError = 0;
 	
 	#ifdef DUMP_AUDIO
 	AudioDumper audioDumper;
 	AudioOutContext() :
-		queue{ 1 }, audioDumper{ "audiodump.raw" }
-	{
-		audioHandle = rtaudio_create(RTAUDIO_API_UNSPECIFIED);
-	}
-	#else
-	AudioOutContext() :
-		queue {1}
+		audioDumper{ "audiodump.raw" }
 	{
-		audioHandle = rtaudio_create(RTAUDIO_API_UNSPECIFIED);
 	}
 	#endif
-
-	~AudioOutContext()
-	{
-		rtaudio_destroy(audioHandle);
-	}
 };
 
-struct AudioProperties
+// Called by the mixer after it read from the ring.
+// Always takes the mutex, so a waiter either sees the read
+// when it checks the fill, or is waiting and gets notified.
+static void notifyConsumed(AudioOutContext* ctx)
 {
-	uint32_t nChannels;
-	uint32_t bytesPerSample;
-	uint32_t audioFormat;
-};
-
-
-static AudioProperties getAudioProperties(uint32_t param)
-{
-	uint32_t format       = param & 0x000000ff;
-	AudioProperties props = {};
-
-	switch (format)
-	{
-	case SCE_AUDIO_OUT_PARAM_FORMAT_S16_MONO:
-	{
-		props.nChannels   = 1;
-		props.bytesPerSample  = 2;
-		props.audioFormat = RTAUDIO_FORMAT_SINT16;
-		break;
-	}
-
-	case SCE_AUDIO_OUT_PARAM_FORMAT_S16_STEREO:
+	std::lock_guard<std::mutex> lock{ ctx->mutex };
+	if (ctx->waiting)
 	{
-		props.nChannels   = 2;
-		props.bytesPerSample  = 2;
-		props.audioFormat = RTAUDIO_FORMAT_SINT16;
-		break;
-	}
-
-	case SCE_AUDIO_OUT_PARAM_FORMAT_S16_8CH:
-	{
-		props.nChannels   = 8;
-		props.bytesPerSample  = 2;
-		props.audioFormat = RTAUDIO_FORMAT_SINT16;
-		break;
-	}
-
-	case SCE_AUDIO_OUT_PARAM_FORMAT_S16_8CH_STD:
-	{
-		props.nChannels   = 8;
-		props.bytesPerSample  = 2;
-		props.audioFormat = RTAUDIO_FORMAT_SINT16;
-		break;
+		ctx->condConsumed.notify_one();
 	}
+}
 
-	case SCE_AUDIO_OUT_PARAM_FORMAT_FLOAT_MONO:
+// Blocks until at most maxFill bytes are queued.
+static void waitForFill(AudioOutContext* ctx, size_t maxFill)
+{
+	// Reads only lower the fill, no need to lock if it's low enough.
+	if (ctx->ring->size() <= maxFill)
 	{
-		props.nChannels   = 1;
-		props.bytesPerSample  = 4;
-		props.audioFormat = RTAUDIO_FORMAT_FLOAT32;
+		return;
 	}
 
-	case SCE_AUDIO_OUT_PARAM_FORMAT_FLOAT_STEREO:
+	std::unique_lock<std::mutex> lock{ ctx->mutex };
+	ctx->waiting = true;
+	while (ctx->ring->size() > maxFill)
 	{
-		props.nChannels   = 2;
-		props.bytesPerSample  = 4;
-		props.audioFormat = RTAUDIO_FORMAT_FLOAT32;
-		break;
+		// Time out in case the output stops pulling.
+		ctx->condConsumed.wait_for(lock, ctx->grainDuration);
 	}
+	ctx->waiting = false;
+}
 
-	case SCE_AUDIO_OUT_PARAM_FORMAT_FLOAT_8CH:
-	{
-		props.nChannels   = 8;
-		props.bytesPerSample  = 4;
-		props.audioFormat = RTAUDIO_FORMAT_FLOAT32;
-		break;
-	}
+AudioOut::AudioOut(SceUserServiceUserId userId,
+				   int32_t type,
+				   int32_t index,
+				   uint32_t len,
+				   uint32_t freq,
+				   uint32_t param)
+{
+	m_audioOutContext = std::make_unique<AudioOutContext>();
+	auto ctx          = m_audioOutContext.get();
 
-	case SCE_AUDIO_OUT_PARAM_FORMAT_FLOAT_8CH_STD:
+	// save API parameteres
+	ctx->apiParams.userId = userId;
+	ctx->apiParams.type = type;
+	ctx->apiParams.index = index;
+	ctx->apiParams.len = len;
+	ctx->apiParams.freq = freq;
+	ctx->apiParams.param = param;
+
+	// The input knows the layout of the format.
+	ctx->input     = std::make_unique<AudioMixerInput>(nullptr, param, freq);
+	ctx->grainSize = ctx->input->numChannels * ctx->input->bytesPerSample * len;
+
+	ctx->ring        = std::make_unique<AudioRingBuffer>(ctx->grainSize * g_latencyGrains.load());
+	ctx->input->ring = ctx->ring.get();
+	ctx->input->onConsumed = [ctx]() { notifyConsumed(ctx); };
+	ctx->grainDuration = std::chrono::microseconds(
+		std::max<uint64_t>(freq ? uint64_t(len) * 1000000 / freq : 0, 1000));
+
+	ctx->mixer = getHostOutput().open();
+	if (ctx->mixer == nullptr)
 	{
-		props.nChannels   = 8;
-		props.bytesPerSample  = 4;
-		props.audioFormat = RTAUDIO_FORMAT_FLOAT32;
-		break;
-	}
+		ctx->lastError = -1;
+		return;
 	}
+	ctx->mixer->addInput(ctx->input.get());
+}
 
-	return props;
+AudioOut::~AudioOut()
+{
+	audioClose();
 }
 
-static int outputCallBack(void* outputBuffer,
-						  void* in,
-						  unsigned int nFrames,
-						  double stream_time,
-						  rtaudio_stream_status_t status,
-						  void* userdata)
+int32_t AudioOut::audioSubmit(const void* ptr)
 {
-	int rc = 0;
-	auto ctx = reinterpret_cast<AudioOutContext*>(userdata);
-	auto buffer = reinterpret_cast<const uint8_t*>(ctx->queue.pop());
+	auto ctx = m_audioOutContext.get();
+	if (ctx->mixer == nullptr)
 	{
-		std::unique_lock<std::mutex> lock {ctx->mutex};
-		if (buffer == nullptr)
-		{
-			rc = 1;
-		}
-		else
-		{
-			std::copy(buffer,
-					  buffer + ctx->requestedArgs.bytesConsumesPerSample,
-					  reinterpret_cast<uint8_t*>(outputBuffer));
-			rc = 0;
-		}
-
-		ctx->doneFlag = true;
+		return -1;
 	}
 
-	ctx->condDone.notify_one();
+#ifdef DUMP_AUDIO
+	ctx->audioDumper.dumpAudio(reinterpret_cast<const uint8_t*>(ptr), ctx->grainSize);
+#endif
 
-	return rc;
+	waitForFill(ctx, ctx->ring->capacity() - ctx->grainSize);
+	ctx->ring->write(ptr, ctx->grainSize);
+	return 0;
 }
 
-AudioOut::AudioOut(SceUserServiceUserId userId,
-				   int32_t type,
-				   int32_t index,
-				   uint32_t len,
-				   uint32_t freq,
-				   uint32_t param)
+void AudioOut::audioWaitForRoom()
 {
-	m_audioOutContext = std::make_unique<AudioOutContext>();
-
-	// save API parameteres
-	m_audioOutContext->apiParams.userId = userId;
-	m_audioOutContext->apiParams.type = type;
-	m_audioOutContext->apiParams.index = index;
-	m_audioOutContext->apiParams.len = len;
-	m_audioOutContext->apiParams.freq = freq;
-	m_audioOutContext->apiParams.param = param;
-
-	// requested paramters
-	auto audioProps = getAudioProperties(param);
-	m_audioOutContext->bytesPerSample            = audioProps.bytesPerSample;
-	m_audioOutContext->requestedArgs.numChannels = audioProps.nChannels;
-	m_audioOutContext->requestedArgs.bytesConsumesPerSample =
-		m_audioOutContext->requestedArgs.numChannels
-		* audioProps.bytesPerSample 
-		* m_audioOutContext->apiParams.len;
-
-	auto devId = rtaudio_get_default_output_device(m_audioOutContext->audioHandle);
-	auto devInfo = rtaudio_get_device_info(m_audioOutContext->audioHandle, devId);
-
-	// supported parameters
-	m_audioOutContext->supportedArgs.numChannels = devInfo.output_channels;
-
-	m_audioOutContext->supportedArgs.bytesConsumesPerSample =
-		m_audioOutContext->supportedArgs.numChannels 
-		* audioProps.bytesPerSample 
-		* m_audioOutContext->apiParams.len;
-
-	// open audio stream
-	rtaudio_stream_parameters_t streamParam;
-	streamParam.device_id = devId;
-	streamParam.first_channel = 0;
-	streamParam.num_channels  = m_audioOutContext->requestedArgs.numChannels;
-
-	unsigned int bufferFrameSize = static_cast<unsigned int>(m_audioOutContext->apiParams.len);
-	m_audioOutContext->lastError =
-		rtaudio_open_stream(m_audioOutContext->audioHandle,
-							&streamParam,
-							nullptr,
-							audioProps.audioFormat,
-							m_audioOutContext->apiParams.freq,
-							&bufferFrameSize,
-							outputCallBack,
-							m_audioOutContext.get(),
-							nullptr,
-							nullptr);
+	auto ctx = m_audioOutContext.get();
+	if (ctx->mixer != nullptr)
+	{
+		waitForFill(ctx, ctx->ring->capacity() - ctx->grainSize);
+	}
 }
 
-AudioOut::~AudioOut() = default;
-
 int32_t AudioOut::audioOutput(const void* ptr)
 {
 	int rc = 0;
 	do
 	{
-		if (m_audioOutContext->streamOpenFlag == false)
+		auto ctx = m_audioOutContext.get();
+		if (ctx->mixer == nullptr)
 		{
-			rtaudio_start_stream(m_audioOutContext->audioHandle);
-			if (rtaudio_error(m_audioOutContext->audioHandle) != nullptr)
-			{
-				m_audioOutContext->lastError = -1;
-				rc                           = -1;
-
-				break;	
-			}
-			m_audioOutContext->streamOpenFlag = true;
+			rc = -1;
+			break;
 		}
 
+		// Null waits until everything queued has been played.
 		if (ptr == nullptr)
 		{
-			std::unique_lock<std::mutex> lock { m_audioOutContext->mutex };
-			m_audioOutContext->condDone.wait(lock, [=] { return m_audioOutContext->doneFlag; });
+			waitForFill(ctx, 0);
 			break;
 		}
 
-		auto dataPtr = reinterpret_cast<const uint8_t*>(ptr);
+		// Return once there is room for the next grain,
+		// like the hardware does with its queued buffers.
+		audioSubmit(ptr);
+		audioWaitForRoom();
+	} while (false);
 
-#ifdef DUMP_AUDIO
-			m_audioOutContext
-				->audioDumper
-				.dumpAudio(dataPtr, m_audioOutContext->requestedArgs.bytesConsumesPerSample);
-#endif
+	return rc;
+}
 
+void AudioOut::audioSetVolume(int32_t flag, const int32_t* vol)
+{
+	for (uint32_t i = 0; i != AUDIO_CHANNEL_COUNT; ++i)
+	{
+		if (flag & (1 << i))
 		{
-			std::unique_lock<std::mutex> lock{ m_audioOutContext->mutex };
-			m_audioOutContext->doneFlag = false;
-			m_audioOutContext->queue.push(dataPtr);
-			m_audioOutContext->condDone.wait(lock, [=] { return m_audioOutContext->doneFlag; });
+			m_audioOutContext->input->setVolume(static_cast<AudioChannel>(i),
+												float(vol[i]) / SCE_AUDIO_VOLUME_0DB);
 		}
-
-	} while (false);
-
-	return rc;
+	}
 }
 
 int32_t AudioOut::audioClose()
 {
-	m_audioOutContext->queue.push(nullptr);
-	rtaudio_close_stream(m_audioOutContext->audioHandle);
-	m_audioOutContext->streamOpenFlag = false;
+	auto ctx = m_audioOutContext.get();
+	if (ctx->mixer)
+	{
+		ctx->mixer->removeInput(ctx->input.get());
+		ctx->mixer = nullptr;
+	}
 
 	return 0;
 }
 
+bool AudioOut::setBackend(const std::string& name)
+{
+	if (!isAudioBackendName(name))
+	{
+		return false;
+	}
+	getHostOutput().setBackend(name);
+	return true;
+}
+
+void AudioOut::setLatency(uint32_t grains)
+{
+	g_latencyGrains.store(std::max(grains, 1u));
+}
+
 int AudioOut::getLastError()
 {
 	return m_audioOutContext->lastError;
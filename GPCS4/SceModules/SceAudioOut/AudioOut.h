@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <string>
 #include "sce_audioout.h"
 
 struct AudioOutContext;
@@ -11,8 +12,22 @@ public:
 	AudioOut(SceUserServiceUserId userId, int32_t type, int32_t index, uint32_t len, uint32_t freq, uint32_t param);
 	~AudioOut();
 	int32_t audioOutput(const void* ptr);
+	// Queues a grain without waiting for room for the next one,
+	// so several ports can be fed before any of them blocks.
+	int32_t audioSubmit(const void* ptr);
+	void audioWaitForRoom();
+	// vol holds one volume per channel, flag selects the channels to set.
+	void audioSetVolume(int32_t flag, const int32_t* vol);
 	int32_t audioClose();
 	int getLastError();
+
+	// Grains a port may queue before output blocks,
+	// applies to ports opened afterwards.
+	static void setLatency(uint32_t grains);
+
+	// Selects the host output, see createAudioBackend.
+	// Returns false for an unknown backend.
+	static bool setBackend(const std::string& name);
 private:
 	std::unique_ptr<AudioOutContext> m_audioOutContext;
 };
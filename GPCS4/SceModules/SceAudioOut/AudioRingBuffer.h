@@ -0,0 +1,89 @@
+#pragma once
+
+#include "GPCS4Common.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <vector>
+
+// Single producer, single consumer byte ring.
+// The game thread writes whole grains, the audio device callback
+// reads whatever it needs. Neither side ever locks, the read and
+// write positions only grow, so a full ring can't be mistaken for
+// an empty one.
+
+class AudioRingBuffer
+{
+public:
+	explicit AudioRingBuffer(size_t capacity) :
+		m_buffer(std::max<size_t>(capacity, 1))
+	{
+	}
+
+	size_t capacity() const
+	{
+		return m_buffer.size();
+	}
+
+	// Bytes written but not read yet.
+	size_t size() const
+	{
+		uint64_t writePos = m_writePos.load(std::memory_order_acquire);
+		uint64_t readPos  = m_readPos.load(std::memory_order_acquire);
+		return static_cast<size_t>(writePos - readPos);
+	}
+
+	// Producer only.
+	// Writes all of the data or nothing, if it doesn't fit.
+	bool write(const void* data, size_t length)
+	{
+		uint64_t writePos = m_writePos.load(std::memory_order_relaxed);
+		uint64_t readPos  = m_readPos.load(std::memory_order_acquire);
+		if (length > m_buffer.size() - (writePos - readPos))
+		{
+			return false;
+		}
+
+		copyIn(writePos, reinterpret_cast<const uint8_t*>(data), length);
+		m_writePos.store(writePos + length, std::memory_order_release);
+		return true;
+	}
+
+	// Consumer only.
+	// Returns the number of bytes read, less than length on underrun.
+	size_t read(void* data, size_t length)
+	{
+		uint64_t readPos  = m_readPos.load(std::memory_order_relaxed);
+		uint64_t writePos = m_writePos.load(std::memory_order_acquire);
+		size_t   count    = std::min<size_t>(length, writePos - readPos);
+
+		copyOut(readPos, reinterpret_cast<uint8_t*>(data), count);
+		m_readPos.store(readPos + count, std::memory_order_release);
+		return count;
+	}
+
+private:
+	void copyIn(uint64_t pos, const uint8_t* data, size_t length)
+	{
+		size_t offset = static_cast<size_t>(pos % m_buffer.size());
+		size_t first  = std::min(length, m_buffer.size() - offset);
+		std::memcpy(m_buffer.data() + offset, data, first);
+		std::memcpy(m_buffer.data(), data + first, length - first);
+	}
+
+	void copyOut(uint64_t pos, uint8_t* data, size_t length)
+	{
+		size_t offset = static_cast<size_t>(pos % m_buffer.size());
+		size_t first  = std::min(length, m_buffer.size() - offset);
+		std::memcpy(data, m_buffer.data() + offset, first);
+		std::memcpy(data + first, m_buffer.data(), length - first);
+	}
+
+private:
+	std::vector<uint8_t> m_buffer;
+
+	// Each side owns a cache line
+	alignas(64) std::atomic<uint64_t> m_writePos = { 0 };
+	alignas(64) std::atomic<uint64_t> m_readPos  = { 0 };
+};
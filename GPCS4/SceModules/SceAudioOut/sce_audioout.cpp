@@ -56,8 +56,23 @@ int32_t PS4API sceAudioOutOpen(SceUserServiceUserId userId, int32_t type, int32_
 }
 
 
+static AudioOut* getAudioOut(int32_t handle)
+{
+	if (handle <= 0 || handle >= MAX_AUDIO_SLOTS)
+	{
+		return nullptr;
+	}
+	return g_AudioSlots.GetItemAt(handle).get();
+}
+
+
 int32_t PS4API sceAudioOutClose(int32_t handle)
 {
+	if (!getAudioOut(handle))
+	{
+		return SCE_AUDIO_OUT_ERROR_INVALID_PORT;
+	}
+
 	auto& audioOut = g_AudioSlots.GetItemAt(handle);
 	audioOut->audioClose();
 	audioOut.reset(nullptr);
@@ -81,7 +96,12 @@ int32_t PS4API sceAudioOutOutput(int32_t handle, const void *ptr)
 {
 	int rc         = SCE_OK;
 
-	auto& audioOut = g_AudioSlots.GetItemAt(handle);
+	auto audioOut = getAudioOut(handle);
+	if (!audioOut)
+	{
+		return SCE_AUDIO_OUT_ERROR_INVALID_PORT;
+	}
+
 	rc = audioOut->audioOutput(ptr);
 	if (rc != 0)
 	{
@@ -92,17 +112,96 @@ int32_t PS4API sceAudioOutOutput(int32_t handle, const void *ptr)
 }
 
 
-int PS4API sceAudioOutOutputs(void)
+int32_t PS4API sceAudioOutOutputs(SceAudioOutOutputParam *param, uint32_t num)
 {
-	LOG_FIXME("Not implemented");
-	return SCE_OK;
+	int32_t rc = SCE_OK;
+	do
+	{
+		if (!param)
+		{
+			rc = SCE_AUDIO_OUT_ERROR_INVALID_POINTER;
+			break;
+		}
+
+		for (uint32_t i = 0; i != num; ++i)
+		{
+			if (!getAudioOut(param[i].handle))
+			{
+				rc = SCE_AUDIO_OUT_ERROR_INVALID_PORT;
+				break;
+			}
+		}
+
+		if (rc != SCE_OK)
+		{
+			break;
+		}
+
+		// Queue every grain first, so all ports start together,
+		// then block like a single output does.
+		for (uint32_t i = 0; i != num; ++i)
+		{
+			auto audioOut = getAudioOut(param[i].handle);
+			if (param[i].ptr && audioOut->audioSubmit(param[i].ptr) != 0)
+			{
+				rc = SCE_AUDIO_OUT_ERROR_TRANS_EVENT;
+			}
+		}
+
+		for (uint32_t i = 0; i != num; ++i)
+		{
+			auto audioOut = getAudioOut(param[i].handle);
+			if (param[i].ptr)
+			{
+				audioOut->audioWaitForRoom();
+			}
+			else
+			{
+				audioOut->audioOutput(nullptr);
+			}
+		}
+	} while (false);
+
+	return rc;
 }
 
 
-int PS4API sceAudioOutSetVolume(void)
+int32_t PS4API sceAudioOutSetVolume(int32_t handle, int32_t flag, int32_t *vol)
 {
-	LOG_FIXME("Not implemented");
-	return SCE_OK;
+	int32_t rc = SCE_OK;
+	do
+	{
+		auto audioOut = getAudioOut(handle);
+		if (!audioOut)
+		{
+			rc = SCE_AUDIO_OUT_ERROR_INVALID_PORT;
+			break;
+		}
+
+		if (!vol)
+		{
+			rc = SCE_AUDIO_OUT_ERROR_INVALID_POINTER;
+			break;
+		}
+
+		for (uint32_t i = 0; i != 8; ++i)
+		{
+			if ((flag & (1 << i)) && (vol[i] < 0 || vol[i] > SCE_AUDIO_VOLUME_0DB))
+			{
+				rc = SCE_AUDIO_OUT_ERROR_INVALID_VOLUME;
+				break;
+			}
+		}
+
+		if (rc != SCE_OK)
+		{
+			break;
+		}
+
+		audioOut->audioSetVolume(flag, vol);
+	} while (false);
+
+	return rc;
 }
 
 
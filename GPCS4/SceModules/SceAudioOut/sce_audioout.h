@@ -32,6 +32,22 @@ extern const SCE_EXPORT_MODULE g_ExpModuleSceAudioOut;
 #define SCE_AUDIO_OUT_PARAM_FORMAT_MASK  0x000000FF
 #define SCE_AUDIO_OUT_PARAM_FORMAT_SHIFT 0
 
+#define SCE_AUDIO_VOLUME_SHIFT 15
+#define SCE_AUDIO_VOLUME_0DB   (1 << SCE_AUDIO_VOLUME_SHIFT)
+
+#define SCE_AUDIO_VOLUME_FLAG_L_CH   (1 << 0)
+#define SCE_AUDIO_VOLUME_FLAG_R_CH   (1 << 1)
+#define SCE_AUDIO_VOLUME_FLAG_C_CH   (1 << 2)
+#define SCE_AUDIO_VOLUME_FLAG_LFE_CH (1 << 3)
+#define SCE_AUDIO_VOLUME_FLAG_LS_CH  (1 << 4)
+#define SCE_AUDIO_VOLUME_FLAG_RS_CH  (1 << 5)
+#define SCE_AUDIO_VOLUME_FLAG_LE_CH  (1 << 6)
+#define SCE_AUDIO_VOLUME_FLAG_RE_CH  (1 << 7)
+
+#define SCE_AUDIO_OUT_ERROR_NOT_OPENED      -2144993279
+#define SCE_AUDIO_OUT_ERROR_INVALID_PORT    -2144993277
+#define SCE_AUDIO_OUT_ERROR_INVALID_POINTER -2144993276
+#define SCE_AUDIO_OUT_ERROR_INVALID_VOLUME  -2144993271
 #define SCE_AUDIO_OUT_ERROR_TRANS_EVENT -2144993262
 //////////////////////////////////////////////////////////////////////////
 // library: libSceAudioOut
@@ -52,10 +68,10 @@ int32_t PS4API sceAudioOutOpen(SceUserServiceUserId userId, int32_t type, int32_
 int32_t PS4API sceAudioOutOutput(int32_t handle, const void *p);
 
 
-int PS4API sceAudioOutOutputs(void);
+int32_t PS4API sceAudioOutOutputs(SceAudioOutOutputParam *param, uint32_t num);
 
 
-int PS4API sceAudioOutSetVolume(void);
+int32_t PS4API sceAudioOutSetVolume(int32_t handle, int32_t flag, int32_t *vol);
 
 
 int PS4API sceAudioOutInitIpmiGetSession(void);
@@ -30,3 +30,9 @@ typedef struct {
 	uint64_t flag;			// SceAudioOutStateFlag (bitwise OR)
 	uint64_t reserved64[2];	// reserved
 } SceAudioOutPortState;
+
+
+typedef struct {
+	int32_t handle;		// port handle
+	const void *ptr;	// grain to output, NULL waits for the port
+} SceAudioOutOutputParam;
@@ -1,4 +1,9 @@
 #include "sce_fiber.h"
+#include "Platform/PlatFiber.h"
+
+#include <atomic>
+#include <cstring>
+#include <new>
 
 
 // Note:
@@ -7,50 +12,346 @@
 
 LOG_CHANNEL(SceModules.SceFiber);
 
+// Fibers switch in user mode on the stack the game hands in, there
+// is no host thread behind a fiber. A fiber can be run by any thread,
+// but only by one at a time.
+
+enum FIBER_STATE
+{
+	FIBER_STATE_INIT,  // not started yet
+	FIBER_STATE_IDLE,  // suspended
+	FIBER_STATE_RUN,
+	FIBER_STATE_DONE,  // returned from its entry, can't run again
+};
+
+constexpr uint32_t FiberMagic = 0x52424946;  // 'FIBR'
+
+// Fibers created without a context get a stack of their own.
+constexpr size_t FiberDefaultStackSize = 1024 * 1024;
+
+// Lives in the SceFiber of the game.
+struct SceFiberObject
+{
+	uint32_t              nMagic;
+	std::atomic<uint32_t> nState;
+	SceFiberEntry*        pEntry;
+	uint64_t              argOnInitialize;
+	// Handed to the fiber every time it is run or switched to.
+	uint64_t              argOnRun;
+	plat::FiberContext    context;
+	uint8_t*              pOwnStack;
+	char                  szName[SCE_FIBER_MAX_NAME_LENGTH + 1];
+};
+
+static_assert(sizeof(SceFiberObject) <= sizeof(SceFiber), "SceFiberObject doesn't fit into SceFiber.");
+
+struct FiberThreadState
+{
+	// The thread itself while one of its fibers runs
+	plat::FiberContext context;
+	SceFiberObject*    pCurrent;
+	uint64_t           argOnReturn;
+
+	// The fiber switched away from. It is released only after
+	// the switch, so no other thread can resume it before its
+	// registers are saved.
+	SceFiberObject* pSuspended;
+	FIBER_STATE     nSuspendState;
+};
+
+static thread_local FiberThreadState t_fiberState = {};
+
+static FiberThreadState* loadThreadState()
+{
+	return &t_fiberState;
+}
+
+// A fiber may be resumed on another thread than the one it was
+// suspended on. Compilers treat the address of a thread local as
+// constant within a function and keep it in a register across the
+// switch, calls through a volatile pointer can't be folded that way.
+static FiberThreadState* (*volatile g_loadThreadState)() = loadThreadState;
+
+static FiberThreadState* getThreadState()
+{
+	return g_loadThreadState();
+}
+
+static void finishSwitch(FiberThreadState* pThread)
+{
+	if (pThread->pSuspended)
+	{
+		pThread->pSuspended->nState.store(pThread->nSuspendState, std::memory_order_release);
+		pThread->pSuspended = nullptr;
+	}
+}
+
+static bool acquireFiber(SceFiberObject* pFiber)
+{
+	uint32_t nState = pFiber->nState.load(std::memory_order_acquire);
+	return (nState == FIBER_STATE_INIT || nState == FIBER_STATE_IDLE) &&
+		   pFiber->nState.compare_exchange_strong(nState, FIBER_STATE_RUN, std::memory_order_acquire);
+}
+
+static int getFiber(SceFiber* fiber, SceFiberObject** ppFiber)
+{
+	int nRet = SCE_OK;
+	do
+	{
+		if (!fiber)
+		{
+			nRet = SCE_FIBER_ERROR_NULL;
+			break;
+		}
+
+		if (reinterpret_cast<uintptr_t>(fiber) % alignof(SceFiber) != 0)
+		{
+			nRet = SCE_FIBER_ERROR_ALIGNMENT;
+			break;
+		}
+
+		auto pFiber = reinterpret_cast<SceFiberObject*>(fiber);
+		if (pFiber->nMagic != FiberMagic)
+		{
+			nRet = SCE_FIBER_ERROR_INVALID;
+			break;
+		}
+
+		*ppFiber = pFiber;
+	} while (false);
+	return nRet;
+}
+
+static void fiberMain(void* pParam)
+{
+	auto pFiber = reinterpret_cast<SceFiberObject*>(pParam);
+	finishSwitch(getThreadState());
+
+	pFiber->pEntry(pFiber->argOnInitialize, pFiber->argOnRun);
+
+	// There is nothing to return to, go back to the thread
+	// which ran the fiber and never come back here.
+	LOG_ERR("fiber %s returned from its entry", pFiber->szName);
+
+	auto pThread           = getThreadState();
+	pThread->argOnReturn   = 0;
+	pThread->pCurrent      = nullptr;
+	pThread->pSuspended    = pFiber;
+	pThread->nSuspendState = FIBER_STATE_DONE;
+	plat::FiberContextSwitch(&pFiber->context, &pThread->context);
+}
+
 //////////////////////////////////////////////////////////////////////////
 // library: libSceFiber
 //////////////////////////////////////////////////////////////////////////
 
-int PS4API _sceFiberInitializeImpl(void)
+int PS4API _sceFiberInitializeImpl(SceFiber* fiber, const char* name, SceFiberEntry* entry, uint64_t argOnInitialize,
+	void* addrContext, uint64_t sizeContext, const SceFiberOptParam* optParam, uint32_t buildVersion)
 {
-	LOG_FIXME("Not implemented");
-	return SCE_OK;
-}
+	LOG_SCE_TRACE("fiber %p name %s entry %p context %p size %llx", fiber, name, entry, addrContext, sizeContext);
+	int nRet = SCE_OK;
+	do
+	{
+		if (!fiber || !name || !entry)
+		{
+			nRet = SCE_FIBER_ERROR_NULL;
+			break;
+		}
 
+		if (reinterpret_cast<uintptr_t>(fiber) % alignof(SceFiber) != 0 ||
+			reinterpret_cast<uintptr_t>(addrContext) % SCE_FIBER_CONTEXT_ALIGNMENT != 0)
+		{
+			nRet = SCE_FIBER_ERROR_ALIGNMENT;
+			break;
+		}
 
-int PS4API sceFiberFinalize(void)
-{
-	LOG_FIXME("Not implemented");
-	return SCE_OK;
+		if (addrContext ? sizeContext < SCE_FIBER_CONTEXT_MINIMUM_SIZE : sizeContext != 0)
+		{
+			nRet = SCE_FIBER_ERROR_RANGE;
+			break;
+		}
+
+		auto pFiber             = new (fiber) SceFiberObject();
+		pFiber->nMagic          = FiberMagic;
+		pFiber->pEntry          = entry;
+		pFiber->argOnInitialize = argOnInitialize;
+		pFiber->argOnRun        = 0;
+		pFiber->pOwnStack       = nullptr;
+		strncpy(pFiber->szName, name, SCE_FIBER_MAX_NAME_LENGTH);
+		pFiber->szName[SCE_FIBER_MAX_NAME_LENGTH] = '\0';
+
+		if (!addrContext)
+		{
+			pFiber->pOwnStack = new uint8_t[FiberDefaultStackSize];
+			addrContext       = pFiber->pOwnStack;
+			sizeContext       = FiberDefaultStackSize;
+		}
+
+		plat::FiberContextInit(&pFiber->context, addrContext, sizeContext, fiberMain, pFiber);
+		pFiber->nState.store(FIBER_STATE_INIT, std::memory_order_release);
+	} while (false);
+	return nRet;
 }
 
 
-int PS4API sceFiberReturnToThread(void)
+int PS4API sceFiberFinalize(SceFiber* fiber)
 {
-	LOG_FIXME("Not implemented");
-	return SCE_OK;
+	LOG_SCE_TRACE("fiber %p", fiber);
+	SceFiberObject* pFiber = nullptr;
+	int             nRet   = getFiber(fiber, &pFiber);
+	do
+	{
+		if (nRet != SCE_OK)
+		{
+			break;
+		}
+
+		if (pFiber->nState.load(std::memory_order_acquire) == FIBER_STATE_RUN)
+		{
+			nRet = SCE_FIBER_ERROR_STATE;
+			break;
+		}
+
+		delete[] pFiber->pOwnStack;
+		pFiber->nMagic = 0;
+		pFiber->~SceFiberObject();
+	} while (false);
+	return nRet;
 }
 
+// No traces in the switching functions below,
+// job systems switch fibers thousands of times a frame.
 
-int PS4API sceFiberRun(void)
+int PS4API sceFiberRun(SceFiber* fiber, uint64_t argOnRunTo, uint64_t* argOnReturn)
 {
-	LOG_FIXME("Not implemented");
-	return SCE_OK;
+	SceFiberObject* pFiber = nullptr;
+	int             nRet   = getFiber(fiber, &pFiber);
+	do
+	{
+		if (nRet != SCE_OK)
+		{
+			break;
+		}
+
+		auto pThread = getThreadState();
+		if (pThread->pCurrent)
+		{
+			nRet = SCE_FIBER_ERROR_PERMISSION;
+			break;
+		}
+
+		if (!acquireFiber(pFiber))
+		{
+			nRet = SCE_FIBER_ERROR_STATE;
+			break;
+		}
+
+		pFiber->argOnRun  = argOnRunTo;
+		pThread->pCurrent = pFiber;
+		plat::FiberContextSwitch(&pThread->context, &pFiber->context);
+
+		// Back once the fiber, or one it switched to,
+		// returned to the thread.
+		pThread = getThreadState();
+		finishSwitch(pThread);
+		if (argOnReturn)
+		{
+			*argOnReturn = pThread->argOnReturn;
+		}
+	} while (false);
+	return nRet;
 }
 
 
-int PS4API sceFiberSwitch(void)
+int PS4API sceFiberSwitch(SceFiber* fiber, uint64_t argOnRunTo, uint64_t* argOnRun)
 {
-	LOG_FIXME("Not implemented");
-	return SCE_OK;
+	SceFiberObject* pFiber = nullptr;
+	int             nRet   = getFiber(fiber, &pFiber);
+	do
+	{
+		if (nRet != SCE_OK)
+		{
+			break;
+		}
+
+		auto pThread = getThreadState();
+		auto pSelf   = pThread->pCurrent;
+		if (!pSelf)
+		{
+			nRet = SCE_FIBER_ERROR_PERMISSION;
+			break;
+		}
+
+		if (!acquireFiber(pFiber))
+		{
+			nRet = SCE_FIBER_ERROR_STATE;
+			break;
+		}
+
+		pFiber->argOnRun       = argOnRunTo;
+		pThread->pCurrent      = pFiber;
+		pThread->pSuspended    = pSelf;
+		pThread->nSuspendState = FIBER_STATE_IDLE;
+		plat::FiberContextSwitch(&pSelf->context, &pFiber->context);
+
+		finishSwitch(getThreadState());
+		if (argOnRun)
+		{
+			*argOnRun = pSelf->argOnRun;
+		}
+	} while (false);
+	return nRet;
 }
 
-int PS4API sceFiberGetSelf(void)
+
+int PS4API sceFiberReturnToThread(uint64_t argOnReturn, uint64_t* argOnRun)
 {
-	LOG_FIXME("Not implemented");
-	return SCE_OK;
+	int nRet = SCE_OK;
+	do
+	{
+		auto pThread = getThreadState();
+		auto pSelf   = pThread->pCurrent;
+		if (!pSelf)
+		{
+			nRet = SCE_FIBER_ERROR_PERMISSION;
+			break;
+		}
+
+		pThread->argOnReturn   = argOnReturn;
+		pThread->pCurrent      = nullptr;
+		pThread->pSuspended    = pSelf;
+		pThread->nSuspendState = FIBER_STATE_IDLE;
+		plat::FiberContextSwitch(&pSelf->context, &pThread->context);
+
+		finishSwitch(getThreadState());
+		if (argOnRun)
+		{
+			*argOnRun = pSelf->argOnRun;
+		}
+	} while (false);
+	return nRet;
 }
 
 
+int PS4API sceFiberGetSelf(SceFiber** fiber)
+{
+	int nRet = SCE_OK;
+	do
+	{
+		if (!fiber)
+		{
+			nRet = SCE_FIBER_ERROR_NULL;
+			break;
+		}
 
+		auto pSelf = getThreadState()->pCurrent;
+		if (!pSelf)
+		{
+			nRet = SCE_FIBER_ERROR_PERMISSION;
+			break;
+		}
 
+		*fiber = reinterpret_cast<SceFiber*>(pSelf);
+	} while (false);
+	return nRet;
+}
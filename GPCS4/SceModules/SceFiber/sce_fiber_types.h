@@ -0,0 +1,20 @@
+#pragma once
+
+#include "GPCS4Common.h"
+
+
+
+#define SCE_FIBER_CONTEXT_ALIGNMENT      16
+#define SCE_FIBER_CONTEXT_MINIMUM_SIZE   512
+#define SCE_FIBER_MAX_NAME_LENGTH        31
+
+typedef void PS4API SceFiberEntry(uint64_t argOnInitialize, uint64_t argOnRun);
+
+// Opaque to the game, holds the fiber state.
+typedef struct {
+	uint64_t reserved[16];
+} SceFiber;
+
+typedef struct {
+	uint64_t reserved[16];
+} SceFiberOptParam;
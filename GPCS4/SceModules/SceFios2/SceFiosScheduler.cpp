@@ -0,0 +1,807 @@
+#include "SceFiosScheduler.h"
+#include "sce_errors.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+LOG_CHANNEL(SceModules.SceFios2.scheduler);
+
+// Set on I/O threads and while complete callbacks run.
+// Delete must not wait for a complete callback there,
+// the callback may be the one calling it.
+static thread_local bool t_bDeferDelete = false;
+
+static int toFiosError(int64_t nError)
+{
+	int nRet = static_cast<int>(nError);
+	switch (nError)
+	{
+	case SCE_KERNEL_ERROR_EBADF:
+		nRet = SCE_FIOS_ERROR_BAD_FH;
+		break;
+	case SCE_KERNEL_ERROR_ENOENT:
+		nRet = SCE_FIOS_ERROR_BAD_PATH;
+		break;
+	case SCE_KERNEL_ERROR_EISDIR:
+		nRet = SCE_FIOS_ERROR_NOT_A_FILE;
+		break;
+	case SCE_KERNEL_ERROR_EINVAL:
+		nRet = SCE_FIOS_ERROR_BAD_OFFSET;
+		break;
+	default:
+		break;
+	}
+	return nRet;
+}
+
+CSceFiosFile::CSceFiosFile(CSceFileTable::Ref&& file, int fd, uint32_t nOpenFlags, bool bPassthrough) :
+	m_file(std::move(file)),
+	m_fd(fd),
+	m_nOpenFlags(nOpenFlags),
+	m_bPassthrough(bPassthrough)
+{
+}
+
+CSceFiosFile::~CSceFiosFile()
+{
+}
+
+SceFiosSize CSceFiosFile::ReadAt(void* pBuffer, SceFiosSize nLength, SceFiosOffset nOffset)
+{
+	SceFiosSize nRet = 0;
+	do
+	{
+		if (nLength < 0 || nOffset < 0)
+		{
+			nRet = nLength < 0 ? SCE_FIOS_ERROR_BAD_SIZE : SCE_FIOS_ERROR_BAD_OFFSET;
+			break;
+		}
+
+		if ((m_nOpenFlags & SCE_FIOS_O_RDWR) == SCE_FIOS_O_READ &&
+			!m_bPassthrough && nLength < ReadAheadThreshold)
+		{
+			nRet = readAhead(pBuffer, nLength, nOffset);
+			break;
+		}
+
+		nRet = m_file->Pread(pBuffer, nLength, nOffset);
+		if (nRet < 0)
+		{
+			nRet = toFiosError(nRet);
+		}
+	} while (false);
+	return nRet;
+}
+
+bool CSceFiosFile::PrepareRead(plat::FileReadRequest* pRequest, void* pBuffer, SceFiosSize nLength, SceFiosOffset nOffset)
+{
+	bool bRet = false;
+	do
+	{
+		if (nLength <= 0 || nOffset < 0 || m_file->IsDirectory())
+		{
+			break;
+		}
+
+		if (!(m_nOpenFlags & SCE_FIOS_O_READ))
+		{
+			break;
+		}
+
+		// Same condition as in ReadAt, the window serves these.
+		if ((m_nOpenFlags & SCE_FIOS_O_RDWR) == SCE_FIOS_O_READ &&
+			!m_bPassthrough && nLength < ReadAheadThreshold)
+		{
+			break;
+		}
+
+		pRequest->hFile   = m_file->Handle();
+		pRequest->pBuffer = pBuffer;
+		pRequest->nSize   = nLength;
+		pRequest->nOffset = nOffset;
+		pRequest->nResult = 0;
+
+		bRet = true;
+	} while (false);
+	return bRet;
+}
+
+SceFiosSize CSceFiosFile::FinishRead(const plat::FileReadRequest& request)
+{
+	return request.nResult < 0 ? toFiosError(SCE_KERNEL_ERROR_EIO) : request.nResult;
+}
+
+SceFiosSize CSceFiosFile::WriteAt(const void* pBuffer, SceFiosSize nLength, SceFiosOffset nOffset)
+{
+	SceFiosSize nRet = 0;
+	do
+	{
+		if (nLength < 0 || nOffset < 0)
+		{
+			nRet = nLength < 0 ? SCE_FIOS_ERROR_BAD_SIZE : SCE_FIOS_ERROR_BAD_OFFSET;
+			break;
+		}
+
+		nRet = m_file->Pwrite(pBuffer, nLength, nOffset);
+		if (nRet < 0)
+		{
+			nRet = nRet == SCE_KERNEL_ERROR_EBADF ? SCE_FIOS_ERROR_READ_ONLY : toFiosError(nRet);
+		}
+	} while (false);
+	return nRet;
+}
+
+SceFiosSize CSceFiosFile::readAhead(void* pBuffer, SceFiosSize nLength, SceFiosOffset nOffset)
+{
+	std::lock_guard<std::mutex> lock(m_windowMutex);
+
+	SceFiosOffset nWindowEnd = m_nWindowOffset + m_vtWindow.size();
+	if (nOffset < m_nWindowOffset || nOffset + nLength > nWindowEnd)
+	{
+		// Readers of the same file wait here for the
+		// refill, they most likely need the same window.
+		m_vtWindow.resize(ReadAheadSize);
+		ssize_t nRead = m_file->Pread(m_vtWindow.data(), ReadAheadSize, nOffset);
+		if (nRead < 0)
+		{
+			m_vtWindow.clear();
+			return toFiosError(nRead);
+		}
+
+		m_vtWindow.resize(nRead);
+		m_nWindowOffset = nOffset;
+		nWindowEnd      = nOffset + nRead;
+	}
+
+	SceFiosSize nCopy = std::max<SceFiosSize>(0, std::min(nLength, nWindowEnd - nOffset));
+	if (nCopy)
+	{
+		std::memcpy(pBuffer, m_vtWindow.data() + (nOffset - m_nWindowOffset), nCopy);
+	}
+	return nCopy;
+}
+
+SceFiosOffset CSceFiosFile::ReserveRead(SceFiosSize* pLength)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	SceFiosOffset nOffset = m_nPosition;
+	SceFiosSize   nSize   = plat::FileGetSize(m_file->Handle());
+	*pLength              = std::max<SceFiosSize>(0, std::min(*pLength, nSize - nOffset));
+	m_nPosition += *pLength;
+	return nOffset;
+}
+
+SceFiosOffset CSceFiosFile::ReserveWrite(SceFiosSize nLength)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (m_nOpenFlags & SCE_FIOS_O_APPEND)
+	{
+		m_nPosition = plat::FileGetSize(m_file->Handle());
+	}
+
+	SceFiosOffset nOffset = m_nPosition;
+	m_nPosition += nLength;
+	return nOffset;
+}
+
+SceFiosOffset CSceFiosFile::Seek(SceFiosOffset nOffset, SceFiosWhence nWhence)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	SceFiosOffset nRet = SCE_FIOS_ERROR_BAD_OFFSET;
+	do
+	{
+		SceFiosOffset nBase = 0;
+		switch (nWhence)
+		{
+		case SCE_FIOS_SEEK_SET:
+			nBase = 0;
+			break;
+		case SCE_FIOS_SEEK_CUR:
+			nBase = m_nPosition;
+			break;
+		case SCE_FIOS_SEEK_END:
+			nBase = plat::FileGetSize(m_file->Handle());
+			break;
+		default:
+			nBase = -1;
+			break;
+		}
+
+		if (nBase < 0 || nBase + nOffset < 0)
+		{
+			break;
+		}
+
+		m_nPosition = nBase + nOffset;
+		nRet        = m_nPosition;
+	} while (false);
+	return nRet;
+}
+
+SceFiosOffset CSceFiosFile::Tell()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_nPosition;
+}
+
+SceFiosSize CSceFiosFile::Size()
+{
+	int64_t nSize = plat::FileGetSize(m_file->Handle());
+	return nSize < 0 ? SCE_FIOS_ERROR_BAD_FH : nSize;
+}
+
+void CSceFiosFile::Stat(SceFiosStat* pStat)
+{
+	std::memset(pStat, 0, sizeof(SceFiosStat));
+	pStat->fileSize  = std::max<SceFiosSize>(Size(), 0);
+	pStat->statFlags = 0;
+	if (m_nOpenFlags & SCE_FIOS_O_READ)
+	{
+		pStat->statFlags |= SCE_FIOS_STATUS_READABLE;
+	}
+	if (m_nOpenFlags & SCE_FIOS_O_WRITE)
+	{
+		pStat->statFlags |= SCE_FIOS_STATUS_WRITABLE;
+	}
+}
+
+bool CSceFiosScheduler::OpOrder::operator()(const OpRef& a, const OpRef& b) const
+{
+	// No deadline means the op can wait for any other.
+	SceFiosTime deadlineA = a->attr.deadline == SCE_FIOS_TIME_NULL ? SCE_FIOS_TIME_LATEST : a->attr.deadline;
+	SceFiosTime deadlineB = b->attr.deadline == SCE_FIOS_TIME_NULL ? SCE_FIOS_TIME_LATEST : b->attr.deadline;
+	if (deadlineA != deadlineB)
+	{
+		return deadlineA < deadlineB;
+	}
+
+	if (a->attr.priority != b->attr.priority)
+	{
+		return a->attr.priority > b->attr.priority;
+	}
+
+	return a->nSequence < b->nSequence;
+}
+
+CSceFiosScheduler::CSceFiosScheduler()
+{
+	m_workers.reserve(IoThreadCount);
+	for (uint32_t i = 0; i != IoThreadCount; ++i)
+	{
+		m_workers.emplace_back([this] { run(); });
+	}
+}
+
+CSceFiosScheduler::~CSceFiosScheduler()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_bStopped = true;
+	}
+	m_queueCond.notify_all();
+
+	for (auto& worker : m_workers)
+	{
+		worker.join();
+	}
+}
+
+SceFiosFH CSceFiosScheduler::AddFile(std::shared_ptr<CSceFiosFile> file)
+{
+	std::lock_guard<std::mutex> lock(m_fileMutex);
+	SceFiosFH fh = file->Fileno();
+	m_files[fh]  = std::move(file);
+	return fh;
+}
+
+std::shared_ptr<CSceFiosFile> CSceFiosScheduler::GetFile(SceFiosFH fh)
+{
+	std::lock_guard<std::mutex> lock(m_fileMutex);
+	auto                        iter = m_files.find(fh);
+	return iter != m_files.end() ? iter->second : nullptr;
+}
+
+std::shared_ptr<CSceFiosFile> CSceFiosScheduler::RemoveFile(SceFiosFH fh)
+{
+	std::lock_guard<std::mutex> lock(m_fileMutex);
+	std::shared_ptr<CSceFiosFile> file;
+	auto                          iter = m_files.find(fh);
+	if (iter != m_files.end())
+	{
+		file = std::move(iter->second);
+		m_files.erase(iter);
+	}
+	return file;
+}
+
+SceFiosOp CSceFiosScheduler::SubmitOp(const SceFiosOpAttr* pAttr, OpFunction&& fnOp)
+{
+	auto op  = std::make_shared<Op>();
+	op->fnOp = std::move(fnOp);
+	return submit(pAttr, std::move(op));
+}
+
+SceFiosOp CSceFiosScheduler::SubmitRead(const SceFiosOpAttr*        pAttr,
+										std::shared_ptr<CSceFiosFile> file,
+										void*                         pBuffer,
+										SceFiosSize                   nLength,
+										SceFiosOffset                 nOffset)
+{
+	auto op     = std::make_shared<Op>();
+	op->file    = std::move(file);
+	op->pBuffer = pBuffer;
+	op->nLength = nLength;
+	op->nOffset = nOffset;
+	return submit(pAttr, std::move(op));
+}
+
+SceFiosOp CSceFiosScheduler::submit(const SceFiosOpAttr* pAttr, OpRef op)
+{
+	if (pAttr)
+	{
+		op->attr = *pAttr;
+	}
+	else
+	{
+		std::memset(&op->attr, 0, sizeof(SceFiosOpAttr));
+	}
+	op->nState     = OPS_PENDING;
+	op->bNotified  = false;
+	op->bDeleted   = false;
+	op->bCancelled = false;
+	op->nResult    = 0;
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		do
+		{
+			op->id    = m_nNextOp;
+			m_nNextOp = m_nNextOp == INT32_MAX ? 1 : m_nNextOp + 1;
+		} while (m_ops.count(op->id));
+
+		op->nSequence = m_nSequence++;
+		m_ops.emplace(op->id, op);
+		m_queue.insert(op);
+	}
+	m_queueCond.notify_one();
+	return op->id;
+}
+
+CSceFiosScheduler::OpRef CSceFiosScheduler::findOp(SceFiosOp op)
+{
+	auto iter = m_ops.find(op);
+	return iter != m_ops.end() ? iter->second : nullptr;
+}
+
+bool CSceFiosScheduler::IsOp(SceFiosOp op)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_ops.count(op) != 0;
+}
+
+int CSceFiosScheduler::Wait(SceFiosOp op, SceFiosTime deadline)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	int                          nRet = SCE_FIOS_ERROR_BAD_OP;
+	do
+	{
+		auto pOp = findOp(op);
+		if (!pOp)
+		{
+			break;
+		}
+
+		auto isDone = [&pOp]() { return pOp->nState == OPS_DONE; };
+		if (deadline == SCE_FIOS_TIME_NULL || deadline == SCE_FIOS_TIME_LATEST)
+		{
+			m_doneCond.wait(lock, isDone);
+		}
+		else
+		{
+			auto timeout = std::chrono::steady_clock::time_point(std::chrono::nanoseconds(deadline));
+			if (!m_doneCond.wait_until(lock, timeout, isDone))
+			{
+				nRet = SCE_FIOS_ERROR_TIMEOUT;
+				break;
+			}
+		}
+
+		nRet = pOp->nResult < 0 ? static_cast<int>(pOp->nResult) : SCE_OK;
+	} while (false);
+	return nRet;
+}
+
+int CSceFiosScheduler::Cancel(SceFiosOp op)
+{
+	OpRef pOp;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		pOp = findOp(op);
+		if (!pOp)
+		{
+			return SCE_FIOS_ERROR_BAD_OP;
+		}
+
+		pOp->bCancelled = true;
+		if (pOp->nState != OPS_PENDING)
+		{
+			// Running ops are not interrupted.
+			return SCE_OK;
+		}
+
+		m_queue.erase(pOp);
+		pOp->nState  = OPS_DONE;
+		pOp->nResult = SCE_FIOS_ERROR_CANCELLED;
+	}
+	m_doneCond.notify_all();
+
+	notifyComplete({ pOp });
+	return SCE_OK;
+}
+
+void CSceFiosScheduler::Delete(SceFiosOp op)
+{
+	OpRef pOp;
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		pOp = findOp(op);
+		if (!pOp)
+		{
+			return;
+		}
+
+		if (pOp->nState == OPS_PENDING)
+		{
+			m_queue.erase(pOp);
+			pOp->bCancelled = true;
+			pOp->nState     = OPS_DONE;
+			pOp->bNotified  = true;
+			pOp->nResult    = SCE_FIOS_ERROR_CANCELLED;
+		}
+
+		if (!pOp->bNotified && t_bDeferDelete)
+		{
+			// Leave it to the thread which calls the complete callback.
+			pOp->bDeleted = true;
+			return;
+		}
+
+		// The game may free the buffer of the op once it's
+		// deleted, and expects the complete callback before
+		// the delete one.
+		m_doneCond.wait(lock, [&pOp]() { return pOp->bNotified; });
+		if (pOp->bDeleted)
+		{
+			// Finished by the complete callback's thread.
+			return;
+		}
+		m_ops.erase(op);
+	}
+
+	notify(pOp, SCE_FIOS_OPEVENT_DELETE);
+}
+
+int CSceFiosScheduler::Reschedule(SceFiosOp op, SceFiosTime deadline)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	int                         nRet = SCE_FIOS_ERROR_BAD_OP;
+	do
+	{
+		auto pOp = findOp(op);
+		if (!pOp)
+		{
+			break;
+		}
+
+		if (pOp->nState == OPS_PENDING)
+		{
+			m_queue.erase(pOp);
+			pOp->attr.deadline = deadline;
+			m_queue.insert(pOp);
+		}
+
+		nRet = SCE_OK;
+	} while (false);
+	return nRet;
+}
+
+bool CSceFiosScheduler::IsDone(SceFiosOp op)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	auto                        pOp = findOp(op);
+	return pOp && pOp->nState == OPS_DONE;
+}
+
+bool CSceFiosScheduler::IsCancelled(SceFiosOp op)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	auto                        pOp = findOp(op);
+	return pOp && pOp->bCancelled;
+}
+
+int CSceFiosScheduler::GetError(SceFiosOp op)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	int                         nRet = SCE_FIOS_ERROR_BAD_OP;
+	do
+	{
+		auto pOp = findOp(op);
+		if (!pOp)
+		{
+			break;
+		}
+
+		if (pOp->nState != OPS_DONE)
+		{
+			nRet = SCE_FIOS_ERROR_BUSY;
+			break;
+		}
+
+		nRet = pOp->nResult < 0 ? static_cast<int>(pOp->nResult) : SCE_OK;
+	} while (false);
+	return nRet;
+}
+
+SceFiosSize CSceFiosScheduler::GetActualCount(SceFiosOp op)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	auto                        pOp = findOp(op);
+	return pOp && pOp->nState == OPS_DONE ? std::max<SceFiosSize>(pOp->nResult, 0) : 0;
+}
+
+SceFiosTime CSceFiosScheduler::CurrentTime()
+{
+	auto now = std::chrono::steady_clock::now().time_since_epoch();
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(now).count();
+}
+
+void CSceFiosScheduler::run()
+{
+	// Guest callbacks may run on these threads. The threads live until
+	// the process exits, so their TLS blocks are never released.
+	t_bDeferDelete = true;
+	while (true)
+	{
+		std::vector<Batch> batches;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_queueCond.wait(lock, [this]()
+							 { return m_bStopped || !m_queue.empty(); });
+
+			if (m_queue.empty())
+			{
+				break;
+			}
+
+			batches.push_back(popBatch());
+
+			// Take the reads queued right behind, so the
+			// host has them all in flight at the same time.
+			while (batches.front().front()->file && batches.size() != ReadBatchMax &&
+				   !m_queue.empty() && (*m_queue.begin())->file)
+			{
+				batches.push_back(popBatch());
+			}
+		}
+
+		execute(batches);
+		for (const auto& batch : batches)
+		{
+			complete(batch);
+		}
+	}
+}
+
+CSceFiosScheduler::Batch CSceFiosScheduler::popBatch()
+{
+	Batch batch;
+
+	OpRef head = *m_queue.begin();
+	m_queue.erase(m_queue.begin());
+	batch.push_back(head);
+
+	if (head->file && head->nLength > 0)
+	{
+		std::vector<OpRef> reads;
+		for (const auto& op : m_queue)
+		{
+			if (op->file == head->file && op->nLength > 0)
+			{
+				reads.push_back(op);
+			}
+		}
+
+		std::sort(reads.begin(), reads.end(), [](const OpRef& a, const OpRef& b)
+				  { return a->nOffset < b->nOffset; });
+
+		// Grow the span of the head read with
+		// the reads right before and after it.
+		SceFiosOffset nBegin = head->nOffset;
+		SceFiosOffset nEnd   = head->nOffset + head->nLength;
+
+		auto upper = std::upper_bound(reads.begin(), reads.end(), nBegin, [](SceFiosOffset nOffset, const OpRef& op)
+									  { return nOffset < op->nOffset; });
+		for (auto iter = upper; iter != reads.end(); ++iter)
+		{
+			const auto&   op     = *iter;
+			SceFiosOffset nOpEnd = std::max(nEnd, op->nOffset + op->nLength);
+			if (op->nOffset > nEnd + CoalesceGap || nOpEnd - nBegin > CoalesceMax)
+			{
+				break;
+			}
+			nEnd = nOpEnd;
+			batch.push_back(op);
+		}
+
+		for (auto iter = std::make_reverse_iterator(upper); iter != reads.rend(); ++iter)
+		{
+			const auto&   op       = *iter;
+			SceFiosOffset nOpBegin = op->nOffset;
+			if (op->nOffset + op->nLength + CoalesceGap < nBegin || nEnd - nOpBegin > CoalesceMax)
+			{
+				break;
+			}
+			nBegin = std::min(nBegin, nOpBegin);
+			nEnd   = std::max(nEnd, op->nOffset + op->nLength);
+			batch.push_back(op);
+		}
+
+		for (size_t i = 1; i < batch.size(); ++i)
+		{
+			m_queue.erase(batch[i]);
+		}
+	}
+
+	for (auto& op : batch)
+	{
+		op->nState = OPS_RUNNING;
+	}
+	return batch;
+}
+
+void CSceFiosScheduler::execute(const std::vector<Batch>& batches)
+{
+	// Reads of a single batch go through ReadAt, so large
+	// reads are still split by the kernel file.
+	bool bSubmit = batches.size() > 1;
+
+	std::vector<std::vector<uint8_t>>  vtSpans(batches.size());
+	std::vector<plat::FileReadRequest> vtRequests;
+	std::vector<size_t>                vtRequestBatches;
+	for (size_t i = 0; i != batches.size(); ++i)
+	{
+		const auto& batch = batches[i];
+		const auto& head  = batch.front();
+		if (!head->file)
+		{
+			head->nResult = head->fnOp();
+			continue;
+		}
+
+		SceFiosOffset nBegin = head->nOffset;
+		SceFiosOffset nEnd   = head->nOffset + head->nLength;
+		for (const auto& op : batch)
+		{
+			nBegin = std::min(nBegin, op->nOffset);
+			nEnd   = std::max(nEnd, op->nOffset + op->nLength);
+		}
+
+		void* pBuffer = head->pBuffer;
+		if (batch.size() != 1)
+		{
+			LOG_TRACE("coalesce %zu reads offset %lld size %lld", batch.size(), nBegin, nEnd - nBegin);
+			vtSpans[i].resize(nEnd - nBegin);
+			pBuffer = vtSpans[i].data();
+		}
+
+		plat::FileReadRequest request;
+		if (bSubmit && head->file->PrepareRead(&request, pBuffer, nEnd - nBegin, nBegin))
+		{
+			vtRequests.push_back(request);
+			vtRequestBatches.push_back(i);
+			continue;
+		}
+
+		SceFiosSize nRead = head->file->ReadAt(pBuffer, nEnd - nBegin, nBegin);
+		scatter(batch, nBegin, vtSpans[i], nRead);
+	}
+
+	if (!vtRequests.empty())
+	{
+		plat::FileReadBatch(vtRequests.data(), vtRequests.size());
+	}
+
+	for (size_t i = 0; i != vtRequests.size(); ++i)
+	{
+		size_t nBatch = vtRequestBatches[i];
+		scatter(batches[nBatch], vtRequests[i].nOffset, vtSpans[nBatch], CSceFiosFile::FinishRead(vtRequests[i]));
+	}
+}
+
+void CSceFiosScheduler::scatter(const Batch& batch, SceFiosOffset nBegin, const std::vector<uint8_t>& vtSpan, SceFiosSize nRead)
+{
+	if (batch.size() == 1)
+	{
+		batch.front()->nResult = nRead;
+		return;
+	}
+
+	for (const auto& op : batch)
+	{
+		if (nRead < 0)
+		{
+			op->nResult = nRead;
+			continue;
+		}
+
+		SceFiosOffset nStart = op->nOffset - nBegin;
+		SceFiosSize   nCopy  = std::max<SceFiosSize>(0, std::min(op->nLength, nRead - nStart));
+		if (nCopy)
+		{
+			std::memcpy(op->pBuffer, vtSpan.data() + nStart, nCopy);
+		}
+		op->nResult = nCopy;
+	}
+}
+
+void CSceFiosScheduler::complete(const Batch& batch)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		for (const auto& op : batch)
+		{
+			op->nState = OPS_DONE;
+		}
+	}
+	m_doneCond.notify_all();
+
+	notifyComplete(batch);
+}
+
+void CSceFiosScheduler::notifyComplete(const Batch& batch)
+{
+	bool bDeferDelete = t_bDeferDelete;
+	t_bDeferDelete    = true;
+	for (const auto& op : batch)
+	{
+		notify(op, SCE_FIOS_OPEVENT_COMPLETE);
+	}
+	t_bDeferDelete = bDeferDelete;
+
+	Batch deleted;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		for (const auto& op : batch)
+		{
+			op->bNotified = true;
+			if (op->bDeleted)
+			{
+				m_ops.erase(op->id);
+				deleted.push_back(op);
+			}
+		}
+	}
+	m_doneCond.notify_all();
+
+	for (const auto& op : deleted)
+	{
+		notify(op, SCE_FIOS_OPEVENT_DELETE);
+	}
+}
+
+void CSceFiosScheduler::notify(const OpRef& op, SceFiosOpEvent event)
+{
+	if (op->attr.pCallback)
+	{
+		int nError = op->nResult < 0 ? static_cast<int>(op->nResult) : SCE_OK;
+		op->attr.pCallback(op->attr.pCallbackContext, op->id, event, nError);
+	}
+}
+
+CSceFiosScheduler& GetFiosScheduler()
+{
+	// Never destroyed, the I/O threads run until the process exits.
+	static CSceFiosScheduler* s_scheduler = new CSceFiosScheduler();
+	return *s_scheduler;
+}
@@ -0,0 +1,233 @@
+#pragma once
+
+#include "GPCS4Common.h"
+#include "sce_fios2_types.h"
+#include "SceLibkernel/SceFileTable.h"
+
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// A Fios file handle.
+// It wraps a kernel descriptor, the handle value is the descriptor
+// itself. The handle keeps a reference to the kernel file, so ops
+// still in flight when the handle is closed read from the right file.
+
+class CSceFiosFile
+{
+public:
+	CSceFiosFile(CSceFileTable::Ref&& file, int fd, uint32_t nOpenFlags, bool bPassthrough);
+	~CSceFiosFile();
+
+	int Fileno() const
+	{
+		return m_fd;
+	}
+
+	uint32_t OpenFlags() const
+	{
+		return m_nOpenFlags;
+	}
+
+	// Passthrough handles wrap descriptors opened by the game,
+	// they don't own the descriptor.
+	bool IsPassthrough() const
+	{
+		return m_bPassthrough;
+	}
+
+	// Return the number of bytes transferred or an error code.
+	SceFiosSize ReadAt(void* pBuffer, SceFiosSize nLength, SceFiosOffset nOffset);
+
+	SceFiosSize WriteAt(const void* pBuffer, SceFiosSize nLength, SceFiosOffset nOffset);
+
+	// Fills a host request for a read which can go straight to
+	// the host file. Returns false if it has to go through ReadAt.
+	bool PrepareRead(plat::FileReadRequest* pRequest, void* pBuffer, SceFiosSize nLength, SceFiosOffset nOffset);
+
+	// Result of a prepared read, as ReadAt would return it.
+	static SceFiosSize FinishRead(const plat::FileReadRequest& request);
+
+	// Take the range of a stream read or write from the file position.
+	// Reads are clamped to the end of the file.
+	SceFiosOffset ReserveRead(SceFiosSize* pLength);
+
+	SceFiosOffset ReserveWrite(SceFiosSize nLength);
+
+	// Returns the new position or an error code.
+	SceFiosOffset Seek(SceFiosOffset nOffset, SceFiosWhence nWhence);
+
+	SceFiosOffset Tell();
+
+	SceFiosSize Size();
+
+	void Stat(SceFiosStat* pStat);
+
+private:
+	// Small reads are served from a window read ahead of them.
+	// Only used for read only handles, so the window can't get stale.
+	static constexpr SceFiosSize ReadAheadThreshold = 64 * 1024;
+	static constexpr SceFiosSize ReadAheadSize      = 512 * 1024;
+
+	SceFiosSize readAhead(void* pBuffer, SceFiosSize nLength, SceFiosOffset nOffset);
+
+private:
+	CSceFileTable::Ref m_file;
+	int                m_fd;
+	uint32_t           m_nOpenFlags;
+	bool               m_bPassthrough;
+
+	std::mutex    m_mutex;
+	SceFiosOffset m_nPosition = 0;
+
+	std::mutex           m_windowMutex;
+	SceFiosOffset        m_nWindowOffset = 0;
+	std::vector<uint8_t> m_vtWindow;
+};
+
+// Fios op scheduler and handle table.
+// Async ops run on a fixed set of I/O threads, so guest threads only
+// block if they wait for an op. Pending ops are ordered by deadline,
+// ops with the same deadline by priority. Reads of the same file which
+// are queued together and close to each other are coalesced into one
+// host read, and a worker submits the reads at the front of the queue
+// to the host as one batch.
+
+class CSceFiosScheduler
+{
+public:
+	using OpFunction = std::function<SceFiosSize()>;
+
+	CSceFiosScheduler();
+	~CSceFiosScheduler();
+
+	// The handle is the descriptor of the file.
+	SceFiosFH AddFile(std::shared_ptr<CSceFiosFile> file);
+
+	std::shared_ptr<CSceFiosFile> GetFile(SceFiosFH fh);
+
+	std::shared_ptr<CSceFiosFile> RemoveFile(SceFiosFH fh);
+
+	// Queues an op, pAttr may be null.
+	// fnOp runs on an I/O thread and returns the actual
+	// count of the op or an error code.
+	SceFiosOp SubmitOp(const SceFiosOpAttr* pAttr, OpFunction&& fnOp);
+
+	SceFiosOp SubmitRead(const SceFiosOpAttr*        pAttr,
+						 std::shared_ptr<CSceFiosFile> file,
+						 void*                         pBuffer,
+						 SceFiosSize                   nLength,
+						 SceFiosOffset                 nOffset);
+
+	bool IsOp(SceFiosOp op);
+
+	// Returns the error of the op, or SCE_FIOS_ERROR_TIMEOUT
+	// if it is not done when the deadline passes.
+	int Wait(SceFiosOp op, SceFiosTime deadline);
+
+	int Cancel(SceFiosOp op);
+
+	// Cancels the op if it is pending, waits for it if it is running.
+	void Delete(SceFiosOp op);
+
+	int Reschedule(SceFiosOp op, SceFiosTime deadline);
+
+	bool IsDone(SceFiosOp op);
+
+	bool IsCancelled(SceFiosOp op);
+
+	int GetError(SceFiosOp op);
+
+	SceFiosSize GetActualCount(SceFiosOp op);
+
+	static SceFiosTime CurrentTime();
+
+private:
+	// Coalesced reads may not be further apart than the gap.
+	static constexpr SceFiosSize CoalesceGap   = 64 * 1024;
+	static constexpr SceFiosSize CoalesceMax   = 4 * 1024 * 1024;
+	static constexpr uint32_t    IoThreadCount = 4;
+	static constexpr size_t      ReadBatchMax  = 16;
+
+	enum OP_STATE
+	{
+		OPS_PENDING,
+		OPS_RUNNING,
+		OPS_DONE,
+	};
+
+	struct Op
+	{
+		SceFiosOp     id;
+		SceFiosOpAttr attr;
+		uint64_t      nSequence;
+		OP_STATE      nState;
+		// The complete callback returned, set after OPS_DONE.
+		bool          bNotified;
+		// Deleted before the complete callback returned,
+		// the delete is finished once it did.
+		bool          bDeleted;
+		bool          bCancelled;
+		SceFiosSize   nResult;
+
+		OpFunction fnOp;
+
+		// Reads are kept apart to coalesce them
+		std::shared_ptr<CSceFiosFile> file;
+		void*                         pBuffer;
+		SceFiosSize                   nLength;
+		SceFiosOffset                 nOffset;
+	};
+
+	using OpRef = std::shared_ptr<Op>;
+	using Batch = std::vector<OpRef>;
+
+	struct OpOrder
+	{
+		bool operator()(const OpRef& a, const OpRef& b) const;
+	};
+
+	SceFiosOp submit(const SceFiosOpAttr* pAttr, OpRef op);
+
+	OpRef findOp(SceFiosOp op);
+
+	void run();
+
+	// Takes the next op and the reads coalesced with it.
+	Batch popBatch();
+
+	void execute(const std::vector<Batch>& batches);
+
+	void complete(const Batch& batch);
+
+	// Calls the complete callbacks and lets Delete go on,
+	// finishes deletes deferred by the callbacks.
+	void notifyComplete(const Batch& batch);
+
+	// Hands the data of a coalesced read to its ops.
+	static void scatter(const Batch& batch, SceFiosOffset nBegin, const std::vector<uint8_t>& vtSpan, SceFiosSize nRead);
+
+	static void notify(const OpRef& op, SceFiosOpEvent event);
+
+private:
+	std::mutex                                                   m_fileMutex;
+	std::unordered_map<SceFiosFH, std::shared_ptr<CSceFiosFile>> m_files;
+
+	std::mutex                           m_mutex;
+	std::condition_variable              m_queueCond;
+	std::condition_variable              m_doneCond;
+	std::unordered_map<SceFiosOp, OpRef> m_ops;
+	std::set<OpRef, OpOrder>             m_queue;
+	SceFiosOp                            m_nNextOp   = 1;
+	uint64_t                             m_nSequence = 0;
+	bool                                 m_bStopped  = false;
+	std::vector<std::thread>             m_workers;
+};
+
+CSceFiosScheduler& GetFiosScheduler();
@@ -1,7 +1,12 @@
 #include "sce_fios2.h"
+#include "SceFiosScheduler.h"
 
-#include "Platform/PlatPath.h"
+#include "Emulator.h"
+#include "VirtualFileSystem.h"
+#include "SceLibkernel/sce_libkernel.h"
+#include "Platform/PlatFile.h"
 
+#include <cstring>
 #include <filesystem>
 
 // Note:
@@ -10,162 +15,700 @@
 
 LOG_CHANNEL(SceModules.SceFios2);
 
+namespace fs = std::filesystem;
+
+static int openFile(const std::string& strPath, uint32_t nOpenFlags, SceFiosFH* pOutFH)
+{
+	int nRet = SCE_FIOS_ERROR_BAD_PATH;
+	do
+	{
+		if (!(nOpenFlags & SCE_FIOS_O_RDWR))
+		{
+			nOpenFlags |= SCE_FIOS_O_READ;
+		}
+
+		int nFlags = 0;
+		switch (nOpenFlags & SCE_FIOS_O_RDWR)
+		{
+		case SCE_FIOS_O_WRITE:
+			nFlags = SCE_KERNEL_O_WRONLY;
+			break;
+		case SCE_FIOS_O_RDWR:
+			nFlags = SCE_KERNEL_O_RDWR;
+			break;
+		default:
+			nFlags = SCE_KERNEL_O_RDONLY;
+			break;
+		}
+
+		if (nOpenFlags & SCE_FIOS_O_APPEND)
+		{
+			nFlags |= SCE_KERNEL_O_APPEND;
+		}
+		if (nOpenFlags & SCE_FIOS_O_CREAT)
+		{
+			nFlags |= SCE_KERNEL_O_CREAT;
+		}
+		if (nOpenFlags & SCE_FIOS_O_TRUNC)
+		{
+			nFlags |= SCE_KERNEL_O_TRUNC;
+		}
+
+		int fd = sceKernelOpen(strPath.c_str(), nFlags, 0666);
+		if (fd < 0)
+		{
+			nRet = fd == SCE_KERNEL_ERROR_EMFILE ? SCE_FIOS_ERROR_CANT_ALLOCATE_FH : SCE_FIOS_ERROR_BAD_PATH;
+			break;
+		}
+
+		auto file = std::make_shared<CSceFiosFile>(GetFileTable().Get(fd), fd, nOpenFlags, false);
+		*pOutFH   = GetFiosScheduler().AddFile(std::move(file));
+
+		nRet = SCE_OK;
+	} while (false);
+	return nRet;
+}
+
+static int closeFile(SceFiosFH fh)
+{
+	int nRet = SCE_FIOS_ERROR_BAD_FH;
+	do
+	{
+		auto file = GetFiosScheduler().RemoveFile(fh);
+		if (!file)
+		{
+			break;
+		}
+
+		if (!file->IsPassthrough())
+		{
+			sceKernelClose(file->Fileno());
+		}
+
+		nRet = SCE_OK;
+	} while (false);
+	return nRet;
+}
+
+static SceFiosSize readFile(CSceFiosFile* pFile, void* pBuffer, SceFiosSize nLength)
+{
+	SceFiosOffset nOffset = pFile->ReserveRead(&nLength);
+	return pFile->ReadAt(pBuffer, nLength, nOffset);
+}
+
+static SceFiosSize writeFile(CSceFiosFile* pFile, const void* pBuffer, SceFiosSize nLength)
+{
+	SceFiosOffset nOffset = pFile->ReserveWrite(nLength);
+	return pFile->WriteAt(pBuffer, nLength, nOffset);
+}
+
+static int statPath(const std::string& strPath, SceFiosStat* pStat)
+{
+	int nRet = SCE_FIOS_ERROR_BAD_PATH;
+	do
+	{
+		VfsFileInfo info;
+		if (!VFS().Stat(strPath, &info))
+		{
+			break;
+		}
+
+		std::memset(pStat, 0, sizeof(SceFiosStat));
+		pStat->fileSize  = info.nSize;
+		pStat->statFlags = SCE_FIOS_STATUS_READABLE;
+		if (info.bDirectory)
+		{
+			pStat->statFlags |= SCE_FIOS_STATUS_DIRECTORY;
+		}
+		if (!info.bReadOnly)
+		{
+			pStat->statFlags |= SCE_FIOS_STATUS_WRITABLE;
+		}
+
+		nRet = SCE_OK;
+	} while (false);
+	return nRet;
+}
+
+static SceFiosSize getFileSize(const std::string& strPath)
+{
+	SceFiosSize nRet = SCE_FIOS_ERROR_BAD_PATH;
+	do
+	{
+		VfsFileInfo info;
+		if (!VFS().Stat(strPath, &info))
+		{
+			break;
+		}
+
+		if (info.bDirectory)
+		{
+			nRet = SCE_FIOS_ERROR_NOT_A_FILE;
+			break;
+		}
+
+		nRet = info.nSize;
+	} while (false);
+	return nRet;
+}
+
+static SceFiosSize readPath(const std::string& strPath, void* pBuffer, SceFiosSize nLength, SceFiosOffset nOffset)
+{
+	SceFiosSize nRet = SCE_FIOS_ERROR_BAD_PATH;
+	do
+	{
+		if (nLength < 0 || nOffset < 0)
+		{
+			nRet = nLength < 0 ? SCE_FIOS_ERROR_BAD_SIZE : SCE_FIOS_ERROR_BAD_OFFSET;
+			break;
+		}
+
+		plat::FileHandle file = plat::FileOpen(VFS().Resolve(strPath), plat::FOF_READ);
+		if (file == plat::INVALID_FILE_HANDLE)
+		{
+			break;
+		}
+
+		nRet = plat::FileReadAt(file, pBuffer, nLength, nOffset);
+		if (nRet < 0)
+		{
+			nRet = SCE_FIOS_ERROR_ACCESS;
+		}
+
+		plat::FileClose(file);
+	} while (false);
+	return nRet;
+}
+
+static SceFiosSize writePath(const std::string& strPath, const void* pBuffer, SceFiosSize nLength, SceFiosOffset nOffset)
+{
+	SceFiosSize nRet = SCE_FIOS_ERROR_BAD_PATH;
+	do
+	{
+		if (nLength < 0 || nOffset < 0)
+		{
+			nRet = nLength < 0 ? SCE_FIOS_ERROR_BAD_SIZE : SCE_FIOS_ERROR_BAD_OFFSET;
+			break;
+		}
+
+		VFS().Invalidate(strPath);
+		plat::FileHandle file = plat::FileOpen(VFS().Resolve(strPath), plat::FOF_WRITE | plat::FOF_CREATE);
+		if (file == plat::INVALID_FILE_HANDLE)
+		{
+			break;
+		}
+
+		nRet = plat::FileWriteAt(file, pBuffer, nLength, nOffset);
+		if (nRet < 0)
+		{
+			nRet = SCE_FIOS_ERROR_ACCESS;
+		}
+
+		plat::FileClose(file);
+	} while (false);
+	return nRet;
+}
+
+static SceFiosOp submitError(const SceFiosOpAttr* pAttr, int nError)
+{
+	return GetFiosScheduler().SubmitOp(pAttr, [nError]() -> SceFiosSize
+									   { return nError; });
+}
+
 //////////////////////////////////////////////////////////////////////////
 // library: libSceFios2
 //////////////////////////////////////////////////////////////////////////
 
-int PS4API sceFiosDateToComponents(void)
+int PS4API sceFiosInitialize(const SceFiosParams* pParameters)
 {
-	LOG_FIXME("Not implemented");
+	LOG_SCE_TRACE("params %p", pParameters);
+	// Start the I/O threads.
+	GetFiosScheduler();
 	return SCE_OK;
 }
 
 
-int PS4API sceFiosDeleteSync(void)
+void PS4API sceFiosTerminate(void)
 {
-	LOG_FIXME("Not implemented");
-	return SCE_OK;
+	LOG_SCE_TRACE("");
 }
 
 
-int PS4API sceFiosDirectoryCreateSync(void)
+int PS4API sceFiosDateToComponents(void)
 {
 	LOG_FIXME("Not implemented");
 	return SCE_OK;
 }
 
 
-bool PS4API sceFiosFileExistsSync(const SceFiosOpAttr* pAttr, const char* pPath)
+int PS4API sceFiosDeleteSync(const SceFiosOpAttr* pAttr, const char* pPath)
+{
+	LOG_SCE_TRACE("path %s", pPath);
+	std::error_code ec;
+	VFS().Invalidate(pPath);
+	return fs::remove(VFS().Resolve(pPath), ec) ? SCE_OK : SCE_FIOS_ERROR_BAD_PATH;
+}
+
+
+int PS4API sceFiosDirectoryCreateSync(const SceFiosOpAttr* pAttr, const char* pPath)
 {
 	LOG_SCE_TRACE("path %s", pPath);
+	std::error_code ec;
+	VFS().Invalidate(pPath);
+	fs::create_directory(VFS().Resolve(pPath), ec);
+	return ec ? SCE_FIOS_ERROR_BAD_PATH : SCE_OK;
+}
 
-	LOG_ASSERT(pAttr == nullptr, "only support null attr.");
-	auto path = plat::PS4PathToPCPath(pPath);
-	bool isDir = std::filesystem::is_directory(path);
-	bool exists = std::filesystem::exists(path);
-	return !isDir && exists;
+
+bool PS4API sceFiosFileExistsSync(const SceFiosOpAttr* pAttr, const char* pPath)
+{
+	LOG_SCE_TRACE("path %s", pPath);
+	VfsFileInfo info;
+	return VFS().Stat(pPath, &info) && !info.bDirectory;
 }
 
 
 bool PS4API sceFiosDirectoryExistsSync(const SceFiosOpAttr *pAttr, const char *pPath)
 {
 	LOG_SCE_TRACE("path %s", pPath);
+	VfsFileInfo info;
+	return VFS().Stat(pPath, &info) && info.bDirectory;
+}
+
 
-	LOG_ASSERT(pAttr == nullptr, "only support null attr.");
-	auto path   = plat::PS4PathToPCPath(pPath);
-	bool isDir  = std::filesystem::is_directory(path);
-	bool exists = std::filesystem::exists(path);
-	return isDir && exists;
+int PS4API sceFiosFHCloseSync(const SceFiosOpAttr* pAttr, SceFiosFH fh)
+{
+	LOG_SCE_TRACE("fh %d", fh);
+	return closeFile(fh);
 }
 
 
-int PS4API sceFiosFHCloseSync(void)
+int PS4API sceFiosFHOpenSync(const SceFiosOpAttr* pAttr, SceFiosFH* pOutFH, const char* pPath, const SceFiosOpenParams* pOpenParams)
 {
-	LOG_FIXME("Not implemented");
-	return SCE_OK;
+	LOG_SCE_TRACE("path %s params %p", pPath, pOpenParams);
+	uint32_t nOpenFlags = pOpenParams ? pOpenParams->openFlags : SCE_FIOS_O_READ;
+	return openFile(pPath, nOpenFlags, pOutFH);
 }
 
 
-int PS4API sceFiosFHOpenSync(void)
+SceFiosSize PS4API sceFiosFHReadSync(const SceFiosOpAttr* pAttr, SceFiosFH fh, void* pBuf, SceFiosSize length)
 {
-	LOG_FIXME("Not implemented");
-	return SCE_OK;
+	LOG_SCE_TRACE("fh %d buf %p length %lld", fh, pBuf, length);
+	auto file = GetFiosScheduler().GetFile(fh);
+	return file ? readFile(file.get(), pBuf, length) : SCE_FIOS_ERROR_BAD_FH;
 }
 
 
-int PS4API sceFiosFHReadSync(void)
+SceFiosOffset PS4API sceFiosFHSeek(SceFiosFH fh, SceFiosOffset offset, SceFiosWhence whence)
 {
-	LOG_FIXME("Not implemented");
-	return SCE_OK;
+	LOG_SCE_TRACE("fh %d offset %lld whence %d", fh, offset, whence);
+	auto file = GetFiosScheduler().GetFile(fh);
+	return file ? file->Seek(offset, whence) : SCE_FIOS_ERROR_BAD_FH;
 }
 
 
-int PS4API sceFiosFHSeek(void)
+int PS4API sceFiosFHStatSync(const SceFiosOpAttr* pAttr, SceFiosFH fh, SceFiosStat* pOutStatus)
 {
-	LOG_FIXME("Not implemented");
-	return SCE_OK;
+	LOG_SCE_TRACE("fh %d", fh);
+	int nRet = SCE_FIOS_ERROR_BAD_FH;
+	do
+	{
+		auto file = GetFiosScheduler().GetFile(fh);
+		if (!file)
+		{
+			break;
+		}
+
+		file->Stat(pOutStatus);
+		nRet = SCE_OK;
+	} while (false);
+	return nRet;
 }
 
 
-int PS4API sceFiosFHStatSync(void)
+SceFiosSize PS4API sceFiosFHWriteSync(const SceFiosOpAttr* pAttr, SceFiosFH fh, const void* pBuf, SceFiosSize length)
 {
-	LOG_FIXME("Not implemented");
-	return SCE_OK;
+	LOG_SCE_TRACE("fh %d buf %p length %lld", fh, pBuf, length);
+	auto file = GetFiosScheduler().GetFile(fh);
+	return file ? writeFile(file.get(), pBuf, length) : SCE_FIOS_ERROR_BAD_FH;
 }
 
 
-int PS4API sceFiosFHWriteSync(void)
+SceFiosSize PS4API sceFiosFileGetSizeSync(const SceFiosOpAttr* pAttr, const char* pPath)
 {
-	LOG_FIXME("Not implemented");
-	return SCE_OK;
+	LOG_SCE_TRACE("path %s", pPath);
+	return getFileSize(pPath);
 }
 
 
-int PS4API sceFiosFileGetSizeSync(void)
+SceFiosSize PS4API sceFiosFileReadSync(const SceFiosOpAttr* pAttr, const char* pPath, void* pBuf, SceFiosSize length, SceFiosOffset offset)
 {
-	LOG_FIXME("Not implemented");
-	return SCE_OK;
+	LOG_SCE_TRACE("path %s buf %p length %lld offset %lld", pPath, pBuf, length, offset);
+	return readPath(pPath, pBuf, length, offset);
 }
 
 
-int PS4API sceFiosFileReadSync(void)
+SceFiosSize PS4API sceFiosFileWriteSync(const SceFiosOpAttr* pAttr, const char* pPath, const void* pBuf, SceFiosSize length, SceFiosOffset offset)
 {
-	LOG_FIXME("Not implemented");
-	return SCE_OK;
+	LOG_SCE_TRACE("path %s buf %p length %lld offset %lld", pPath, pBuf, length, offset);
+	return writePath(pPath, pBuf, length, offset);
 }
 
 
-int PS4API sceFiosFileWriteSync(void)
+int PS4API sceFiosStatSync(const SceFiosOpAttr* pAttr, const char* pPath, SceFiosStat* pOutStatus)
 {
-	LOG_FIXME("Not implemented");
-	return SCE_OK;
+	LOG_SCE_TRACE("path %s", pPath);
+	return statPath(pPath, pOutStatus);
 }
 
 
-int PS4API sceFiosStatSync(void)
+int PS4API sceFiosDeallocatePassthruFH(SceFiosFH fh)
 {
-	LOG_FIXME("Not implemented");
-	return SCE_OK;
+	LOG_SCE_TRACE("fh %d", fh);
+	int nRet = SCE_FIOS_ERROR_BAD_FH;
+	do
+	{
+		auto file = GetFiosScheduler().GetFile(fh);
+		if (!file || !file->IsPassthrough())
+		{
+			break;
+		}
+
+		GetFiosScheduler().RemoveFile(fh);
+		nRet = SCE_OK;
+	} while (false);
+	return nRet;
 }
 
 
-int PS4API sceFiosDeallocatePassthruFH(void) 
+SceFiosFH PS4API sceFiosFilenoToFH(int fd)
 {
-	LOG_FIXME("Not implemented");
-	return SCE_OK;
+	LOG_SCE_TRACE("fd %d", fd);
+	SceFiosFH fh = SCE_FIOS_FH_INVALID;
+	do
+	{
+		if (GetFiosScheduler().GetFile(fd))
+		{
+			fh = fd;
+			break;
+		}
+
+		auto ref = GetFileTable().Get(fd);
+		if (!ref)
+		{
+			break;
+		}
+
+		auto file = std::make_shared<CSceFiosFile>(std::move(ref), fd, SCE_FIOS_O_RDWR, true);
+		fh        = GetFiosScheduler().AddFile(std::move(file));
+	} while (false);
+	return fh;
 }
 
 
-int PS4API sceFiosFilenoToFH(void) 
+int PS4API sceFiosFHToFileno(SceFiosFH fh)
 {
-	LOG_FIXME("Not implemented");
-	return SCE_OK;
+	LOG_SCE_TRACE("fh %d", fh);
+	auto file = GetFiosScheduler().GetFile(fh);
+	return file ? file->Fileno() : -1;
 }
 
 
-int PS4API sceFiosFHToFileno(void) 
+bool PS4API sceFiosIsValidHandle(SceFiosHandle h)
 {
-	LOG_FIXME("Not implemented");
-	return SCE_OK;
+	LOG_SCE_TRACE("handle %d", h);
+	return GetFiosScheduler().GetFile(h) || GetFiosScheduler().IsOp(h);
 }
 
 
-int PS4API sceFiosIsValidHandle(void) 
+int PS4API sceFiosFHOpenWithModeSync(const SceFiosOpAttr* pAttr, SceFiosFH* pOutFH, const char* pPath, const SceFiosOpenParams* pOpenParams, int32_t nativeMode)
 {
-	LOG_FIXME("Not implemented");
-	return SCE_OK;
+	LOG_SCE_TRACE("path %s params %p mode %o", pPath, pOpenParams, nativeMode);
+	uint32_t nOpenFlags = pOpenParams ? pOpenParams->openFlags : SCE_FIOS_O_READ;
+	return openFile(pPath, nOpenFlags, pOutFH);
 }
 
 
-int PS4API sceFiosFHOpenWithModeSync(void) 
+int PS4API sceFiosRenameSync(const SceFiosOpAttr* pAttr, const char* pOldPath, const char* pNewPath)
 {
-	LOG_FIXME("Not implemented");
-	return SCE_OK;
+	LOG_SCE_TRACE("old %s new %s", pOldPath, pNewPath);
+	std::error_code ec;
+	VFS().Invalidate(pOldPath);
+	VFS().Invalidate(pNewPath);
+	fs::rename(VFS().Resolve(pOldPath), VFS().Resolve(pNewPath), ec);
+	return ec ? SCE_FIOS_ERROR_BAD_PATH : SCE_OK;
 }
 
 
-int PS4API sceFiosRenameSync(void)
+SceFiosOp PS4API sceFiosFHOpen(const SceFiosOpAttr* pAttr, SceFiosFH* pOutFH, const char* pPath, const SceFiosOpenParams* pOpenParams)
 {
-	LOG_FIXME("Not implemented");
-	return SCE_OK;
+	LOG_SCE_TRACE("path %s params %p", pPath, pOpenParams);
+	std::string strPath    = pPath;
+	uint32_t    nOpenFlags = pOpenParams ? pOpenParams->openFlags : SCE_FIOS_O_READ;
+	return GetFiosScheduler().SubmitOp(pAttr, [strPath, nOpenFlags, pOutFH]() -> SceFiosSize
+									   { return openFile(strPath, nOpenFlags, pOutFH); });
+}
+
+
+SceFiosOp PS4API sceFiosFHClose(const SceFiosOpAttr* pAttr, SceFiosFH fh)
+{
+	LOG_SCE_TRACE("fh %d", fh);
+	return GetFiosScheduler().SubmitOp(pAttr, [fh]() -> SceFiosSize
+									   { return closeFile(fh); });
+}
+
+
+SceFiosOp PS4API sceFiosFHRead(const SceFiosOpAttr* pAttr, SceFiosFH fh, void* pBuf, SceFiosSize length)
+{
+	LOG_SCE_TRACE("fh %d buf %p length %lld", fh, pBuf, length);
+	SceFiosOp op = SCE_FIOS_OP_INVALID;
+	do
+	{
+		auto file = GetFiosScheduler().GetFile(fh);
+		if (!file)
+		{
+			op = submitError(pAttr, SCE_FIOS_ERROR_BAD_FH);
+			break;
+		}
+
+		// The position moves when the op is issued, so
+		// back to back reads continue each other.
+		SceFiosOffset offset = file->ReserveRead(&length);
+		op                   = GetFiosScheduler().SubmitRead(pAttr, std::move(file), pBuf, length, offset);
+	} while (false);
+	return op;
+}
+
+
+SceFiosOp PS4API sceFiosFHPread(const SceFiosOpAttr* pAttr, SceFiosFH fh, void* pBuf, SceFiosSize length, SceFiosOffset offset)
+{
+	LOG_SCE_TRACE("fh %d buf %p length %lld offset %lld", fh, pBuf, length, offset);
+	auto file = GetFiosScheduler().GetFile(fh);
+	return file ? GetFiosScheduler().SubmitRead(pAttr, std::move(file), pBuf, length, offset)
+				: submitError(pAttr, SCE_FIOS_ERROR_BAD_FH);
+}
+
+
+SceFiosSize PS4API sceFiosFHPreadSync(const SceFiosOpAttr* pAttr, SceFiosFH fh, void* pBuf, SceFiosSize length, SceFiosOffset offset)
+{
+	LOG_SCE_TRACE("fh %d buf %p length %lld offset %lld", fh, pBuf, length, offset);
+	auto file = GetFiosScheduler().GetFile(fh);
+	return file ? file->ReadAt(pBuf, length, offset) : SCE_FIOS_ERROR_BAD_FH;
+}
+
+
+SceFiosOp PS4API sceFiosFHWrite(const SceFiosOpAttr* pAttr, SceFiosFH fh, const void* pBuf, SceFiosSize length)
+{
+	LOG_SCE_TRACE("fh %d buf %p length %lld", fh, pBuf, length);
+	SceFiosOp op = SCE_FIOS_OP_INVALID;
+	do
+	{
+		auto file = GetFiosScheduler().GetFile(fh);
+		if (!file)
+		{
+			op = submitError(pAttr, SCE_FIOS_ERROR_BAD_FH);
+			break;
+		}
+
+		SceFiosOffset offset = file->ReserveWrite(length);
+		op                   = GetFiosScheduler().SubmitOp(pAttr, [file, pBuf, length, offset]() -> SceFiosSize
+														   { return file->WriteAt(pBuf, length, offset); });
+	} while (false);
+	return op;
+}
+
+
+SceFiosOp PS4API sceFiosFHPwrite(const SceFiosOpAttr* pAttr, SceFiosFH fh, const void* pBuf, SceFiosSize length, SceFiosOffset offset)
+{
+	LOG_SCE_TRACE("fh %d buf %p length %lld offset %lld", fh, pBuf, length, offset);
+	auto file = GetFiosScheduler().GetFile(fh);
+	if (!file)
+	{
+		return submitError(pAttr, SCE_FIOS_ERROR_BAD_FH);
+	}
+	return GetFiosScheduler().SubmitOp(pAttr, [file, pBuf, length, offset]() -> SceFiosSize
+									   { return file->WriteAt(pBuf, length, offset); });
+}
+
+
+SceFiosSize PS4API sceFiosFHPwriteSync(const SceFiosOpAttr* pAttr, SceFiosFH fh, const void* pBuf, SceFiosSize length, SceFiosOffset offset)
+{
+	LOG_SCE_TRACE("fh %d buf %p length %lld offset %lld", fh, pBuf, length, offset);
+	auto file = GetFiosScheduler().GetFile(fh);
+	return file ? file->WriteAt(pBuf, length, offset) : SCE_FIOS_ERROR_BAD_FH;
+}
+
+
+SceFiosOp PS4API sceFiosFHStat(const SceFiosOpAttr* pAttr, SceFiosFH fh, SceFiosStat* pOutStatus)
+{
+	LOG_SCE_TRACE("fh %d", fh);
+	return GetFiosScheduler().SubmitOp(pAttr, [fh, pOutStatus]() -> SceFiosSize
+									   { return sceFiosFHStatSync(nullptr, fh, pOutStatus); });
+}
+
+
+SceFiosOffset PS4API sceFiosFHTell(SceFiosFH fh)
+{
+	LOG_SCE_TRACE("fh %d", fh);
+	auto file = GetFiosScheduler().GetFile(fh);
+	return file ? file->Tell() : SCE_FIOS_ERROR_BAD_FH;
+}
+
+
+SceFiosSize PS4API sceFiosFHGetSize(SceFiosFH fh)
+{
+	LOG_SCE_TRACE("fh %d", fh);
+	auto file = GetFiosScheduler().GetFile(fh);
+	return file ? file->Size() : SCE_FIOS_ERROR_BAD_FH;
+}
+
+
+SceFiosOp PS4API sceFiosFileRead(const SceFiosOpAttr* pAttr, const char* pPath, void* pBuf, SceFiosSize length, SceFiosOffset offset)
+{
+	LOG_SCE_TRACE("path %s buf %p length %lld offset %lld", pPath, pBuf, length, offset);
+	std::string strPath = pPath;
+	return GetFiosScheduler().SubmitOp(pAttr, [strPath, pBuf, length, offset]() -> SceFiosSize
+									   { return readPath(strPath, pBuf, length, offset); });
+}
+
+
+SceFiosOp PS4API sceFiosFileWrite(const SceFiosOpAttr* pAttr, const char* pPath, const void* pBuf, SceFiosSize length, SceFiosOffset offset)
+{
+	LOG_SCE_TRACE("path %s buf %p length %lld offset %lld", pPath, pBuf, length, offset);
+	std::string strPath = pPath;
+	return GetFiosScheduler().SubmitOp(pAttr, [strPath, pBuf, length, offset]() -> SceFiosSize
+									   { return writePath(strPath, pBuf, length, offset); });
+}
+
+
+SceFiosOp PS4API sceFiosFileGetSize(const SceFiosOpAttr* pAttr, const char* pPath, SceFiosSize* pOutSize)
+{
+	LOG_SCE_TRACE("path %s", pPath);
+	std::string strPath = pPath;
+	return GetFiosScheduler().SubmitOp(pAttr, [strPath, pOutSize]() -> SceFiosSize
+									   {
+										   SceFiosSize nSize = getFileSize(strPath);
+										   if (nSize < 0)
+										   {
+											   return nSize;
+										   }
+										   *pOutSize = nSize;
+										   return 0;
+									   });
+}
+
+
+SceFiosOp PS4API sceFiosStat(const SceFiosOpAttr* pAttr, const char* pPath, SceFiosStat* pOutStatus)
+{
+	LOG_SCE_TRACE("path %s", pPath);
+	std::string strPath = pPath;
+	return GetFiosScheduler().SubmitOp(pAttr, [strPath, pOutStatus]() -> SceFiosSize
+									   { return statPath(strPath, pOutStatus); });
+}
+
+
+int PS4API sceFiosOpWait(SceFiosOp op)
+{
+	LOG_SCE_TRACE("op %d", op);
+	return GetFiosScheduler().Wait(op, SCE_FIOS_TIME_NULL);
+}
+
+
+int PS4API sceFiosOpWaitUntil(SceFiosOp op, SceFiosTime deadline)
+{
+	LOG_SCE_TRACE("op %d deadline %lld", op, deadline);
+	return GetFiosScheduler().Wait(op, deadline);
+}
+
+
+int PS4API sceFiosOpSyncWait(SceFiosOp op)
+{
+	LOG_SCE_TRACE("op %d", op);
+	int nRet = GetFiosScheduler().Wait(op, SCE_FIOS_TIME_NULL);
+	GetFiosScheduler().Delete(op);
+	return nRet;
+}
+
+
+SceFiosSize PS4API sceFiosOpSyncWaitForIO(SceFiosOp op)
+{
+	LOG_SCE_TRACE("op %d", op);
+	SceFiosSize nRet = GetFiosScheduler().Wait(op, SCE_FIOS_TIME_NULL);
+	if (nRet == SCE_OK)
+	{
+		nRet = GetFiosScheduler().GetActualCount(op);
+	}
+	GetFiosScheduler().Delete(op);
+	return nRet;
+}
+
+
+int PS4API sceFiosOpCancel(SceFiosOp op)
+{
+	LOG_SCE_TRACE("op %d", op);
+	return GetFiosScheduler().Cancel(op);
+}
+
+
+void PS4API sceFiosOpDelete(SceFiosOp op)
+{
+	LOG_SCE_TRACE("op %d", op);
+	GetFiosScheduler().Delete(op);
+}
+
+
+bool PS4API sceFiosOpIsDone(SceFiosOp op)
+{
+	LOG_SCE_TRACE("op %d", op);
+	return GetFiosScheduler().IsDone(op);
+}
+
+
+bool PS4API sceFiosOpIsCancelled(SceFiosOp op)
+{
+	LOG_SCE_TRACE("op %d", op);
+	return GetFiosScheduler().IsCancelled(op);
+}
+
+
+int PS4API sceFiosOpGetError(SceFiosOp op)
+{
+	LOG_SCE_TRACE("op %d", op);
+	return GetFiosScheduler().GetError(op);
+}
+
+
+SceFiosSize PS4API sceFiosOpGetActualCount(SceFiosOp op)
+{
+	LOG_SCE_TRACE("op %d", op);
+	return GetFiosScheduler().GetActualCount(op);
+}
+
+
+void PS4API sceFiosOpReschedule(SceFiosOp op, SceFiosTime newDeadline)
+{
+	LOG_SCE_TRACE("op %d deadline %lld", op, newDeadline);
+	GetFiosScheduler().Reschedule(op, newDeadline);
+}
+
+
+SceFiosTime PS4API sceFiosTimeGetCurrent(void)
+{
+	LOG_SCE_TRACE("");
+	return CSceFiosScheduler::CurrentTime();
+}
+
+
+SceFiosTime PS4API sceFiosTimeIntervalFromNanoseconds(int64_t ns)
+{
+	LOG_SCE_TRACE("ns %lld", ns);
+	// Fios time is counted in nanoseconds.
+	return ns;
+}
+
+
+int64_t PS4API sceFiosTimeIntervalToNanoseconds(SceFiosTime interval)
+{
+	LOG_SCE_TRACE("interval %lld", interval);
+	return interval;
 }
@@ -25,64 +25,159 @@ extern const SCE_EXPORT_MODULE g_ExpModuleSceFios2;
 // library: libSceFios2
 //////////////////////////////////////////////////////////////////////////
 
+int PS4API sceFiosInitialize(const SceFiosParams* pParameters);
+
+
+void PS4API sceFiosTerminate(void);
+
+
 int PS4API sceFiosDateToComponents(void);
 
 
-int PS4API sceFiosDeleteSync(void);
+int PS4API sceFiosDeleteSync(const SceFiosOpAttr* pAttr, const char* pPath);
 
 
-int PS4API sceFiosDirectoryCreateSync(void);
+int PS4API sceFiosDirectoryCreateSync(const SceFiosOpAttr* pAttr, const char* pPath);
+
+
+bool PS4API sceFiosFileExistsSync(const SceFiosOpAttr* pAttr, const char* pPath);
 
 
 bool PS4API sceFiosDirectoryExistsSync(const SceFiosOpAttr *pAttr, const char *pPath);
 
 
-int PS4API sceFiosFHCloseSync(void);
+int PS4API sceFiosFHCloseSync(const SceFiosOpAttr* pAttr, SceFiosFH fh);
+
+
+int PS4API sceFiosFHOpenSync(const SceFiosOpAttr* pAttr, SceFiosFH* pOutFH, const char* pPath, const SceFiosOpenParams* pOpenParams);
+
+
+SceFiosSize PS4API sceFiosFHReadSync(const SceFiosOpAttr* pAttr, SceFiosFH fh, void* pBuf, SceFiosSize length);
+
+
+SceFiosOffset PS4API sceFiosFHSeek(SceFiosFH fh, SceFiosOffset offset, SceFiosWhence whence);
+
+
+int PS4API sceFiosFHStatSync(const SceFiosOpAttr* pAttr, SceFiosFH fh, SceFiosStat* pOutStatus);
+
+
+SceFiosSize PS4API sceFiosFHWriteSync(const SceFiosOpAttr* pAttr, SceFiosFH fh, const void* pBuf, SceFiosSize length);
+
+
+SceFiosSize PS4API sceFiosFileGetSizeSync(const SceFiosOpAttr* pAttr, const char* pPath);
+
+
+SceFiosSize PS4API sceFiosFileReadSync(const SceFiosOpAttr* pAttr, const char* pPath, void* pBuf, SceFiosSize length, SceFiosOffset offset);
+
+
+SceFiosSize PS4API sceFiosFileWriteSync(const SceFiosOpAttr* pAttr, const char* pPath, const void* pBuf, SceFiosSize length, SceFiosOffset offset);
+
+
+int PS4API sceFiosStatSync(const SceFiosOpAttr* pAttr, const char* pPath, SceFiosStat* pOutStatus);
+
+
+int PS4API sceFiosDeallocatePassthruFH(SceFiosFH fh);
+
+
+SceFiosFH PS4API sceFiosFilenoToFH(int fd);
+
+
+int PS4API sceFiosFHToFileno(SceFiosFH fh);
+
+
+bool PS4API sceFiosIsValidHandle(SceFiosHandle h);
+
+
+int PS4API sceFiosFHOpenWithModeSync(const SceFiosOpAttr* pAttr, SceFiosFH* pOutFH, const char* pPath, const SceFiosOpenParams* pOpenParams, int32_t nativeMode);
+
+
+int PS4API sceFiosRenameSync(const SceFiosOpAttr* pAttr, const char* pOldPath, const char* pNewPath);
+
+
+SceFiosOp PS4API sceFiosFHOpen(const SceFiosOpAttr* pAttr, SceFiosFH* pOutFH, const char* pPath, const SceFiosOpenParams* pOpenParams);
+
+
+SceFiosOp PS4API sceFiosFHClose(const SceFiosOpAttr* pAttr, SceFiosFH fh);
+
+
+SceFiosOp PS4API sceFiosFHRead(const SceFiosOpAttr* pAttr, SceFiosFH fh, void* pBuf, SceFiosSize length);
+
+
+SceFiosOp PS4API sceFiosFHPread(const SceFiosOpAttr* pAttr, SceFiosFH fh, void* pBuf, SceFiosSize length, SceFiosOffset offset);
+
+
+SceFiosSize PS4API sceFiosFHPreadSync(const SceFiosOpAttr* pAttr, SceFiosFH fh, void* pBuf, SceFiosSize length, SceFiosOffset offset);
+
+
+SceFiosOp PS4API sceFiosFHWrite(const SceFiosOpAttr* pAttr, SceFiosFH fh, const void* pBuf, SceFiosSize length);
+
+
+SceFiosOp PS4API sceFiosFHPwrite(const SceFiosOpAttr* pAttr, SceFiosFH fh, const void* pBuf, SceFiosSize length, SceFiosOffset offset);
+
+
+SceFiosSize PS4API sceFiosFHPwriteSync(const SceFiosOpAttr* pAttr, SceFiosFH fh, const void* pBuf, SceFiosSize length, SceFiosOffset offset);
+
+
+SceFiosOp PS4API sceFiosFHStat(const SceFiosOpAttr* pAttr, SceFiosFH fh, SceFiosStat* pOutStatus);
+
+
+SceFiosOffset PS4API sceFiosFHTell(SceFiosFH fh);
+
+
+SceFiosSize PS4API sceFiosFHGetSize(SceFiosFH fh);
+
+
+SceFiosOp PS4API sceFiosFileRead(const SceFiosOpAttr* pAttr, const char* pPath, void* pBuf, SceFiosSize length, SceFiosOffset offset);
+
+
+SceFiosOp PS4API sceFiosFileWrite(const SceFiosOpAttr* pAttr, const char* pPath, const void* pBuf, SceFiosSize length, SceFiosOffset offset);
+
+
+SceFiosOp PS4API sceFiosFileGetSize(const SceFiosOpAttr* pAttr, const char* pPath, SceFiosSize* pOutSize);
 
 
-int PS4API sceFiosFHOpenSync(void);
+SceFiosOp PS4API sceFiosStat(const SceFiosOpAttr* pAttr, const char* pPath, SceFiosStat* pOutStatus);
 
 
-int PS4API sceFiosFHReadSync(void);
+int PS4API sceFiosOpWait(SceFiosOp op);
 
 
-int PS4API sceFiosFHSeek(void);
+int PS4API sceFiosOpWaitUntil(SceFiosOp op, SceFiosTime deadline);
 
 
-int PS4API sceFiosFHStatSync(void);
+int PS4API sceFiosOpSyncWait(SceFiosOp op);
 
 
-int PS4API sceFiosFHWriteSync(void);
+SceFiosSize PS4API sceFiosOpSyncWaitForIO(SceFiosOp op);
 
 
-bool PS4API sceFiosFileExistsSync(const SceFiosOpAttr *pAttr, const char *pPath);
+int PS4API sceFiosOpCancel(SceFiosOp op);
 
 
-int PS4API sceFiosFileGetSizeSync(void);
+void PS4API sceFiosOpDelete(SceFiosOp op);
 
 
-int PS4API sceFiosFileReadSync(void);
+bool PS4API sceFiosOpIsDone(SceFiosOp op);
 
 
-int PS4API sceFiosFileWriteSync(void);
+bool PS4API sceFiosOpIsCancelled(SceFiosOp op);
 
 
-int PS4API sceFiosStatSync(void);
+int PS4API sceFiosOpGetError(SceFiosOp op);
 
 
-int PS4API sceFiosDeallocatePassthruFH(void);
+SceFiosSize PS4API sceFiosOpGetActualCount(SceFiosOp op);
 
 
-int PS4API sceFiosFilenoToFH(void);
+void PS4API sceFiosOpReschedule(SceFiosOp op, SceFiosTime newDeadline);
 
 
-int PS4API sceFiosFHToFileno(void);
+SceFiosTime PS4API sceFiosTimeGetCurrent(void);
 
 
-int PS4API sceFiosIsValidHandle(void);
+SceFiosTime PS4API sceFiosTimeIntervalFromNanoseconds(int64_t ns);
 
 
-int PS4API sceFiosFHOpenWithModeSync(void);
+int64_t PS4API sceFiosTimeIntervalToNanoseconds(SceFiosTime interval);
 
 
-int PS4API sceFiosRenameSync(void);
\ No newline at end of file
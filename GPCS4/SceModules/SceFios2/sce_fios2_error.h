@@ -0,0 +1,31 @@
+#pragma once
+
+
+
+// FIOS2 errors
+#define SCE_FIOS_ERROR_UNIMPLEMENTED				-2137915391	 //0x80920001
+#define SCE_FIOS_ERROR_CANT_ALLOCATE_OP				-2137915390	 //0x80920002
+#define SCE_FIOS_ERROR_CANT_ALLOCATE_FH				-2137915389	 //0x80920003
+#define SCE_FIOS_ERROR_CANT_ALLOCATE_DH				-2137915388	 //0x80920004
+#define SCE_FIOS_ERROR_CANT_ALLOCATE_CHUNK			-2137915387	 //0x80920005
+#define SCE_FIOS_ERROR_BAD_PATH						-2137915386	 //0x80920006
+#define SCE_FIOS_ERROR_BAD_PTR						-2137915385	 //0x80920007
+#define SCE_FIOS_ERROR_BAD_OFFSET					-2137915384	 //0x80920008
+#define SCE_FIOS_ERROR_BAD_SIZE						-2137915383	 //0x80920009
+#define SCE_FIOS_ERROR_BAD_IOVCNT					-2137915382	 //0x8092000A
+#define SCE_FIOS_ERROR_BAD_OP						-2137915381	 //0x8092000B
+#define SCE_FIOS_ERROR_BAD_FH						-2137915380	 //0x8092000C
+#define SCE_FIOS_ERROR_BAD_DH						-2137915379	 //0x8092000D
+#define SCE_FIOS_ERROR_BAD_ALIGNMENT				-2137915378	 //0x8092000E
+#define SCE_FIOS_ERROR_NOT_A_FILE					-2137915377	 //0x8092000F
+#define SCE_FIOS_ERROR_NOT_A_DIRECTORY				-2137915376	 //0x80920010
+#define SCE_FIOS_ERROR_EOF							-2137915375	 //0x80920011
+#define SCE_FIOS_ERROR_TIMEOUT						-2137915374	 //0x80920012
+#define SCE_FIOS_ERROR_CANCELLED					-2137915373	 //0x80920013
+#define SCE_FIOS_ERROR_ACCESS						-2137915372	 //0x80920014
+#define SCE_FIOS_ERROR_DECOMPRESSION				-2137915371	 //0x80920015
+#define SCE_FIOS_ERROR_READ_ONLY					-2137915370	 //0x80920016
+#define SCE_FIOS_ERROR_WRITE_ONLY					-2137915369	 //0x80920017
+#define SCE_FIOS_ERROR_MEDIA_GONE					-2137915368	 //0x80920018
+#define SCE_FIOS_ERROR_BUSY							-2137915367	 //0x80920019
+#define SCE_FIOS_ERROR_PATH_TOO_LONG				-2137915366	 //0x8092001A
@@ -8,9 +8,12 @@
 
 static const SCE_EXPORT_FUNCTION g_pSceFios2_libSceFios2_FunctionTable[] =
 {
+	{ 0xC00299FDD7ADFB2A, "sceFiosInitialize", (void*)sceFiosInitialize },
+	{ 0xDC702064F975BFEE, "sceFiosTerminate", (void*)sceFiosTerminate },
 	{ 0x466FA18B0BD29F1C, "sceFiosDateToComponents", (void*)sceFiosDateToComponents },
 	{ 0x2AC553734E2437D9, "sceFiosDeleteSync", (void*)sceFiosDeleteSync },
 	{ 0x9D6BB36B465D7EA0, "sceFiosDirectoryCreateSync", (void*)sceFiosDirectoryCreateSync },
+	{ 0x3703873113363E9C, "sceFiosFileExistsSync", (void*)sceFiosFileExistsSync },
 	{ 0x38EBAF1CA4EEE0E7, "sceFiosDirectoryExistsSync", (void*)sceFiosDirectoryExistsSync },
 	{ 0x00EBA3486A94FA6B, "sceFiosFHCloseSync", (void*)sceFiosFHCloseSync },
 	{ 0x6F8E1A9D5D83ECAD, "sceFiosFHOpenSync", (void*)sceFiosFHOpenSync },
@@ -18,7 +21,6 @@ static const SCE_EXPORT_FUNCTION g_pSceFios2_libSceFios2_FunctionTable[] =
 	{ 0xC5179279BC0A0290, "sceFiosFHSeek", (void*)sceFiosFHSeek },
 	{ 0xC4FE397889ED122B, "sceFiosFHStatSync", (void*)sceFiosFHStatSync },
 	{ 0x2A5FD36EB0D4F583, "sceFiosFHWriteSync", (void*)sceFiosFHWriteSync },
-	{ 0x3703873113363E9C, "sceFiosFileExistsSync", (void*)sceFiosFileExistsSync },
 	{ 0xCC5F3F091BD15E73, "sceFiosFileGetSizeSync", (void*)sceFiosFileGetSizeSync },
 	{ 0x9153314A2603EAD7, "sceFiosFileReadSync", (void*)sceFiosFileReadSync },
 	{ 0xC23FD4FA631BC803, "sceFiosFileWriteSync", (void*)sceFiosFileWriteSync },
@@ -29,6 +31,35 @@ static const SCE_EXPORT_FUNCTION g_pSceFios2_libSceFios2_FunctionTable[] =
 	{ 0xF081A3C2D9EF6302, "sceFiosIsValidHandle", (void*)sceFiosIsValidHandle },
 	{ 0xC35DCE8E6ECE37DA, "sceFiosFHOpenWithModeSync", (void*)sceFiosFHOpenWithModeSync },
 	{ 0x1BFDFD96C752817A, "sceFiosRenameSync", (void*)sceFiosRenameSync },
+	{ 0x7ABE93910154BE9D, "sceFiosFHOpen", (void*)sceFiosFHOpen },
+	{ 0xE6C60D04D2BE5B78, "sceFiosFHClose", (void*)sceFiosFHClose },
+	{ 0x720FD5A0FA9962CB, "sceFiosFHRead", (void*)sceFiosFHRead },
+	{ 0xAD1F30ABB605459B, "sceFiosFHPread", (void*)sceFiosFHPread },
+	{ 0xDA6F7E3A9728FE19, "sceFiosFHPreadSync", (void*)sceFiosFHPreadSync },
+	{ 0xBAB5079061B0780E, "sceFiosFHWrite", (void*)sceFiosFHWrite },
+	{ 0x3DBC4655F3AF5106, "sceFiosFHPwrite", (void*)sceFiosFHPwrite },
+	{ 0x80C71F3AD1D6EB39, "sceFiosFHPwriteSync", (void*)sceFiosFHPwriteSync },
+	{ 0xFFFDA2469467E41C, "sceFiosFHStat", (void*)sceFiosFHStat },
+	{ 0x32B445ADD829B31F, "sceFiosFHTell", (void*)sceFiosFHTell },
+	{ 0x15D8E8A8540E96DD, "sceFiosFHGetSize", (void*)sceFiosFHGetSize },
+	{ 0x62528291F24BF98F, "sceFiosFileRead", (void*)sceFiosFileRead },
+	{ 0xABC09F7AD2267486, "sceFiosFileWrite", (void*)sceFiosFileWrite },
+	{ 0xEA34CDC735DC90A5, "sceFiosFileGetSize", (void*)sceFiosFileGetSize },
+	{ 0x40AB08F4DECAD731, "sceFiosStat", (void*)sceFiosStat },
+	{ 0x4A7A104169C62BD2, "sceFiosOpWait", (void*)sceFiosOpWait },
+	{ 0x652B058AD6782A99, "sceFiosOpWaitUntil", (void*)sceFiosOpWaitUntil },
+	{ 0xDB0BEA4BB39D6FA3, "sceFiosOpSyncWait", (void*)sceFiosOpSyncWait },
+	{ 0x9CFFCB69B6311DB9, "sceFiosOpSyncWaitForIO", (void*)sceFiosOpSyncWaitForIO },
+	{ 0x140EDD52579E1A29, "sceFiosOpCancel", (void*)sceFiosOpCancel },
+	{ 0xE5CC8472294EFC9D, "sceFiosOpDelete", (void*)sceFiosOpDelete },
+	{ 0x6DF828D8EB66AB3D, "sceFiosOpIsDone", (void*)sceFiosOpIsDone },
+	{ 0xFBCBDCBAB3E16C46, "sceFiosOpIsCancelled", (void*)sceFiosOpIsCancelled },
+	{ 0x5FEEEB21F63DECFB, "sceFiosOpGetError", (void*)sceFiosOpGetError },
+	{ 0xF8546F2A49D48F52, "sceFiosOpGetActualCount", (void*)sceFiosOpGetActualCount },
+	{ 0x0D7D493FDE63DC68, "sceFiosOpReschedule", (void*)sceFiosOpReschedule },
+	{ 0x35490118E640462E, "sceFiosTimeGetCurrent", (void*)sceFiosTimeGetCurrent },
+	{ 0x1757423FBAA4AA89, "sceFiosTimeIntervalFromNanoseconds", (void*)sceFiosTimeIntervalFromNanoseconds },
+	{ 0xBD9348701DE7F9B8, "sceFiosTimeIntervalToNanoseconds", (void*)sceFiosTimeIntervalToNanoseconds },
 	SCE_FUNCTION_ENTRY_END
 };
 
@@ -1,11 +1,17 @@
 #include "sce_libc.h"
 #include "Platform.h"
+#include "Emulator.h"
+#include "VirtualFileSystem.h"
 
 LOG_CHANNEL(SceModules.SceLibc.file);
 
 FILE* PS4API scec_fopen(const char *pathname, const char *mode)
 {
-	auto pcPath = plat::PS4PathToPCPath(pathname);
+	auto pcPath = VFS().Resolve(pathname);
+	if (strpbrk(mode, "wa+"))
+	{
+		VFS().Invalidate(pathname);
+	}
 	FILE* fp = fopen(pcPath.c_str(), mode);
 	LOG_SCE_TRACE("(fname '%s' mode '%s') = %p", pathname, mode, fp);
 	return fp;
@@ -0,0 +1,349 @@
+#include "SceFileTable.h"
+#include "sce_errors.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+LOG_CHANNEL(SceModules.SceLibkernel.file);
+
+CSceFile::CSceFile(const std::string& strPath, plat::FileHandle hFile, int nFlags) :
+	m_strPath(strPath),
+	m_hFile(hFile),
+	m_bDirectory(false),
+	m_nFlags(nFlags)
+{
+}
+
+CSceFile::CSceFile(const std::string& strPath, std::vector<uint8_t>&& vtDirents) :
+	m_strPath(strPath),
+	m_hFile(plat::INVALID_FILE_HANDLE),
+	m_bDirectory(true),
+	m_nFlags(SCE_KERNEL_O_RDONLY | SCE_KERNEL_O_DIRECTORY),
+	m_vtDirents(std::move(vtDirents))
+{
+}
+
+CSceFile::~CSceFile()
+{
+	if (m_hFile != plat::INVALID_FILE_HANDLE)
+	{
+		plat::FileClose(m_hFile);
+	}
+}
+
+ssize_t CSceFile::Read(void* pBuffer, size_t nSize)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	ssize_t nRet = Pread(pBuffer, nSize, m_nPosition);
+	if (nRet > 0)
+	{
+		m_nPosition += nRet;
+	}
+	return nRet;
+}
+
+ssize_t CSceFile::Write(const void* pBuffer, size_t nSize)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if ((m_nFlags & SCE_KERNEL_O_APPEND) && !IsDirectory())
+	{
+		m_nPosition = plat::FileGetSize(m_hFile);
+	}
+
+	ssize_t nRet = Pwrite(pBuffer, nSize, m_nPosition);
+	if (nRet > 0)
+	{
+		m_nPosition += nRet;
+	}
+	return nRet;
+}
+
+ssize_t CSceFile::Pread(void* pBuffer, size_t nSize, sce_off_t nOffset)
+{
+	ssize_t nRet = SCE_KERNEL_ERROR_EIO;
+	do
+	{
+		if (IsDirectory())
+		{
+			nRet = SCE_KERNEL_ERROR_EISDIR;
+			break;
+		}
+
+		if ((m_nFlags & O_ACCMODE) == SCE_KERNEL_O_WRONLY)
+		{
+			nRet = SCE_KERNEL_ERROR_EBADF;
+			break;
+		}
+
+		if (nOffset < 0)
+		{
+			nRet = SCE_KERNEL_ERROR_EINVAL;
+			break;
+		}
+
+		int64_t nRead = nSize < 2 * ReadChunkSize ? plat::FileReadAt(m_hFile, pBuffer, nSize, nOffset)
+												  : readChunked(pBuffer, nSize, nOffset);
+		if (nRead < 0)
+		{
+			LOG_WARN("read failed %s offset %lld size %zu", m_strPath.c_str(), nOffset, nSize);
+			break;
+		}
+
+		nRet = nRead;
+	} while (false);
+	return nRet;
+}
+
+int64_t CSceFile::readChunked(void* pBuffer, size_t nSize, sce_off_t nOffset)
+{
+	size_t nChunkSize = std::max(ReadChunkSize, (nSize + ReadChunkCount - 1) / ReadChunkCount);
+	size_t nCount     = (nSize + nChunkSize - 1) / nChunkSize;
+
+	std::array<plat::FileReadRequest, ReadChunkCount> requests;
+	for (size_t i = 0; i != nCount; ++i)
+	{
+		size_t nChunkOffset = i * nChunkSize;
+		requests[i].hFile   = m_hFile;
+		requests[i].pBuffer = reinterpret_cast<uint8_t*>(pBuffer) + nChunkOffset;
+		requests[i].nSize   = std::min(nChunkSize, nSize - nChunkOffset);
+		requests[i].nOffset = nOffset + nChunkOffset;
+	}
+
+	plat::FileReadBatch(requests.data(), nCount);
+
+	// Data past a short chunk is not contiguous with the rest.
+	int64_t nRead = 0;
+	for (size_t i = 0; i != nCount; ++i)
+	{
+		if (requests[i].nResult < 0)
+		{
+			nRead = -1;
+			break;
+		}
+
+		nRead += requests[i].nResult;
+		if (requests[i].nResult != int64_t(requests[i].nSize))
+		{
+			break;
+		}
+	}
+	return nRead;
+}
+
+ssize_t CSceFile::Pwrite(const void* pBuffer, size_t nSize, sce_off_t nOffset)
+{
+	ssize_t nRet = SCE_KERNEL_ERROR_EIO;
+	do
+	{
+		if (IsDirectory())
+		{
+			nRet = SCE_KERNEL_ERROR_EISDIR;
+			break;
+		}
+
+		if ((m_nFlags & O_ACCMODE) == SCE_KERNEL_O_RDONLY)
+		{
+			nRet = SCE_KERNEL_ERROR_EBADF;
+			break;
+		}
+
+		if (nOffset < 0)
+		{
+			nRet = SCE_KERNEL_ERROR_EINVAL;
+			break;
+		}
+
+		int64_t nWritten = plat::FileWriteAt(m_hFile, pBuffer, nSize, nOffset);
+		if (nWritten < 0)
+		{
+			LOG_WARN("write failed %s offset %lld size %zu", m_strPath.c_str(), nOffset, nSize);
+			break;
+		}
+
+		nRet = nWritten;
+	} while (false);
+	return nRet;
+}
+
+sce_off_t CSceFile::Seek(sce_off_t nOffset, int nWhence)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	sce_off_t nRet = SCE_KERNEL_ERROR_EINVAL;
+	do
+	{
+		sce_off_t nBase = 0;
+		switch (nWhence)
+		{
+		case SEEK_SET:
+			nBase = 0;
+			break;
+		case SEEK_CUR:
+			nBase = m_nPosition;
+			break;
+		case SEEK_END:
+			nBase = IsDirectory() ? m_vtDirents.size() : plat::FileGetSize(m_hFile);
+			break;
+		default:
+			nBase = -1;
+			break;
+		}
+
+		if (nBase < 0 || nBase + nOffset < 0)
+		{
+			break;
+		}
+
+		m_nPosition = nBase + nOffset;
+		nRet        = m_nPosition;
+	} while (false);
+	return nRet;
+}
+
+int CSceFile::ReadDirents(void* pBuffer, size_t nSize)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	int nRet = SCE_KERNEL_ERROR_EINVAL;
+	do
+	{
+		if (!IsDirectory())
+		{
+			break;
+		}
+
+		size_t nBegin = std::min<size_t>(m_nPosition, m_vtDirents.size());
+		size_t nEnd   = nBegin;
+		while (nEnd != m_vtDirents.size())
+		{
+			auto pEnt = reinterpret_cast<const SceKernelDirent*>(&m_vtDirents[nEnd]);
+			if (nEnd + pEnt->d_reclen - nBegin > nSize)
+			{
+				break;
+			}
+			nEnd += pEnt->d_reclen;
+		}
+
+		// The buffer must hold at least one record.
+		if (nEnd == nBegin && nBegin != m_vtDirents.size())
+		{
+			break;
+		}
+
+		std::memcpy(pBuffer, m_vtDirents.data() + nBegin, nEnd - nBegin);
+		m_nPosition = nEnd;
+
+		nRet = static_cast<int>(nEnd - nBegin);
+	} while (false);
+	return nRet;
+}
+
+CSceFileTable::CSceFileTable()
+{
+}
+
+CSceFileTable::~CSceFileTable()
+{
+	for (auto& slot : m_slots)
+	{
+		if (slot.nState.load(std::memory_order_relaxed) & SLOT_OPEN)
+		{
+			delete slot.pFile;
+		}
+	}
+}
+
+int CSceFileTable::Insert(CSceFile* pFile)
+{
+	int fd = SCE_KERNEL_ERROR_EMFILE;
+	for (int i = FD_FIRST; i != SCE_FD_MAX; ++i)
+	{
+		Slot&    slot  = m_slots[i];
+		uint32_t state = 0;
+		if (!slot.nState.compare_exchange_strong(state, SLOT_RESERVED, std::memory_order_acquire))
+		{
+			continue;
+		}
+
+		// Lookups can't see the file until the slot is open.
+		slot.pFile = pFile;
+		slot.nState.store(SLOT_OPEN | 1, std::memory_order_release);
+
+		fd = i;
+		break;
+	}
+
+	if (fd < 0)
+	{
+		LOG_WARN("file table is full");
+		delete pFile;
+	}
+	return fd;
+}
+
+CSceFileTable::Ref CSceFileTable::Get(int fd)
+{
+	if (fd < FD_FIRST || fd >= SCE_FD_MAX)
+	{
+		return Ref();
+	}
+
+	Slot&    slot  = m_slots[fd];
+	uint32_t state = slot.nState.load(std::memory_order_relaxed);
+	while (state & SLOT_OPEN)
+	{
+		// While the reference is held the slot can't be
+		// reused, so the file pointer stays valid.
+		if (slot.nState.compare_exchange_weak(state, state + 1, std::memory_order_acquire))
+		{
+			return Ref(&slot, slot.pFile);
+		}
+	}
+	return Ref();
+}
+
+bool CSceFileTable::Remove(int fd)
+{
+	bool bRet = false;
+	do
+	{
+		if (fd < FD_FIRST || fd >= SCE_FD_MAX)
+		{
+			break;
+		}
+
+		Slot&    slot  = m_slots[fd];
+		uint32_t state = slot.nState.load(std::memory_order_relaxed);
+		while (state & SLOT_OPEN)
+		{
+			if (slot.nState.compare_exchange_weak(state, state & ~SLOT_OPEN, std::memory_order_acquire))
+			{
+				bRet = true;
+				break;
+			}
+		}
+
+		if (!bRet)
+		{
+			break;
+		}
+
+		// Drop the reference of the table.
+		Release(&slot, slot.pFile);
+	} while (false);
+	return bRet;
+}
+
+void CSceFileTable::Release(Slot* pSlot, CSceFile* pFile)
+{
+	// The last reference of a closed descriptor frees the slot.
+	if (pSlot->nState.fetch_sub(1, std::memory_order_acq_rel) == 1)
+	{
+		delete pFile;
+	}
+}
+
+CSceFileTable& GetFileTable()
+{
+	static CSceFileTable s_fileTable;
+	return s_fileTable;
+}
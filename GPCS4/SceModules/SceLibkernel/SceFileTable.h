@@ -0,0 +1,173 @@
+#pragma once
+#include "GPCS4Common.h"
+#include "sce_types.h"
+#include "sce_kernel_file.h"
+#include "Platform/PlatFile.h"
+
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+// An open file or directory.
+// Positional reads and writes go straight to the host file and
+// never lock, only calls that use the file position serialize.
+
+class CSceFile
+{
+public:
+	CSceFile(const std::string& strPath, plat::FileHandle hFile, int nFlags);
+	// A directory is read once when it is opened, vtDirents holds
+	// its entries as packed SceKernelDirent records.
+	CSceFile(const std::string& strPath, std::vector<uint8_t>&& vtDirents);
+	~CSceFile();
+
+	bool IsDirectory() const
+	{
+		return m_bDirectory;
+	}
+
+	const std::string& Path() const
+	{
+		return m_strPath;
+	}
+
+	plat::FileHandle Handle() const
+	{
+		return m_hFile;
+	}
+
+	// Size of the directory records in bytes.
+	size_t DirentsSize() const
+	{
+		return m_vtDirents.size();
+	}
+
+	// Return the number of bytes transferred or an sce error code.
+	ssize_t Read(void* pBuffer, size_t nSize);
+
+	ssize_t Write(const void* pBuffer, size_t nSize);
+
+	ssize_t Pread(void* pBuffer, size_t nSize, sce_off_t nOffset);
+
+	ssize_t Pwrite(const void* pBuffer, size_t nSize, sce_off_t nOffset);
+
+	// Returns the new position or an sce error code.
+	sce_off_t Seek(sce_off_t nOffset, int nWhence);
+
+	// Copies as many whole directory records as fit, starting
+	// at the file position. Returns the number of bytes copied,
+	// 0 at the end of the directory, or an sce error code.
+	int ReadDirents(void* pBuffer, size_t nSize);
+
+private:
+	// Large reads are split into chunks read as one batch,
+	// so the host can keep several requests in flight.
+	static constexpr size_t ReadChunkSize  = 1024 * 1024;
+	static constexpr size_t ReadChunkCount = 64;
+
+	int64_t readChunked(void* pBuffer, size_t nSize, sce_off_t nOffset);
+
+private:
+	std::string      m_strPath;
+	plat::FileHandle m_hFile;
+	bool             m_bDirectory;
+	int              m_nFlags;
+
+	std::vector<uint8_t> m_vtDirents;
+
+	std::mutex m_mutex;
+	sce_off_t  m_nPosition = 0;
+};
+
+// File descriptor table.
+// Lookups are lock free, every slot counts the references held on
+// its file. Closing a descriptor only drops the table's reference,
+// the file is destroyed once the last lookup using it is done, so
+// a close racing with reads on other threads is safe.
+
+class CSceFileTable
+{
+	struct Slot
+	{
+		std::atomic<uint32_t> nState = { 0 };
+		CSceFile*             pFile  = nullptr;
+	};
+
+public:
+	// Reference to an open file, released on destruction
+	class Ref
+	{
+	public:
+		Ref() = default;
+
+		Ref(Slot* pSlot, CSceFile* pFile) :
+			m_pSlot(pSlot), m_pFile(pFile)
+		{
+		}
+
+		Ref(Ref&& other) noexcept :
+			m_pSlot(std::exchange(other.m_pSlot, nullptr)),
+			m_pFile(std::exchange(other.m_pFile, nullptr))
+		{
+		}
+
+		Ref(const Ref&) = delete;
+		Ref& operator=(const Ref&) = delete;
+
+		~Ref()
+		{
+			if (m_pFile)
+			{
+				CSceFileTable::Release(m_pSlot, m_pFile);
+			}
+		}
+
+		CSceFile* operator->() const
+		{
+			return m_pFile;
+		}
+
+		explicit operator bool() const
+		{
+			return m_pFile != nullptr;
+		}
+
+	private:
+		Slot*     m_pSlot = nullptr;
+		CSceFile* m_pFile = nullptr;
+	};
+
+	CSceFileTable();
+	~CSceFileTable();
+
+	// Takes ownership of the file.
+	// Returns the lowest free descriptor, or an sce error code
+	// if the table is full, in which case the file is destroyed.
+	int Insert(CSceFile* pFile);
+
+	// Returns an empty reference if the descriptor is not open.
+	Ref Get(int fd);
+
+	// Returns false if the descriptor is not open.
+	bool Remove(int fd);
+
+private:
+	static void Release(Slot* pSlot, CSceFile* pFile);
+
+private:
+	// Descriptors 0 to 2 are the standard streams.
+	static constexpr int FD_FIRST = 3;
+
+	// Slot state, the low bits count references. The table
+	// holds one reference while the descriptor is open.
+	static constexpr uint32_t SLOT_OPEN     = 1u << 31;
+	static constexpr uint32_t SLOT_RESERVED = 1u << 30;
+	static constexpr uint32_t SLOT_REFS     = SLOT_RESERVED - 1;
+
+	std::array<Slot, SCE_FD_MAX> m_slots;
+};
+
+CSceFileTable& GetFileTable();
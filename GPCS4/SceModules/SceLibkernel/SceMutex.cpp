@@ -0,0 +1,327 @@
+#include "SceMutex.h"
+#include "sce_kernel_scepthread.h"
+#include "Platform/PlatTime.h"
+
+#include <cerrno>
+#include <chrono>
+#include <limits>
+#include <immintrin.h>
+
+LOG_CHANNEL(SceModules.SceLibkernel.mutex);
+
+// Number of probes before a contended lock parks the thread.
+// Adaptive mutexes spin longer, expecting the owner to release soon.
+constexpr uint32_t MutexSpinCount         = 100;
+constexpr uint32_t AdaptiveMutexSpinCount = 2000;
+
+
+class WaitDeadline
+{
+public:
+	WaitDeadline(const uint64_t* timeoutUs) :
+		m_infinite(timeoutUs == nullptr)
+	{
+		if (!m_infinite)
+		{
+			m_deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(*timeoutUs);
+		}
+	}
+
+	// returns nullptr for infinite wait
+	const uint64_t* remaining()
+	{
+		if (m_infinite)
+		{
+			return nullptr;
+		}
+
+		auto now = std::chrono::steady_clock::now();
+		m_remain = now >= m_deadline ? 0 :
+			std::chrono::duration_cast<std::chrono::microseconds>(m_deadline - now).count();
+		return &m_remain;
+	}
+
+	bool expired()
+	{
+		return !m_infinite && std::chrono::steady_clock::now() >= m_deadline;
+	}
+
+private:
+	bool                                  m_infinite;
+	std::chrono::steady_clock::time_point m_deadline;
+	uint64_t                              m_remain = 0;
+};
+
+
+CSceMutex::CSceMutex(const SceMutexAttr& attr, const char* name) :
+	m_type(attr.type),
+	m_protocol(attr.protocol),
+	m_prioceiling(attr.prioceiling),
+	m_name(name ? name : "")
+{
+	m_spinCount = m_type == SCE_PTHREAD_MUTEX_ADAPTIVE_NP ?
+		AdaptiveMutexSpinCount : MutexSpinCount;
+}
+
+CSceMutex::~CSceMutex()
+{
+}
+
+int CSceMutex::TryLock()
+{
+	uint32_t self  = CurrentThread();
+	uint32_t state = 0;
+	int      err   = 0;
+	do
+	{
+		if (m_state.compare_exchange_strong(state, self, std::memory_order_acquire))
+		{
+			break;
+		}
+
+		if ((state & OwnerMask) == self && m_type == SCE_PTHREAD_MUTEX_RECURSIVE)
+		{
+			if (m_recursion == std::numeric_limits<uint32_t>::max())
+			{
+				err = EAGAIN;
+				break;
+			}
+			++m_recursion;
+			break;
+		}
+
+		err = EBUSY;
+	} while (false);
+	return err;
+}
+
+int CSceMutex::TimedLock(uint64_t timeoutUs)
+{
+	uint32_t self  = CurrentThread();
+	uint32_t state = 0;
+	if (m_state.compare_exchange_strong(state, self, std::memory_order_acquire))
+	{
+		return 0;
+	}
+	return LockContended(self, state, &timeoutUs);
+}
+
+int CSceMutex::GetPrioceiling(int* prioceiling)
+{
+	if (m_protocol != SCE_PTHREAD_PRIO_PROTECT)
+	{
+		return EINVAL;
+	}
+	*prioceiling = m_prioceiling;
+	return 0;
+}
+
+int CSceMutex::SetPrioceiling(int prioceiling, int* oldCeiling)
+{
+	if (m_protocol != SCE_PTHREAD_PRIO_PROTECT)
+	{
+		return EINVAL;
+	}
+
+	int err = Lock();
+	if (err != 0)
+	{
+		return err;
+	}
+
+	if (oldCeiling)
+	{
+		*oldCeiling = m_prioceiling;
+	}
+	m_prioceiling = prioceiling;
+
+	return Unlock();
+}
+
+uint32_t CSceMutex::ReleaseForWait()
+{
+	uint32_t recursion = m_recursion;
+	m_recursion        = 0;
+	Unlock();
+	return recursion;
+}
+
+void CSceMutex::AcquireAfterWait(uint32_t recursion)
+{
+	// Self lock is impossible here, all types behave the same.
+	Lock();
+	m_recursion = recursion;
+}
+
+int CSceMutex::LockContended(uint32_t self, uint32_t state, const uint64_t* timeoutUs)
+{
+	if ((state & OwnerMask) == self)
+	{
+		return LockSelf(timeoutUs);
+	}
+
+	if (IsPriorityInherit())
+	{
+		// Let the kernel boost the owner while we are blocked.
+		return plat::FutexLockPi(reinterpret_cast<volatile uint32_t*>(&m_state), timeoutUs);
+	}
+
+	// Adaptive spin, the owner is likely running on another core
+	// and will release the lock soon.
+	for (uint32_t i = 0; i != m_spinCount; ++i)
+	{
+		_mm_pause();
+		state = m_state.load(std::memory_order_relaxed);
+		if (state == 0 &&
+			m_state.compare_exchange_weak(state, self, std::memory_order_acquire))
+		{
+			return 0;
+		}
+	}
+
+	// Park the thread. Once we slept, we must acquire the lock
+	// with waiters bit set, since there may be other sleepers.
+	WaitDeadline deadline(timeoutUs);
+	while (true)
+	{
+		state = m_state.load(std::memory_order_relaxed);
+		if (state == 0)
+		{
+			if (m_state.compare_exchange_weak(state, self | WaitersBit, std::memory_order_acquire))
+			{
+				return 0;
+			}
+			continue;
+		}
+
+		if (!(state & WaitersBit))
+		{
+			if (!m_state.compare_exchange_weak(state, state | WaitersBit, std::memory_order_relaxed))
+			{
+				continue;
+			}
+			state |= WaitersBit;
+		}
+
+		if (deadline.expired() ||
+			!plat::FutexWait(reinterpret_cast<volatile uint32_t*>(&m_state), state, deadline.remaining()))
+		{
+			return ETIMEDOUT;
+		}
+	}
+}
+
+void CSceMutex::UnlockContended()
+{
+	if (IsPriorityInherit())
+	{
+		plat::FutexUnlockPi(reinterpret_cast<volatile uint32_t*>(&m_state));
+		return;
+	}
+
+	uint32_t state = m_state.exchange(0, std::memory_order_release);
+	if (state & WaitersBit)
+	{
+		plat::FutexWakeOne(reinterpret_cast<volatile uint32_t*>(&m_state));
+	}
+}
+
+int CSceMutex::LockSelf(const uint64_t* timeoutUs)
+{
+	// Follows libthr's mutex_self_lock
+	int err = 0;
+	switch (m_type)
+	{
+	case SCE_PTHREAD_MUTEX_RECURSIVE:
+	{
+		if (m_recursion == std::numeric_limits<uint32_t>::max())
+		{
+			err = EAGAIN;
+			break;
+		}
+		++m_recursion;
+	}
+		break;
+	case SCE_PTHREAD_MUTEX_ERRORCHECK:
+	case SCE_PTHREAD_MUTEX_ADAPTIVE_NP:
+		err = timeoutUs ? ETIMEDOUT : EDEADLK;
+		break;
+	case SCE_PTHREAD_MUTEX_NORMAL:
+	{
+		// A normal mutex deadlocks on itself,
+		// the owner is us, so nobody is going to wake us up.
+		if (timeoutUs)
+		{
+			plat::MicroSleep(static_cast<uint32_t>(*timeoutUs));
+			err = ETIMEDOUT;
+			break;
+		}
+		LOG_WARN("normal mutex %s self deadlock.", m_name.c_str());
+		while (true)
+		{
+			plat::MicroSleep(std::numeric_limits<uint32_t>::max());
+		}
+	}
+		break;
+	default:
+		err = EINVAL;
+		break;
+	}
+	return err;
+}
+
+bool CSceMutex::IsPriorityInherit() const
+{
+	return m_protocol == SCE_PTHREAD_PRIO_INHERIT && plat::FutexSupportPriorityInherit();
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+CSceCond::CSceCond(const char* name) :
+	m_name(name ? name : "")
+{
+}
+
+CSceCond::~CSceCond()
+{
+}
+
+int CSceCond::Wait(CSceMutex* mutex, const uint64_t* timeoutUs)
+{
+	if (!mutex->IsOwnedByCurrentThread())
+	{
+		return EPERM;
+	}
+
+	// Register as a waiter before sampling the sequence,
+	// paired with Signal, which bumps the sequence before checking waiters.
+	m_waiters.fetch_add(1);
+	uint32_t sequence = m_sequence.load();
+
+	uint32_t recursion = mutex->ReleaseForWait();
+	bool notExpired = plat::FutexWait(reinterpret_cast<volatile uint32_t*>(&m_sequence), sequence, timeoutUs);
+	m_waiters.fetch_sub(1, std::memory_order_relaxed);
+	mutex->AcquireAfterWait(recursion);
+
+	return notExpired ? 0 : ETIMEDOUT;
+}
+
+int CSceCond::Signal()
+{
+	m_sequence.fetch_add(1);
+	if (m_waiters.load() != 0)
+	{
+		plat::FutexWakeOne(reinterpret_cast<volatile uint32_t*>(&m_sequence));
+	}
+	return 0;
+}
+
+int CSceCond::Broadcast()
+{
+	m_sequence.fetch_add(1);
+	if (m_waiters.load() != 0)
+	{
+		plat::FutexWakeAll(reinterpret_cast<volatile uint32_t*>(&m_sequence));
+	}
+	return 0;
+}
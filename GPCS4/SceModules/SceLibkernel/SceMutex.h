@@ -0,0 +1,147 @@
+#pragma once
+#include "GPCS4Common.h"
+#include "UtilLikely.h"
+#include "Platform/PlatThread.h"
+
+#include <atomic>
+#include <cerrno>
+#include <string>
+
+// Native guest mutex and condition variable.
+//
+// The lock word holds the owner thread id in the low 30 bits
+// and a waiters flag in bit 31, which is the same layout
+// Linux expects for priority inheritance futexes,
+// so a PI mutex can be handed to the kernel directly.
+//
+// All methods return posix error codes, the sce variants
+// convert them using pthreadErrorToSceError.
+
+struct SceMutexAttr
+{
+	int type;
+	int protocol;
+	int prioceiling;
+};
+
+
+class CSceMutex
+{
+public:
+	CSceMutex(const SceMutexAttr& attr, const char* name);
+	~CSceMutex();
+
+	static constexpr uint32_t WaitersBit = 0x80000000;
+	static constexpr uint32_t OwnerMask  = 0x3FFFFFFF;
+
+	static uint32_t CurrentThread()
+	{
+		static thread_local uint32_t t_owner =
+			static_cast<uint32_t>(plat::GetThreadId()) & OwnerMask;
+		return t_owner;
+	}
+
+	int Lock()
+	{
+		uint32_t self  = CurrentThread();
+		uint32_t state = 0;
+		if (likely(m_state.compare_exchange_strong(state, self, std::memory_order_acquire)))
+		{
+			return 0;
+		}
+		return LockContended(self, state, nullptr);
+	}
+
+	int Unlock()
+	{
+		uint32_t self  = CurrentThread();
+		uint32_t state = m_state.load(std::memory_order_relaxed);
+		if (unlikely((state & OwnerMask) != self))
+		{
+			return EPERM;
+		}
+
+		if (unlikely(m_recursion != 0))
+		{
+			--m_recursion;
+			return 0;
+		}
+
+		if (likely(state == self &&
+				   m_state.compare_exchange_strong(state, 0, std::memory_order_release)))
+		{
+			return 0;
+		}
+		UnlockContended();
+		return 0;
+	}
+
+	int TryLock();
+
+	// microseconds
+	int TimedLock(uint64_t timeoutUs);
+
+	int GetPrioceiling(int* prioceiling);
+
+	int SetPrioceiling(int prioceiling, int* oldCeiling);
+
+	bool IsOwnedByCurrentThread() const
+	{
+		return (m_state.load(std::memory_order_relaxed) & OwnerMask) == CurrentThread();
+	}
+
+	// Held by any thread, including the current one.
+	bool IsLocked() const
+	{
+		return m_state.load(std::memory_order_acquire) != 0;
+	}
+
+	// Used by condition variable, fully releases a recursive mutex
+	// and returns the recursion count to be restored.
+	uint32_t ReleaseForWait();
+
+	void AcquireAfterWait(uint32_t recursion);
+
+private:
+	int LockContended(uint32_t self, uint32_t state, const uint64_t* timeoutUs);
+
+	void UnlockContended();
+
+	int LockSelf(const uint64_t* timeoutUs);
+
+	bool IsPriorityInherit() const;
+
+private:
+	std::atomic<uint32_t> m_state = { 0 };
+	uint32_t              m_recursion = 0;
+	int                   m_type;
+	int                   m_protocol;
+	int                   m_prioceiling;
+	uint32_t              m_spinCount;
+	std::string           m_name;
+};
+
+
+class CSceCond
+{
+public:
+	CSceCond(const char* name);
+	~CSceCond();
+
+	// timeoutUs == nullptr means wait infinitely
+	int Wait(CSceMutex* mutex, const uint64_t* timeoutUs);
+
+	int Signal();
+
+	int Broadcast();
+
+	bool HasWaiters() const
+	{
+		return m_waiters.load() != 0;
+	}
+
+private:
+	std::atomic<uint32_t> m_sequence = { 0 };
+	std::atomic<uint32_t> m_waiters  = { 0 };
+	std::string           m_name;
+};
@@ -1,88 +1,108 @@
 #include "sce_libkernel.h"
 #include "sce_kernel_file.h"
-#include "MapSlot.h"
+#include "SceFileTable.h"
+#include "Emulator.h"
+#include "VirtualFileSystem.h"
 #include "Platform/PlatPath.h"
 #include <io.h>
 #include <fcntl.h>
+#include <algorithm>
+#include <cstddef>
 #include <cstdio>
-
-LOG_CHANNEL(SceModules.SceLibkernel.file);
-
-// this will be more friendly on linux....
+#include <cstring>
+#include <vector>
 
 #ifdef GPCS4_WINDOWS
-
 #include "dirent/dirent.h"
+#else
+#include <dirent.h>
+// glibc aliases d_fileno to d_ino, which would rename
+// the member of SceKernelDirent.
+#undef d_fileno
+#endif
 
-enum FdType
-{
-	FD_TYPE_UNKNOWN,
-	FD_TYPE_FILE,
-	FD_TYPE_DIRECTORY
-};
+LOG_CHANNEL(SceModules.SceLibkernel.file);
 
-struct FdItem
-{
-	uintptr_t fd;  // Maybe a file or a directory
-	FdType type;
-};
 
-bool isEqualFdItem(const FdItem& lhs, const FdItem& rhs)
+inline uint8_t getSceFileType(dirent* ent)
 {
-	return (lhs.fd == rhs.fd) && (lhs.type == rhs.type);
-}
+	uint8_t type = SCE_KERNEL_DT_UNKNOWN;
+	if (!strcmp(ent->d_name, ".") || !strcmp(ent->d_name, ".."))
+	{
+		type = SCE_KERNEL_DT_DIR;
+	}
+	else
+	{
+		switch (ent->d_type)
+		{
+		case DT_DIR:
+			type = SCE_KERNEL_DT_DIR;
+			break;
+		case DT_REG:
+			type = SCE_KERNEL_DT_REG;
+			break;
+		default:
+			LOG_ERR("found unknown file type. file %s type %x", ent->d_name, ent->d_type);
+			break;
+		}
+	}
 
-bool isEmptyFdItem(const FdItem& item)
-{
-	return (item.fd == 0 && item.type == FD_TYPE_UNKNOWN);
+	return type;
 }
 
-// since windows doesn't allow open(directory),
-// we record both DIR* and fd in this slot array
-MapSlot<FdItem, isEmptyFdItem, isEqualFdItem> g_fdSlots(SCE_FD_MAX);
-
-
-inline bool getDirName(DIR* dir, char* dirname, int len)
+// Reads a whole directory as packed SceKernelDirent records.
+// Like on FreeBSD, a record only spans its name rounded up
+// to 4 bytes, including the null terminator.
+bool readDirents(const std::string& pcPath, std::vector<uint8_t>& dirents)
 {
 	bool bRet = false;
 	do
 	{
-		wchar_t* wfname = dir->wdirp->patt;
-		if (!wfname)
+		DIR* dir = opendir(pcPath.c_str());
+		if (!dir)
 		{
 			break;
 		}
 
-		if (wcstombs(dirname, wfname, len) == (size_t)-1)
+		dirent* ent;
+		while ((ent = readdir(dir)) != nullptr)
 		{
-			break;
+			size_t namlen = std::min<size_t>(strlen(ent->d_name), SCE_MAX_PATH);
+			size_t reclen = offsetof(SceKernelDirent, d_name) + util::align(namlen + 1, 4);
+
+			size_t offset = dirents.size();
+			dirents.resize(offset + reclen);
+
+			SceKernelDirent* sce_ent = reinterpret_cast<SceKernelDirent*>(&dirents[offset]);
+			sce_ent->d_fileno = ent->d_ino;
+			sce_ent->d_reclen = reclen;
+			sce_ent->d_type = getSceFileType(ent);
+			sce_ent->d_namlen = namlen;
+			memcpy(sce_ent->d_name, ent->d_name, namlen);
 		}
-		
-		int str_len = strlen(dirname);
-		dirname[str_len - 2] = 0;
-		dirname[str_len - 1] = 0;
-		
-		bRet  = true;
-	}while(false);
+
+		closedir(dir);
+		bRet = true;
+	} while (false);
 	return bRet;
 }
 
-#endif  //GPCS4_WINDOWS
-
 
 int PS4API scek__write(int fd, const void* buf, size_t size)
 {
 	LOG_SCE_TRACE("fd %d buf 0x%p size %zu", fd, buf, size);
 
+	int ret = size;
 	do 
 	{
-		_write(fd, buf, size);
-
 		if (fd != 1 && fd != 2)
 		{
+			ret = sceKernelWrite(fd, buf, size);
 			break;
 		}
 
+		_write(fd, buf, size);
+
 		// If it's stdout/stderr, also log it to emulator logger
 		// TODO: Strip newline, log line already adds one
 		std::string tempBuf(static_cast<const char*>(buf), 0, size);
@@ -91,114 +111,104 @@ int PS4API scek__write(int fd, const void* buf, size_t size)
 		
 	} while (false);
 
-	return size;
+	return ret;
 }
 
 
 int PS4API sceKernelOpen(const char *path, int flags, SceKernelMode mode)
 {
 	LOG_SCE_TRACE("path %s flag %x mode %x", path, flags, mode);
-	std::string pcPath = plat::PS4PathToPCPath(path);
+	std::string pcPath = VFS().Resolve(path);
 
-#ifdef GPCS4_WINDOWS
-	int idx = g_fdSlots.GetEmptySlotIndex();
-	bool hasError = false;
-	if (flags & SCE_KERNEL_O_DIRECTORY)
+	int ret = SCE_KERNEL_ERROR_ENOENT;
+	do
 	{
-		DIR* dir = opendir(pcPath.c_str());
-		if (!dir)
+		if (flags & SCE_KERNEL_O_DIRECTORY)
 		{
-			LOG_WARN("open dir failed %s", path);
-			hasError = true;
+			std::vector<uint8_t> dirents;
+			if (!readDirents(pcPath, dirents))
+			{
+				LOG_WARN("open dir failed %s", path);
+				break;
+			}
+
+			ret = GetFileTable().Insert(new CSceFile(pcPath, std::move(dirents)));
+			break;
 		}
-		g_fdSlots[idx].fd = (uintptr_t)dir;
-		g_fdSlots[idx].type = FD_TYPE_DIRECTORY;
 
-	}
-	else
-	{
-		LOG_ASSERT((flags == SCE_KERNEL_O_RDONLY || flags & SCE_KERNEL_O_TRUNC), "not supported flag.");
-		LOG_ASSERT((mode == SCE_KERNEL_S_IRU) || ((mode == SCE_KERNEL_S_INONE) && ((flags & SCE_KERNEL_O_CREAT) == 0)) || ((mode == SCE_KERNEL_S_IRWU) && ((flags & SCE_KERNEL_O_TRUNC))), "not supported mode.");
+		uint32_t openFlags = 0;
+		switch (flags & O_ACCMODE)
+		{
+		case SCE_KERNEL_O_WRONLY:
+			openFlags = plat::FOF_WRITE;
+			break;
+		case SCE_KERNEL_O_RDWR:
+			openFlags = plat::FOF_READ_WRITE;
+			break;
+		default:
+			openFlags = plat::FOF_READ;
+			break;
+		}
 
-		int oflag;
-		int pmode;
-		
-		if (flags & SCE_KERNEL_O_TRUNC) 
+		if (flags & SCE_KERNEL_O_CREAT)
+		{
+			openFlags |= plat::FOF_CREATE;
+		}
+		if (flags & SCE_KERNEL_O_TRUNC)
 		{
-			oflag = _O_CREAT | _O_TRUNC | _O_BINARY;
-			pmode = _S_IREAD | _S_IWRITE;
+			openFlags |= plat::FOF_TRUNCATE;
 		}
-		else 
+		if (flags & SCE_KERNEL_O_EXCL)
 		{
-			oflag = _O_RDONLY | _O_BINARY;
-			pmode = _S_IREAD;
+			openFlags |= plat::FOF_EXCLUSIVE;
 		}
 
-		int fd = _open(pcPath.c_str(), oflag, pmode);
-		if (fd == -1)
+		if (flags & (SCE_KERNEL_O_CREAT | SCE_KERNEL_O_TRUNC))
 		{
-			LOG_WARN("open file failed %s", path);
-			hasError = true;
-			g_fdSlots[idx].fd = 0;
-			g_fdSlots[idx].type = FD_TYPE_UNKNOWN;
+			VFS().Invalidate(path);
 		}
-		else
+
+		plat::FileHandle file = plat::FileOpen(pcPath, openFlags);
+		if (file == plat::INVALID_FILE_HANDLE)
 		{
-			g_fdSlots[idx].fd = fd;
-			g_fdSlots[idx].type = FD_TYPE_FILE;
+			LOG_WARN("open file failed %s", path);
+			break;
 		}
-	}
 
-	int ret_fd = hasError ? -1 : idx;
-	return ret_fd;
-#endif  //GPCS4_WINDOWS
+		ret = GetFileTable().Insert(new CSceFile(pcPath, file, flags));
+	} while (false);
+	return ret;
 }
 
 
 ssize_t PS4API sceKernelRead(int d, void *buf, size_t nbytes)
 {
 	LOG_SCE_TRACE("d %d buff %p nbytes %x", d, buf, nbytes);
-	int fd = g_fdSlots[d].fd;
-	return _read(fd, buf, nbytes);
+	auto file = GetFileTable().Get(d);
+	return file ? file->Read(buf, nbytes) : SCE_KERNEL_ERROR_EBADF;
 }
 
 
 ssize_t PS4API sceKernelWrite(int d, const void *buf, size_t nbytes)
 {
-	LOG_FIXME("Not implemented");
-	return SCE_OK;
+	LOG_SCE_TRACE("d %d buff %p nbytes %x", d, buf, nbytes);
+	auto file = GetFileTable().Get(d);
+	return file ? file->Write(buf, nbytes) : SCE_KERNEL_ERROR_EBADF;
 }
 
 
 sce_off_t PS4API sceKernelLseek(int fildes, sce_off_t offset, int whence)
 {
 	LOG_SCE_TRACE("fd %d off %d where %d", fildes, offset, whence);
-	int fd = g_fdSlots[fildes].fd;
-	return _lseeki64(fd, offset, whence);
+	auto file = GetFileTable().Get(fildes);
+	return file ? file->Seek(offset, whence) : SCE_KERNEL_ERROR_EBADF;
 }
 
 
 int PS4API sceKernelClose(int d)
 {
 	LOG_SCE_TRACE("fd %d", d);
-
-#ifdef GPCS4_WINDOWS
-	int ret = -1;
-	FdItem& item = g_fdSlots[d];
-	if (item.type == FD_TYPE_DIRECTORY)
-	{
-		DIR* dir = (DIR*)item.fd;
-		closedir(dir);
-	}
-	else
-	{
-		int fd = item.fd;
-		_close(fd);
-	}
-
-	g_fdSlots[d] = {0, FD_TYPE_UNKNOWN};
-	return ret;
-#endif  //GPCS4_WINDOWS
+	return GetFileTable().Remove(d) ? SCE_OK : SCE_KERNEL_ERROR_EBADF;
 }
 
 
@@ -230,49 +240,43 @@ inline sce_mode_t getSceFileMode(uint16_t oldMode)
 int PS4API scek_fstat(int fd, SceKernelStat *sb)
 {
 	LOG_SCE_TRACE("fd %d sb %p", fd, sb);
-
-	struct stat stat;
-	int ret = fstat(fd, &stat);
-	sb->st_mode = getSceFileMode(stat.st_mode);
-	sb->st_size = stat.st_size;
-	if (stat.st_mode & _S_IFMT & _S_IFDIR)
-	{
-		// TODO
-		sb->st_blocks = 0; // UtilPath::FileCountInDirectory(pcPath);
-		sb->st_blksize = sizeof(SceKernelDirent);
-	}
-	else
-	{
-		sb->st_blocks = stat.st_size / SSD_BLOCK_SIZE + (stat.st_size % SSD_BLOCK_SIZE) ? 1 : 0;
-		sb->st_blksize = SSD_BLOCK_SIZE;
-	}
-	return ret;
+	return sceKernelFstat(fd, sb);
 }
 
 
 int PS4API sceKernelStat(const char *path, SceKernelStat *sb)
 {
 	LOG_SCE_TRACE("path %s sb %p", path, sb);
-	std::string pcPath = plat::PS4PathToPCPath(path);
-
-	struct _stat stat;
-	int ret = _stat(pcPath.c_str(), &stat);
-	sb->st_mode = getSceFileMode(stat.st_mode);
-	//sb->st_atim = stat.st_atime;
-	//sb->st_mtim = stat.st_mtime;
-	//sb->st_ctim = stat.st_ctime;
-	sb->st_size = stat.st_size;
-	//sb->st_birthtim = stat.st_ctime; //?
-	if (stat.st_mode & _S_IFMT & _S_IFDIR)
-	{
-		sb->st_blocks = plat::FileCountInDirectory(pcPath);
-		sb->st_blksize = sizeof(SceKernelDirent);
-	}
-	else
+
+	int ret = SCE_KERNEL_ERROR_ENOENT;
+	do
 	{
-		sb->st_blocks = stat.st_size / SSD_BLOCK_SIZE + (stat.st_size % SSD_BLOCK_SIZE) ? 1 : 0;
-		sb->st_blksize = SSD_BLOCK_SIZE;
-	}
+		VfsFileInfo info;
+		if (!VFS().Stat(path, &info))
+		{
+			break;
+		}
+
+		sb->st_mode = info.bReadOnly ? SCE_KERNEL_S_IRU : SCE_KERNEL_S_IRWU;
+		sb->st_mode |= info.bDirectory ? SCE_KERNEL_S_IFDIR : SCE_KERNEL_S_IFREG;
+		//sb->st_atim = stat.st_atime;
+		//sb->st_mtim = stat.st_mtime;
+		//sb->st_ctim = stat.st_ctime;
+		sb->st_size = info.nSize;
+		//sb->st_birthtim = stat.st_ctime; //?
+		if (info.bDirectory)
+		{
+			sb->st_blocks = plat::FileCountInDirectory(VFS().Resolve(path));
+			sb->st_blksize = sizeof(SceKernelDirent);
+		}
+		else
+		{
+			sb->st_blocks = info.nSize / SSD_BLOCK_SIZE + ((info.nSize % SSD_BLOCK_SIZE) ? 1 : 0);
+			sb->st_blksize = SSD_BLOCK_SIZE;
+		}
+
+		ret = SCE_OK;
+	} while (false);
 	return ret;
 }
 
@@ -281,43 +285,53 @@ int PS4API sceKernelFstat(int fd, SceKernelStat *sb)
 {
 	LOG_SCE_TRACE("fd %d sb %p", fd, sb);
 
-#ifdef GPCS4_WINDOWS
-	int ret = -1;
-	FdItem& item = g_fdSlots[fd];
-	if (item.type == FD_TYPE_DIRECTORY)
+	int ret = SCE_KERNEL_ERROR_EBADF;
+	do
 	{
-		char dir_path[SCE_MAX_PATH] = { 0 };
-		getDirName((DIR*)item.fd, dir_path, SCE_MAX_PATH);
-		struct _stat stat;
-		ret = _stat(dir_path, &stat);
-		sb->st_mode = getSceFileMode(stat.st_mode);
+		auto file = GetFileTable().Get(fd);
+		if (!file)
+		{
+			break;
+		}
+
+		if (file->IsDirectory())
+		{
+			struct _stat stat;
+			ret = _stat(file->Path().c_str(), &stat);
+			sb->st_mode = getSceFileMode(stat.st_mode);
 		
-		//sb->st_atim = stat.st_atime;
-		//sb->st_mtim = stat.st_mtime;
-		//sb->st_ctim = stat.st_ctime;
-		sb->st_size = stat.st_size;
-		//sb->st_birthtim = stat.st_ctime; //?
-		sb->st_blocks = plat::FileCountInDirectory(dir_path);
-		sb->st_blksize = sizeof(SceKernelDirent);
-	}
-	else
-	{
-		int pcFd = item.fd;
+			//sb->st_atim = stat.st_atime;
+			//sb->st_mtim = stat.st_mtime;
+			//sb->st_ctim = stat.st_ctime;
+			sb->st_size = file->DirentsSize();
+			//sb->st_birthtim = stat.st_ctime; //?
+			sb->st_blocks = plat::FileCountInDirectory(file->Path());
+			sb->st_blksize = sizeof(SceKernelDirent);
+			break;
+		}
+
+		int64_t size = plat::FileGetSize(file->Handle());
+		if (size < 0)
+		{
+			ret = SCE_KERNEL_ERROR_EIO;
+			break;
+		}
+
 		struct _stat stat;
-		ret = _fstat(pcFd, &stat);
+		_stat(file->Path().c_str(), &stat);
 		sb->st_mode = getSceFileMode(stat.st_mode);
 
 		//sb->st_atim = stat.st_atime;
 		//sb->st_mtim = stat.st_mtime;
 		//sb->st_ctim = stat.st_ctime;
-		sb->st_size = stat.st_size;
+		sb->st_size = size;
 		//sb->st_birthtim = stat.st_ctime; //?
-		sb->st_blocks = stat.st_size / SSD_BLOCK_SIZE + (stat.st_size % SSD_BLOCK_SIZE) ? 1 : 0;
+		sb->st_blocks = size / SSD_BLOCK_SIZE + ((size % SSD_BLOCK_SIZE) ? 1 : 0);
 		sb->st_blksize = SSD_BLOCK_SIZE;
-	}
 
+		ret = SCE_OK;
+	} while (false);
 	return ret;
-#endif  //GPCS4_WINDOWS
 }
 
 
@@ -334,69 +348,28 @@ int PS4API sceKernelFtruncate(void)
 	return SCE_OK;
 }
 
-inline uint8_t getSceFileType(dirent* ent)
-{
-	uint8_t type = SCE_KERNEL_DT_UNKNOWN;
-	if ( (ent->d_namlen == 1 && !strncmp(ent->d_name, ".", 1)) ||
-		 (ent->d_namlen == 2 && !strncmp(ent->d_name, ".", 2)) )
-	{
-		type = SCE_KERNEL_DT_DIR;
-	}
-	else
-	{
-		switch (ent->d_type)
-		{
-		case DT_DIR:
-			type = SCE_KERNEL_DT_DIR;
-			break;
-		case DT_REG:
-			type = SCE_KERNEL_DT_REG;
-			break;
-		default:
-			LOG_ERR("found unknown file type. file %s type %x", ent->d_name, ent->d_type);
-			break;
-		}
-	}
-
-	return type;
-}
-
 int PS4API sceKernelGetdents(int fd, char *buf, int nbytes)
 {
 	LOG_SCE_TRACE("fd %d buff %p nbytes %x", fd, buf, nbytes);
-#ifdef GPCS4_WINDOWS
 	int ret = SCE_KERNEL_ERROR_EBADF;
 	do 
 	{
-		FdItem& item = g_fdSlots[fd];
-		if (item.type != FD_TYPE_DIRECTORY)
+		auto file = GetFileTable().Get(fd);
+		if (!file)
 		{
-			ret = SCE_KERNEL_ERROR_EINVAL;
 			break;
 		}
 
-		DIR* dir = (DIR*)item.fd;
-		dirent *ent;
-		ent = readdir(dir);
-		if (!ent)
+		if (nbytes < 0)
 		{
-			ret = 0;  //ends
+			ret = SCE_KERNEL_ERROR_EINVAL;
 			break;
 		}
 
-		SceKernelDirent* sce_ent = (SceKernelDirent*)buf;
-		sce_ent->d_fileno = ent->d_ino;
-		sce_ent->d_reclen = sizeof(SceKernelDirent);
-		sce_ent->d_type = getSceFileType(ent);
-		sce_ent->d_namlen = ent->d_namlen;
-		strcpy_s(sce_ent->d_name, SCE_MAX_PATH, ent->d_name);
-		
-		ret = sizeof(SceKernelDirent);
+		ret = file->ReadDirents(buf, nbytes);
 	} while (false);
 
 	return ret;
-
-#endif  //GPCS4_WINDOWS
 }
 
 
@@ -456,13 +429,10 @@ int PS4API scek_shm_unlink(const char *name)
 }
 
 
-ssize_t PS4API sceKernelPread(int d, void* buf, size_t nbytes, off_t offset) 
+ssize_t PS4API sceKernelPread(int d, void* buf, size_t nbytes, sce_off_t offset) 
 {
-	LOG_SCE_TRACE("fd %d, buf %p, nbytes %lu, offset %d", d, buf, nbytes, offset);
+	LOG_SCE_TRACE("fd %d, buf %p, nbytes %lu, offset %lld", d, buf, nbytes, offset);
 	// The read/write position pointer for the file will not move
-	auto off = _lseek(d, 0, SEEK_CUR);
-	_lseek(d, offset, SEEK_SET);
-	auto ret = _read(d, buf, nbytes);
-	_lseek(d, off, SEEK_SET);
-	return ret;
+	auto file = GetFileTable().Get(d);
+	return file ? file->Pread(buf, nbytes, offset) : SCE_KERNEL_ERROR_EBADF;
 }
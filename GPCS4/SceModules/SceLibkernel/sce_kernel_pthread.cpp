@@ -3,45 +3,64 @@
 //#include "pthreads4w/pthread.h"
 #include "MapSlot.h"
 
-LOG_CHANNEL(SceModules.SceLibkernel.plat);
+#include <ctime>
 
-int sceMutexAttrTypeToPthreadType(int type);
+LOG_CHANNEL(SceModules.SceLibkernel.plat);
 
-int PS4API scek_pthread_cond_init(pthread_cond_t *cond, const pthread_condattr_t *attr)
+int PS4API scek_pthread_cond_init(ScePthreadCond *cond, const ScePthreadCondattr *attr)
 {
 	LOG_SCE_TRACE("cond %p attr %p", cond, attr);
-	auto rc = pthread_cond_init(cond, attr);
-	return rc;
+	if (!cond)
+	{
+		return EINVAL;
+	}
+	*cond = new CSceCond(nullptr);
+	return 0;
 }
 
-int PS4API scek_pthread_cond_destroy(pthread_cond_t *cond)
+int PS4API scek_pthread_cond_destroy(ScePthreadCond *cond)
 {
 	LOG_SCE_TRACE("cond %p", cond);
-	auto rc = pthread_cond_destroy(cond);
-	return rc;
+	return destroySceCond(cond);
 }
 
 
-int PS4API scek_pthread_cond_signal(pthread_cond_t *cond)
+int PS4API scek_pthread_cond_signal(ScePthreadCond *cond)
 {
 	LOG_SCE_TRACE("cond %p", cond);
-	auto rc = pthread_cond_signal(cond);
-	return rc;
+	return getSceCond(cond)->Signal();
 }
 
 
-int PS4API scek_pthread_cond_timedwait(void)
+int PS4API scek_pthread_cond_timedwait(ScePthreadCond *cond, ScePthreadMutex *mutex, const struct sce_timespec *abstime)
 {
-	LOG_FIXME("Not implemented");
-	return SCE_OK;
+	LOG_SCE_TRACE("cond %p mutex %p abstime %p", cond, mutex, abstime);
+	int rc = 0;
+	do 
+	{
+		if (!abstime || abstime->tv_nsec < 0 || abstime->tv_nsec >= 1000000000)
+		{
+			rc = EINVAL;
+			break;
+		}
+
+		// abstime is measured against CLOCK_REALTIME,
+		// same as scek_clock_gettime
+		struct timespec now;
+		timespec_get(&now, TIME_UTC);
+		int64_t remainNs = (abstime->tv_sec - now.tv_sec) * 1000000000ll + (abstime->tv_nsec - now.tv_nsec);
+		uint64_t timeoutUs = remainNs > 0 ? remainNs / 1000 : 0;
+
+		rc = getSceCond(cond)->Wait(getSceMutex(mutex), &timeoutUs);
+	} while (false);
+	return rc;
 }
 
 
-int PS4API scek_pthread_cond_wait(pthread_cond_t * cond, pthread_mutex_t * mutex)
+int PS4API scek_pthread_cond_wait(ScePthreadCond *cond, ScePthreadMutex *mutex)
 {
 	LOG_SCE_TRACE("cond %p mutex %p", cond, mutex);
-	auto rc = pthread_cond_wait(cond, mutex);
-	return rc;
+	return getSceCond(cond)->Wait(getSceMutex(mutex), nullptr);
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -88,65 +107,77 @@ int PS4API scek_pthread_join(void)
 }
 
 //////////////////////////////////////////////////////////////////////////
-int PS4API scek_pthread_mutex_init(pthread_mutex_t *mutex, const pthread_mutexattr_t *attr)
+int PS4API scek_pthread_mutex_init(ScePthreadMutex *mutex, const ScePthreadMutexattr *attr)
 {
 	LOG_SCE_TRACE("mutex %p attr %p", mutex, attr);
-	return scePthreadMutexInit(mutex, attr, nullptr);
+	if (!mutex)
+	{
+		return EINVAL;
+	}
+	SceMutexAttr mutexAttr = (attr && *attr) ?
+		**attr : defaultSceMutexAttr(SCE_PTHREAD_MUTEX_ERRORCHECK);
+	*mutex = new CSceMutex(mutexAttr, nullptr);
+	return 0;
 }
 
 
-int PS4API scek_pthread_mutex_destroy(pthread_mutex_t *mutex)
+int PS4API scek_pthread_mutex_destroy(ScePthreadMutex *mutex)
 {
 	LOG_SCE_TRACE("mutex %p", mutex);
-	auto ret = pthread_mutex_destroy(mutex);
-	return ret;
+	return destroySceMutex(mutex);
 }
 
 
-int PS4API scek_pthread_mutex_lock(pthread_mutex_t* mtx)
+int PS4API scek_pthread_mutex_lock(ScePthreadMutex* mtx)
 {
 	LOG_SCE_TRACE("mtx %p", mtx);
-	int err = pthread_mutex_lock(mtx);
-	return err;
+	return getSceMutex(mtx)->Lock();
 }
 
 
-int PS4API scek_pthread_mutex_trylock(pthread_mutex_t *mtx) 
+int PS4API scek_pthread_mutex_trylock(ScePthreadMutex *mtx) 
 {
 	LOG_SCE_TRACE("mtx %p", mtx);
-	int err = pthread_mutex_trylock(mtx);
-	return err;
+	return getSceMutex(mtx)->TryLock();
 }
 
 
-int PS4API scek_pthread_mutex_unlock(pthread_mutex_t* mtx)
+int PS4API scek_pthread_mutex_unlock(ScePthreadMutex* mtx)
 {
 	LOG_SCE_TRACE("mtx %p", mtx);
-	int err = pthread_mutex_unlock(mtx);
-	return err;
+	return getSceMutex(mtx)->Unlock();
 }
 
 
-int PS4API scek_pthread_mutexattr_destroy(void)
+int PS4API scek_pthread_mutexattr_destroy(ScePthreadMutexattr *attr)
 {
-	LOG_FIXME("Not implemented");
-	return SCE_OK;
+	LOG_SCE_TRACE("attr %p", attr);
+	return destroySceMutexAttr(attr);
 }
 
 
-int PS4API scek_pthread_mutexattr_init(pthread_mutexattr_t * attr)
+int PS4API scek_pthread_mutexattr_init(ScePthreadMutexattr *attr)
 {
 	LOG_SCE_TRACE("attr %p", attr);
-	int err = pthread_mutexattr_init(attr);
-	return err;
+	if (!attr)
+	{
+		return EINVAL;
+	}
+	*attr = new SceMutexAttr(defaultSceMutexAttr(SCE_PTHREAD_MUTEX_ERRORCHECK));
+	return 0;
 }
 
-int PS4API scek_pthread_mutexattr_settype(pthread_mutexattr_t* attr, int type)
+// posix mutex types have the same values as sce ones on PS4
+int PS4API scek_pthread_mutexattr_settype(ScePthreadMutexattr* attr, int type)
 {
 	LOG_SCE_TRACE("attr %p type %d", attr, type);
-	int ptype = sceMutexAttrTypeToPthreadType(type);
-	int err = pthread_mutexattr_settype((pthread_mutexattr_t*)attr, ptype);
-	return err;
+	if (!attr || !*attr ||
+		type < SCE_PTHREAD_MUTEX_ERRORCHECK || type >= SCE_PTHREAD_MUTEX_TYPE_MAX)
+	{
+		return EINVAL;
+	}
+	(*attr)->type = type;
+	return 0;
 }
 
 // For PS4 system, ScePthread and pthread_t are same.
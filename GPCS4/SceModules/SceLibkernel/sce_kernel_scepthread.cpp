@@ -144,29 +144,20 @@ int pthreadErrorToSceError(int perror)
 int PS4API scePthreadMutexInit(ScePthreadMutex *mutex, const ScePthreadMutexattr *attr, const char *name)
 {
 	LOG_SCE_TRACE("mutex %p attr %p name %s", mutex, attr, name);
-	// TODO:
-	// pthread mutex do not have names
-	// if this is necessary, we could add a name field
-	// in pthread_mutex_t of pthread4w
-	if (name)
-	{
-		LOG_FIXME("set name is not supported yet.")
-	}
 	int err = 0;
-	if (attr == nullptr)
+	do 
 	{
+		if (!mutex)
+		{
+			err = EINVAL;
+			break;
+		}
+
 		// If attr is nullptr then default will be used which is PTHREAD_MUTEX_ERRORCHECK on PS4
-		// so we make sure we set PTHREAD_MUTEX_ERRORCHECK here to match behaviour.
-		pthread_mutexattr_t errorCheckMutexAttr;
-		pthread_mutexattr_init(&errorCheckMutexAttr);
-		pthread_mutexattr_settype(&errorCheckMutexAttr, PTHREAD_MUTEX_ERRORCHECK);
-		err = pthread_mutex_init((pthread_mutex_t*)mutex, &errorCheckMutexAttr);
-		pthread_mutexattr_destroy(&errorCheckMutexAttr);
-	}
-	else
-	{
-		err = pthread_mutex_init((pthread_mutex_t*)mutex, (pthread_mutexattr_t*)attr);
-	}
+		SceMutexAttr mutexAttr = (attr && *attr) ? 
+			**attr : defaultSceMutexAttr(SCE_PTHREAD_MUTEX_ERRORCHECK);
+		*mutex = new CSceMutex(mutexAttr, name);
+	} while (false);
 	return pthreadErrorToSceError(err);
 }
 
@@ -174,7 +165,7 @@ int PS4API scePthreadMutexInit(ScePthreadMutex *mutex, const ScePthreadMutexattr
 int PS4API scePthreadMutexDestroy(ScePthreadMutex *mutex)
 {
 	LOG_SCE_TRACE("mutex %p", mutex);
-	int err = pthread_mutex_destroy((pthread_mutex_t*)mutex);
+	int err = destroySceMutex(mutex);
 	return pthreadErrorToSceError(err);
 }
 
@@ -183,7 +174,7 @@ int PS4API scePthreadMutexLock(ScePthreadMutex *mutex)
 {
 	// Prevent log spamming
 	// LOG_SCE_TRACE("mutex %p", mutex);
-	int err = pthread_mutex_lock((pthread_mutex_t*)mutex);
+	int err = getSceMutex(mutex)->Lock();
 	return pthreadErrorToSceError(err);
 }
 
@@ -192,7 +183,7 @@ int PS4API scePthreadMutexUnlock(ScePthreadMutex *mutex)
 {
 	// Prevent log spamming
 	// LOG_SCE_TRACE("mutex %p", mutex);
-	int err = pthread_mutex_unlock((pthread_mutex_t*)mutex);
+	int err = getSceMutex(mutex)->Unlock();
 	return pthreadErrorToSceError(err);
 }
 
@@ -200,7 +191,17 @@ int PS4API scePthreadMutexUnlock(ScePthreadMutex *mutex)
 int PS4API scePthreadMutexattrInit(ScePthreadMutexattr *attr)
 {
 	LOG_SCE_TRACE("attr %p", attr);
-	int err = pthread_mutexattr_init((pthread_mutexattr_t*)attr);
+	int err = 0;
+	do 
+	{
+		if (!attr)
+		{
+			err = EINVAL;
+			break;
+		}
+
+		*attr = new SceMutexAttr(defaultSceMutexAttr(SCE_PTHREAD_MUTEX_ERRORCHECK));
+	} while (false);
 	return pthreadErrorToSceError(err);
 }
 
@@ -208,7 +209,7 @@ int PS4API scePthreadMutexattrInit(ScePthreadMutexattr *attr)
 int PS4API scePthreadMutexattrDestroy(ScePthreadMutexattr *attr)
 {
 	LOG_SCE_TRACE("attr %p", attr);
-	int err = pthread_mutexattr_destroy((pthread_mutexattr_t*)attr);
+	int err = destroySceMutexAttr(attr);
 	return pthreadErrorToSceError(err);
 }
 
@@ -216,65 +217,64 @@ int PS4API scePthreadMutexattrDestroy(ScePthreadMutexattr *attr)
 int PS4API scePthreadMutexattrSetprotocol(ScePthreadMutexattr *attr, int protocol)
 {
 	LOG_SCE_TRACE("attr %p prot %d", attr, protocol);
-	// TODO:
-	// pthread4w do not support this call
-	// but this seems doesn't matter
-	// winpthread from MinGW64 do not actually implement this either
-	LOG_FIXME("mutex attr set protocal not implenmet.");
-	return SCE_OK;
-}
-
-int sceMutexAttrTypeToPthreadType(int sceType)
-{
-	int pthreadType = -1;
-	switch (sceType)
+	int err = 0;
+	do 
 	{
-	case SCE_PTHREAD_MUTEX_ERRORCHECK:
-		pthreadType = PTHREAD_MUTEX_ERRORCHECK;
-		break;
-	case SCE_PTHREAD_MUTEX_RECURSIVE:
-		pthreadType = PTHREAD_MUTEX_RECURSIVE;
-		break;
-	case SCE_PTHREAD_MUTEX_NORMAL:
-		pthreadType = PTHREAD_MUTEX_NORMAL;
-		break;
-	case SCE_PTHREAD_MUTEX_ADAPTIVE_NP:
-		pthreadType = PTHREAD_MUTEX_ADAPTIVE_NP;
-		break;
-	default:
-		LOG_ERR("not supported mutex attr type %d", sceType);
-		break;
-	}
-	return pthreadType;
+		if (!attr || !*attr ||
+			protocol < SCE_PTHREAD_PRIO_NONE || protocol > SCE_PTHREAD_PRIO_PROTECT)
+		{
+			err = EINVAL;
+			break;
+		}
+
+		// Note:
+		// PRIO_PROTECT only records the ceiling,
+		// guest thread priorities are not applied to host threads yet.
+		(*attr)->protocol = protocol;
+	} while (false);
+	return pthreadErrorToSceError(err);
 }
 
+
 int PS4API scePthreadMutexattrSettype(ScePthreadMutexattr *attr, int type)
 {
 	LOG_SCE_TRACE("attr %p type %d", attr, type);
-	int ptype = sceMutexAttrTypeToPthreadType(type);
-	int err = pthread_mutexattr_settype((pthread_mutexattr_t*)attr, ptype);
+	int err = 0;
+	do 
+	{
+		if (!attr || !*attr ||
+			type < SCE_PTHREAD_MUTEX_ERRORCHECK || type >= SCE_PTHREAD_MUTEX_TYPE_MAX)
+		{
+			err = EINVAL;
+			break;
+		}
+
+		(*attr)->type = type;
+	} while (false);
 	return pthreadErrorToSceError(err);
 }
 
 
-int PS4API scePthreadMutexGetprioceiling(void)
+int PS4API scePthreadMutexGetprioceiling(ScePthreadMutex *mutex, int *prioceiling)
 {
-	LOG_FIXME("Not implemented");
-	return SCE_OK;
+	LOG_SCE_TRACE("mutex %p prioceiling %p", mutex, prioceiling);
+	int err = getSceMutex(mutex)->GetPrioceiling(prioceiling);
+	return pthreadErrorToSceError(err);
 }
 
 
-int PS4API scePthreadMutexTimedlock(void)
+int PS4API scePthreadMutexTimedlock(ScePthreadMutex *mutex, SceKernelUseconds usec)
 {
-	LOG_FIXME("Not implemented");
-	return SCE_OK;
+	LOG_SCE_TRACE("mutex %p usec %d", mutex, usec);
+	int err = getSceMutex(mutex)->TimedLock(usec);
+	return pthreadErrorToSceError(err);
 }
 
 
 int PS4API scePthreadMutexTrylock(ScePthreadMutex *mutex)
 {
 	LOG_SCE_TRACE("mutex %p", mutex);
-	int err = pthread_mutex_trylock((pthread_mutex_t*)mutex);
+	int err = getSceMutex(mutex)->TryLock();
 	return pthreadErrorToSceError(err);
 }
 
@@ -456,11 +456,17 @@ int PS4API scePthreadSetaffinity(ScePthread thread, const SceKernelCpumask mask)
 int PS4API scePthreadCondInit(ScePthreadCond *cond, const ScePthreadCondattr *attr, const char *name)
 {
 	LOG_SCE_TRACE("cond %p attr %p name %s", cond, attr, name);
-	if (name)
+	int err = 0;
+	do 
 	{
-		LOG_FIXME("cond name is not supported yet");
-	}
-	int err = pthread_cond_init(cond, attr);
+		if (!cond)
+		{
+			err = EINVAL;
+			break;
+		}
+
+		*cond = new CSceCond(name);
+	} while (false);
 	return pthreadErrorToSceError(err);
 }
 
@@ -468,7 +474,7 @@ int PS4API scePthreadCondInit(ScePthreadCond *cond, const ScePthreadCondattr *at
 int PS4API scePthreadCondDestroy(ScePthreadCond *cond)
 {
 	LOG_SCE_TRACE("cond %p", cond);
-	int err = pthread_cond_destroy(cond);
+	int err = destroySceCond(cond);
 	return pthreadErrorToSceError(err);
 }
 
@@ -476,14 +482,14 @@ int PS4API scePthreadCondDestroy(ScePthreadCond *cond)
 int PS4API scePthreadCondBroadcast(ScePthreadCond *cond)
 {
 	LOG_SCE_TRACE("cond %p", cond);
-	int err = pthread_cond_broadcast(cond);
+	int err = getSceCond(cond)->Broadcast();
 	return pthreadErrorToSceError(err);
 }
 
 int PS4API scePthreadCondSignal(ScePthreadCond *cond)
 {
 	LOG_SCE_TRACE("cond %p", cond);
-	int err = pthread_cond_signal(cond);
+	int err = getSceCond(cond)->Signal();
 	return pthreadErrorToSceError(err);
 }
 
@@ -491,7 +497,7 @@ int PS4API scePthreadCondSignal(ScePthreadCond *cond)
 int PS4API scePthreadCondWait(ScePthreadCond *cond, ScePthreadMutex *mutex)
 {
 	LOG_SCE_TRACE("cond %p mutex %p", cond, mutex);
-	int err = pthread_cond_wait(cond, mutex);
+	int err = getSceCond(cond)->Wait(getSceMutex(mutex), nullptr);
 	return pthreadErrorToSceError(err);
 }
 
@@ -499,7 +505,7 @@ int PS4API scePthreadCondWait(ScePthreadCond *cond, ScePthreadMutex *mutex)
 int PS4API scePthreadCondattrInit(ScePthreadCondattr *attr)
 {
 	LOG_SCE_TRACE("attr %p", attr);
-	int err = pthread_condattr_init(attr);
+	int err = attr ? pthread_condattr_init(attr) : EINVAL;
 	return pthreadErrorToSceError(err);
 }
 
@@ -507,7 +513,7 @@ int PS4API scePthreadCondattrInit(ScePthreadCondattr *attr)
 int PS4API scePthreadCondattrDestroy(ScePthreadCondattr *attr)
 {
 	LOG_SCE_TRACE("attr %p", attr);
-	int err = pthread_condattr_destroy(attr);
+	int err = attr ? pthread_condattr_destroy(attr) : EINVAL;
 	return pthreadErrorToSceError(err);
 }
 
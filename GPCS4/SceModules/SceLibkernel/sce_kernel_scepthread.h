@@ -3,6 +3,10 @@
 #include "pthreads4w/sched.h"
 #include "pthreads4w/semaphore.h"
 
+class CSceMutex;
+class CSceCond;
+struct SceMutexAttr;
+
 // pthread to sce pthread
 // Note:
 // we need to take care of the size of these structs if it's not a pointer type
@@ -15,10 +19,10 @@ typedef pthread_attr_t            ScePthreadAttr;
 typedef pthread_barrier_t         ScePthreadBarrier;
 typedef pthread_barrierattr_t     ScePthreadBarrierattr;
 typedef pthread_condattr_t        ScePthreadCondattr;
-typedef pthread_cond_t            ScePthreadCond;
+typedef CSceCond*                 ScePthreadCond;
 typedef pthread_key_t             ScePthreadKey;
-typedef pthread_mutex_t           ScePthreadMutex;
-typedef pthread_mutexattr_t       ScePthreadMutexattr;
+typedef CSceMutex*                ScePthreadMutex;
+typedef SceMutexAttr*             ScePthreadMutexattr;
 typedef pthread_rwlock_t          ScePthreadRwlock;
 typedef pthread_rwlockattr_t      ScePthreadRwlockattr;
 
@@ -32,6 +36,11 @@ typedef enum ScePthreadMutextype
 	SCE_PTHREAD_MUTEX_TYPE_MAX
 } ScePthreadMutextype;
 
+// static initializers of guest mutex and cond
+#define SCE_PTHREAD_MUTEX_INITIALIZER           ((ScePthreadMutex)0)
+#define SCE_PTHREAD_ADAPTIVE_MUTEX_INITIALIZER  ((ScePthreadMutex)1)
+#define SCE_PTHREAD_COND_INITIALIZER            ((ScePthreadCond)0)
+
 
 // used for scePthreadMutexattrSetprotocol
 #define SCE_PTHREAD_PRIO_NONE           0
@@ -279,7 +279,7 @@ int PS4API scePthreadMutexattrSetprotocol(ScePthreadMutexattr *attr, int protoco
 int PS4API scePthreadMutexattrSettype(ScePthreadMutexattr *attr, int type);
 
 
-int PS4API scePthreadMutexGetprioceiling(void);
+int PS4API scePthreadMutexGetprioceiling(ScePthreadMutex *mutex, int *prioceiling);
 
 
 int PS4API scePthreadRename(void);
@@ -408,7 +408,7 @@ int PS4API scePthreadAttrGet(ScePthread thread, ScePthreadAttr* attr);
 int PS4API scePthreadAttrGetaffinity(ScePthread thread, SceKernelCpumask* mask);
 
 
-int PS4API scePthreadMutexTimedlock(void);
+int PS4API scePthreadMutexTimedlock(ScePthreadMutex *mutex, SceKernelUseconds usec);
 
 
 int PS4API scePthreadMutexTrylock(ScePthreadMutex *mutex);
@@ -506,20 +506,20 @@ int PS4API scek_nanosleep(void);
 
 
 //int PS4API scek_pthread_cond_destroy(void);
-int PS4API scek_pthread_cond_destroy(pthread_cond_t *cond);
+int PS4API scek_pthread_cond_destroy(ScePthreadCond *cond);
 
-int PS4API scek_pthread_cond_init(pthread_cond_t *cond,
-								  const pthread_condattr_t *attr);
+int PS4API scek_pthread_cond_init(ScePthreadCond *cond,
+								  const ScePthreadCondattr *attr);
 
 //int PS4API scek_pthread_cond_signal(void);
-int PS4API scek_pthread_cond_signal(pthread_cond_t *cond);
+int PS4API scek_pthread_cond_signal(ScePthreadCond *cond);
 
 
-int PS4API scek_pthread_cond_timedwait(void);
+int PS4API scek_pthread_cond_timedwait(ScePthreadCond *cond, ScePthreadMutex *mutex, const struct sce_timespec *abstime);
 
 
 //int PS4API scek_pthread_cond_wait(void);
-int PS4API scek_pthread_cond_wait(pthread_cond_t *cond, pthread_mutex_t *mutex);
+int PS4API scek_pthread_cond_wait(ScePthreadCond *cond, ScePthreadMutex *mutex);
 
 
 int PS4API scek_pthread_create(ScePthread *thread,
@@ -534,29 +534,29 @@ int PS4API scek_pthread_equal(ScePthread thread1, ScePthread thread2);
 int PS4API scek_pthread_join(void);
 
 
-int PS4API scek_pthread_mutex_destroy(pthread_mutex_t *mutex);
+int PS4API scek_pthread_mutex_destroy(ScePthreadMutex *mutex);
 
 
-int PS4API scek_pthread_mutex_init(pthread_mutex_t *mutex,
-								   const pthread_mutexattr_t *attr);
+int PS4API scek_pthread_mutex_init(ScePthreadMutex *mutex,
+								   const ScePthreadMutexattr *attr);
 
 
-int PS4API scek_pthread_mutex_lock(pthread_mutex_t* mtx);
+int PS4API scek_pthread_mutex_lock(ScePthreadMutex* mtx);
 
 
-int PS4API scek_pthread_mutex_trylock(pthread_mutex_t *mtx);
+int PS4API scek_pthread_mutex_trylock(ScePthreadMutex *mtx);
 
 
-int PS4API scek_pthread_mutex_unlock(pthread_mutex_t* mtx);
+int PS4API scek_pthread_mutex_unlock(ScePthreadMutex* mtx);
 
 
-int PS4API scek_pthread_mutexattr_destroy(void);
+int PS4API scek_pthread_mutexattr_destroy(ScePthreadMutexattr *attr);
 
 
-int PS4API scek_pthread_mutexattr_init(pthread_mutexattr_t * attr);
+int PS4API scek_pthread_mutexattr_init(ScePthreadMutexattr *attr);
 
 
-int PS4API scek_pthread_mutexattr_settype(pthread_mutexattr_t* attr, int type);
+int PS4API scek_pthread_mutexattr_settype(ScePthreadMutexattr* attr, int type);
 
 
 ScePthread PS4API scek_pthread_self(void);
@@ -636,7 +636,7 @@ int PS4API scePthreadEqual(ScePthread thread1, ScePthread thread2);
 pthread_t PS4API scePthreadGetthreadid();
 
 
-ssize_t PS4API sceKernelPread(int d, void* buf, size_t nbytes, off_t offset);
+ssize_t PS4API sceKernelPread(int d, void* buf, size_t nbytes, sce_off_t offset);
 
 
 
@@ -50,3 +50,130 @@ void* newThreadWrapper(void* arg)
 	}
 	return ret;
 }
+
+
+SceMutexAttr defaultSceMutexAttr(int type)
+{
+	return SceMutexAttr{ type, SCE_PTHREAD_PRIO_NONE, 0 };
+}
+
+CSceMutex* getSceMutex(ScePthreadMutex* mutex)
+{
+	CSceMutex* native = *mutex;
+	if (likely(reinterpret_cast<uintptr_t>(native) >
+			   reinterpret_cast<uintptr_t>(SCE_PTHREAD_ADAPTIVE_MUTEX_INITIALIZER)))
+	{
+		return native;
+	}
+
+	// PS4 default mutex type is PTHREAD_MUTEX_ERRORCHECK
+	int type = native == SCE_PTHREAD_ADAPTIVE_MUTEX_INITIALIZER ?
+		SCE_PTHREAD_MUTEX_ADAPTIVE_NP : SCE_PTHREAD_MUTEX_ERRORCHECK;
+	CSceMutex* created = new CSceMutex(defaultSceMutexAttr(type), nullptr);
+
+	auto slot = reinterpret_cast<std::atomic<CSceMutex*>*>(mutex);
+	if (!slot->compare_exchange_strong(native, created))
+	{
+		// another thread won the race
+		delete created;
+		return native;
+	}
+	return created;
+}
+
+CSceCond* getSceCond(ScePthreadCond* cond)
+{
+	CSceCond* native = *cond;
+	if (likely(native != SCE_PTHREAD_COND_INITIALIZER))
+	{
+		return native;
+	}
+
+	CSceCond* created = new CSceCond(nullptr);
+
+	auto slot = reinterpret_cast<std::atomic<CSceCond*>*>(cond);
+	if (!slot->compare_exchange_strong(native, created))
+	{
+		delete created;
+		return native;
+	}
+	return created;
+}
+
+int destroySceMutex(ScePthreadMutex* mutex)
+{
+	int err = 0;
+	do 
+	{
+		if (!mutex)
+		{
+			err = EINVAL;
+			break;
+		}
+
+		CSceMutex* native = *mutex;
+		if (reinterpret_cast<uintptr_t>(native) <=
+			reinterpret_cast<uintptr_t>(SCE_PTHREAD_ADAPTIVE_MUTEX_INITIALIZER))
+		{
+			// statically initialized and never used
+			break;
+		}
+
+		if (native->IsLocked())
+		{
+			err = EBUSY;
+			break;
+		}
+
+		delete native;
+		*mutex = nullptr;
+	} while (false);
+	return err;
+}
+
+int destroySceCond(ScePthreadCond* cond)
+{
+	int err = 0;
+	do 
+	{
+		if (!cond)
+		{
+			err = EINVAL;
+			break;
+		}
+
+		CSceCond* native = *cond;
+		if (native == SCE_PTHREAD_COND_INITIALIZER)
+		{
+			// statically initialized and never used
+			break;
+		}
+
+		if (native->HasWaiters())
+		{
+			err = EBUSY;
+			break;
+		}
+
+		delete native;
+		*cond = nullptr;
+	} while (false);
+	return err;
+}
+
+int destroySceMutexAttr(ScePthreadMutexattr* attr)
+{
+	int err = 0;
+	do 
+	{
+		if (!attr || !*attr)
+		{
+			err = EINVAL;
+			break;
+		}
+
+		delete *attr;
+		*attr = nullptr;
+	} while (false);
+	return err;
+}
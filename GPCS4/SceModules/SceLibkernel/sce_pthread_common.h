@@ -2,6 +2,7 @@
 #include "sce_libkernel.h"
 #include "pthreads4w/pthread.h"
 #include "MapSlot.h"
+#include "SceMutex.h"
 
 struct SCE_THREAD_PARAM
 {
@@ -22,3 +23,17 @@ typedef void* (PS4API *PFUNC_PS4_THREAD_ENTRY)(void*);
 extern MapSlot<pthread_t, isEmptyPthread, isEqualPthread> g_threadSlot;
 
 
+
+
+// guest mutex and cond may be statically initialized,
+// these create the native object on first use.
+CSceMutex* getSceMutex(ScePthreadMutex* mutex);
+CSceCond* getSceCond(ScePthreadCond* cond);
+
+SceMutexAttr defaultSceMutexAttr(int type);
+
+// Shared by the sce and posix variants, return posix error codes.
+// A statically initialized object which was never used is left alone.
+int destroySceMutex(ScePthreadMutex* mutex);
+int destroySceCond(ScePthreadCond* cond);
+int destroySceMutexAttr(ScePthreadMutexattr* attr);
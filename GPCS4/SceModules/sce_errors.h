@@ -12,3 +12,4 @@
 #include "SceIme/sce_ime_error.h"
 #include "SceUserService/sce_userservice_error.h"
 #include "SceSystemService/sce_systemservice_error.h"
+#include "SceFios2/sce_fios2_error.h"
@@ -0,0 +1,224 @@
+#pragma once
+
+#include "GPCS4Common.h"
+
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include <unordered_map>
+#include <vector>
+
+namespace util
+{
+
+	/**
+     * \brief Perfect hash map
+     *
+     * Map from keys to values. Hash computes a 64 bit hash
+     * of a key, every slot keeps the full key, so a lookup
+     * only matches its own key. Entries are added first,
+     * then the map is frozen into a hash and displace table,
+     * after which every lookup is a single probe and the
+     * map can be read concurrently.
+     */
+	template <typename K, typename T, typename Hash = std::hash<K>>
+	class PerfectHashMap
+	{
+		// Average number of keys per bucket,
+		// higher values save memory but take longer to build.
+		static constexpr size_t   BucketLoad    = 4;
+		static constexpr uint32_t MaxSeedProbes = 0x10000;
+
+		struct Entry
+		{
+			uint64_t hash;
+			K        key;
+			T        value;
+			bool     used;
+		};
+
+	public:
+		/**
+         * \brief Looks up an entry which is not frozen yet
+         *
+         * Only valid before the map is frozen.
+         * \param [in] key Key
+         * \returns Pointer to the value, or \c nullptr
+         */
+		const T* findPending(const K& key) const
+		{
+			auto iter = m_pending.find(Hash{}(key));
+			return iter != m_pending.end() && iter->second.key == key ?
+				&iter->second.value : nullptr;
+		}
+
+		/**
+         * \brief Adds an entry
+         *
+         * Only valid before the map is frozen. Fails if the key
+         * has been added before, or if another key has the same
+         * hash, the map can't tell those apart.
+         * \param [in] key Key
+         * \param [in] value Value
+         * \returns \c true if the entry was added
+         */
+		bool insert(const K& key, const T& value)
+		{
+			uint64_t hash = Hash{}(key);
+			return m_pending.emplace(hash, Entry{ hash, key, value, true }).second;
+		}
+
+		/**
+         * \brief Builds the perfect hash
+         *
+         * Drops the build data, no more
+         * entries can be added afterwards.
+         */
+		void freeze()
+		{
+			size_t count = m_pending.size();
+			if (count != 0)
+			{
+				size_t slotCount = count + count / 4 + 1;
+				while (!tryBuild(slotCount))
+				{
+					slotCount *= 2;
+				}
+			}
+
+			m_pending.clear();
+			m_count  = count;
+			m_frozen = true;
+		}
+
+		bool isFrozen() const
+		{
+			return m_frozen;
+		}
+
+		/**
+         * \brief Looks up an entry
+         *
+         * \param [in] key Key
+         * \returns Pointer to the value, or \c nullptr
+         */
+		const T* find(const K& key) const
+		{
+			if (m_slots.empty())
+			{
+				return nullptr;
+			}
+
+			uint64_t    hash  = Hash{}(key);
+			auto const& entry = m_slots[slotIndex(hash, m_seeds[bucketIndex(hash)])];
+			return entry.used && entry.hash == hash && entry.key == key ?
+				&entry.value : nullptr;
+		}
+
+		void clear()
+		{
+			m_pending.clear();
+			m_seeds.clear();
+			m_slots.clear();
+			m_count  = 0;
+			m_frozen = false;
+		}
+
+		size_t size() const
+		{
+			return m_frozen ? m_count : m_pending.size();
+		}
+
+	private:
+		static uint64_t mix(uint64_t key, uint64_t seed)
+		{
+			// splitmix64 finalizer
+			uint64_t x = key ^ (seed * 0x9E3779B97F4A7C15ull);
+			x          = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+			x          = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+			return x ^ (x >> 31);
+		}
+
+		size_t bucketIndex(uint64_t hash) const
+		{
+			return mix(hash, 0) % m_seeds.size();
+		}
+
+		size_t slotIndex(uint64_t hash, uint32_t seed) const
+		{
+			return mix(hash, seed) % m_slots.size();
+		}
+
+		// Buckets are placed largest first, each one searching
+		// for a seed which maps all of its keys to free slots.
+		bool tryBuild(size_t slotCount)
+		{
+			size_t bucketCount = std::max<size_t>(1, m_pending.size() / BucketLoad);
+			m_seeds.assign(bucketCount, 0);
+			m_slots.assign(slotCount, Entry{ 0, K{}, T{}, false });
+
+			std::vector<std::vector<const Entry*>> buckets(bucketCount);
+			for (auto const& pair : m_pending)
+			{
+				buckets[bucketIndex(pair.first)].push_back(&pair.second);
+			}
+
+			std::vector<size_t> order(bucketCount);
+			std::iota(order.begin(), order.end(), 0);
+			std::sort(order.begin(), order.end(), [&buckets](size_t a, size_t b)
+					  { return buckets[a].size() > buckets[b].size(); });
+
+			std::vector<size_t> slots;
+			for (auto b : order)
+			{
+				auto const& bucket = buckets[b];
+				if (bucket.empty())
+				{
+					break;
+				}
+
+				uint32_t seed = 1;
+				for (; seed != MaxSeedProbes; ++seed)
+				{
+					slots.clear();
+					for (auto entry : bucket)
+					{
+						size_t slot = slotIndex(entry->hash, seed);
+						if (m_slots[slot].used ||
+							std::find(slots.begin(), slots.end(), slot) != slots.end())
+						{
+							break;
+						}
+						slots.push_back(slot);
+					}
+
+					if (slots.size() == bucket.size())
+					{
+						break;
+					}
+				}
+
+				if (seed == MaxSeedProbes)
+				{
+					return false;
+				}
+
+				for (size_t i = 0; i != bucket.size(); ++i)
+				{
+					m_slots[slots[i]] = *bucket[i];
+				}
+				m_seeds[b] = seed;
+			}
+
+			return true;
+		}
+
+	private:
+		std::unordered_map<uint64_t, Entry> m_pending;
+		std::vector<uint32_t>           m_seeds;
+		std::vector<Entry>              m_slots;
+		size_t                          m_count  = 0;
+		bool                            m_frozen = false;
+	};
+
+}  // namespace util
@@ -0,0 +1,152 @@
+#pragma once
+
+#include "GPCS4Common.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace util
+{
+
+	/**
+     * \brief Thread pool
+     *
+     * Fixed set of worker threads consuming a FIFO
+     * of tasks. Submitted tasks return a future,
+     * destroying the pool waits for queued tasks
+     * to finish.
+     */
+	class ThreadPool
+	{
+
+	public:
+		/**
+         * \brief Creates thread pool
+         * \param [in] threadCount Worker count, 0 uses
+         *        the number of hardware threads
+         */
+		explicit ThreadPool(uint32_t threadCount = 0)
+		{
+			if (threadCount == 0)
+			{
+				threadCount = std::max(1u, std::thread::hardware_concurrency());
+			}
+
+			m_workers.reserve(threadCount);
+			for (uint32_t i = 0; i != threadCount; ++i)
+			{
+				m_workers.emplace_back([this] { run(); });
+			}
+		}
+
+		~ThreadPool()
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_stopped = true;
+			}
+			m_cond.notify_all();
+
+			for (auto& worker : m_workers)
+			{
+				worker.join();
+			}
+		}
+
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+
+		/**
+         * \brief Number of worker threads
+         */
+		uint32_t size() const
+		{
+			return static_cast<uint32_t>(m_workers.size());
+		}
+
+		/**
+         * \brief Queues a task
+         *
+         * \param [in] fn Task to execute on a worker
+         * \returns Future holding the result of \c fn
+         */
+		template <typename Fn>
+		auto submit(Fn&& fn) -> std::future<std::invoke_result_t<std::decay_t<Fn>>>
+		{
+			using Result = std::invoke_result_t<std::decay_t<Fn>>;
+
+			// std::function requires a copyable callable
+			auto task   = std::make_shared<std::packaged_task<Result()>>(std::forward<Fn>(fn));
+			auto future = task->get_future();
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_tasks.emplace([task] { (*task)(); });
+			}
+			m_cond.notify_one();
+			return future;
+		}
+
+		/**
+         * \brief Runs a function over a range in parallel
+         *
+         * Blocks until \c fn has been called for
+         * every index in <tt>[0, count)</tt>.
+         * \param [in] count Number of items
+         * \param [in] fn Function taking the item index
+         */
+		template <typename Fn>
+		void parallelFor(size_t count, const Fn& fn)
+		{
+			std::vector<std::future<void>> futures;
+			futures.reserve(count);
+			for (size_t i = 0; i != count; ++i)
+			{
+				futures.push_back(submit([&fn, i] { fn(i); }));
+			}
+
+			for (auto& future : futures)
+			{
+				future.get();
+			}
+		}
+
+	private:
+		void run()
+		{
+			while (true)
+			{
+				std::function<void()> task;
+				{
+					std::unique_lock<std::mutex> lock(m_mutex);
+					m_cond.wait(lock, [this]
+								{ return m_stopped || !m_tasks.empty(); });
+
+					if (m_tasks.empty())
+					{
+						break;
+					}
+
+					task = std::move(m_tasks.front());
+					m_tasks.pop();
+				}
+				task();
+			}
+		}
+
+	private:
+		std::mutex                        m_mutex;
+		std::condition_variable           m_cond;
+		std::queue<std::function<void()>> m_tasks;
+		std::vector<std::thread>          m_workers;
+		bool                              m_stopped = false;
+	};
+
+}  // namespace util
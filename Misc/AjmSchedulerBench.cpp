@@ -0,0 +1,97 @@
+// Throughput benchmark of the Ajm batch scheduler.
+// Runs PCM passthrough jobs, so the numbers are the scheduler's
+// own overhead plus a memcpy per job.
+// Build together with SceModules/SceAjm/SceAjmScheduler.cpp and SceModules/SceAjm/SceAjmCodec.cpp.
+
+#include "SceModules/SceAjm/SceAjmScheduler.h"
+#include "SceModules/sce_errors.h"
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+constexpr uint32_t BatchCount   = 4000;
+constexpr uint32_t JobsPerBatch = 8;
+constexpr size_t   FrameSize    = 4096;
+
+struct Stream
+{
+	SceAjmInstanceId     instance;
+	std::vector<uint8_t> input;
+	std::vector<uint8_t> output;
+	std::vector<uint8_t> sideband;
+	std::vector<uint8_t> batch;
+};
+
+// Returns jobs per second, every stream gets a batch in flight.
+double runBatches(CSceAjmScheduler& scheduler, SceAjmContextId context, std::vector<Stream>& streams)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+
+	std::vector<SceAjmBatchId> batches(streams.size());
+	uint32_t                   started = 0;
+	while (started < BatchCount)
+	{
+		for (size_t s = 0; s != streams.size(); ++s)
+		{
+			auto&    stream   = streams[s];
+			uint8_t* position = stream.batch.data();
+			for (uint32_t j = 0; j != JobsPerBatch; ++j)
+			{
+				SceAjmBuffer input    = { stream.input.data() + j * FrameSize, FrameSize };
+				SceAjmBuffer output   = { stream.output.data() + j * FrameSize, FrameSize };
+				SceAjmBuffer sideband = { stream.sideband.data() + j * 64, 64 };
+				position              = CSceAjmScheduler::EncodeJob(position, CSceAjmScheduler::JOB_RUN, stream.instance,
+																	SCE_AJM_FLAG_SIDEBAND_STREAM,
+																	&input, 1, &output, 1, sideband, nullptr);
+			}
+
+			SceAjmBatchError error = {};
+			scheduler.StartBatch(context, stream.batch.data(), uint32_t(position - stream.batch.data()),
+								 SCE_AJM_PRIORITY_MIN, &error, &batches[s]);
+		}
+
+		for (size_t s = 0; s != streams.size(); ++s)
+		{
+			SceAjmBatchError error = {};
+			if (scheduler.WaitBatch(context, batches[s], SCE_AJM_WAIT_INFINITE, &error) != SCE_OK)
+			{
+				printf("batch failed!\n");
+			}
+		}
+		started += uint32_t(streams.size());
+	}
+
+	auto end = std::chrono::high_resolution_clock::now();
+	auto ns  = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+	return double(started) * JobsPerBatch * 1e9 / double(ns);
+}
+
+int main()
+{
+	CSceAjmScheduler scheduler;
+
+	printf("streams\tjobs/s\t\tbatches/s\n");
+	for (uint32_t streamCount = 1; streamCount <= 16; streamCount *= 2)
+	{
+		SceAjmContextId context = 0;
+		scheduler.CreateContext(&context);
+		scheduler.RegisterCodec(context, SCE_AJM_CODEC_PCM_PASSTHROUGH);
+
+		std::vector<Stream> streams(streamCount);
+		for (auto& stream : streams)
+		{
+			scheduler.CreateInstance(context, SCE_AJM_CODEC_PCM_PASSTHROUGH, 0, &stream.instance);
+			stream.input.assign(JobsPerBatch * FrameSize, 0x5A);
+			stream.output.resize(JobsPerBatch * FrameSize);
+			stream.sideband.resize(JobsPerBatch * 64);
+			stream.batch.resize(JobsPerBatch * SCE_AJM_JOB_RUN_SIZE);
+		}
+
+		double jobsPerSecond = runBatches(scheduler, context, streams);
+		printf("%u\t%.0f\t%.0f\n", streamCount, jobsPerSecond, jobsPerSecond / JobsPerBatch);
+
+		scheduler.DestroyContext(context);
+	}
+	return 0;
+}
@@ -0,0 +1,177 @@
+// Import resolution benchmark, SymbolManager + PolicyManager lookups
+// against the frozen BuiltinSymbolTable.
+// Build together with Emulator/BuiltinSymbolTable.cpp, Emulator/SymbolManager.cpp,
+// Emulator/PolicyManager.cpp, Emulator/ModuleManger.cpp and their dependencies.
+//
+// usage: BuiltinSymbolBench [imports.txt]
+// The import list uses the "module library nid" format written
+// by NativeModule::outputUnresolvedSymbols, without it a large eboot is simulated.
+
+#include "Emulator/BuiltinSymbolTable.h"
+#include "Emulator/ModuleManger.h"
+#include "Emulator/PolicyManager.h"
+#include "Emulator/SymbolManager.h"
+#include "SceModules/sce_module_common.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+constexpr uint32_t ModuleCount          = 40;
+constexpr uint32_t SimulatedImportCount = 20000;
+constexpr uint32_t Rounds               = 20;
+
+struct Import
+{
+	std::string modName;
+	std::string libName;
+	uint64_t    nid;
+};
+
+// Storage of the generated export tables, must outlive the symbol table build.
+struct ExportStorage
+{
+	std::deque<std::string>                      names;
+	std::deque<std::vector<SCE_EXPORT_FUNCTION>> functions;
+	std::deque<std::vector<SCE_EXPORT_LIBRARY>>  libraries;
+	std::deque<SCE_EXPORT_MODULE>                modules;
+};
+
+static std::vector<Import> loadImports(const char* path)
+{
+	std::vector<Import> imports;
+	std::ifstream       fin(path);
+	Import              import;
+	while (fin >> import.modName >> import.libName >> std::hex >> import.nid)
+	{
+		imports.push_back(import);
+	}
+	return imports;
+}
+
+static std::vector<Import> simulateImports()
+{
+	std::mt19937_64     rng(0x6770637334ull);
+	std::vector<Import> imports;
+	for (uint32_t i = 0; i != SimulatedImportCount; ++i)
+	{
+		auto name = "libSceBench" + std::to_string(rng() % ModuleCount);
+		imports.push_back({ name, name, rng() });
+	}
+	return imports;
+}
+
+// Every tenth import is left without a builtin implementation.
+static void generateExports(ExportStorage& storage, std::vector<Import> const& imports)
+{
+	std::map<std::pair<std::string, std::string>, std::vector<uint64_t>> libraries;
+	for (size_t i = 0; i != imports.size(); ++i)
+	{
+		if (i % 10 != 0)
+		{
+			libraries[{ imports[i].modName, imports[i].libName }].push_back(imports[i].nid);
+		}
+	}
+
+	for (auto const& library : libraries)
+	{
+		storage.names.push_back(library.first.first);
+		const char* modName = storage.names.back().c_str();
+		storage.names.push_back(library.first.second);
+		const char* libName = storage.names.back().c_str();
+
+		auto& functions = storage.functions.emplace_back();
+		for (auto nid : library.second)
+		{
+			storage.names.push_back("func" + std::to_string(nid));
+			functions.push_back({ nid, storage.names.back().c_str(), reinterpret_cast<void*>(nid | 1) });
+		}
+		functions.push_back(SCE_FUNCTION_ENTRY_END);
+
+		// one library per module is enough here
+		auto& exportLibraries = storage.libraries.emplace_back();
+		exportLibraries.push_back({ libName, functions.data() });
+		exportLibraries.push_back(SCE_LIBRARY_ENTRY_END);
+
+		storage.modules.push_back({ modName, exportLibraries.data() });
+	}
+}
+
+template <typename Fn>
+double measure(std::vector<Import> const& imports, Fn resolve)
+{
+	uint64_t checksum = 0;
+
+	auto start = std::chrono::high_resolution_clock::now();
+	for (uint32_t r = 0; r != Rounds; ++r)
+	{
+		for (auto const& import : imports)
+		{
+			checksum += reinterpret_cast<uintptr_t>(resolve(import));
+		}
+	}
+	auto end = std::chrono::high_resolution_clock::now();
+
+	printf("  checksum %llx\n", static_cast<unsigned long long>(checksum));
+	auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+	return double(ns) / (double(Rounds) * imports.size());
+}
+
+int main(int argc, char* argv[])
+{
+	auto imports = argc > 1 ? loadImports(argv[1]) : simulateImports();
+
+	ExportStorage storage;
+	generateExports(storage, imports);
+
+	ModuleManager      moduleManager;
+	SymbolManager      symbolManager;
+	PolicyManager      policyManager(moduleManager);
+	BuiltinSymbolTable builtinTable;
+
+	for (auto const& module : storage.modules)
+	{
+		moduleManager.registerBuiltinModule(module.szModuleName);
+		for (auto pLib = module.pLibraries; !pLib->isEndEntry(); pLib = pLib->iterNext())
+		{
+			for (auto pFunc = pLib->pFunctionEntries; !pFunc->isEndEntry(); pFunc = pFunc->iterNext())
+			{
+				symbolManager.registerBuiltinSymbol(module.szModuleName, pLib->szLibraryName,
+													pFunc->nNid, pFunc->pFunction);
+			}
+		}
+		builtinTable.addModule(module);
+	}
+
+	auto buildStart = std::chrono::high_resolution_clock::now();
+	builtinTable.freeze(policyManager);
+	auto buildEnd = std::chrono::high_resolution_clock::now();
+
+	printf("%zu imports, %zu builtin entries, table built in %.2f ms\n",
+		   imports.size(), builtinTable.size(),
+		   std::chrono::duration<double, std::milli>(buildEnd - buildStart).count());
+
+	double nestedNs = measure(imports, [&](Import const& import)
+	{
+		auto policy = policyManager.getSymbolPolicy(import.modName, import.libName, import.nid);
+		return policy == Policy::UseBuiltin ?
+			symbolManager.findBuiltinSymbol(import.modName, import.libName, import.nid) :
+			symbolManager.findNativeSymbol(import.modName, import.libName, import.nid);
+	});
+
+	double flatNs = measure(imports, [&](Import const& import)
+	{
+		auto entry = builtinTable.find(BuiltinSymbolTable::symbolKey(import.modName, import.libName, import.nid));
+		return entry != nullptr && entry->policy == Policy::UseBuiltin ? entry->address : nullptr;
+	});
+
+	printf("nested maps\t%.1f ns/import\n", nestedNs);
+	printf("perfect hash\t%.1f ns/import\n", flatNs);
+	return 0;
+}
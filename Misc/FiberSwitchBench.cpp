@@ -0,0 +1,171 @@
+// Measures the cost of a fiber switch.
+// Build together with Platform/PlatFiber.cpp and SceModules/SceFiber/sce_fiber.cpp.
+//
+// Usage: FiberSwitchBench [switches]
+// Reports nanoseconds per switch for the bare context switch, for
+// sceFiberRun/sceFiberReturnToThread, for sceFiberSwitch between two
+// fibers, and for handing control between two threads, which is what
+// mapping every fiber to a host thread would cost.
+
+#include "Platform/PlatFiber.h"
+#include "SceModules/SceFiber/sce_fiber.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+constexpr size_t StackSize = 64 * 1024;
+
+using Clock = std::chrono::steady_clock;
+
+static uint64_t g_nSwitches = 10000000;
+
+static double nsPerSwitch(Clock::time_point start, uint64_t nSwitches)
+{
+	return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / nSwitches;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Bare context switch
+
+static plat::FiberContext g_threadContext;
+static plat::FiberContext g_fiberContext;
+
+static void pingPongEntry(void* pParam)
+{
+	while (true)
+	{
+		plat::FiberContextSwitch(&g_fiberContext, &g_threadContext);
+	}
+}
+
+static double benchContextSwitch(uint8_t* pStack)
+{
+	plat::FiberContextInit(&g_fiberContext, pStack, StackSize, pingPongEntry, nullptr);
+
+	auto start = Clock::now();
+	for (uint64_t i = 0; i != g_nSwitches / 2; ++i)
+	{
+		plat::FiberContextSwitch(&g_threadContext, &g_fiberContext);
+	}
+	return nsPerSwitch(start, g_nSwitches / 2 * 2);
+}
+
+//////////////////////////////////////////////////////////////////////////
+// sceFiberRun and sceFiberReturnToThread
+
+static void PS4API returnEntry(uint64_t argOnInitialize, uint64_t argOnRun)
+{
+	while (true)
+	{
+		sceFiberReturnToThread(argOnRun + 1, &argOnRun);
+	}
+}
+
+static double benchRun(uint8_t* pStack)
+{
+	SceFiber fiber;
+	_sceFiberInitializeImpl(&fiber, "return", returnEntry, 0, pStack, StackSize, nullptr, 0);
+
+	uint64_t nResult = 0;
+	auto     start   = Clock::now();
+	for (uint64_t i = 0; i != g_nSwitches / 2; ++i)
+	{
+		sceFiberRun(&fiber, i, &nResult);
+	}
+	double ns = nsPerSwitch(start, g_nSwitches / 2 * 2);
+
+	if (nResult != g_nSwitches / 2)
+	{
+		printf("run returned %llu, expected %llu\n",
+			   (unsigned long long)nResult, (unsigned long long)(g_nSwitches / 2));
+	}
+	return ns;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// sceFiberSwitch between two fibers
+
+static SceFiber g_fibers[2];
+static uint64_t g_nSwitchCount;
+
+static void PS4API switchEntry(uint64_t nIndex, uint64_t argOnRun)
+{
+	while (++g_nSwitchCount < g_nSwitches)
+	{
+		sceFiberSwitch(&g_fibers[nIndex ^ 1], 0, nullptr);
+	}
+	sceFiberReturnToThread(0, nullptr);
+}
+
+static double benchSwitch(uint8_t* pStack)
+{
+	_sceFiberInitializeImpl(&g_fibers[0], "ping", switchEntry, 0, pStack, StackSize, nullptr, 0);
+	_sceFiberInitializeImpl(&g_fibers[1], "pong", switchEntry, 1, pStack + StackSize, StackSize, nullptr, 0);
+
+	g_nSwitchCount = 0;
+	auto start     = Clock::now();
+	sceFiberRun(&g_fibers[0], 0, nullptr);
+	return nsPerSwitch(start, g_nSwitches);
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Two host threads taking turns
+
+static double benchThreads()
+{
+	// Orders of magnitude slower, don't wait for all of them.
+	uint64_t nSwitches = std::min<uint64_t>(g_nSwitches, 200000);
+
+	std::mutex              mutex;
+	std::condition_variable cond;
+	uint64_t                nTurn = 0;
+
+	auto start = Clock::now();
+
+	std::thread other([&]()
+					  {
+						  std::unique_lock<std::mutex> lock(mutex);
+						  for (uint64_t i = 1; i < nSwitches; i += 2)
+						  {
+							  cond.wait(lock, [&]() { return nTurn == i; });
+							  ++nTurn;
+							  cond.notify_one();
+						  } });
+
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		for (uint64_t i = 0; i < nSwitches; i += 2)
+		{
+			cond.wait(lock, [&]() { return nTurn == i; });
+			++nTurn;
+			cond.notify_one();
+		}
+	}
+	other.join();
+	return nsPerSwitch(start, nSwitches);
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc > 1)
+	{
+		g_nSwitches = std::max<uint64_t>(strtoull(argv[1], nullptr, 10), 2);
+	}
+
+	std::vector<uint8_t> vtStacks(StackSize * 2);
+
+	// Warm up
+	benchContextSwitch(vtStacks.data());
+
+	printf("context switch      %8.1f ns\n", benchContextSwitch(vtStacks.data()));
+	printf("run/return          %8.1f ns\n", benchRun(vtStacks.data()));
+	printf("fiber switch        %8.1f ns\n", benchSwitch(vtStacks.data()));
+	printf("thread handoff      %8.1f ns\n", benchThreads());
+	return 0;
+}
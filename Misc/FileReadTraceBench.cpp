@@ -0,0 +1,214 @@
+// Replays a read trace against a local file with each file I/O backend.
+// Build together with Platform/PlatFile.cpp, define GPCS4_IO_URING on Linux
+// to include the io_uring backend.
+//
+// Usage: FileReadTraceBench [trace] [file]
+// Every trace line is "offset size fd". Reads of the same trace fd go through
+// the same host handle, offsets are wrapped to the size of the file. Without
+// a trace a mix of streamed and small random reads is generated. The file is
+// created with FileSize bytes if it doesn't exist. Drop the page cache
+// between runs to measure the disk instead of memcpy.
+
+#include "Platform/PlatFile.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <vector>
+
+constexpr uint64_t FileSize  = 256ull * 1024 * 1024;
+constexpr size_t   BatchSize = 16;
+constexpr uint32_t Rounds    = 3;
+
+struct TraceRead
+{
+	uint64_t nOffset;
+	uint32_t nSize;
+	int      fd;
+};
+
+std::vector<TraceRead> loadTrace(const char* szPath)
+{
+	std::vector<TraceRead> vtTrace;
+	FILE*                  pFile = fopen(szPath, "r");
+	if (!pFile)
+	{
+		printf("can't open trace %s\n", szPath);
+		return vtTrace;
+	}
+
+	unsigned long long nOffset = 0;
+	unsigned int       nSize   = 0;
+	int                fd      = 0;
+	while (fscanf(pFile, "%llu %u %d", &nOffset, &nSize, &fd) == 3)
+	{
+		vtTrace.push_back({ nOffset, nSize, fd });
+	}
+	fclose(pFile);
+	return vtTrace;
+}
+
+std::vector<TraceRead> makeTrace()
+{
+	// Four streams reading 256 KiB at a time, like
+	// audio and texture streaming, between them small
+	// random reads of a few KiB, like asset headers.
+	std::vector<TraceRead> vtTrace;
+	std::mt19937_64        rng(4);
+	uint64_t               streams[4] = { 0, FileSize / 4, FileSize / 2, FileSize / 4 * 3 };
+	for (uint32_t i = 0; i != 8192; ++i)
+	{
+		if (i % 3 == 0)
+		{
+			uint32_t nStream = (i / 3) % 4;
+			vtTrace.push_back({ streams[nStream], 256 * 1024, int(3 + nStream) });
+			streams[nStream] += 256 * 1024;
+		}
+		else
+		{
+			uint64_t nOffset = rng() % FileSize & ~uint64_t(511);
+			vtTrace.push_back({ nOffset, uint32_t(512 + rng() % (16 * 1024)), 7 });
+		}
+	}
+	return vtTrace;
+}
+
+bool prepareFile(const char* szPath)
+{
+	plat::FileHandle hFile = plat::FileOpen(szPath, plat::FOF_READ);
+	if (hFile != plat::INVALID_FILE_HANDLE)
+	{
+		plat::FileClose(hFile);
+		return true;
+	}
+
+	hFile = plat::FileOpen(szPath, plat::FOF_READ_WRITE | plat::FOF_CREATE);
+	if (hFile == plat::INVALID_FILE_HANDLE)
+	{
+		return false;
+	}
+
+	std::vector<uint8_t> vtChunk(4 * 1024 * 1024);
+	std::mt19937         rng(1);
+	for (auto& nByte : vtChunk)
+	{
+		nByte = uint8_t(rng());
+	}
+
+	bool bRet = true;
+	for (uint64_t nOffset = 0; bRet && nOffset < FileSize; nOffset += vtChunk.size())
+	{
+		bRet = plat::FileWriteAt(hFile, vtChunk.data(), vtChunk.size(), nOffset) == int64_t(vtChunk.size());
+	}
+	plat::FileClose(hFile);
+	return bRet;
+}
+
+void replay(const char* szName, const std::vector<TraceRead>& vtTrace, const char* szPath)
+{
+	// One host handle per trace fd
+	std::map<int, plat::FileHandle> handles;
+	for (const auto& read : vtTrace)
+	{
+		if (!handles.count(read.fd))
+		{
+			handles[read.fd] = plat::FileOpen(szPath, plat::FOF_READ);
+		}
+	}
+
+	int64_t nFileSize = plat::FileGetSize(handles.begin()->second);
+	size_t  nMaxRead  = 0;
+	for (const auto& read : vtTrace)
+	{
+		nMaxRead = std::max<size_t>(nMaxRead, read.nSize);
+	}
+
+	std::vector<std::vector<uint8_t>>  vtBuffers(BatchSize, std::vector<uint8_t>(nMaxRead));
+	std::vector<plat::FileReadRequest> vtRequests(BatchSize);
+	std::vector<double>                vtLatencies;
+
+	uint64_t nBytes  = 0;
+	uint32_t nErrors = 0;
+	auto     start   = std::chrono::high_resolution_clock::now();
+	for (uint32_t nRound = 0; nRound != Rounds; ++nRound)
+	{
+		for (size_t nFirst = 0; nFirst < vtTrace.size(); nFirst += BatchSize)
+		{
+			size_t nCount = std::min(BatchSize, vtTrace.size() - nFirst);
+			for (size_t i = 0; i != nCount; ++i)
+			{
+				const auto& read       = vtTrace[nFirst + i];
+				vtRequests[i].hFile   = handles[read.fd];
+				vtRequests[i].pBuffer = vtBuffers[i].data();
+				vtRequests[i].nSize   = read.nSize;
+				vtRequests[i].nOffset = read.nOffset % nFileSize;
+			}
+
+			auto batchStart = std::chrono::high_resolution_clock::now();
+			plat::FileReadBatch(vtRequests.data(), nCount);
+			auto batchEnd = std::chrono::high_resolution_clock::now();
+			vtLatencies.push_back(std::chrono::duration<double, std::micro>(batchEnd - batchStart).count());
+
+			for (size_t i = 0; i != nCount; ++i)
+			{
+				if (vtRequests[i].nResult < 0)
+				{
+					++nErrors;
+					continue;
+				}
+				nBytes += vtRequests[i].nResult;
+			}
+		}
+	}
+	auto end = std::chrono::high_resolution_clock::now();
+
+	for (const auto& handle : handles)
+	{
+		plat::FileClose(handle.second);
+	}
+
+	std::sort(vtLatencies.begin(), vtLatencies.end());
+	double seconds = std::chrono::duration<double>(end - start).count();
+	double average = 0;
+	for (double latency : vtLatencies)
+	{
+		average += latency;
+	}
+	average /= vtLatencies.size();
+
+	printf("%s\t%.1f\t\t%.1f\t\t%.1f\t\t%u\n", szName,
+		   nBytes / seconds / (1024 * 1024),
+		   average,
+		   vtLatencies[vtLatencies.size() * 99 / 100],
+		   nErrors);
+}
+
+int main(int argc, char* argv[])
+{
+	const char* szPath = argc > 2 ? argv[2] : "FileReadTraceBench.bin";
+
+	std::vector<TraceRead> vtTrace = argc > 1 ? loadTrace(argv[1]) : makeTrace();
+	if (vtTrace.empty() || !prepareFile(szPath))
+	{
+		printf("nothing to replay\n");
+		return 1;
+	}
+
+	printf("%zu reads, batches of %zu, %u rounds\n", vtTrace.size(), BatchSize, Rounds);
+	printf("backend\t\tMiB/s\t\tbatch us\tp99 us\t\terrors\n");
+
+	plat::FileSetIoBackend(plat::FIB_THREAD_POOL);
+	replay("thread pool", vtTrace, szPath);
+
+	if (plat::FileSetIoBackend(plat::FIB_IO_URING))
+	{
+		replay("io_uring", vtTrace, szPath);
+	}
+	else
+	{
+		printf("io_uring\tnot supported\n");
+	}
+	return 0;
+}
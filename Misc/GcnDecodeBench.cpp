@@ -0,0 +1,125 @@
+// GCN decode throughput benchmark, decoding the shader once per pass
+// against decoding it once into a GcnDecodedProgram and iterating twice.
+// Build together with Graphics/Gcn/GcnDecoder.cpp, Graphics/Gcn/GcnInstruction.cpp,
+// Graphics/Gcn/GcnHeader.cpp, Graphics/Gcn/GcnDecodedProgram.cpp and their dependencies.
+//
+// usage: GcnDecodeBench [shader.bin]
+// The file holds the shader as it is found in guest memory, starting with
+// s_mov_b32 vcc_hi and followed by the OrbShdr header, without it the
+// pixel shader in test_p.h is used.
+
+#include "Graphics/Gcn/GcnDecodedProgram.h"
+#include "Graphics/Gcn/GcnDecoder.h"
+#include "Graphics/Gcn/GcnHeader.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+using namespace sce::gcn;
+
+constexpr uint32_t Rounds = 20000;
+// analyzer and compiler
+constexpr uint32_t PassCount = 2;
+
+static const uint32_t g_testShader[] = {
+#include "test_p.h"
+};
+
+static std::vector<uint32_t> loadShader(const char* path)
+{
+	std::ifstream        fin(path, std::ios::binary);
+	std::vector<uint8_t> bytes(std::istreambuf_iterator<char>(fin), {});
+	std::vector<uint32_t> code((bytes.size() + 3) / sizeof(uint32_t));
+	std::copy(bytes.begin(), bytes.end(), reinterpret_cast<uint8_t*>(code.data()));
+	return code;
+}
+
+static std::vector<uint32_t> builtinShader()
+{
+	// skip the sb file header in front of the code
+	const uint32_t  tokenMovVccHi = 0xBEEB03FF;
+	const uint32_t* begin         = std::begin(g_testShader);
+	const uint32_t* end           = std::end(g_testShader);
+	return std::vector<uint32_t>(std::find(begin, end, tokenMovVccHi), end);
+}
+
+template <typename Fn>
+double measure(uint32_t codeSize, Fn run)
+{
+	uint64_t checksum = 0;
+
+	auto start = std::chrono::high_resolution_clock::now();
+	for (uint32_t r = 0; r != Rounds; ++r)
+	{
+		checksum += run();
+	}
+	auto end = std::chrono::high_resolution_clock::now();
+
+	printf("  checksum %llx\n", static_cast<unsigned long long>(checksum));
+	double seconds = std::chrono::duration<double>(end - start).count();
+	return double(codeSize) * Rounds / seconds / (1024.0 * 1024.0);
+}
+
+int main(int argc, char* argv[])
+{
+	auto code = argc > 1 ? loadShader(argv[1]) : builtinShader();
+
+	GcnHeader    header(reinterpret_cast<const uint8_t*>(code.data()));
+	GcnCodeSlice slice(code.data(), code.data() + header.length() / sizeof(uint32_t));
+
+	GcnDecodedProgram program(slice);
+	printf("%u bytes, %u instructions, %zu basic blocks\n",
+		   header.length(), program.instructionCount(), program.blocks().size());
+
+	double decodeEachPass = measure(header.length(), [&]()
+	{
+		uint64_t sum = 0;
+		for (uint32_t pass = 0; pass != PassCount; ++pass)
+		{
+			GcnDecodeContext decoder;
+			GcnCodeSlice     code = slice;
+			while (!code.atEnd())
+			{
+				decoder.decodeInstruction(code);
+				sum += uint32_t(decoder.getInstruction().opcode);
+			}
+		}
+		return sum;
+	});
+
+	double decodeOnce = measure(header.length(), [&]()
+	{
+		uint64_t          sum = 0;
+		GcnDecodedProgram decoded(slice);
+		for (uint32_t pass = 0; pass != PassCount; ++pass)
+		{
+			for (const auto& ins : decoded.instructions())
+			{
+				sum += uint32_t(ins.opcode);
+			}
+		}
+		return sum;
+	});
+
+	double cached = measure(header.length(), [&]()
+	{
+		uint64_t sum = 0;
+		for (uint32_t pass = 0; pass != PassCount; ++pass)
+		{
+			for (const auto& ins : program.instructions())
+			{
+				sum += uint32_t(ins.opcode);
+			}
+		}
+		return sum;
+	});
+
+	printf("decode per pass\t%.1f MiB/s\n", decodeEachPass);
+	printf("decode once\t%.1f MiB/s\n", decodeOnce);
+	printf("cached program\t%.1f MiB/s\n", cached);
+	return 0;
+}
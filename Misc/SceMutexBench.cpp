@@ -0,0 +1,76 @@
+// Contention benchmark of the native guest mutex against pthreads4w.
+// Build together with SceModules/SceLibkernel/SceMutex.cpp and Platform/PlatThread.cpp.
+
+#include "SceModules/SceLibkernel/SceMutex.h"
+#include "SceModules/SceLibkernel/sce_kernel_scepthread.h"
+
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+constexpr uint32_t IterationsPerThread = 200000;
+
+template <typename LockFn, typename UnlockFn>
+double runContention(uint32_t threadCount, LockFn lock, UnlockFn unlock)
+{
+	volatile uint64_t counter = 0;
+
+	auto start = std::chrono::high_resolution_clock::now();
+
+	std::vector<std::thread> threads;
+	for (uint32_t t = 0; t != threadCount; ++t)
+	{
+		threads.emplace_back([&]()
+		{
+			for (uint32_t i = 0; i != IterationsPerThread; ++i)
+			{
+				lock();
+				counter = counter + 1;
+				unlock();
+			}
+		});
+	}
+
+	for (auto& thread : threads)
+	{
+		thread.join();
+	}
+
+	auto end = std::chrono::high_resolution_clock::now();
+	if (counter != uint64_t(threadCount) * IterationsPerThread)
+	{
+		printf("counter mismatch!\n");
+	}
+
+	auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+	return double(ns) / (double(threadCount) * IterationsPerThread);
+}
+
+int main()
+{
+	printf("threads\tsce ns/op\tpthreads4w ns/op\n");
+	for (uint32_t threadCount = 2; threadCount <= 32; threadCount *= 2)
+	{
+		CSceMutex native(SceMutexAttr{ SCE_PTHREAD_MUTEX_ERRORCHECK, SCE_PTHREAD_PRIO_NONE, 0 }, "bench");
+		double nativeNs = runContention(
+			threadCount,
+			[&]() { native.Lock(); },
+			[&]() { native.Unlock(); });
+
+		pthread_mutexattr_t attr;
+		pthread_mutexattr_init(&attr);
+		pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_ERRORCHECK);
+		pthread_mutex_t legacy;
+		pthread_mutex_init(&legacy, &attr);
+		pthread_mutexattr_destroy(&attr);
+		double legacyNs = runContention(
+			threadCount,
+			[&]() { pthread_mutex_lock(&legacy); },
+			[&]() { pthread_mutex_unlock(&legacy); });
+		pthread_mutex_destroy(&legacy);
+
+		printf("%u\t%.1f\t\t%.1f\n", threadCount, nativeNs, legacyNs);
+	}
+	return 0;
+}
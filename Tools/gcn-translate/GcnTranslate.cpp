@@ -0,0 +1,445 @@
+// gcn-translate: offline batch shader translator.
+//
+// Translates a directory of shaders dumped by the emulator (GCN_DUMP_SHADER,
+// see Graphics/Gcn/GcnShaderDump.h) to SPIR-V on a thread pool, checks the
+// SPIR-V structurally and reports translate time, SPIR-V size and failures
+// per shader. Given a previous report as baseline it also fails on new
+// failures and on translate time regressions, so it can run in CI without
+// a GPU.
+//
+// usage: gcn-translate -i shader_dump [-o report.csv] [-b baseline.csv]
+//                      [-s 1.25] [-j threads] [-r repeat]
+
+// Operand helpers of spirv.hpp, for the id checks.
+#define SPV_ENABLE_UTILITY_CODE
+
+#include "Graphics/Gcn/GcnModule.h"
+#include "Graphics/Gcn/GcnShaderDump.h"
+#include "Graphics/Violet/VltShader.h"
+#include "UtilThreadPool.h"
+
+#include <cxxopts/cxxopts.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace sce;
+using namespace sce::gcn;
+
+namespace
+{
+	struct TranslateResult
+	{
+		std::string name;
+		std::string stage;
+		double      milliseconds = 0.0;
+		size_t      spirvSize    = 0;
+		std::string error;
+	};
+
+	struct AssertionFailure : std::runtime_error
+	{
+		using std::runtime_error::runtime_error;
+	};
+
+	void throwAssertion(const char* message)
+	{
+		throw AssertionFailure(message);
+	}
+
+	bool isBlockTerminator(spv::Op op)
+	{
+		return op == spv::OpBranch ||
+			   op == spv::OpBranchConditional ||
+			   op == spv::OpSwitch ||
+			   op == spv::OpReturn ||
+			   op == spv::OpReturnValue ||
+			   op == spv::OpKill ||
+			   op == spv::OpUnreachable;
+	}
+
+	/**
+	 * \brief Structural SPIR-V check
+	 *
+	 * Checks what a broken translator typically gets wrong:
+	 * instruction lengths, result ids against the bound,
+	 * duplicate ids, module layout and block structure.
+	 * Not a replacement for spirv-val, but needs no SDK.
+	 * \returns Empty string if the module is well formed
+	 */
+	std::string validateSpirv(const std::vector<uint32_t>& code)
+	{
+		if (code.size() < 5 || code[0] != spv::MagicNumber)
+		{
+			return "bad header";
+		}
+
+		uint32_t          bound = code[3];
+		std::vector<bool> defined(bound, false);
+
+		uint32_t memoryModels  = 0;
+		uint32_t entryPoints   = 0;
+		bool     inFunction    = false;
+		bool     inBlock       = false;
+		bool     needLabel     = false;
+		uint32_t functionCount = 0;
+
+		size_t offset = 5;
+		while (offset < code.size())
+		{
+			uint32_t wordCount = code[offset] >> 16;
+			auto     op        = spv::Op(code[offset] & 0xFFFF);
+
+			if (wordCount == 0 || offset + wordCount > code.size())
+			{
+				return "bad instruction length at word " + std::to_string(offset);
+			}
+
+			bool hasResult = false;
+			bool hasType   = false;
+			spv::HasResultAndType(op, &hasResult, &hasType);
+			if (hasResult)
+			{
+				uint32_t index = hasType ? 2 : 1;
+				if (index >= wordCount)
+				{
+					return "missing result id at word " + std::to_string(offset);
+				}
+
+				uint32_t id = code[offset + index];
+				if (id == 0 || id >= bound)
+				{
+					return "result id " + std::to_string(id) + " out of bound";
+				}
+				if (defined[id])
+				{
+					return "result id " + std::to_string(id) + " defined twice";
+				}
+				defined[id] = true;
+			}
+
+			switch (op)
+			{
+			case spv::OpMemoryModel:
+				++memoryModels;
+				break;
+			case spv::OpEntryPoint:
+				++entryPoints;
+				break;
+			case spv::OpFunction:
+				if (inFunction)
+				{
+					return "nested function";
+				}
+				inFunction = true;
+				needLabel  = true;
+				++functionCount;
+				break;
+			case spv::OpFunctionEnd:
+				if (!inFunction || inBlock)
+				{
+					return "function end without terminated block";
+				}
+				inFunction = false;
+				needLabel  = false;
+				break;
+			case spv::OpFunctionParameter:
+				break;
+			case spv::OpLabel:
+				if (!inFunction || inBlock)
+				{
+					return "label inside an unterminated block";
+				}
+				inBlock   = true;
+				needLabel = false;
+				break;
+			default:
+				if (inFunction && needLabel)
+				{
+					return "function body does not start with a label";
+				}
+				if (isBlockTerminator(op))
+				{
+					if (!inBlock)
+					{
+						return "terminator outside of a block";
+					}
+					inBlock = false;
+				}
+				break;
+			}
+
+			offset += wordCount;
+		}
+
+		if (inFunction)
+		{
+			return "unterminated function";
+		}
+		if (memoryModels != 1)
+		{
+			return "expected one memory model";
+		}
+		if (entryPoints == 0 || functionCount == 0)
+		{
+			return "no entry point";
+		}
+		return std::string();
+	}
+
+	TranslateResult translateShader(
+		const std::string& metaPath,
+		uint32_t           repeat)
+	{
+		TranslateResult result;
+
+		GcnShaderDump dump;
+		if (!gcnLoadShaderDump(metaPath, dump))
+		{
+			result.name  = std::filesystem::path(metaPath).stem().string();
+			result.error = "failed to load dump";
+			return result;
+		}
+
+		result.name  = dump.name;
+		result.stage = gcnProgramTypeName(dump.info.type);
+
+		try
+		{
+			GcnModule module(dump.info.type, dump.code.data());
+
+			vlt::Rc<vlt::VltShader> shader;
+			result.milliseconds = 0.0;
+			for (uint32_t i = 0; i != repeat; ++i)
+			{
+				auto start = std::chrono::high_resolution_clock::now();
+				shader     = module.compile(dump.info.meta);
+				auto end   = std::chrono::high_resolution_clock::now();
+
+				double ms = std::chrono::duration<double, std::milli>(end - start).count();
+				result.milliseconds = i == 0 ? ms : std::min(result.milliseconds, ms);
+			}
+
+			std::stringstream stream;
+			shader->dump(stream);
+			std::string bytes = stream.str();
+
+			std::vector<uint32_t> spirv(bytes.size() / sizeof(uint32_t));
+			std::memcpy(spirv.data(), bytes.data(), spirv.size() * sizeof(uint32_t));
+
+			result.spirvSize = bytes.size();
+			result.error     = validateSpirv(spirv);
+		}
+		catch (const std::exception& e)
+		{
+			result.error = e.what();
+		}
+		return result;
+	}
+
+	std::string csvField(std::string field)
+	{
+		// Keep one record per line, messages may be multi-line.
+		std::replace(field.begin(), field.end(), '\n', ' ');
+		std::replace(field.begin(), field.end(), ',', ';');
+		return field;
+	}
+
+	void writeReport(
+		const std::string&                  path,
+		const std::vector<TranslateResult>& results)
+	{
+		std::ofstream fout(path, std::ofstream::trunc);
+		fout << "name,stage,ms,spirv_bytes,error\n";
+		for (const auto& r : results)
+		{
+			fout << r.name << ',' << r.stage << ',' << r.milliseconds << ','
+				 << r.spirvSize << ',' << csvField(r.error) << '\n';
+		}
+	}
+
+	std::map<std::string, TranslateResult> readReport(
+		const std::string& path)
+	{
+		std::map<std::string, TranslateResult> results;
+
+		std::ifstream fin(path);
+		std::string   line;
+		std::getline(fin, line);  // column names
+		while (std::getline(fin, line))
+		{
+			std::stringstream        ss(line);
+			std::vector<std::string> fields;
+			std::string              field;
+			while (std::getline(ss, field, ','))
+			{
+				fields.push_back(field);
+			}
+			fields.resize(5);
+
+			TranslateResult r;
+			r.name         = fields[0];
+			r.stage        = fields[1];
+			r.milliseconds = fields[2].empty() ? 0.0 : std::stod(fields[2]);
+			r.spirvSize    = fields[3].empty() ? 0 : std::stoull(fields[3]);
+			r.error        = fields[4];
+			results.emplace(r.name, r);
+		}
+		return results;
+	}
+
+	/**
+	 * \brief Compares against a baseline report
+	 *
+	 * Individual shaders are too fast to time reliably,
+	 * so only the total time of the shaders present in
+	 * both reports is compared. The SPIR-V size of those
+	 * shaders is printed as well, to measure compiler
+	 * changes, but never counts as regression.
+	 * \returns Number of regressions
+	 */
+	uint32_t compareBaseline(
+		const std::vector<TranslateResult>&           results,
+		const std::map<std::string, TranslateResult>& baseline,
+		double                                        maxSlowdown)
+	{
+		uint32_t regressions  = 0;
+		double   totalCurrent = 0.0;
+		double   totalBase    = 0.0;
+		size_t   spirvCurrent = 0;
+		size_t   spirvBase    = 0;
+
+		for (const auto& r : results)
+		{
+			auto iter = baseline.find(r.name);
+			if (iter == baseline.end())
+			{
+				continue;
+			}
+
+			const auto& base = iter->second;
+			if (!r.error.empty() && base.error.empty())
+			{
+				printf("REGRESSION %s: %s\n", r.name.c_str(), r.error.c_str());
+				++regressions;
+			}
+
+			if (r.error.empty() && base.error.empty())
+			{
+				totalCurrent += r.milliseconds;
+				totalBase += base.milliseconds;
+				spirvCurrent += r.spirvSize;
+				spirvBase += base.spirvSize;
+			}
+		}
+
+		if (spirvBase != 0)
+		{
+			printf("spir-v %zu bytes, baseline %zu bytes (%+.1f%%)\n",
+				   spirvCurrent, spirvBase,
+				   (double(spirvCurrent) / double(spirvBase) - 1.0) * 100.0);
+		}
+
+		if (totalBase > 0.0 && totalCurrent > totalBase * maxSlowdown)
+		{
+			printf("REGRESSION translate time %.2f ms, baseline %.2f ms\n",
+				   totalCurrent, totalBase);
+			++regressions;
+		}
+		return regressions;
+	}
+
+}  // namespace
+
+int main(int argc, char* argv[])
+{
+	cxxopts::Options opts("gcn-translate", "Offline GCN to SPIR-V batch translator");
+	opts.add_options()
+		("i,input", "Directory of dumped shaders.", cxxopts::value<std::string>())
+		("o,output", "Write the report as csv.", cxxopts::value<std::string>())
+		("b,baseline", "Report to compare against.", cxxopts::value<std::string>())
+		("s,max-slowdown", "Allowed total translate time ratio against the baseline.", cxxopts::value<double>()->default_value("1.25"))
+		("j,jobs", "Worker thread count, 0 for one per core.", cxxopts::value<uint32_t>()->default_value("0"))
+		("r,repeat", "Translate each shader this often and keep the fastest time.", cxxopts::value<uint32_t>()->default_value("1"))
+		("D,debug-channel", "Enable debug channel.", cxxopts::value<std::vector<std::string>>())
+		("H,help", "Print help message.");
+
+	auto optResult = opts.parse(argc, argv);
+	if (optResult.count("H") || !optResult.count("i"))
+	{
+		printf("%s\n", opts.help().c_str());
+		return -1;
+	}
+
+	logsys::init(optResult);
+	// A failing assertion fails the shader, not the run.
+	logsys::setAssertHandler(throwAssertion);
+
+	std::vector<std::string> metaFiles;
+	for (const auto& entry : std::filesystem::directory_iterator(optResult["i"].as<std::string>()))
+	{
+		if (entry.path().extension() == ".meta")
+		{
+			metaFiles.push_back(entry.path().string());
+		}
+	}
+	std::sort(metaFiles.begin(), metaFiles.end());
+
+	uint32_t repeat = std::max(1u, optResult["r"].as<uint32_t>());
+
+	std::vector<TranslateResult> results(metaFiles.size());
+
+	auto start = std::chrono::high_resolution_clock::now();
+	{
+		util::ThreadPool workers(optResult["j"].as<uint32_t>());
+		workers.parallelFor(metaFiles.size(), [&](size_t i)
+		{
+			results[i] = translateShader(metaFiles[i], repeat);
+		});
+	}
+	auto end = std::chrono::high_resolution_clock::now();
+
+	uint32_t failures   = 0;
+	size_t   totalSpirv = 0;
+	double   totalMs    = 0.0;
+	for (const auto& r : results)
+	{
+		printf("%-40s %s %9.3f ms %8zu bytes %s\n",
+			   r.name.c_str(), r.stage.c_str(), r.milliseconds, r.spirvSize,
+			   r.error.empty() ? "ok" : r.error.c_str());
+
+		failures += r.error.empty() ? 0 : 1;
+		totalSpirv += r.spirvSize;
+		totalMs += r.milliseconds;
+	}
+
+	double wallMs = std::chrono::duration<double, std::milli>(end - start).count();
+	printf("%zu shaders, %u failed, %.2f ms translate, %.2f ms wall, %zu bytes spir-v\n",
+		   results.size(), failures, totalMs, wallMs, totalSpirv);
+
+	if (optResult.count("o"))
+	{
+		writeReport(optResult["o"].as<std::string>(), results);
+	}
+
+	uint32_t regressions = 0;
+	if (optResult.count("b"))
+	{
+		regressions = compareBaseline(
+			results,
+			readReport(optResult["b"].as<std::string>()),
+			optResult["s"].as<double>());
+	}
+
+	logsys::shutdown();
+	return regressions == 0 ? 0 : 1;
+}